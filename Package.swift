@@ -18,7 +18,22 @@ let package = Package(
             targets: ["SDWebImage"]),
         .library(
             name: "SDWebImageMapKit",
-            targets: ["SDWebImageMapKit"])
+            targets: ["SDWebImageMapKit"]),
+        .library(
+            name: "SDWebImageTurboJPEGCoder",
+            targets: ["SDWebImageTurboJPEGCoder"]),
+        .library(
+            name: "SDWebImageSPNGCoder",
+            targets: ["SDWebImageSPNGCoder"]),
+        .library(
+            name: "SDWebImageGIFLibCoder",
+            targets: ["SDWebImageGIFLibCoder"]),
+        .library(
+            name: "SDWebImageLibWebPCoder",
+            targets: ["SDWebImageLibWebPCoder"]),
+        .library(
+            name: "SDWebImageLibAVIFCoder",
+            targets: ["SDWebImageLibAVIFCoder"])
     ],
     dependencies: [
         // Dependencies declare other packages that this package depends on.
@@ -44,6 +59,66 @@ let package = Package(
             path: "SDWebImageMapKit",
             sources: ["MapKit"],
             resources: [.copy("Resources/PrivacyInfo.xcprivacy")]
+        ),
+        // The reference coders are plugins which link the system C libraries
+        .systemLibrary(
+            name: "CTurboJPEG",
+            path: "SDWebImageCoders/Libraries/CTurboJPEG",
+            pkgConfig: "libturbojpeg",
+            providers: [.brew(["jpeg-turbo"]), .apt(["libturbojpeg0-dev"])]
+        ),
+        .systemLibrary(
+            name: "CSPNG",
+            path: "SDWebImageCoders/Libraries/CSPNG",
+            pkgConfig: "spng",
+            providers: [.brew(["libspng"]), .apt(["libspng-dev"])]
+        ),
+        .systemLibrary(
+            name: "CGIFLib",
+            path: "SDWebImageCoders/Libraries/CGIFLib",
+            providers: [.brew(["giflib"]), .apt(["libgif-dev"])]
+        ),
+        .systemLibrary(
+            name: "CLibWebP",
+            path: "SDWebImageCoders/Libraries/CLibWebP",
+            pkgConfig: "libwebpdemux",
+            providers: [.brew(["webp"]), .apt(["libwebp-dev"])]
+        ),
+        .systemLibrary(
+            name: "CLibAVIF",
+            path: "SDWebImageCoders/Libraries/CLibAVIF",
+            pkgConfig: "libavif",
+            providers: [.brew(["libavif"]), .apt(["libavif-dev"])]
+        ),
+        .target(
+            name: "SDWebImageCoderCommon",
+            dependencies: ["SDWebImage"],
+            path: "SDWebImageCoders/Common"
+        ),
+        .target(
+            name: "SDWebImageTurboJPEGCoder",
+            dependencies: ["SDWebImage", "SDWebImageCoderCommon", "CTurboJPEG"],
+            path: "SDWebImageCoders/TurboJPEG"
+        ),
+        .target(
+            name: "SDWebImageSPNGCoder",
+            dependencies: ["SDWebImage", "SDWebImageCoderCommon", "CSPNG"],
+            path: "SDWebImageCoders/SPNG"
+        ),
+        .target(
+            name: "SDWebImageGIFLibCoder",
+            dependencies: ["SDWebImage", "SDWebImageCoderCommon", "CGIFLib"],
+            path: "SDWebImageCoders/GIFLib"
+        ),
+        .target(
+            name: "SDWebImageLibWebPCoder",
+            dependencies: ["SDWebImage", "SDWebImageCoderCommon", "CLibWebP"],
+            path: "SDWebImageCoders/LibWebP"
+        ),
+        .target(
+            name: "SDWebImageLibAVIFCoder",
+            dependencies: ["SDWebImage", "SDWebImageCoderCommon", "CLibAVIF"],
+            path: "SDWebImageCoders/LibAVIF"
         )
     ]
 )
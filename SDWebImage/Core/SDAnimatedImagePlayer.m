@@ -7,6 +7,7 @@
 */
 
 #import "SDAnimatedImagePlayer.h"
+#import "SDAnimatedImagePlayerInternal.h"
 #import "NSImage+Compatibility.h"
 #import "SDDisplayLink.h"
 #import "SDDeviceHelper.h"
@@ -139,6 +140,30 @@
     [self.framePool removeAllFrames];
 }
 
+- (void)replaceProvider:(id<SDAnimatedImageProvider>)provider {
+    if (!provider || provider == self.animatedProvider) {
+        return;
+    }
+    NSUInteger animatedImageFrameCount = provider.animatedImageFrameCount;
+    if (animatedImageFrameCount < self.totalFrameCount) {
+        return;
+    }
+    SDImageFramePool *framePool = [SDImageFramePool registerProvider:provider];
+    framePool.maxBufferCount = self.framePool.maxBufferCount;
+    // Move the decoded frames, the frame index is the same for the new provider
+    for (NSUInteger i = 0; i < self.totalFrameCount; i++) {
+        UIImage *frame = [self.framePool frameAtIndex:i];
+        if (frame && ![framePool frameAtIndex:i]) {
+            [framePool setFrame:frame atIndex:i];
+        }
+    }
+    [SDImageFramePool unregisterProvider:self.animatedProvider];
+    self.animatedProvider = provider;
+    self.framePool = framePool;
+    self.totalFrameCount = animatedImageFrameCount;
+    self.totalLoopCount = provider.animatedImageLoopCount;
+}
+
 #pragma mark - Animation Control
 - (void)startPlaying {
     [self.displayLink start];
@@ -332,10 +357,9 @@
     if (self.maxBufferSize > 0) {
         max = self.maxBufferSize;
     } else {
-        // Calculate based on current memory, these factors are by experience
-        NSUInteger total = [SDDeviceHelper totalMemory];
-        NSUInteger free = [SDDeviceHelper freeMemory];
-        max = MIN(total * 0.2, free * 0.6);
+        // Calculate based on the real headroom of current process, these factors are by experience
+        SDMemoryBudget budget = [SDDeviceHelper memoryBudget];
+        max = MIN(budget.limit * 0.2, budget.available * 0.6);
     }
     
     NSUInteger maxBufferCount = (double)max / (double)bytes;
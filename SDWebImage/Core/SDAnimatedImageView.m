@@ -13,6 +13,7 @@
 #import "UIImage+Metadata.h"
 #import "NSImage+Compatibility.h"
 #import "SDInternalMacros.h"
+#import "SDAnimatedImagePlayerInternal.h"
 #import "objc/runtime.h"
 
 // A wrapper to implements the transformer on animated image, like tint color
@@ -96,6 +97,7 @@
 @property (nonatomic, assign, readwrite) NSUInteger currentLoopCount;
 @property (nonatomic, assign) BOOL shouldAnimate;
 @property (nonatomic, assign) BOOL isProgressive;
+@property (nonatomic, assign) BOOL isProgressiveFinished;
 @property (nonatomic) CALayer *imageViewLayer; // The actual rendering layer.
 
 @end
@@ -183,7 +185,7 @@
     // Check Progressive rendering
     [self updateIsProgressiveWithImage:image];
     
-    if (!self.isProgressive) {
+    if (!self.isProgressive && !self.isProgressiveFinished) {
         // Stop animating
         self.player = nil;
         self.currentFrame = nil;
@@ -212,8 +214,31 @@
                 self.player = [SDAnimatedImagePlayer playerWithProvider:provider];
             }
         } else {
-            // Update Frame Count
-            self.player.totalFrameCount = [(id<SDAnimatedImage>)image animatedImageFrameCount];
+            // Progressive animation append the new received frames to the running player, keep the current frame index and frame buffer
+            NSUInteger previousFrameCount = self.player.totalFrameCount;
+            if (self.isProgressiveFinished) {
+                // The final image of progressive loading, hand it over to the running player
+                id<SDAnimatedImageProvider> provider = (id<SDAnimatedImage>)image;
+                if (self.animationTransformer) {
+                    provider = [[SDAnimatedImageFrameProvider alloc] initWithProvider:provider transformer:self.animationTransformer];
+                }
+                [self.player replaceProvider:provider];
+                if (self.shouldCustomLoopCount) {
+                    self.player.totalLoopCount = self.animationRepeatCount;
+                }
+            } else {
+                self.player.totalFrameCount = [(id<SDAnimatedImage>)image animatedImageFrameCount];
+            }
+            if (self.player.isPlaying) {
+                [self.imageViewLayer setNeedsDisplay];
+                return;
+            }
+            if (self.isProgressiveFinished || self.currentFrameIndex + 1 == previousFrameCount) {
+                // Paused at the previous last frame waiting for new frames, or finished loading. Resume without reset
+                [self checkPlay];
+                [self.imageViewLayer setNeedsDisplay];
+                return;
+            }
         }
         
         if (!self.player) {
@@ -514,7 +539,9 @@
 // Update progressive status only after `setImage:` call.
 - (void)updateIsProgressiveWithImage:(UIImage *)image
 {
+    BOOL wasProgressive = self.isProgressive;
     self.isProgressive = NO;
+    self.isProgressiveFinished = NO;
     if (!self.shouldIncrementalLoad) {
         // Early return
         return;
@@ -534,6 +561,11 @@
                 self.isProgressive = YES;
             }
         }
+    } else if (wasProgressive && self.player && [image.class conformsToProtocol:@protocol(SDAnimatedImage)] && !image.sd_isIncremental) {
+        // The final image after progressive loading, which contains all the received frames, can continue the running player
+        if ([(id<SDAnimatedImage>)image animatedImageFrameCount] >= self.player.totalFrameCount) {
+            self.isProgressiveFinished = YES;
+        }
     }
 }
 
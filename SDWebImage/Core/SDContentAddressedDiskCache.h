@@ -0,0 +1,46 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDWebImageCompat.h"
+#import "SDDiskCache.h"
+
+/**
+ A content-addressed disk cache, which store the same bytes only once even they are associated with different keys (such as the same image served with signed query strings, tracking parameters or mirror hosts).
+ Each key is mapped to the SHA-256 hash of its data, the data file is shared by all the keys with the same hash and reference counted. The data is hashed before writing, duplicate stores are detected and do not write the data again.
+ To use this, set `SDImageCacheConfig.diskCacheClass` to this class.
+
+ @note The `cachePathForKey:` returns the shared data file of all the keys with the same hash, not a per-key path. The file is read-only, write the data with `setData:forKey:` instead. The extended data, expiration date and eviction entry (access count, fetch cost and priority) are still associated with each key.
+ @note The expiration and size limit are applied to the keys (by `diskCacheExpireType` and `diskEvictionPolicy`), the data file is removed when no key references it. The `totalSize` and `totalAllocatedSize` count the shared data only once.
+ */
+@interface SDContentAddressedDiskCache : NSObject <SDDiskCache>
+
+/**
+ Cache Config object - storing all kind of settings.
+ */
+@property (nonatomic, strong, readonly, nonnull) SDImageCacheConfig *config;
+
+- (nonnull instancetype)init NS_UNAVAILABLE;
++ (nonnull instancetype)new  NS_UNAVAILABLE;
+
+/**
+ Returns the number of keys which share the same data with the given key.
+
+ @param key A string identifying the data.
+ @return The reference count of data, or 0 if the key is not in cache.
+ */
+- (NSUInteger)referenceCountForKey:(nonnull NSString *)key;
+
+/**
+ Returns the allocated disk size of the data files, the shared data is counted only once.
+ This is tracked in memory after the first call, so it's cheap to query after each store.
+
+ @return The allocated size in bytes.
+ */
+- (NSUInteger)totalAllocatedSize;
+
+@end
@@ -0,0 +1,609 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDContentAddressedDiskCache.h"
+#import "SDImageCacheConfig.h"
+#import "SDFileAttributeHelper.h"
+#import "SDDiskCacheEvictionPolicy.h"
+#import "SDDiskCacheHelper.h"
+#import "SDInternalMacros.h"
+#import <CommonCrypto/CommonDigest.h>
+#import <sys/stat.h>
+
+static NSString * const SDContentAddressedDiskCacheExtendedAttributeName = @"com.hackemist.SDDiskCache";
+// The reference count is stored on the content file, so it survives relaunch
+static NSString * const SDContentAddressedDiskCacheReferenceCountAttributeName = @"com.hackemist.SDContentAddressedDiskCache.referenceCount";
+// Each key file contains the content hash, the content file is named by the content hash
+static NSString * const SDContentAddressedDiskCacheKeysDirectoryName = @"keys";
+static NSString * const SDContentAddressedDiskCacheContentsDirectoryName = @"contents";
+
+static inline NSString * _Nonnull SDContentAddressedDiskCacheHexString(const unsigned char *digest) {
+    NSMutableString *hexString = [NSMutableString stringWithCapacity:CC_SHA256_DIGEST_LENGTH * 2];
+    for (size_t i = 0; i < CC_SHA256_DIGEST_LENGTH; i++) {
+        [hexString appendFormat:@"%02x", digest[i]];
+    }
+    return [hexString copy];
+}
+
+static NSString * _Nonnull SDContentAddressedDiskCacheHashForData(NSData * _Nonnull data) {
+    CC_SHA256_CTX context;
+    CC_SHA256_Init(&context);
+    // The data may be discontiguous (such as dispatch_data), and CC_LONG is 32-bit
+    [data enumerateByteRangesUsingBlock:^(const void * _Nonnull bytes, NSRange byteRange, BOOL * _Nonnull stop) {
+        NSUInteger offset = 0;
+        while (offset < byteRange.length) {
+            CC_LONG length = (CC_LONG)MIN(byteRange.length - offset, (NSUInteger)UINT32_MAX);
+            CC_SHA256_Update(&context, (const unsigned char *)bytes + offset, length);
+            offset += length;
+        }
+    }];
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256_Final(digest, &context);
+    return SDContentAddressedDiskCacheHexString(digest);
+}
+
+static inline NSString * _Nonnull SDContentAddressedDiskCacheFileNameForKey(NSString * _Nonnull key) {
+    const char *str = key.UTF8String;
+    if (str == NULL) {
+        str = "";
+    }
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256(str, (CC_LONG)strlen(str), digest);
+    return SDContentAddressedDiskCacheHexString(digest);
+}
+
+static inline NSUInteger SDContentAddressedDiskCacheAllocatedSizeAtPath(NSString * _Nonnull path) {
+    struct stat fileStat;
+    if (stat(path.fileSystemRepresentation, &fileStat) != 0) {
+        return 0;
+    }
+    return (NSUInteger)fileStat.st_blocks * 512;
+}
+
+@interface SDContentAddressedDiskCache () {
+    SD_LOCK_DECLARE(_lock); // Lock the key to content mapping, the reference count and the allocated size
+    NSUInteger _allocatedSize;
+    BOOL _allocatedSizeLoaded;
+}
+
+@property (nonatomic, copy) NSString *diskCachePath;
+@property (nonatomic, copy) NSString *keysPath;
+@property (nonatomic, copy) NSString *contentsPath;
+@property (nonatomic, strong, nonnull) NSFileManager *fileManager;
+@property (nonatomic, strong, nullable) id<SDDiskCacheEvictionPolicy> evictionPolicy;
+
+@end
+
+@implementation SDContentAddressedDiskCache
+
+- (instancetype)init {
+    NSAssert(NO, @"Use `initWithCachePath:` with the disk cache path");
+    return nil;
+}
+
+- (instancetype)initWithCachePath:(NSString *)cachePath config:(SDImageCacheConfig *)config {
+    if (self = [super init]) {
+        _diskCachePath = cachePath;
+        _keysPath = [cachePath stringByAppendingPathComponent:SDContentAddressedDiskCacheKeysDirectoryName];
+        _contentsPath = [cachePath stringByAppendingPathComponent:SDContentAddressedDiskCacheContentsDirectoryName];
+        _config = config;
+        if (config.fileManager) {
+            _fileManager = config.fileManager;
+        } else {
+            _fileManager = [NSFileManager new];
+        }
+        SD_LOCK_INIT(_lock);
+        [self createDirectory];
+        // The expiration date and eviction entry are stored on the key file, which is not shared, the policy state on the cache directory
+        _evictionPolicy = config.diskEvictionPolicy;
+        if (_evictionPolicy) {
+            [SDDiskCacheHelper restorePersistentStateForPolicy:_evictionPolicy atPath:cachePath];
+        }
+    }
+    return self;
+}
+
+#pragma mark - SDDiskCache Protocol
+
+- (BOOL)containsDataForKey:(NSString *)key {
+    NSParameterAssert(key);
+    NSString *keyPath = [self keyPathForKey:key];
+    if ([self removeKeyIfExpiredAtPath:keyPath]) {
+        return NO;
+    }
+    NSString *contentHash = [self contentHashForKeyPath:keyPath];
+    if (!contentHash) {
+        return NO;
+    }
+    return [self.fileManager fileExistsAtPath:[self contentPathForHash:contentHash]];
+}
+
+- (NSData *)dataForKey:(NSString *)key {
+    NSParameterAssert(key);
+    NSString *keyPath = [self keyPathForKey:key];
+    if ([self removeKeyIfExpiredAtPath:keyPath]) {
+        return nil;
+    }
+    NSString *contentHash = [self contentHashForKeyPath:keyPath];
+    if (!contentHash) {
+        return nil;
+    }
+    NSString *contentPath = [self contentPathForHash:contentHash];
+    NSData *data = [NSData dataWithContentsOfFile:contentPath options:self.config.diskCacheReadingOptions error:nil];
+    if (data) {
+        // The access date and count are tracked for each key, the content is shared
+        [[NSURL fileURLWithPath:keyPath] setResourceValue:[NSDate date] forKey:NSURLContentAccessDateKey error:nil];
+        [self updateEvictionEntryAtKeyPath:keyPath contentPath:contentPath reset:NO];
+    }
+    return data;
+}
+
+- (void)setData:(NSData *)data forKey:(NSString *)key {
+    NSParameterAssert(data);
+    NSParameterAssert(key);
+    NSString *contentHash = SDContentAddressedDiskCacheHashForData(data);
+    // Duplicate content does not write the data again, only add the reference
+    if ([self.fileManager fileExistsAtPath:[self contentPathForHash:contentHash]] &&
+        [self commitContentWithHash:contentHash temporaryURL:nil forKey:key]) {
+        return;
+    }
+    NSURL *temporaryURL = [self uniqueTemporaryURL];
+    if (![data writeToURL:temporaryURL options:self.config.diskCacheWritingOptions error:nil]) {
+        [self.fileManager removeItemAtURL:temporaryURL error:nil];
+        return;
+    }
+    [self commitContentWithHash:contentHash temporaryURL:temporaryURL forKey:key];
+}
+
+- (NSURL *)temporaryURLForKey:(NSString *)key {
+    NSParameterAssert(key);
+#if !SD_MAC
+    if (self.config.diskCacheWritingOptions & NSDataWritingFileProtectionMask) {
+        // The file protection is applied by `-[NSData writeToURL:options:error:]`, use `setData:forKey:` instead
+        return nil;
+    }
+#endif
+    return [self uniqueTemporaryURL];
+}
+
+- (BOOL)setDataWithTemporaryURL:(NSURL *)temporaryURL forKey:(NSString *)key {
+    NSParameterAssert(temporaryURL);
+    NSParameterAssert(key);
+    // Hash the written file without loading it into memory
+    NSData *data = [NSData dataWithContentsOfURL:temporaryURL options:NSDataReadingMappedIfSafe error:nil];
+    if (!data) {
+        [self.fileManager removeItemAtURL:temporaryURL error:nil];
+        return NO;
+    }
+    NSString *contentHash = SDContentAddressedDiskCacheHashForData(data);
+    data = nil;
+    return [self commitContentWithHash:contentHash temporaryURL:temporaryURL forKey:key];
+}
+
+- (NSData *)extendedDataForKey:(NSString *)key {
+    NSParameterAssert(key);
+    // The extended data is stored on the key file, which is not shared
+    NSString *keyPath = [self keyPathForKey:key];
+
+    return [SDFileAttributeHelper extendedAttribute:SDContentAddressedDiskCacheExtendedAttributeName atPath:keyPath traverseLink:NO error:nil];
+}
+
+- (void)setExtendedData:(NSData *)extendedData forKey:(NSString *)key {
+    NSParameterAssert(key);
+    NSString *keyPath = [self keyPathForKey:key];
+
+    if (!extendedData) {
+        // Remove
+        [SDFileAttributeHelper removeExtendedAttribute:SDContentAddressedDiskCacheExtendedAttributeName atPath:keyPath traverseLink:NO error:nil];
+    } else {
+        // Override
+        [SDFileAttributeHelper setExtendedAttribute:SDContentAddressedDiskCacheExtendedAttributeName value:extendedData atPath:keyPath traverseLink:NO overwrite:YES error:nil];
+    }
+}
+
+- (void)removeDataForKey:(NSString *)key {
+    NSParameterAssert(key);
+    [self removeKeyAtPath:[self keyPathForKey:key]];
+}
+
+- (void)setFetchCost:(NSTimeInterval)fetchCost forKey:(NSString *)key {
+    NSParameterAssert(key);
+    if (!self.evictionPolicy) {
+        return;
+    }
+    NSString *keyPath = [self keyPathForKey:key];
+    NSString *contentHash = [self contentHashForKeyPath:keyPath];
+    if (!contentHash) {
+        return;
+    }
+    SDDiskCacheEvictionEntry *entry = [SDDiskCacheHelper evictionEntryAtPath:keyPath];
+    entry.size = SDContentAddressedDiskCacheAllocatedSizeAtPath([self contentPathForHash:contentHash]);
+    entry.date = [NSDate date];
+    entry.accessCount = MAX(entry.accessCount, 1);
+    entry.fetchCost = fetchCost;
+    [self.evictionPolicy updatePriorityForEntry:entry];
+    [SDDiskCacheHelper setEvictionEntry:entry atPath:keyPath];
+}
+
+- (void)setExpirationDate:(NSDate *)expirationDate forKey:(NSString *)key {
+    NSParameterAssert(key);
+    NSString *keyPath = [self keyPathForKey:key];
+    if (![self.fileManager fileExistsAtPath:keyPath]) {
+        return;
+    }
+    [SDDiskCacheHelper setExpirationDate:expirationDate atPath:keyPath];
+}
+
+- (void)removeAllData {
+    SD_LOCK(_lock);
+    [self.fileManager removeItemAtPath:self.diskCachePath error:nil];
+    [self createDirectory];
+    _allocatedSize = 0;
+    _allocatedSizeLoaded = YES;
+    SD_UNLOCK(_lock);
+}
+
+- (void)removeExpiredData {
+    [SDDiskCacheHelper removeExpiredTemporaryFilesWithCachePath:self.diskCachePath fileManager:self.fileManager];
+
+    NSURLResourceKey cacheContentDateKey = [SDDiskCacheHelper contentDateKeyWithConfig:self.config];
+    NSArray<NSURL *> *keyURLs = [SDDiskCacheHelper fileURLsInDirectory:self.keysPath includingPropertiesForKeys:@[cacheContentDateKey] fileManager:self.fileManager];
+    NSDate *expirationDate = [SDDiskCacheHelper ageExpirationDateWithConfig:self.config];
+    NSMutableDictionary<NSURL *, NSDate *> *keyDates = [NSMutableDictionary dictionaryWithCapacity:keyURLs.count];
+
+    // The expiration is applied to keys, the content is removed when the last key is removed
+    for (NSURL *keyURL in keyURLs) {
+        @autoreleasepool {
+            NSDate *modifiedDate;
+            [keyURL getResourceValue:&modifiedDate forKey:cacheContentDateKey error:nil];
+            // Remove keys that are expired by HTTP caching headers, or older than the expiration date
+            if ([SDDiskCacheHelper isExpiredFileAtPath:keyURL.path contentDate:modifiedDate ageExpirationDate:expirationDate config:self.config]) {
+                [self removeKeyAtPath:keyURL.path];
+                continue;
+            }
+            keyDates[keyURL] = modifiedDate ?: [NSDate distantPast];
+        }
+    }
+
+    // Fix the reference count and remove the unreferenced content, which may be left by the interrupted writes
+    [self collectGarbage];
+
+    // If our remaining disk cache exceeds a configured maximum size, perform a second
+    // size-based cleanup pass.  We delete the oldest keys first.
+    NSUInteger maxDiskSize = self.config.maxDiskSize;
+    NSUInteger currentCacheSize = [self totalAllocatedSize];
+    if (maxDiskSize > 0 && currentCacheSize > maxDiskSize) {
+        // Target half of our maximum cache size for this cleanup pass.
+        const NSUInteger desiredCacheSize = maxDiskSize / 2;
+        [self removeKeysWithDates:keyDates currentCacheSize:currentCacheSize desiredCacheSize:desiredCacheSize];
+    }
+}
+
+- (void)removeDataToFitSize:(NSUInteger)size {
+    NSUInteger currentCacheSize = [self totalAllocatedSize];
+    if (currentCacheSize <= size) {
+        return;
+    }
+    NSURLResourceKey cacheContentDateKey = [SDDiskCacheHelper contentDateKeyWithConfig:self.config];
+    NSArray<NSURL *> *keyURLs = [SDDiskCacheHelper fileURLsInDirectory:self.keysPath includingPropertiesForKeys:@[cacheContentDateKey] fileManager:self.fileManager];
+    NSMutableDictionary<NSURL *, NSDate *> *keyDates = [NSMutableDictionary dictionaryWithCapacity:keyURLs.count];
+    for (NSURL *keyURL in keyURLs) {
+        NSDate *modifiedDate;
+        [keyURL getResourceValue:&modifiedDate forKey:cacheContentDateKey error:nil];
+        keyDates[keyURL] = modifiedDate ?: [NSDate distantPast];
+    }
+    [self removeKeysWithDates:keyDates currentCacheSize:currentCacheSize desiredCacheSize:size];
+}
+
+// The shared content file is read-only, so the caller can't modify the data of other keys by this path
+- (nullable NSString *)cachePathForKey:(NSString *)key {
+    NSParameterAssert(key);
+    NSString *contentHash = [self contentHashForKeyPath:[self keyPathForKey:key]];
+    if (!contentHash) {
+        return nil;
+    }
+    return [self contentPathForHash:contentHash];
+}
+
+- (NSUInteger)totalSize {
+    NSUInteger size = 0;
+    // The shared content is counted only once
+    @autoreleasepool {
+        NSURL *contentsURL = [NSURL fileURLWithPath:self.contentsPath isDirectory:YES];
+        NSDirectoryEnumerator<NSURL *> *fileEnumerator = [self.fileManager enumeratorAtURL:contentsURL
+                                                                includingPropertiesForKeys:@[NSURLFileSizeKey]
+                                                                                   options:(NSDirectoryEnumerationOptions)0
+                                                                              errorHandler:NULL];
+        for (NSURL *fileURL in fileEnumerator) {
+            @autoreleasepool {
+                NSNumber *fileSize;
+                [fileURL getResourceValue:&fileSize forKey:NSURLFileSizeKey error:NULL];
+                size += fileSize.unsignedIntegerValue;
+            }
+        }
+    }
+    return size;
+}
+
+- (NSUInteger)totalCount {
+    NSUInteger count = 0;
+    @autoreleasepool {
+        NSURL *keysURL = [NSURL fileURLWithPath:self.keysPath isDirectory:YES];
+        NSDirectoryEnumerator<NSURL *> *fileEnumerator = [self.fileManager enumeratorAtURL:keysURL includingPropertiesForKeys:@[] options:NSDirectoryEnumerationSkipsHiddenFiles errorHandler:nil];
+        count = fileEnumerator.allObjects.count;
+    }
+    return count;
+}
+
+#pragma mark - Reference Count
+
+- (NSUInteger)referenceCountForKey:(NSString *)key {
+    NSParameterAssert(key);
+    NSString *contentHash = [self contentHashForKeyPath:[self keyPathForKey:key]];
+    if (!contentHash) {
+        return 0;
+    }
+    SD_LOCK(_lock);
+    NSUInteger referenceCount = [self referenceCountForContentPath:[self contentPathForHash:contentHash]];
+    SD_UNLOCK(_lock);
+    return referenceCount;
+}
+
+// Link the key to the content, the temporary file is moved as the content if the content does not exist, else removed.
+- (BOOL)commitContentWithHash:(nonnull NSString *)contentHash temporaryURL:(nullable NSURL *)temporaryURL forKey:(nonnull NSString *)key {
+    NSString *keyPath = [self keyPathForKey:key];
+    NSString *contentPath = [self contentPathForHash:contentHash];
+    BOOL success = YES;
+    BOOL duplicated = NO;
+    SD_LOCK(_lock);
+    if ([self.fileManager fileExistsAtPath:contentPath]) {
+        duplicated = YES;
+    } else {
+        // rename(2) is atomic, the reader never see the partial data
+        success = temporaryURL && rename(temporaryURL.fileSystemRepresentation, contentPath.fileSystemRepresentation) == 0;
+        if (success) {
+            [self setReferenceCount:0 forContentPath:contentPath];
+            if (_allocatedSizeLoaded) {
+                _allocatedSize += SDContentAddressedDiskCacheAllocatedSizeAtPath(contentPath);
+            }
+        }
+    }
+    if (success) {
+        NSString *previousContentHash = [self contentHashForKeyPath:keyPath];
+        if ([previousContentHash isEqualToString:contentHash]) {
+            // Same content, only refresh the key's date
+            [[NSURL fileURLWithPath:keyPath] setResourceValue:[NSDate date] forKey:NSURLContentModificationDateKey error:nil];
+        } else {
+            NSData *hashData = [contentHash dataUsingEncoding:NSUTF8StringEncoding];
+            success = [hashData writeToFile:keyPath options:NSDataWritingAtomic error:nil];
+            if (success) {
+                [self setReferenceCount:[self referenceCountForContentPath:contentPath] + 1 forContentPath:contentPath];
+                if (previousContentHash) {
+                    [self releaseContentWithHash:previousContentHash];
+                }
+            }
+        }
+    }
+    SD_UNLOCK(_lock);
+    if (temporaryURL && (duplicated || !success)) {
+        [self.fileManager removeItemAtURL:temporaryURL error:nil];
+    }
+    if (success) {
+        [self updateEvictionEntryAtKeyPath:keyPath contentPath:contentPath reset:YES];
+    }
+
+    return success;
+}
+
+// Remove the key, returns the freed size if the content is removed as well
+- (NSUInteger)removeKeyAtPath:(nonnull NSString *)keyPath {
+    NSUInteger freedSize = 0;
+    SD_LOCK(_lock);
+    NSString *contentHash = [self contentHashForKeyPath:keyPath];
+    if ([self.fileManager removeItemAtPath:keyPath error:nil] && contentHash) {
+        freedSize = [self releaseContentWithHash:contentHash];
+    }
+    SD_UNLOCK(_lock);
+    return freedSize;
+}
+
+// Must be called inside the lock
+- (NSUInteger)releaseContentWithHash:(nonnull NSString *)contentHash {
+    NSString *contentPath = [self contentPathForHash:contentHash];
+    NSUInteger referenceCount = [self referenceCountForContentPath:contentPath];
+    if (referenceCount > 1) {
+        [self setReferenceCount:referenceCount - 1 forContentPath:contentPath];
+        return 0;
+    }
+    NSUInteger allocatedSize = SDContentAddressedDiskCacheAllocatedSizeAtPath(contentPath);
+    if (![self.fileManager removeItemAtPath:contentPath error:nil]) {
+        return 0;
+    }
+    if (_allocatedSizeLoaded) {
+        _allocatedSize -= MIN(allocatedSize, _allocatedSize);
+    }
+    return allocatedSize;
+}
+
+- (NSUInteger)referenceCountForContentPath:(nonnull NSString *)contentPath {
+    NSData *value = [SDFileAttributeHelper extendedAttribute:SDContentAddressedDiskCacheReferenceCountAttributeName atPath:contentPath traverseLink:NO error:nil];
+    if (!value) {
+        return 0;
+    }
+    NSString *referenceCount = [[NSString alloc] initWithData:value encoding:NSUTF8StringEncoding];
+    return (NSUInteger)MAX(referenceCount.integerValue, 0);
+}
+
+// The content is shared by keys and should never be modified in place, it's read-only except updating the reference count
+- (void)setReferenceCount:(NSUInteger)referenceCount forContentPath:(nonnull NSString *)contentPath {
+    NSData *value = [[NSString stringWithFormat:@"%lu", (unsigned long)referenceCount] dataUsingEncoding:NSUTF8StringEncoding];
+    const char *path = contentPath.fileSystemRepresentation;
+    chmod(path, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    [SDFileAttributeHelper setExtendedAttribute:SDContentAddressedDiskCacheReferenceCountAttributeName value:value atPath:contentPath traverseLink:NO overwrite:YES error:nil];
+    chmod(path, S_IRUSR | S_IRGRP | S_IROTH);
+}
+
+- (void)collectGarbage {
+    SD_LOCK(_lock);
+    NSCountedSet<NSString *> *references = [NSCountedSet set];
+    NSArray<NSURL *> *keyURLs = [self.fileManager contentsOfDirectoryAtURL:[NSURL fileURLWithPath:self.keysPath isDirectory:YES] includingPropertiesForKeys:@[] options:NSDirectoryEnumerationSkipsHiddenFiles error:nil];
+    for (NSURL *keyURL in keyURLs) {
+        @autoreleasepool {
+            NSString *contentHash = [self contentHashForKeyPath:keyURL.path];
+            if (contentHash) {
+                [references addObject:contentHash];
+            } else {
+                // Broken key file
+                [self.fileManager removeItemAtURL:keyURL error:nil];
+            }
+        }
+    }
+    NSArray<NSURL *> *contentURLs = [self.fileManager contentsOfDirectoryAtURL:[NSURL fileURLWithPath:self.contentsPath isDirectory:YES] includingPropertiesForKeys:@[] options:NSDirectoryEnumerationSkipsHiddenFiles error:nil];
+    for (NSURL *contentURL in contentURLs) {
+        @autoreleasepool {
+            NSString *contentPath = contentURL.path;
+            NSUInteger referenceCount = [references countForObject:contentURL.lastPathComponent];
+            if (referenceCount == 0) {
+                NSUInteger allocatedSize = SDContentAddressedDiskCacheAllocatedSizeAtPath(contentPath);
+                if ([self.fileManager removeItemAtURL:contentURL error:nil] && _allocatedSizeLoaded) {
+                    _allocatedSize -= MIN(allocatedSize, _allocatedSize);
+                }
+            } else if (referenceCount != [self referenceCountForContentPath:contentPath]) {
+                [self setReferenceCount:referenceCount forContentPath:contentPath];
+            }
+        }
+    }
+    SD_UNLOCK(_lock);
+}
+
+#pragma mark - Expiration
+
+// Remove the key expired by HTTP caching headers, which should be downloaded again
+- (BOOL)removeKeyIfExpiredAtPath:(nonnull NSString *)keyPath {
+    if (![SDDiskCacheHelper isExpiredByHTTPCacheAtPath:keyPath config:self.config]) {
+        return NO;
+    }
+    [self removeKeyAtPath:keyPath];
+    return YES;
+}
+
+#pragma mark - Size-based cleanup
+
+// Delete keys until we fall below our desired cache size, only the last reference free the space. The keys are sorted by the eviction policy if provided, else the oldest first
+- (void)removeKeysWithDates:(nonnull NSDictionary<NSURL *, NSDate *> *)keyDates currentCacheSize:(NSUInteger)currentCacheSize desiredCacheSize:(NSUInteger)desiredCacheSize {
+    NSArray<NSURL *> *sortedKeyURLs;
+    id<SDDiskCacheEvictionPolicy> evictionPolicy = self.evictionPolicy;
+    NSMutableDictionary<NSString *, SDDiskCacheEvictionEntry *> *entries;
+    if (evictionPolicy) {
+        entries = [NSMutableDictionary dictionaryWithCapacity:keyDates.count];
+        NSMutableDictionary<NSString *, NSURL *> *keyURLs = [NSMutableDictionary dictionaryWithCapacity:keyDates.count];
+        [keyDates enumerateKeysAndObjectsUsingBlock:^(NSURL * _Nonnull keyURL, NSDate * _Nonnull date, BOOL * _Nonnull stop) {
+            SDDiskCacheEvictionEntry *entry = [self evictionEntryForKeyURL:keyURL date:date];
+            entries[entry.identifier] = entry;
+            keyURLs[entry.identifier] = keyURL;
+        }];
+        NSArray<SDDiskCacheEvictionEntry *> *sortedEntries = [evictionPolicy sortedEntriesForEviction:entries.allValues];
+        NSMutableArray<NSURL *> *mutableKeyURLs = [NSMutableArray arrayWithCapacity:sortedEntries.count];
+        for (SDDiskCacheEvictionEntry *entry in sortedEntries) {
+            NSURL *keyURL = keyURLs[entry.identifier];
+            if (keyURL) {
+                [mutableKeyURLs addObject:keyURL];
+            }
+        }
+        sortedKeyURLs = mutableKeyURLs;
+    } else {
+        sortedKeyURLs = [keyDates keysSortedByValueUsingSelector:@selector(compare:)];
+    }
+
+    for (NSURL *keyURL in sortedKeyURLs) {
+        if (currentCacheSize <= desiredCacheSize) {
+            break;
+        }
+        NSUInteger freedSize = [self removeKeyAtPath:keyURL.path];
+        currentCacheSize -= MIN(freedSize, currentCacheSize);
+        SDDiskCacheEvictionEntry *entry = entries[keyURL.lastPathComponent];
+        if (entry) {
+            [evictionPolicy didEvictEntry:entry];
+        }
+    }
+    if (evictionPolicy) {
+        [SDDiskCacheHelper savePersistentStateForPolicy:evictionPolicy atPath:self.diskCachePath];
+    }
+}
+
+// The entry size is the shared content size, the access count, fetch cost and priority are persisted on the key file
+- (nonnull SDDiskCacheEvictionEntry *)evictionEntryForKeyURL:(nonnull NSURL *)keyURL date:(nonnull NSDate *)date {
+    SDDiskCacheEvictionEntry *entry = [SDDiskCacheHelper evictionEntryAtPath:keyURL.path];
+    NSString *contentHash = [self contentHashForKeyPath:keyURL.path];
+    if (contentHash) {
+        entry.size = SDContentAddressedDiskCacheAllocatedSizeAtPath([self contentPathForHash:contentHash]);
+    }
+    entry.date = date;
+    return entry;
+}
+
+// Count the access of key, `reset` for the newly written key
+- (void)updateEvictionEntryAtKeyPath:(nonnull NSString *)keyPath contentPath:(nonnull NSString *)contentPath reset:(BOOL)reset {
+    id<SDDiskCacheEvictionPolicy> evictionPolicy = self.evictionPolicy;
+    if (!evictionPolicy) {
+        return;
+    }
+    [SDDiskCacheHelper updateEvictionEntryAtPath:keyPath size:SDContentAddressedDiskCacheAllocatedSizeAtPath(contentPath) reset:reset policy:evictionPolicy];
+}
+
+#pragma mark - Cache paths
+
+- (nonnull NSString *)keyPathForKey:(nonnull NSString *)key {
+    return [self.keysPath stringByAppendingPathComponent:SDContentAddressedDiskCacheFileNameForKey(key)];
+}
+
+- (nonnull NSString *)contentPathForHash:(nonnull NSString *)contentHash {
+    return [self.contentsPath stringByAppendingPathComponent:contentHash];
+}
+
+- (nullable NSString *)contentHashForKeyPath:(nonnull NSString *)keyPath {
+    NSData *hashData = [NSData dataWithContentsOfFile:keyPath];
+    if (hashData.length != CC_SHA256_DIGEST_LENGTH * 2) {
+        return nil;
+    }
+    return [[NSString alloc] initWithData:hashData encoding:NSUTF8StringEncoding];
+}
+
+- (NSUInteger)totalAllocatedSize {
+    SD_LOCK(_lock);
+    if (!_allocatedSizeLoaded) {
+        _allocatedSize = [self contentsAllocatedSize];
+        _allocatedSizeLoaded = YES;
+    }
+    NSUInteger allocatedSize = _allocatedSize;
+    SD_UNLOCK(_lock);
+    return allocatedSize;
+}
+
+- (NSUInteger)contentsAllocatedSize {
+    NSUInteger size = 0;
+    NSArray<NSURL *> *contentURLs = [self.fileManager contentsOfDirectoryAtURL:[NSURL fileURLWithPath:self.contentsPath isDirectory:YES] includingPropertiesForKeys:@[NSURLTotalFileAllocatedSizeKey] options:NSDirectoryEnumerationSkipsHiddenFiles error:nil];
+    for (NSURL *contentURL in contentURLs) {
+        NSNumber *allocatedSize;
+        [contentURL getResourceValue:&allocatedSize forKey:NSURLTotalFileAllocatedSizeKey error:nil];
+        size += allocatedSize.unsignedIntegerValue;
+    }
+    return size;
+}
+
+- (void)createDirectory {
+    [SDDiskCacheHelper createDirectoryAtPath:self.diskCachePath config:self.config fileManager:self.fileManager];
+    [self.fileManager createDirectoryAtPath:self.keysPath withIntermediateDirectories:YES attributes:nil error:NULL];
+    [self.fileManager createDirectoryAtPath:self.contentsPath withIntermediateDirectories:YES attributes:nil error:NULL];
+}
+
+- (NSURL *)uniqueTemporaryURL {
+    return [SDDiskCacheHelper uniqueTemporaryURLWithCachePath:self.diskCachePath fileManager:self.fileManager];
+}
+
+@end
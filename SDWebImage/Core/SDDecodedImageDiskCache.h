@@ -0,0 +1,95 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDWebImageCompat.h"
+#import "SDImageCoder.h"
+
+@class SDImageCacheConfig;
+/**
+ A disk cache which store the decoded, display-ready bitmap (premultiplied BGRA, 8 bits per component) instead of the encoded image data.
+ The bitmaps are packed into large memory-mapped chunk files. The returned image is backed by the mapping directly, so displaying it needs no decoding and no copy.
+ Each entry is identified by the cache key, the decode options (including the thumbnail pixel size) and the pixel format. So the same URL decoded at different sizes are different entries.
+ This is used by `SDImageCache` as an optional tier between the memory cache and the disk cache, see `SDImageCacheConfig.maxDecodedDiskSize`.
+
+ @note Only the static, 8-bit, sRGB compatible images are stored. The animated, vector, HDR, wide color and region decoded images are ignored.
+ @note The size limit is applied to the whole chunks, the least recently used chunk is removed at once. The already returned images keep the removed chunk mapping alive until they are released.
+ @note The index changes are coalesced and saved to disk in background after a short delay, call `removeExpiredImages` to save it immediately.
+ */
+@interface SDDecodedImageDiskCache : NSObject
+
+/**
+ Cache Config object - storing all kind of settings.
+ */
+@property (nonatomic, strong, readonly, nonnull) SDImageCacheConfig *config;
+
+- (nonnull instancetype)init NS_UNAVAILABLE;
++ (nonnull instancetype)new  NS_UNAVAILABLE;
+
+/**
+ Create a new decoded image cache based on the specified path. The `maxDecodedDiskSize` and `maxDiskAge` of config are used for the limit.
+
+ @param cachePath Full path of a directory in which the cache will write the chunk files.
+ @param config The cache config to be used to create the cache.
+ @return A new cache object, or nil if the directory can not be created.
+ */
+- (nullable instancetype)initWithCachePath:(nonnull NSString *)cachePath config:(nonnull SDImageCacheConfig *)config NS_DESIGNATED_INITIALIZER;
+
+/**
+ Returns the image associated with a given key and decode options. The image's CGImage is backed by the mapped chunk file.
+
+ @param key A string identifying the image.
+ @param options The decode options used to decode the image, see `SDGetDecodeOptionsFromContext`.
+ @return The image, or nil if there is no matching entry.
+ */
+- (nullable UIImage *)imageForKey:(nonnull NSString *)key options:(nullable SDImageCoderOptions *)options;
+
+/**
+ Stores the decoded bitmap of image for a given key and decode options. The image is ignored if it can not be stored as premultiplied BGRA without loss.
+
+ @param image The image to be stored.
+ @param key A string identifying the image.
+ @param options The decode options used to decode the image, see `SDGetDecodeOptionsFromContext`.
+ @return Whether the image is stored.
+ */
+- (BOOL)storeImage:(nonnull UIImage *)image forKey:(nonnull NSString *)key options:(nullable SDImageCoderOptions *)options;
+
+/**
+ Removes all the entries of a given key, regardless of the decode options.
+
+ @param key A string identifying the image.
+ */
+- (void)removeImagesForKey:(nonnull NSString *)key;
+
+/**
+ Empties the cache.
+ */
+- (void)removeAllImages;
+
+/**
+ Removes the expired chunks and the least recently used chunks to fit the size limit, then saves the index to disk.
+ */
+- (void)removeExpiredImages;
+
+/**
+ Removes the least recently used chunks until the total size is below the specified size, then saves the index to disk.
+
+ @param size The desired size in bytes.
+ */
+- (void)removeImagesToFitSize:(NSUInteger)size;
+
+/**
+ Returns the total size of the chunk files, in bytes.
+ */
+- (NSUInteger)totalSize;
+
+/**
+ Returns the number of the entries in the cache.
+ */
+- (NSUInteger)totalCount;
+
+@end
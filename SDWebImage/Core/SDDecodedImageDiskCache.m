@@ -0,0 +1,657 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDDecodedImageDiskCache.h"
+#import "SDImageCacheConfig.h"
+#import "SDImageCoderHelper.h"
+#import "SDAnimatedImage.h"
+#import "NSImage+Compatibility.h"
+#import "UIImage+Metadata.h"
+#import "UIImage+ForceDecode.h"
+#import "SDInternalMacros.h"
+#import <sys/mman.h>
+#import <sys/stat.h>
+#import <fcntl.h>
+#import <unistd.h>
+
+// The bitmaps are appended into the chunk, a chunk is removed as a whole
+static const size_t SDDecodedImageChunkSize = 16 * 1024 * 1024;
+// Each bitmap starts at a cache line boundary
+static const size_t SDDecodedImageEntryAlignment = 64;
+// Premultiplied BGRA8888, part of the entry key, so the future formats don't collide
+static NSString * const SDDecodedImagePixelFormat = @"BGRA8888";
+static NSString * const SDDecodedImageIndexFileName = @"index.plist";
+static NSString * const SDDecodedImageChunkFilePrefix = @"chunk-";
+static const NSInteger SDDecodedImageIndexVersion = 1;
+// The index changes are coalesced and saved after the delay, the `removeExpiredImages` saves it immediately
+static const NSTimeInterval SDDecodedImageIndexSaveDelay = 1;
+
+static void SDDecodedImageReleaseChunk(void *info, const void *data, size_t size) {
+    if (info) {
+        CFRelease(info);
+    }
+}
+
+// Only the plain values are stable to describe, other options (like custom objects) can not identify the bitmap
+static NSString * _Nullable SDDecodedImageVariantForOptions(SDImageCoderOptions * _Nullable options) {
+    NSArray<SDImageCoderOption> *optionKeys = [options.allKeys sortedArrayUsingSelector:@selector(compare:)];
+    NSMutableArray<NSString *> *components = [NSMutableArray arrayWithCapacity:optionKeys.count];
+    for (SDImageCoderOption optionKey in optionKeys) {
+        // The hints are only used to choose the coder, they don't change the pixels
+        if ([optionKey isEqualToString:SDImageCoderDecodeTypeIdentifierHint] || [optionKey isEqualToString:SDImageCoderDecodeFileExtensionHint]) {
+            continue;
+        }
+        id value = options[optionKey];
+        if (![value isKindOfClass:NSNumber.class] && ![value isKindOfClass:NSValue.class] && ![value isKindOfClass:NSString.class]) {
+            return nil;
+        }
+        [components addObject:[NSString stringWithFormat:@"%@=%@", optionKey, value]];
+    }
+    return [components componentsJoinedByString:@","];
+}
+
+static BOOL SDDecodedImageColorSpaceIsSupported(CGColorSpaceRef _Nullable colorSpace) {
+    if (!colorSpace) {
+        return NO;
+    }
+    if (colorSpace == [SDImageCoderHelper colorSpaceGetDeviceRGB]) {
+        return YES;
+    }
+    CGColorSpaceModel model = CGColorSpaceGetModel(colorSpace);
+    if (model == kCGColorSpaceModelMonochrome) {
+        return YES;
+    }
+    if (model != kCGColorSpaceModelRGB) {
+        return NO;
+    }
+    if (@available(iOS 10.0, tvOS 10.0, macOS 10.6, watchOS 3.0, *)) {
+        // Drawing the wide color into the device RGB loses the color, keep them decoding from data
+        NSString *colorSpaceName = (__bridge_transfer NSString *)CGColorSpaceCopyName(colorSpace);
+        return [colorSpaceName isEqualToString:(__bridge NSString *)kCGColorSpaceDeviceRGB]
+            || [colorSpaceName isEqualToString:(__bridge NSString *)kCGColorSpaceSRGB];
+    }
+    return YES;
+}
+
+static BOOL SDDecodedImageCanStoreImage(UIImage * _Nonnull image) {
+    if (image.sd_isAnimated || image.sd_isVector || image.sd_isRegionDecoded) {
+        return NO;
+    }
+    if ([image conformsToProtocol:@protocol(SDAnimatedImage)]) {
+        return NO;
+    }
+    CGImageRef cgImage = image.CGImage;
+    if (!cgImage) {
+        return NO;
+    }
+    if (CGImageGetBitsPerComponent(cgImage) != 8 || image.sd_isHighDynamicRange) {
+        return NO;
+    }
+    return SDDecodedImageColorSpaceIsSupported(CGImageGetColorSpace(cgImage));
+}
+
+/// A memory-mapped chunk file. The mapping is unmapped when the chunk is released, so the images which retain the chunk keep their pixels valid after the eviction.
+@interface SDDecodedImageChunk : NSObject
+
+@property (nonatomic, copy, readonly, nonnull) NSString *name;
+@property (nonatomic, copy, readonly, nonnull) NSString *path;
+@property (nonatomic, assign, readonly) size_t capacity;
+@property (nonatomic, assign, readonly, nonnull) uint8_t *bytes;
+@property (nonatomic, assign) size_t usedSize;
+@property (nonatomic, strong, nonnull) NSDate *accessDate;
+// Whether the chunk contains bitmaps which are not synchronized to the file
+@property (nonatomic, assign, getter=isDirty) BOOL dirty;
+// Whether the chunk is evicted, the entry written into the removed chunk should not be published
+@property (nonatomic, assign, getter=isRemoved) BOOL removed;
+
+@end
+
+@implementation SDDecodedImageChunk
+
+- (nullable instancetype)initWithName:(nonnull NSString *)name path:(nonnull NSString *)path capacity:(size_t)capacity create:(BOOL)create {
+    self = [super init];
+    if (self) {
+        int fd = open(path.fileSystemRepresentation, create ? (O_RDWR | O_CREAT | O_EXCL) : O_RDWR, 0644);
+        if (fd < 0) {
+            return nil;
+        }
+        if (create) {
+            // The file hole is zero filled, the disk space is allocated only when the bitmap is written
+            if (ftruncate(fd, (off_t)capacity) != 0) {
+                close(fd);
+                unlink(path.fileSystemRepresentation);
+                return nil;
+            }
+        } else {
+            struct stat st;
+            if (fstat(fd, &st) != 0 || (size_t)st.st_size != capacity) {
+                close(fd);
+                return nil;
+            }
+        }
+        void *bytes = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        // The mapping keeps the file referenced, the descriptor is not needed
+        close(fd);
+        if (bytes == MAP_FAILED) {
+            if (create) {
+                unlink(path.fileSystemRepresentation);
+            }
+            return nil;
+        }
+        _name = [name copy];
+        _path = [path copy];
+        _capacity = capacity;
+        _bytes = bytes;
+        _accessDate = [NSDate date];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    munmap(_bytes, _capacity);
+}
+
+- (void)synchronize {
+    if (!self.isDirty) {
+        return;
+    }
+    msync(self.bytes, SDByteAlign(self.usedSize, (size_t)getpagesize()), MS_SYNC);
+    self.dirty = NO;
+}
+
+@end
+
+@interface SDDecodedImageEntry : NSObject
+
+@property (nonatomic, copy, nonnull) NSString *key;
+@property (nonatomic, strong, nonnull) SDDecodedImageChunk *chunk;
+@property (nonatomic, assign) size_t offset;
+@property (nonatomic, assign) size_t width;
+@property (nonatomic, assign) size_t height;
+@property (nonatomic, assign) size_t bytesPerRow;
+@property (nonatomic, assign) CGBitmapInfo bitmapInfo;
+@property (nonatomic, assign) CGFloat scale;
+@property (nonatomic, assign) NSInteger orientation;
+@property (nonatomic, assign) SDImageFormat imageFormat;
+
+@end
+
+@implementation SDDecodedImageEntry
+@end
+
+@interface SDDecodedImageDiskCache () {
+    SD_LOCK_DECLARE(_lock); // Lock the index and the chunk allocation
+}
+
+@property (nonatomic, copy) NSString *diskCachePath;
+@property (nonatomic, strong, nonnull) NSFileManager *fileManager;
+@property (nonatomic, assign) size_t chunkSize;
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSString *, SDDecodedImageEntry *> *entries;
+// The cache key to the entry keys of all variants, to remove them without enumerating all entries
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSString *, NSMutableSet<NSString *> *> *keyEntries;
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSString *, SDDecodedImageChunk *> *chunks;
+@property (nonatomic, strong, nullable) SDDecodedImageChunk *currentChunk;
+@property (nonatomic, assign) BOOL indexSaveScheduled;
+
+@end
+
+@implementation SDDecodedImageDiskCache
+
+- (instancetype)init {
+    NSAssert(NO, @"Use `initWithCachePath:config:` with the disk cache path");
+    return nil;
+}
+
+- (instancetype)initWithCachePath:(NSString *)cachePath config:(SDImageCacheConfig *)config {
+    if (self = [super init]) {
+        _diskCachePath = [cachePath copy];
+        _config = config;
+        if (config.fileManager) {
+            _fileManager = config.fileManager;
+        } else {
+            _fileManager = [NSFileManager new];
+        }
+        // Small limit use smaller chunk, or one chunk exceeds the whole limit
+        size_t chunkSize = SDDecodedImageChunkSize;
+        if (config.maxDecodedDiskSize > 0) {
+            chunkSize = MIN(chunkSize, SDByteAlign(config.maxDecodedDiskSize, (size_t)getpagesize()));
+        }
+        _chunkSize = chunkSize;
+        _entries = [NSMutableDictionary dictionary];
+        _keyEntries = [NSMutableDictionary dictionary];
+        _chunks = [NSMutableDictionary dictionary];
+        SD_LOCK_INIT(_lock);
+        if (![self.fileManager createDirectoryAtPath:_diskCachePath withIntermediateDirectories:YES attributes:nil error:NULL]) {
+            return nil;
+        }
+        [self loadIndex];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    // Flush the pending index changes
+    if (_indexSaveScheduled) {
+        [self saveIndex];
+    }
+}
+
+#pragma mark - Query and Store
+
+- (UIImage *)imageForKey:(NSString *)key options:(SDImageCoderOptions *)options {
+    NSParameterAssert(key);
+    NSString *entryKey = [self entryKeyForKey:key options:options];
+    if (!entryKey) {
+        return nil;
+    }
+    SD_LOCK(_lock);
+    SDDecodedImageEntry *entry = self.entries[entryKey];
+    entry.chunk.accessDate = [NSDate date];
+    SD_UNLOCK(_lock);
+    if (!entry) {
+        return nil;
+    }
+
+    // The provider retains the chunk, so the mapping outlives the eviction until the image is released
+    SDDecodedImageChunk *chunk = entry.chunk;
+    CGDataProviderRef provider = CGDataProviderCreateWithData((__bridge_retained void *)chunk, chunk.bytes + entry.offset, entry.bytesPerRow * entry.height, SDDecodedImageReleaseChunk);
+    if (!provider) {
+        return nil;
+    }
+    CGImageRef cgImage = CGImageCreate(entry.width, entry.height, 8, 32, entry.bytesPerRow, [SDImageCoderHelper colorSpaceGetDeviceRGB], entry.bitmapInfo, provider, NULL, false, kCGRenderingIntentDefault);
+    CGDataProviderRelease(provider);
+    if (!cgImage) {
+        return nil;
+    }
+#if SD_MAC
+    UIImage *image = [[UIImage alloc] initWithCGImage:cgImage scale:entry.scale orientation:kCGImagePropertyOrientationUp];
+#else
+    UIImage *image = [[UIImage alloc] initWithCGImage:cgImage scale:entry.scale orientation:(UIImageOrientation)entry.orientation];
+#endif
+    CGImageRelease(cgImage);
+    image.sd_isDecoded = YES;
+    image.sd_imageFormat = entry.imageFormat;
+    image.sd_decodeOptions = options;
+
+    return image;
+}
+
+- (BOOL)storeImage:(UIImage *)image forKey:(NSString *)key options:(SDImageCoderOptions *)options {
+    NSParameterAssert(image);
+    NSParameterAssert(key);
+    NSString *entryKey = [self entryKeyForKey:key options:options];
+    if (!entryKey || !SDDecodedImageCanStoreImage(image)) {
+        return NO;
+    }
+    CGImageRef cgImage = image.CGImage;
+    size_t width = CGImageGetWidth(cgImage);
+    size_t height = CGImageGetHeight(cgImage);
+    if (width == 0 || height == 0 || width > SIZE_MAX / 4) {
+        return NO;
+    }
+    BOOL hasAlpha = [SDImageCoderHelper CGImageContainsAlpha:cgImage];
+    size_t bytesPerRow = SDByteAlign(width * 4, [SDImageCoderHelper preferredPixelFormat:hasAlpha].alignment);
+    if (height > self.chunkSize / bytesPerRow) {
+        // Larger than one chunk, which is not the fixed-size UI this cache designed for
+        return NO;
+    }
+    size_t length = bytesPerRow * height;
+    CGBitmapInfo bitmapInfo = kCGBitmapByteOrder32Little | (hasAlpha ? kCGImageAlphaPremultipliedFirst : kCGImageAlphaNoneSkipFirst);
+
+    size_t offset = 0;
+    SD_LOCK(_lock);
+    if (self.entries[entryKey]) {
+        SD_UNLOCK(_lock);
+        return YES;
+    }
+    SDDecodedImageChunk *chunk = [self reserveChunkWithLength:length offset:&offset];
+    SD_UNLOCK(_lock);
+    if (!chunk) {
+        return NO;
+    }
+
+    // Draw into the mapping directly, the region is reserved so other writers don't touch it
+    CGContextRef context = CGBitmapContextCreate(chunk.bytes + offset, width, height, 8, bytesPerRow, [SDImageCoderHelper colorSpaceGetDeviceRGB], bitmapInfo);
+    if (!context) {
+        return NO;
+    }
+    CGContextDrawImage(context, CGRectMake(0, 0, width, height), cgImage);
+    CGContextRelease(context);
+
+    SDDecodedImageEntry *entry = [SDDecodedImageEntry new];
+    entry.key = key;
+    entry.chunk = chunk;
+    entry.offset = offset;
+    entry.width = width;
+    entry.height = height;
+    entry.bytesPerRow = bytesPerRow;
+    entry.bitmapInfo = bitmapInfo;
+    entry.scale = image.scale;
+#if SD_UIKIT || SD_WATCH
+    entry.orientation = image.imageOrientation;
+#endif
+    entry.imageFormat = image.sd_imageFormat;
+
+    // Publish only after the pixels are drawn
+    BOOL stored = NO;
+    SD_LOCK(_lock);
+    if (!chunk.isRemoved) {
+        [self addEntry:entry forEntryKey:entryKey];
+        stored = YES;
+    }
+    SD_UNLOCK(_lock);
+    return stored;
+}
+
+#pragma mark - Remove Ops
+
+- (void)removeImagesForKey:(NSString *)key {
+    NSParameterAssert(key);
+    SD_LOCK(_lock);
+    NSSet<NSString *> *entryKeys = self.keyEntries[key];
+    if (entryKeys.count > 0) {
+        [self.entries removeObjectsForKeys:entryKeys.allObjects];
+        [self.keyEntries removeObjectForKey:key];
+        // The space is reclaimed with the whole chunk, but the index should not revive the stale bitmap after relaunch
+        [self setNeedsSaveIndex];
+    }
+    SD_UNLOCK(_lock);
+}
+
+- (void)removeAllImages {
+    SD_LOCK(_lock);
+    for (SDDecodedImageChunk *chunk in self.chunks.allValues) {
+        chunk.removed = YES;
+    }
+    [self.chunks removeAllObjects];
+    [self.entries removeAllObjects];
+    [self.keyEntries removeAllObjects];
+    self.currentChunk = nil;
+    self.indexSaveScheduled = NO;
+    [self.fileManager removeItemAtPath:self.diskCachePath error:nil];
+    [self.fileManager createDirectoryAtPath:self.diskCachePath withIntermediateDirectories:YES attributes:nil error:NULL];
+    SD_UNLOCK(_lock);
+}
+
+- (void)removeExpiredImages {
+    SD_LOCK(_lock);
+    if (self.config.maxDiskAge >= 0) {
+        NSDate *expirationDate = [NSDate dateWithTimeIntervalSinceNow:-self.config.maxDiskAge];
+        for (SDDecodedImageChunk *chunk in self.chunks.allValues) {
+            if ([chunk.accessDate compare:expirationDate] == NSOrderedAscending) {
+                [self removeChunk:chunk];
+            }
+        }
+    }
+    if (self.config.maxDecodedDiskSize > 0) {
+        [self trimToSize:self.config.maxDecodedDiskSize keepCurrentChunk:YES];
+    }
+    [self saveIndex];
+    SD_UNLOCK(_lock);
+}
+
+- (void)removeImagesToFitSize:(NSUInteger)size {
+    SD_LOCK(_lock);
+    [self trimToSize:size keepCurrentChunk:NO];
+    [self saveIndex];
+    SD_UNLOCK(_lock);
+}
+
+#pragma mark - Cache Info
+
+- (NSUInteger)totalSize {
+    NSUInteger size = 0;
+    SD_LOCK(_lock);
+    for (SDDecodedImageChunk *chunk in self.chunks.allValues) {
+        size += chunk.capacity;
+    }
+    SD_UNLOCK(_lock);
+    return size;
+}
+
+- (NSUInteger)totalCount {
+    SD_LOCK(_lock);
+    NSUInteger count = self.entries.count;
+    SD_UNLOCK(_lock);
+    return count;
+}
+
+#pragma mark - Helper
+
+- (nullable NSString *)entryKeyForKey:(nonnull NSString *)key options:(nullable SDImageCoderOptions *)options {
+    NSString *variant = SDDecodedImageVariantForOptions(options);
+    if (!variant) {
+        return nil;
+    }
+    return [NSString stringWithFormat:@"%@|%@|%@", key, variant, SDDecodedImagePixelFormat];
+}
+
+// Make sure to call under lock
+- (nullable SDDecodedImageChunk *)reserveChunkWithLength:(size_t)length offset:(size_t *)offset {
+    SDDecodedImageChunk *chunk = self.currentChunk;
+    if (!chunk || SDByteAlign(chunk.usedSize, SDDecodedImageEntryAlignment) + length > chunk.capacity) {
+        NSString *name = [SDDecodedImageChunkFilePrefix stringByAppendingString:[NSUUID UUID].UUIDString];
+        chunk = [[SDDecodedImageChunk alloc] initWithName:name path:[self.diskCachePath stringByAppendingPathComponent:name] capacity:self.chunkSize create:YES];
+        if (!chunk) {
+            return nil;
+        }
+        self.chunks[name] = chunk;
+        self.currentChunk = chunk;
+        if (self.config.maxDecodedDiskSize > 0) {
+            [self trimToSize:self.config.maxDecodedDiskSize keepCurrentChunk:YES];
+        }
+        // The previous chunk is full, persist its entries
+        [self setNeedsSaveIndex];
+    }
+    size_t start = SDByteAlign(chunk.usedSize, SDDecodedImageEntryAlignment);
+    chunk.usedSize = start + length;
+    chunk.accessDate = [NSDate date];
+    chunk.dirty = YES;
+    *offset = start;
+    return chunk;
+}
+
+// Make sure to call under lock
+- (void)removeChunk:(nonnull SDDecodedImageChunk *)chunk {
+    chunk.removed = YES;
+    [self.chunks removeObjectForKey:chunk.name];
+    NSMutableArray<NSString *> *entryKeys = [NSMutableArray array];
+    [self.entries enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull entryKey, SDDecodedImageEntry * _Nonnull entry, BOOL * _Nonnull stop) {
+        if (entry.chunk == chunk) {
+            [entryKeys addObject:entryKey];
+        }
+    }];
+    for (NSString *entryKey in entryKeys) {
+        [self removeEntryForEntryKey:entryKey];
+    }
+    if (self.currentChunk == chunk) {
+        self.currentChunk = nil;
+    }
+    // The mapped images still hold the unlinked file until they are released
+    unlink(chunk.path.fileSystemRepresentation);
+}
+
+// Make sure to call under lock
+- (void)addEntry:(nonnull SDDecodedImageEntry *)entry forEntryKey:(nonnull NSString *)entryKey {
+    self.entries[entryKey] = entry;
+    NSMutableSet<NSString *> *entryKeys = self.keyEntries[entry.key];
+    if (!entryKeys) {
+        entryKeys = [NSMutableSet set];
+        self.keyEntries[entry.key] = entryKeys;
+    }
+    [entryKeys addObject:entryKey];
+}
+
+// Make sure to call under lock
+- (void)removeEntryForEntryKey:(nonnull NSString *)entryKey {
+    SDDecodedImageEntry *entry = self.entries[entryKey];
+    if (!entry) {
+        return;
+    }
+    [self.entries removeObjectForKey:entryKey];
+    NSMutableSet<NSString *> *entryKeys = self.keyEntries[entry.key];
+    [entryKeys removeObject:entryKey];
+    if (entryKeys.count == 0) {
+        [self.keyEntries removeObjectForKey:entry.key];
+    }
+}
+
+// Make sure to call under lock
+- (void)trimToSize:(NSUInteger)maxSize keepCurrentChunk:(BOOL)keepCurrentChunk {
+    NSUInteger currentSize = 0;
+    for (SDDecodedImageChunk *chunk in self.chunks.allValues) {
+        currentSize += chunk.capacity;
+    }
+    if (currentSize <= maxSize) {
+        return;
+    }
+    // Remove the least recently used chunk first, the one in writing is kept when trimming after it is created
+    NSArray<SDDecodedImageChunk *> *sortedChunks = [self.chunks.allValues sortedArrayUsingComparator:^NSComparisonResult(SDDecodedImageChunk * _Nonnull chunk1, SDDecodedImageChunk * _Nonnull chunk2) {
+        return [chunk1.accessDate compare:chunk2.accessDate];
+    }];
+    for (SDDecodedImageChunk *chunk in sortedChunks) {
+        if (currentSize <= maxSize) {
+            break;
+        }
+        if (keepCurrentChunk && chunk == self.currentChunk) {
+            continue;
+        }
+        currentSize -= chunk.capacity;
+        [self removeChunk:chunk];
+    }
+}
+
+#pragma mark - Index
+
+- (NSString *)indexPath {
+    return [self.diskCachePath stringByAppendingPathComponent:SDDecodedImageIndexFileName];
+}
+
+// Make sure to call under lock
+- (void)setNeedsSaveIndex {
+    if (self.indexSaveScheduled) {
+        return;
+    }
+    self.indexSaveScheduled = YES;
+    @weakify(self);
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(SDDecodedImageIndexSaveDelay * NSEC_PER_SEC)), dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        @strongify(self);
+        if (!self) {
+            return;
+        }
+        SD_LOCK(self->_lock);
+        // Already saved by `removeExpiredImages`, or cancelled by `removeAllImages`
+        if (self.indexSaveScheduled) {
+            [self saveIndex];
+        }
+        SD_UNLOCK(self->_lock);
+    });
+}
+
+// Make sure to call under lock
+- (void)saveIndex {
+    self.indexSaveScheduled = NO;
+    NSMutableArray *chunkRecords = [NSMutableArray arrayWithCapacity:self.chunks.count];
+    for (SDDecodedImageChunk *chunk in self.chunks.allValues) {
+        // The index must not reference the bitmap which is not on disk yet
+        [chunk synchronize];
+        [chunkRecords addObject:@{
+            @"name" : chunk.name,
+            @"capacity" : @(chunk.capacity),
+            @"usedSize" : @(chunk.usedSize),
+            @"accessDate" : chunk.accessDate
+        }];
+    }
+    NSMutableArray *entryRecords = [NSMutableArray arrayWithCapacity:self.entries.count];
+    [self.entries enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull entryKey, SDDecodedImageEntry * _Nonnull entry, BOOL * _Nonnull stop) {
+        [entryRecords addObject:@{
+            @"entryKey" : entryKey,
+            @"key" : entry.key,
+            @"chunk" : entry.chunk.name,
+            @"offset" : @(entry.offset),
+            @"width" : @(entry.width),
+            @"height" : @(entry.height),
+            @"bytesPerRow" : @(entry.bytesPerRow),
+            @"bitmapInfo" : @(entry.bitmapInfo),
+            @"scale" : @(entry.scale),
+            @"orientation" : @(entry.orientation),
+            @"imageFormat" : @(entry.imageFormat)
+        }];
+    }];
+    NSMutableDictionary *index = [NSMutableDictionary dictionary];
+    index[@"version"] = @(SDDecodedImageIndexVersion);
+    index[@"chunks"] = chunkRecords;
+    index[@"entries"] = entryRecords;
+    index[@"currentChunk"] = self.currentChunk.name;
+    NSData *data = [NSPropertyListSerialization dataWithPropertyList:index format:NSPropertyListBinaryFormat_v1_0 options:0 error:nil];
+    [data writeToFile:[self indexPath] atomically:YES];
+}
+
+- (void)loadIndex {
+    NSData *data = [NSData dataWithContentsOfFile:[self indexPath]];
+    NSDictionary *index;
+    if (data) {
+        index = [NSPropertyListSerialization propertyListWithData:data options:NSPropertyListImmutable format:NULL error:nil];
+    }
+    if (![index isKindOfClass:NSDictionary.class] || [index[@"version"] integerValue] != SDDecodedImageIndexVersion) {
+        index = nil;
+    }
+    for (NSDictionary *record in index[@"chunks"]) {
+        NSString *name = record[@"name"];
+        size_t capacity = [record[@"capacity"] unsignedLongLongValue];
+        if (![name isKindOfClass:NSString.class] || capacity == 0) {
+            continue;
+        }
+        SDDecodedImageChunk *chunk = [[SDDecodedImageChunk alloc] initWithName:name path:[self.diskCachePath stringByAppendingPathComponent:name] capacity:capacity create:NO];
+        if (!chunk) {
+            continue;
+        }
+        chunk.usedSize = MIN((size_t)[record[@"usedSize"] unsignedLongLongValue], capacity);
+        if ([record[@"accessDate"] isKindOfClass:NSDate.class]) {
+            chunk.accessDate = record[@"accessDate"];
+        }
+        self.chunks[name] = chunk;
+    }
+    for (NSDictionary *record in index[@"entries"]) {
+        SDDecodedImageChunk *chunk = self.chunks[record[@"chunk"]];
+        NSString *entryKey = record[@"entryKey"];
+        NSString *key = record[@"key"];
+        if (!chunk || ![entryKey isKindOfClass:NSString.class] || ![key isKindOfClass:NSString.class]) {
+            continue;
+        }
+        SDDecodedImageEntry *entry = [SDDecodedImageEntry new];
+        entry.key = key;
+        entry.chunk = chunk;
+        entry.offset = [record[@"offset"] unsignedLongLongValue];
+        entry.width = [record[@"width"] unsignedLongLongValue];
+        entry.height = [record[@"height"] unsignedLongLongValue];
+        entry.bytesPerRow = [record[@"bytesPerRow"] unsignedLongLongValue];
+        entry.bitmapInfo = [record[@"bitmapInfo"] unsignedIntValue];
+        entry.scale = [record[@"scale"] doubleValue];
+        entry.orientation = [record[@"orientation"] integerValue];
+        entry.imageFormat = [record[@"imageFormat"] integerValue];
+        // Never map outside the written region
+        if (entry.width == 0 || entry.height == 0 || entry.bytesPerRow < entry.width * 4
+            || entry.height > (chunk.usedSize - MIN(entry.offset, chunk.usedSize)) / entry.bytesPerRow) {
+            continue;
+        }
+        [self addEntry:entry forEntryKey:entryKey];
+    }
+    // Continue appending to the last chunk, the region after the saved used size is not referenced
+    self.currentChunk = self.chunks[index[@"currentChunk"]];
+
+    // Remove the chunk files not in index, such as the one created before crash
+    NSArray<NSString *> *fileNames = [self.fileManager contentsOfDirectoryAtPath:self.diskCachePath error:nil];
+    for (NSString *fileName in fileNames) {
+        if ([fileName hasPrefix:SDDecodedImageChunkFilePrefix] && !self.chunks[fileName]) {
+            [self.fileManager removeItemAtPath:[self.diskCachePath stringByAppendingPathComponent:fileName] error:nil];
+        }
+    }
+}
+
+@end
@@ -117,6 +117,52 @@
  */
 - (NSUInteger)totalSize;
 
+@optional
+/**
+ Returns a new temporary file URL on the same volume as the cache, used to stream the data (such as the encoder output) into file, then commit it with `setDataWithTemporaryURL:forKey:`.
+ @note This method may be called from any queue, the temporary file is not visible as cache data until it's committed.
+ 
+ @param key The key which the data will be associated with
+ @return The temporary file URL, or nil if the cache does not support streaming write currently, then use `setData:forKey:` instead.
+ */
+- (nullable NSURL *)temporaryURLForKey:(nonnull NSString *)key;
+
+/**
+ Move the temporary file written at URL into the cache, and atomically replace the old data of the specified key. The temporary file is removed if failed.
+ This method may blocks the calling thread until file move finished.
+ 
+ @param temporaryURL The temporary file URL returned by `temporaryURLForKey:`
+ @param key The key with which to associate the value.
+ @return YES if the data is stored.
+ */
+- (BOOL)setDataWithTemporaryURL:(nonnull NSURL *)temporaryURL forKey:(nonnull NSString *)key;
+
+/**
+ Record the cost to re-fetch the data, such as the observed download latency. This is used by the eviction policy, see `SDImageCacheConfig.diskEvictionPolicy`.
+ This method may blocks the calling thread until file write finished.
+ 
+ @param fetchCost The fetch cost in seconds.
+ @param key The key of the stored data. If the data does not exist, this method has no effect.
+ */
+- (void)setFetchCost:(NSTimeInterval)fetchCost forKey:(nonnull NSString *)key;
+
+/**
+ Set the expiration date of the data, which is used instead of `maxDiskAge` when `shouldRespectHTTPCacheExpiration` is enabled. See `SDImageCacheConfig.shouldRespectHTTPCacheExpiration`.
+ This method may blocks the calling thread until file write finished.
+ 
+ @param expirationDate The expiration date (pass nil to remove).
+ @param key The key of the stored data. If the data does not exist, this method has no effect.
+ */
+- (void)setExpirationDate:(nullable NSDate *)expirationDate forKey:(nonnull NSString *)key;
+
+/**
+ Removes the data until the total size is below the specified size, in the same order as the size-based cleanup of `removeExpiredData`. This is used by the disk budget shared across caches, see `SDImageCacheDiskBudget`.
+ This method may blocks the calling thread until file delete finished.
+ 
+ @param size The desired total size in bytes.
+ */
+- (void)removeDataToFitSize:(NSUInteger)size;
+
 @end
 
 /**
@@ -9,14 +9,31 @@
 #import "SDDiskCache.h"
 #import "SDImageCacheConfig.h"
 #import "SDFileAttributeHelper.h"
+#import "SDDiskCacheInternal.h"
+#import "SDDiskCacheHelper.h"
 #import <CommonCrypto/CommonDigest.h>
+#import <sys/stat.h>
 
 static NSString * const SDDiskCacheExtendedAttributeName = @"com.hackemist.SDDiskCache";
 
+// The allocated size on disk, same as `NSURLTotalFileAllocatedSizeKey` which is used by `removeDataToFitSize:`
+static inline NSUInteger SDDiskCacheAllocatedSize(const struct stat *fileStat) {
+    return (NSUInteger)fileStat->st_blocks * 512;
+}
+
+static inline NSUInteger SDDiskCacheAllocatedSizeAtPath(NSString *path) {
+    struct stat fileStat;
+    if (stat(path.fileSystemRepresentation, &fileStat) != 0) {
+        return 0;
+    }
+    return SDDiskCacheAllocatedSize(&fileStat);
+}
+
 @interface SDDiskCache ()
 
 @property (nonatomic, copy) NSString *diskCachePath;
 @property (nonatomic, strong, nonnull) NSFileManager *fileManager;
+@property (nonatomic, strong, nullable) id<SDDiskCacheEvictionPolicy> evictionPolicy;
 
 @end
 
@@ -45,12 +62,20 @@ static NSString * const SDDiskCacheExtendedAttributeName = @"com.hackemist.SDDis
     }
   
     [self createDirectory];
+    
+    self.evictionPolicy = self.config.diskEvictionPolicy;
+    if (self.evictionPolicy) {
+        [SDDiskCacheHelper restorePersistentStateForPolicy:self.evictionPolicy atPath:self.diskCachePath];
+    }
 }
 
 - (BOOL)containsDataForKey:(NSString *)key {
     NSParameterAssert(key);
     NSString *filePath = [self cachePathForKey:key];
     BOOL exists = [self.fileManager fileExistsAtPath:filePath];
+    if (exists && [self removeDataIfExpiredAtPath:filePath]) {
+        return NO;
+    }
     
     // fallback because of https://github.com/rs/SDWebImage/pull/976 that added the extension to the disk file name
     // checking the key with and without the extension
@@ -69,9 +94,13 @@ static NSString * const SDDiskCacheExtendedAttributeName = @"com.hackemist.SDDis
     if (filePath == nil || [@"(null)" isEqualToString: filePath]) {
         return nil;
     }
+    if ([self removeDataIfExpiredAtPath:filePath]) {
+        return nil;
+    }
     NSData *data = [NSData dataWithContentsOfFile:filePath options:self.config.diskCacheReadingOptions error:nil];
     if (data) {
         [[NSURL fileURLWithPath:filePath] setResourceValue:[NSDate date] forKey:NSURLContentAccessDateKey error:nil];
+        [self updateEvictionEntryAtPath:filePath size:data.length reset:NO];
         return data;
     }
     
@@ -81,6 +110,7 @@ static NSString * const SDDiskCacheExtendedAttributeName = @"com.hackemist.SDDis
     data = [NSData dataWithContentsOfFile:filePath options:self.config.diskCacheReadingOptions error:nil];
     if (data) {
         [[NSURL fileURLWithPath:filePath] setResourceValue:[NSDate date] forKey:NSURLContentAccessDateKey error:nil];
+        [self updateEvictionEntryAtPath:filePath size:data.length reset:NO];
         return data;
     }
     
@@ -96,7 +126,66 @@ static NSString * const SDDiskCacheExtendedAttributeName = @"com.hackemist.SDDis
     // transform to NSURL
     NSURL *fileURL = [NSURL fileURLWithPath:cachePathForKey isDirectory:NO];
     
-    [data writeToURL:fileURL options:self.config.diskCacheWritingOptions error:nil];
+    if ([data writeToURL:fileURL options:self.config.diskCacheWritingOptions error:nil]) {
+        [self updateEvictionEntryAtPath:cachePathForKey size:data.length reset:YES];
+    }
+}
+
+- (NSURL *)temporaryURLForKey:(NSString *)key {
+    NSParameterAssert(key);
+#if !SD_MAC
+    if (self.config.diskCacheWritingOptions & NSDataWritingFileProtectionMask) {
+        // The file protection is applied by `-[NSData writeToURL:options:error:]`, use `setData:forKey:` instead
+        return nil;
+    }
+#endif
+    return [SDDiskCacheHelper uniqueTemporaryURLWithCachePath:self.diskCachePath fileManager:self.fileManager];
+}
+
+- (BOOL)setDataWithTemporaryURL:(NSURL *)temporaryURL forKey:(NSString *)key {
+    NSParameterAssert(temporaryURL);
+    NSParameterAssert(key);
+    
+    // get cache Path for image key
+    NSString *cachePathForKey = [self cachePathForKey:key];
+    // rename(2) replace the old file atomically, the reader never see the partial data
+    BOOL success = cachePathForKey && rename(temporaryURL.fileSystemRepresentation, cachePathForKey.fileSystemRepresentation) == 0;
+    if (!success) {
+        [self.fileManager removeItemAtURL:temporaryURL error:nil];
+    } else if (self.evictionPolicy) {
+        [self updateEvictionEntryAtPath:cachePathForKey size:SDDiskCacheAllocatedSizeAtPath(cachePathForKey) reset:YES];
+    }
+    
+    return success;
+}
+
+- (void)setFetchCost:(NSTimeInterval)fetchCost forKey:(NSString *)key {
+    NSParameterAssert(key);
+    if (!self.evictionPolicy) {
+        return;
+    }
+    NSString *cachePathForKey = [self cachePathForKey:key];
+    struct stat fileStat;
+    if (stat(cachePathForKey.fileSystemRepresentation, &fileStat) != 0) {
+        return;
+    }
+    SDDiskCacheEvictionEntry *entry = [SDDiskCacheHelper evictionEntryAtPath:cachePathForKey];
+    entry.size = SDDiskCacheAllocatedSize(&fileStat);
+    entry.date = [NSDate date];
+    entry.accessCount = MAX(entry.accessCount, 1);
+    entry.fetchCost = fetchCost;
+    [self.evictionPolicy updatePriorityForEntry:entry];
+    [SDDiskCacheHelper setEvictionEntry:entry atPath:cachePathForKey];
+}
+
+- (void)setExpirationDate:(NSDate *)expirationDate forKey:(NSString *)key {
+    NSParameterAssert(key);
+    NSString *cachePathForKey = [self cachePathForKey:key];
+    if (![self.fileManager fileExistsAtPath:cachePathForKey]) {
+        return;
+    }
+    
+    [SDDiskCacheHelper setExpirationDate:expirationDate atPath:cachePathForKey];
 }
 
 - (NSData *)extendedDataForKey:(NSString *)key {
@@ -136,48 +225,21 @@ static NSString * const SDDiskCacheExtendedAttributeName = @"com.hackemist.SDDis
 }
 
 - (void)createDirectory {
-  [self.fileManager createDirectoryAtPath:self.diskCachePath
-          withIntermediateDirectories:YES
-                           attributes:nil
-                                error:NULL];
-  
-  // disable iCloud backup
-  if (self.config.shouldDisableiCloud) {
-      // ignore iCloud backup resource value error
-      [[NSURL fileURLWithPath:self.diskCachePath isDirectory:YES] setResourceValue:@YES forKey:NSURLIsExcludedFromBackupKey error:nil];
-  }
+    [SDDiskCacheHelper createDirectoryAtPath:self.diskCachePath config:self.config fileManager:self.fileManager];
 }
 
 - (void)removeExpiredData {
-    NSURL *diskCacheURL = [NSURL fileURLWithPath:self.diskCachePath isDirectory:YES];
+    [SDDiskCacheHelper removeExpiredTemporaryFilesWithCachePath:self.diskCachePath fileManager:self.fileManager];
     
     // Compute content date key to be used for tests
-    NSURLResourceKey cacheContentDateKey;
-    switch (self.config.diskCacheExpireType) {
-        case SDImageCacheConfigExpireTypeModificationDate:
-            cacheContentDateKey = NSURLContentModificationDateKey;
-            break;
-        case SDImageCacheConfigExpireTypeCreationDate:
-            cacheContentDateKey = NSURLCreationDateKey;
-            break;
-        case SDImageCacheConfigExpireTypeChangeDate:
-            cacheContentDateKey = NSURLAttributeModificationDateKey;
-            break;
-        case SDImageCacheConfigExpireTypeAccessDate:
-        default:
-            cacheContentDateKey = NSURLContentAccessDateKey;
-            break;
-    }
+    NSURLResourceKey cacheContentDateKey = [SDDiskCacheHelper contentDateKeyWithConfig:self.config];
     
     NSArray<NSString *> *resourceKeys = @[NSURLIsDirectoryKey, cacheContentDateKey, NSURLTotalFileAllocatedSizeKey];
     
-    // This enumerator prefetches useful properties for our cache files.
-    NSDirectoryEnumerator<NSURL *> *fileEnumerator = [self.fileManager enumeratorAtURL:diskCacheURL
-                                               includingPropertiesForKeys:resourceKeys
-                                                                  options:NSDirectoryEnumerationSkipsHiddenFiles
-                                                             errorHandler:NULL];
+    // This listing prefetches useful properties for our cache files.
+    NSArray<NSURL *> *fileURLs = [SDDiskCacheHelper fileURLsInDirectory:self.diskCachePath includingPropertiesForKeys:resourceKeys fileManager:self.fileManager];
     
-    NSDate *expirationDate = (self.config.maxDiskAge < 0) ? nil: [NSDate dateWithTimeIntervalSinceNow:-self.config.maxDiskAge];
+    NSDate *expirationDate = [SDDiskCacheHelper ageExpirationDateWithConfig:self.config];
     NSMutableDictionary<NSURL *, NSDictionary<NSString *, id> *> *cacheFiles = [NSMutableDictionary dictionary];
     NSUInteger currentCacheSize = 0;
     
@@ -186,7 +248,7 @@ static NSString * const SDDiskCacheExtendedAttributeName = @"com.hackemist.SDDis
     //  1. Removing files that are older than the expiration date.
     //  2. Storing file attributes for the size-based cleanup pass.
     NSMutableArray<NSURL *> *urlsToDelete = [[NSMutableArray alloc] init];
-    for (NSURL *fileURL in fileEnumerator) {
+    for (NSURL *fileURL in fileURLs) {
         @autoreleasepool {
             NSError *error;
             NSDictionary<NSString *, id> *resourceValues = [fileURL resourceValuesForKeys:resourceKeys error:&error];
@@ -196,9 +258,8 @@ static NSString * const SDDiskCacheExtendedAttributeName = @"com.hackemist.SDDis
                 continue;
             }
             
-            // Remove files that are older than the expiration date;
-            NSDate *modifiedDate = resourceValues[cacheContentDateKey];
-            if (expirationDate && [[modifiedDate laterDate:expirationDate] isEqualToDate:expirationDate]) {
+            // Remove files that are expired by HTTP caching headers, or older than the expiration date
+            if ([SDDiskCacheHelper isExpiredFileAtPath:fileURL.path contentDate:resourceValues[cacheContentDateKey] ageExpirationDate:expirationDate config:self.config]) {
                 [urlsToDelete addObject:fileURL];
                 continue;
             }
@@ -220,23 +281,64 @@ static NSString * const SDDiskCacheExtendedAttributeName = @"com.hackemist.SDDis
     if (maxDiskSize > 0 && currentCacheSize > maxDiskSize) {
         // Target half of our maximum cache size for this cleanup pass.
         const NSUInteger desiredCacheSize = maxDiskSize / 2;
-        
-        // Sort the remaining cache files by their last modification time or last access time (oldest first).
-        NSArray<NSURL *> *sortedFiles = [cacheFiles keysSortedByValueWithOptions:NSSortConcurrent
-                                                                 usingComparator:^NSComparisonResult(id obj1, id obj2) {
-                                                                     return [obj1[cacheContentDateKey] compare:obj2[cacheContentDateKey]];
-                                                                 }];
-        
-        // Delete files until we fall below our desired cache size.
-        for (NSURL *fileURL in sortedFiles) {
-            if ([self.fileManager removeItemAtURL:fileURL error:nil]) {
-                NSDictionary<NSString *, id> *resourceValues = cacheFiles[fileURL];
-                NSNumber *totalAllocatedSize = resourceValues[NSURLTotalFileAllocatedSizeKey];
-                currentCacheSize -= totalAllocatedSize.unsignedIntegerValue;
-                
-                if (currentCacheSize < desiredCacheSize) {
-                    break;
-                }
+        [self removeCacheFiles:cacheFiles currentCacheSize:currentCacheSize desiredCacheSize:desiredCacheSize dateKey:cacheContentDateKey];
+    }
+}
+
+- (void)removeDataToFitSize:(NSUInteger)size {
+    NSURLResourceKey cacheContentDateKey = [SDDiskCacheHelper contentDateKeyWithConfig:self.config];
+    NSArray<NSString *> *resourceKeys = @[NSURLIsDirectoryKey, cacheContentDateKey, NSURLTotalFileAllocatedSizeKey];
+    NSArray<NSURL *> *fileURLs = [SDDiskCacheHelper fileURLsInDirectory:self.diskCachePath includingPropertiesForKeys:resourceKeys fileManager:self.fileManager];
+    
+    NSMutableDictionary<NSURL *, NSDictionary<NSString *, id> *> *cacheFiles = [NSMutableDictionary dictionary];
+    NSUInteger currentCacheSize = 0;
+    for (NSURL *fileURL in fileURLs) {
+        @autoreleasepool {
+            NSError *error;
+            NSDictionary<NSString *, id> *resourceValues = [fileURL resourceValuesForKeys:resourceKeys error:&error];
+            
+            // Skip directories and errors.
+            if (error || !resourceValues || [resourceValues[NSURLIsDirectoryKey] boolValue]) {
+                continue;
+            }
+            
+            NSNumber *totalAllocatedSize = resourceValues[NSURLTotalFileAllocatedSizeKey];
+            currentCacheSize += totalAllocatedSize.unsignedIntegerValue;
+            cacheFiles[fileURL] = resourceValues;
+        }
+    }
+    
+    if (currentCacheSize > size) {
+        [self removeCacheFiles:cacheFiles currentCacheSize:currentCacheSize desiredCacheSize:size dateKey:cacheContentDateKey];
+    }
+}
+
+// The size-based cleanup pass, delete the files until we fall below our desired cache size
+- (void)removeCacheFiles:(NSDictionary<NSURL *, NSDictionary<NSString *, id> *> *)cacheFiles
+        currentCacheSize:(NSUInteger)currentCacheSize
+        desiredCacheSize:(NSUInteger)desiredCacheSize
+                 dateKey:(NSURLResourceKey)cacheContentDateKey {
+    id<SDDiskCacheEvictionPolicy> evictionPolicy = self.evictionPolicy;
+    if (evictionPolicy) {
+        [self removeCacheFiles:cacheFiles withEvictionPolicy:evictionPolicy currentCacheSize:currentCacheSize desiredCacheSize:desiredCacheSize dateKey:cacheContentDateKey];
+        return;
+    }
+    
+    // Sort the remaining cache files by their last modification time or last access time (oldest first).
+    NSArray<NSURL *> *sortedFiles = [cacheFiles keysSortedByValueWithOptions:NSSortConcurrent
+                                                             usingComparator:^NSComparisonResult(id obj1, id obj2) {
+                                                                 return [obj1[cacheContentDateKey] compare:obj2[cacheContentDateKey]];
+                                                             }];
+    
+    // Delete files until we fall below our desired cache size.
+    for (NSURL *fileURL in sortedFiles) {
+        if ([self.fileManager removeItemAtURL:fileURL error:nil]) {
+            NSDictionary<NSString *, id> *resourceValues = cacheFiles[fileURL];
+            NSNumber *totalAllocatedSize = resourceValues[NSURLTotalFileAllocatedSizeKey];
+            currentCacheSize -= totalAllocatedSize.unsignedIntegerValue;
+            
+            if (currentCacheSize < desiredCacheSize) {
+                break;
             }
         }
     }
@@ -248,6 +350,14 @@ static NSString * const SDDiskCacheExtendedAttributeName = @"com.hackemist.SDDis
 }
 
 - (NSUInteger)totalSize {
+    return [self totalSizeWithResourceKey:NSURLFileSizeKey];
+}
+
+- (NSUInteger)totalAllocatedSize {
+    return [self totalSizeWithResourceKey:NSURLTotalFileAllocatedSizeKey];
+}
+
+- (NSUInteger)totalSizeWithResourceKey:(NSURLResourceKey)resourceKey {
     NSUInteger size = 0;
 
     // Use URL-based enumerator instead of Path(NSString *)-based enumerator to reduce
@@ -258,14 +368,14 @@ static NSString * const SDDiskCacheExtendedAttributeName = @"com.hackemist.SDDis
     @autoreleasepool {
         NSURL *pathURL = [NSURL fileURLWithPath:self.diskCachePath isDirectory:YES];
         NSDirectoryEnumerator<NSURL *> *fileEnumerator = [self.fileManager enumeratorAtURL:pathURL
-                                                  includingPropertiesForKeys:@[NSURLFileSizeKey]
+                                                  includingPropertiesForKeys:@[resourceKey]
                                                                      options:(NSDirectoryEnumerationOptions)0
                                                                 errorHandler:NULL];
         
         for (NSURL *fileURL in fileEnumerator) {
             @autoreleasepool {
                 NSNumber *fileSize;
-                [fileURL getResourceValue:&fileSize forKey:NSURLFileSizeKey error:NULL];
+                [fileURL getResourceValue:&fileSize forKey:resourceKey error:NULL];
                 size += fileSize.unsignedIntegerValue;
             }
         }
@@ -283,6 +393,62 @@ static NSString * const SDDiskCacheExtendedAttributeName = @"com.hackemist.SDDis
     return count;
 }
 
+#pragma mark - Expiration
+
+// Remove the data expired by HTTP caching headers, which should be downloaded again
+- (BOOL)removeDataIfExpiredAtPath:(NSString *)path {
+    if (![SDDiskCacheHelper isExpiredByHTTPCacheAtPath:path config:self.config]) {
+        return NO;
+    }
+    [self.fileManager removeItemAtPath:path error:nil];
+    return YES;
+}
+
+#pragma mark - Eviction policy
+
+- (void)removeCacheFiles:(NSDictionary<NSURL *, NSDictionary<NSString *, id> *> *)cacheFiles
+      withEvictionPolicy:(id<SDDiskCacheEvictionPolicy>)evictionPolicy
+        currentCacheSize:(NSUInteger)currentCacheSize
+        desiredCacheSize:(NSUInteger)desiredCacheSize
+                 dateKey:(NSURLResourceKey)dateKey {
+    NSMutableArray<SDDiskCacheEvictionEntry *> *entries = [NSMutableArray arrayWithCapacity:cacheFiles.count];
+    NSMutableDictionary<NSString *, NSURL *> *fileURLs = [NSMutableDictionary dictionaryWithCapacity:cacheFiles.count];
+    [cacheFiles enumerateKeysAndObjectsUsingBlock:^(NSURL * _Nonnull fileURL, NSDictionary<NSString *, id> * _Nonnull resourceValues, BOOL * _Nonnull stop) {
+        @autoreleasepool {
+            SDDiskCacheEvictionEntry *entry = [SDDiskCacheHelper evictionEntryAtPath:fileURL.path];
+            entry.size = [resourceValues[NSURLTotalFileAllocatedSizeKey] unsignedIntegerValue];
+            entry.date = resourceValues[dateKey];
+            [entries addObject:entry];
+            fileURLs[entry.identifier] = fileURL;
+        }
+    }];
+    
+    // Delete files in the policy order until we fall below our desired cache size.
+    NSArray<SDDiskCacheEvictionEntry *> *sortedEntries = [evictionPolicy sortedEntriesForEviction:entries];
+    for (SDDiskCacheEvictionEntry *entry in sortedEntries) {
+        NSURL *fileURL = fileURLs[entry.identifier];
+        if (fileURL && [self.fileManager removeItemAtURL:fileURL error:nil]) {
+            [evictionPolicy didEvictEntry:entry];
+            currentCacheSize -= entry.size;
+            
+            if (currentCacheSize < desiredCacheSize) {
+                break;
+            }
+        }
+    }
+    
+    [SDDiskCacheHelper savePersistentStateForPolicy:evictionPolicy atPath:self.diskCachePath];
+}
+
+// Count the access of cache file, `reset` for the newly written file
+- (void)updateEvictionEntryAtPath:(NSString *)path size:(NSUInteger)size reset:(BOOL)reset {
+    id<SDDiskCacheEvictionPolicy> evictionPolicy = self.evictionPolicy;
+    if (!evictionPolicy) {
+        return;
+    }
+    [SDDiskCacheHelper updateEvictionEntryAtPath:path size:size reset:reset policy:evictionPolicy];
+}
+
 #pragma mark - Cache paths
 
 - (nullable NSString *)cachePathForKey:(nullable NSString *)key inPath:(nonnull NSString *)path {
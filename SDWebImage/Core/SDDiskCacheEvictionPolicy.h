@@ -0,0 +1,183 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDWebImageCompat.h"
+
+/**
+ The entry of disk cache, which is used by the eviction policy to choose the data to remove.
+ The built-in `SDDiskCache` keeps the `accessCount`, `fetchCost` and `priority` in the extended attribute of cache file.
+ */
+@interface SDDiskCacheEvictionEntry : NSObject
+
+/**
+ The identifier of entry, for `SDDiskCache` it's the cache file name.
+ */
+@property (nonatomic, copy, readonly, nonnull) NSString *identifier;
+
+/**
+ The entry size in bytes.
+ */
+@property (nonatomic, assign) NSUInteger size;
+
+/**
+ The date of entry which is checked by `diskCacheExpireType`, the access date by default.
+ */
+@property (nonatomic, strong, nullable) NSDate *date;
+
+/**
+ The number of times the entry is stored or accessed.
+ */
+@property (nonatomic, assign) NSUInteger accessCount;
+
+/**
+ The cost to re-fetch the entry in seconds, such as the observed download latency. 0 means unknown.
+ */
+@property (nonatomic, assign) NSTimeInterval fetchCost;
+
+/**
+ The eviction priority calculated by the policy.
+ */
+@property (nonatomic, assign) double priority;
+
+- (nonnull instancetype)init NS_UNAVAILABLE;
++ (nonnull instancetype)new  NS_UNAVAILABLE;
+
+/**
+ Create the entry with identifier.
+ */
+- (nonnull instancetype)initWithIdentifier:(nonnull NSString *)identifier NS_DESIGNATED_INITIALIZER;
+
+@end
+
+/**
+ The policy to choose the data to remove, when the disk cache exceeds the `maxDiskSize`. See `SDImageCacheConfig.diskEvictionPolicy`.
+ The expiration by `maxDiskAge` is always applied before the policy.
+ @note The methods may be called from the different disk cache's queue, it's recommended to ensure thread-safe using lock.
+ */
+@protocol SDDiskCacheEvictionPolicy <NSObject>
+
+@required
+/**
+ Update the entry's priority. This is called after the entry is stored, accessed, or the fetch cost is provided.
+
+ @param entry The entry to update, the `accessCount` and `fetchCost` are already updated.
+ */
+- (void)updatePriorityForEntry:(nonnull SDDiskCacheEvictionEntry *)entry;
+
+/**
+ Sort the entries in order to evict. The disk cache remove the entries from the beginning, until the size is below half of `maxDiskSize`.
+
+ @param entries The entries in disk cache.
+ @return The sorted entries, the first one is evicted first.
+ */
+- (nonnull NSArray<SDDiskCacheEvictionEntry *> *)sortedEntriesForEviction:(nonnull NSArray<SDDiskCacheEvictionEntry *> *)entries;
+
+/**
+ Called when the entry is evicted, in the order of eviction.
+
+ @param entry The evicted entry.
+ */
+- (void)didEvictEntry:(nonnull SDDiskCacheEvictionEntry *)entry;
+
+@optional
+/**
+ The state which should survive across launch, such as the aging value of policy. The disk cache saves it after eviction, and restores it when the cache is created.
+ */
+@property (nonatomic, copy, nullable) NSData *persistentState;
+
+@end
+
+/**
+ The least recently used policy, which evicts the entries with the oldest `date` first. This is the same as the disk cache without policy.
+ */
+@interface SDDiskCacheLRUEvictionPolicy : NSObject <SDDiskCacheEvictionPolicy>
+
+@end
+
+/**
+ The GreedyDual-Size-Frequency policy. It combines the recency, frequency, size and re-fetch cost of entry, which keeps the small images reused often and the ones which are slow to download, and evicts the large one-off images first.
+ The priority is `inflation + accessCount * fetchCost / size`, the entry with the lowest priority is evicted first, and the `inflation` is raised to the priority of evicted entry. So the entries not accessed for a long time age out.
+ */
+@interface SDDiskCacheGDSFEvictionPolicy : NSObject <SDDiskCacheEvictionPolicy>
+
+/**
+ The fetch cost used when the entry's fetch cost is unknown, in seconds.
+ Defaults to 0.5.
+ */
+@property (nonatomic, assign) NSTimeInterval defaultFetchCost;
+
+/**
+ The current aging value, which is the priority of last evicted entry.
+ */
+@property (nonatomic, assign, readonly) double inflation;
+
+@end
+
+/**
+ Replay the recorded request trace with an eviction policy, to evaluate the policy in a simulated disk cache. The simulation follows `SDDiskCache`: the missed request stores the entry, and the cache evicts to half of capacity when exceeded.
+ */
+@interface SDDiskCacheEvictionReplay : NSObject
+
+/**
+ The policy to evaluate.
+ */
+@property (nonatomic, strong, readonly, nonnull) id<SDDiskCacheEvictionPolicy> policy;
+
+/**
+ The simulated cache capacity in bytes.
+ */
+@property (nonatomic, assign, readonly) NSUInteger capacity;
+
+/**
+ The number of requests, and the number of requests hit the cache.
+ */
+@property (nonatomic, assign, readonly) NSUInteger requestCount;
+@property (nonatomic, assign, readonly) NSUInteger hitCount;
+
+/**
+ The bytes of requests, and the bytes of requests hit the cache.
+ */
+@property (nonatomic, assign, readonly) NSUInteger requestBytes;
+@property (nonatomic, assign, readonly) NSUInteger hitBytes;
+
+/**
+ The request hit ratio, `hitCount / requestCount`.
+ */
+@property (nonatomic, assign, readonly) double requestHitRatio;
+
+/**
+ The byte hit ratio, `hitBytes / requestBytes`.
+ */
+@property (nonatomic, assign, readonly) double byteHitRatio;
+
+- (nonnull instancetype)init NS_UNAVAILABLE;
++ (nonnull instancetype)new  NS_UNAVAILABLE;
+
+/**
+ Create the replay with the policy and cache capacity.
+ */
+- (nonnull instancetype)initWithPolicy:(nonnull id<SDDiskCacheEvictionPolicy>)policy capacity:(NSUInteger)capacity NS_DESIGNATED_INITIALIZER;
+
+/**
+ Replay one request.
+
+ @param key The cache key.
+ @param size The data size in bytes.
+ @param fetchCost The download latency in seconds, 0 means unknown.
+ */
+- (void)replayRequestForKey:(nonnull NSString *)key size:(NSUInteger)size fetchCost:(NSTimeInterval)fetchCost;
+
+/**
+ Replay the trace file. Each line is `<key> <size> [<fetchCost>]` separated by whitespace, blank lines and lines starting with `#` are ignored.
+
+ @param path The trace file path.
+ @return NO if the file can not be read.
+ */
+- (BOOL)replayTraceAtPath:(nonnull NSString *)path;
+
+@end
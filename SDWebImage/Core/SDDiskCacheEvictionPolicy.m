@@ -0,0 +1,215 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDDiskCacheEvictionPolicy.h"
+#import "SDInternalMacros.h"
+
+static const NSTimeInterval kDefaultFetchCost = 0.5;
+
+@implementation SDDiskCacheEvictionEntry
+
+- (instancetype)initWithIdentifier:(NSString *)identifier {
+    NSParameterAssert(identifier);
+    self = [super init];
+    if (self) {
+        _identifier = [identifier copy];
+    }
+    return self;
+}
+
+@end
+
+@implementation SDDiskCacheLRUEvictionPolicy
+
+- (void)updatePriorityForEntry:(SDDiskCacheEvictionEntry *)entry {
+    // The order only depends on date
+}
+
+- (NSArray<SDDiskCacheEvictionEntry *> *)sortedEntriesForEviction:(NSArray<SDDiskCacheEvictionEntry *> *)entries {
+    return [entries sortedArrayWithOptions:NSSortConcurrent usingComparator:^NSComparisonResult(SDDiskCacheEvictionEntry * _Nonnull entry1, SDDiskCacheEvictionEntry * _Nonnull entry2) {
+        return [entry1.date compare:entry2.date];
+    }];
+}
+
+- (void)didEvictEntry:(SDDiskCacheEvictionEntry *)entry {
+}
+
+@end
+
+@implementation SDDiskCacheGDSFEvictionPolicy {
+    SD_LOCK_DECLARE(_lock);
+    double _inflation;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _defaultFetchCost = kDefaultFetchCost;
+        SD_LOCK_INIT(_lock);
+    }
+    return self;
+}
+
+- (double)inflation {
+    SD_LOCK(_lock);
+    double inflation = _inflation;
+    SD_UNLOCK(_lock);
+    return inflation;
+}
+
+- (void)updatePriorityForEntry:(SDDiskCacheEvictionEntry *)entry {
+    NSTimeInterval fetchCost = entry.fetchCost > 0 ? entry.fetchCost : self.defaultFetchCost;
+    // The frequency and cost per byte, the small images and slow images have higher value
+    double value = (double)MAX(entry.accessCount, 1) * fetchCost / (double)MAX(entry.size, 1);
+    SD_LOCK(_lock);
+    entry.priority = _inflation + value;
+    SD_UNLOCK(_lock);
+}
+
+- (NSArray<SDDiskCacheEvictionEntry *> *)sortedEntriesForEviction:(NSArray<SDDiskCacheEvictionEntry *> *)entries {
+    return [entries sortedArrayWithOptions:NSSortConcurrent usingComparator:^NSComparisonResult(SDDiskCacheEvictionEntry * _Nonnull entry1, SDDiskCacheEvictionEntry * _Nonnull entry2) {
+        if (entry1.priority < entry2.priority) {
+            return NSOrderedAscending;
+        } else if (entry1.priority > entry2.priority) {
+            return NSOrderedDescending;
+        }
+        // Same priority, evict the older one
+        return [entry1.date compare:entry2.date];
+    }];
+}
+
+- (void)didEvictEntry:(SDDiskCacheEvictionEntry *)entry {
+    SD_LOCK(_lock);
+    // Raise the aging value, the entries not accessed since then have lower priority than the new ones
+    _inflation = MAX(_inflation, entry.priority);
+    SD_UNLOCK(_lock);
+}
+
+- (NSData *)persistentState {
+    double inflation = self.inflation;
+    return [NSData dataWithBytes:&inflation length:sizeof(inflation)];
+}
+
+- (void)setPersistentState:(NSData *)persistentState {
+    double inflation = 0;
+    if (persistentState.length == sizeof(inflation)) {
+        [persistentState getBytes:&inflation length:sizeof(inflation)];
+    }
+    if (!isfinite(inflation) || inflation < 0) {
+        inflation = 0;
+    }
+    SD_LOCK(_lock);
+    _inflation = inflation;
+    SD_UNLOCK(_lock);
+}
+
+@end
+
+@interface SDDiskCacheEvictionReplay ()
+
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSString *, SDDiskCacheEvictionEntry *> *entries;
+@property (nonatomic, assign) NSUInteger totalSize;
+@property (nonatomic, assign, readwrite) NSUInteger requestCount;
+@property (nonatomic, assign, readwrite) NSUInteger hitCount;
+@property (nonatomic, assign, readwrite) NSUInteger requestBytes;
+@property (nonatomic, assign, readwrite) NSUInteger hitBytes;
+
+@end
+
+@implementation SDDiskCacheEvictionReplay
+
+- (instancetype)initWithPolicy:(id<SDDiskCacheEvictionPolicy>)policy capacity:(NSUInteger)capacity {
+    NSParameterAssert(policy);
+    self = [super init];
+    if (self) {
+        _policy = policy;
+        _capacity = capacity;
+        _entries = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (double)requestHitRatio {
+    return self.requestCount > 0 ? (double)self.hitCount / self.requestCount : 0;
+}
+
+- (double)byteHitRatio {
+    return self.requestBytes > 0 ? (double)self.hitBytes / self.requestBytes : 0;
+}
+
+- (void)replayRequestForKey:(NSString *)key size:(NSUInteger)size fetchCost:(NSTimeInterval)fetchCost {
+    NSParameterAssert(key);
+    // Use the request sequence as clock, so the replay does not depend on the wall time
+    NSDate *date = [NSDate dateWithTimeIntervalSinceReferenceDate:self.requestCount];
+    self.requestCount++;
+    self.requestBytes += size;
+
+    SDDiskCacheEvictionEntry *entry = self.entries[key];
+    if (entry) {
+        self.hitCount++;
+        self.hitBytes += size;
+        entry.accessCount++;
+        entry.date = date;
+        [self.policy updatePriorityForEntry:entry];
+        return;
+    }
+
+    // Miss, download and store
+    entry = [[SDDiskCacheEvictionEntry alloc] initWithIdentifier:key];
+    entry.size = size;
+    entry.date = date;
+    entry.accessCount = 1;
+    entry.fetchCost = fetchCost;
+    [self.policy updatePriorityForEntry:entry];
+    self.entries[key] = entry;
+    self.totalSize += size;
+
+    if (self.capacity > 0 && self.totalSize > self.capacity) {
+        [self evict];
+    }
+}
+
+- (void)evict {
+    // The same as the size-based cleanup pass of `SDDiskCache`
+    const NSUInteger desiredSize = self.capacity / 2;
+    NSArray<SDDiskCacheEvictionEntry *> *sortedEntries = [self.policy sortedEntriesForEviction:self.entries.allValues];
+    for (SDDiskCacheEvictionEntry *entry in sortedEntries) {
+        [self.entries removeObjectForKey:entry.identifier];
+        self.totalSize -= entry.size;
+        [self.policy didEvictEntry:entry];
+        if (self.totalSize < desiredSize) {
+            break;
+        }
+    }
+}
+
+- (BOOL)replayTraceAtPath:(NSString *)path {
+    NSParameterAssert(path);
+    NSString *trace = [NSString stringWithContentsOfFile:path encoding:NSUTF8StringEncoding error:nil];
+    if (!trace) {
+        return NO;
+    }
+    NSCharacterSet *whitespaceSet = [NSCharacterSet whitespaceCharacterSet];
+    [trace enumerateLinesUsingBlock:^(NSString * _Nonnull line, BOOL * _Nonnull stop) {
+        line = [line stringByTrimmingCharactersInSet:whitespaceSet];
+        if (line.length == 0 || [line hasPrefix:@"#"]) {
+            return;
+        }
+        NSMutableArray<NSString *> *fields = [[line componentsSeparatedByCharactersInSet:whitespaceSet] mutableCopy];
+        [fields removeObject:@""];
+        if (fields.count < 2) {
+            return;
+        }
+        NSUInteger size = (NSUInteger)MAX(fields[1].longLongValue, 0);
+        NSTimeInterval fetchCost = fields.count > 2 ? fields[2].doubleValue : 0;
+        [self replayRequestForKey:fields[0] size:size fetchCost:fetchCost];
+    }];
+    return YES;
+}
+
+@end
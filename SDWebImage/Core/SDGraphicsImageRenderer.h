@@ -82,3 +82,44 @@ typedef NS_ENUM(NSInteger, SDGraphicsImageRendererFormatRange) {
 - (nonnull UIImage *)imageWithActions:(nonnull NS_NOESCAPE SDGraphicsImageDrawingActions)actions;
 
 @end
+
+/**
+ A keyed pool of reusable image renderers, keyed by (size, scale, opaque, preferredRange). The renders used by placeholders, indicators and the transform category happen very often at a handful of fixed sizes, pooling avoid to create a new renderer and bitmap context for each render.
+ For UIKit, the pooled `UIGraphicsImageRenderer` keeps its own cache of Core Graphics contexts. For AppKit, the pooled renderer reuse the same bitmap context, the backing store is copy-on-write so it's reused without copy once the previous image is released.
+ @note A renderer is checked out from the pool during the render, so concurrent renders with the same key never share one renderer.
+ */
+@interface SDGraphicsImageRendererPool : NSObject
+
+/// The shared pool, used by the transform category.
+@property (nonatomic, class, readonly, nonnull) SDGraphicsImageRendererPool *sharedPool;
+
+/// The maximum number of idle renderers kept in the pool. The least recently used one is removed when exceed.
+/// Defaults to 16. Set to 0 to disable the pooling.
+@property (atomic, assign) NSUInteger countLimit;
+
+/// The number of idle renderers currently in the pool.
+@property (atomic, assign, readonly) NSUInteger count;
+
+/// The number of renders which reuse a pooled renderer.
+@property (atomic, assign, readonly) NSUInteger hitCount;
+
+/// The number of renders which create a new renderer.
+@property (atomic, assign, readonly) NSUInteger missCount;
+
+/// The hit rate in [0, 1], 0 if there are no renders yet.
+@property (atomic, assign, readonly) double hitRate;
+
+/// Creates an image by following a set of drawing instructions, using a pooled renderer matching size and format.
+/// @param size The size of image, specified in points.
+/// @param format The format used to create the renderer context. Only `scale`, `opaque` and `preferredRange` are respected.
+/// @param actions A SDGraphicsImageDrawingActions block that executes a set of drawing instructions to create the output image.
+/// @return A UIImage object created by the supplied drawing actions.
+- (nonnull UIImage *)imageWithSize:(CGSize)size format:(nonnull SDGraphicsImageRendererFormat *)format actions:(nonnull NS_NOESCAPE SDGraphicsImageDrawingActions)actions;
+
+/// Remove all idle renderers in the pool. This is called automatically when receiving memory warning on UIKit.
+- (void)removeAllRenderers;
+
+/// Reset the hit and miss count to 0.
+- (void)resetStatistics;
+
+@end
@@ -9,6 +9,13 @@
 #import "SDGraphicsImageRenderer.h"
 #import "SDImageGraphics.h"
 #import "SDDeviceHelper.h"
+#import "SDInternalMacros.h"
+#import "NSImage+Compatibility.h"
+
+#if SD_MAC
+// Defined in `SDImageGraphics.m`
+FOUNDATION_EXTERN CGContextRef SDCGContextCreateBitmapContext(CGSize size, BOOL opaque, CGFloat scale);
+#endif
 
 @implementation SDGraphicsImageRendererFormat
 @synthesize scale = _scale;
@@ -177,9 +184,24 @@
 #if SD_UIKIT
 @property (nonatomic, strong) UIGraphicsImageRenderer *uirenderer API_AVAILABLE(ios(10.0), tvos(10.0));
 #endif
+// Only the pooled renderer reuse the bitmap context, which is never used concurrently
+@property (nonatomic, assign) BOOL reusesContext;
 @end
 
-@implementation SDGraphicsImageRenderer
+@implementation SDGraphicsImageRenderer {
+#if SD_MAC
+    CGContextRef _reusableContext;
+#endif
+}
+
+- (void)dealloc {
+#if SD_MAC
+    if (_reusableContext) {
+        CGContextRelease(_reusableContext);
+        _reusableContext = NULL;
+    }
+#endif
+}
 
 - (instancetype)initWithSize:(CGSize)size {
     return [self initWithSize:size format:SDGraphicsImageRendererFormat.preferredFormat];
@@ -212,6 +234,11 @@
         };
         return [self.uirenderer imageWithActions:uiactions];
     } else {
+#endif
+#if SD_MAC
+        if (self.reusesContext) {
+            return [self reusableContextImageWithActions:actions];
+        }
 #endif
         SDGraphicsBeginImageContextWithOptions(self.size, self.format.opaque, self.format.scale);
         CGContextRef context = SDGraphicsGetCurrentContext();
@@ -226,4 +253,171 @@
 #endif
 }
 
+#if SD_MAC
+- (UIImage *)reusableContextImageWithActions:(NS_NOESCAPE SDGraphicsImageDrawingActions)actions {
+    CGSize size = self.size;
+    CGFloat scale = self.format.scale;
+    if (scale <= 0) {
+        scale = SDDeviceHelper.screenScale;
+    }
+    if (!_reusableContext) {
+        _reusableContext = SDCGContextCreateBitmapContext(size, self.format.opaque, scale);
+    }
+    CGContextRef context = _reusableContext;
+    if (!context) {
+        return nil;
+    }
+    CGContextSaveGState(context);
+    // Reset the previous content, the new bitmap context is zero-filled as well
+    CGContextClearRect(context, CGRectMake(0, 0, size.width, size.height));
+    NSGraphicsContext *graphicsContext = [NSGraphicsContext graphicsContextWithCGContext:context flipped:NO];
+    [NSGraphicsContext saveGraphicsState];
+    NSGraphicsContext.currentContext = graphicsContext;
+    if (actions) {
+        actions(context);
+    }
+    [NSGraphicsContext restoreGraphicsState];
+    CGContextRestoreGState(context);
+    // The returned CGImage share the backing store with context until next draw (copy-on-write)
+    CGImageRef imageRef = CGBitmapContextCreateImage(context);
+    if (!imageRef) {
+        return nil;
+    }
+    NSImage *image = [[NSImage alloc] initWithCGImage:imageRef scale:scale orientation:kCGImagePropertyOrientationUp];
+    CGImageRelease(imageRef);
+    return image;
+}
+#endif
+
+@end
+
+@interface SDGraphicsImageRendererPool ()
+
+@property (nonatomic, strong, nonnull) NSMutableArray<SDGraphicsImageRenderer *> *renderers; // Idle renderers, the last one is the most recently used
+
+@end
+
+@implementation SDGraphicsImageRendererPool {
+    SD_LOCK_DECLARE(_lock);
+}
+
++ (SDGraphicsImageRendererPool *)sharedPool {
+    static dispatch_once_t onceToken;
+    static SDGraphicsImageRendererPool *pool;
+    dispatch_once(&onceToken, ^{
+        pool = [[SDGraphicsImageRendererPool alloc] init];
+    });
+    return pool;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _renderers = [NSMutableArray array];
+        _countLimit = 16;
+        SD_LOCK_INIT(_lock);
+#if SD_UIKIT
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(didReceiveMemoryWarning:) name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+#endif
+    }
+    return self;
+}
+
+- (void)dealloc {
+#if SD_UIKIT
+    [[NSNotificationCenter defaultCenter] removeObserver:self name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+#endif
+}
+
+- (void)didReceiveMemoryWarning:(NSNotification *)notification {
+    [self removeAllRenderers];
+}
+
+- (NSUInteger)count {
+    SD_LOCK(_lock);
+    NSUInteger count = self.renderers.count;
+    SD_UNLOCK(_lock);
+    return count;
+}
+
+- (double)hitRate {
+    SD_LOCK(_lock);
+    NSUInteger hitCount = _hitCount;
+    NSUInteger totalCount = _hitCount + _missCount;
+    SD_UNLOCK(_lock);
+    if (totalCount == 0) {
+        return 0;
+    }
+    return (double)hitCount / totalCount;
+}
+
+static inline BOOL SDGraphicsImageRendererMatch(SDGraphicsImageRenderer *renderer, CGSize size, CGFloat scale, BOOL opaque, SDGraphicsImageRendererFormatRange preferredRange) {
+    SDGraphicsImageRendererFormat *format = renderer.format;
+    return CGSizeEqualToSize(renderer.size, size) && format.scale == scale && format.opaque == opaque && format.preferredRange == preferredRange;
+}
+
+- (UIImage *)imageWithSize:(CGSize)size format:(SDGraphicsImageRendererFormat *)format actions:(NS_NOESCAPE SDGraphicsImageDrawingActions)actions {
+    NSParameterAssert(format);
+    NSParameterAssert(actions);
+    CGFloat scale = format.scale;
+    BOOL opaque = format.opaque;
+    SDGraphicsImageRendererFormatRange preferredRange = format.preferredRange;
+    
+    // Check out the renderer, so it's never used concurrently
+    SDGraphicsImageRenderer *renderer;
+    SD_LOCK(_lock);
+    for (NSInteger i = self.renderers.count - 1; i >= 0; i--) {
+        SDGraphicsImageRenderer *idleRenderer = self.renderers[i];
+        if (SDGraphicsImageRendererMatch(idleRenderer, size, scale, opaque, preferredRange)) {
+            renderer = idleRenderer;
+            [self.renderers removeObjectAtIndex:i];
+            break;
+        }
+    }
+    if (renderer) {
+        _hitCount++;
+    } else {
+        _missCount++;
+    }
+    SD_UNLOCK(_lock);
+    
+    if (!renderer) {
+        // Copy the key attributes, the input format is mutable
+        SDGraphicsImageRendererFormat *pooledFormat = [[SDGraphicsImageRendererFormat alloc] init];
+        pooledFormat.scale = scale;
+        pooledFormat.opaque = opaque;
+        pooledFormat.preferredRange = preferredRange;
+        renderer = [[SDGraphicsImageRenderer alloc] initWithSize:size format:pooledFormat];
+        renderer.reusesContext = YES;
+    }
+    
+    UIImage *image = [renderer imageWithActions:actions];
+    
+    // Check in the renderer
+    SD_LOCK(_lock);
+    NSUInteger countLimit = self.countLimit;
+    if (countLimit > 0) {
+        [self.renderers addObject:renderer];
+        if (self.renderers.count > countLimit) {
+            [self.renderers removeObjectsInRange:NSMakeRange(0, self.renderers.count - countLimit)];
+        }
+    }
+    SD_UNLOCK(_lock);
+    
+    return image;
+}
+
+- (void)removeAllRenderers {
+    SD_LOCK(_lock);
+    [self.renderers removeAllObjects];
+    SD_UNLOCK(_lock);
+}
+
+- (void)resetStatistics {
+    SD_LOCK(_lock);
+    _hitCount = 0;
+    _missCount = 0;
+    SD_UNLOCK(_lock);
+}
+
 @end
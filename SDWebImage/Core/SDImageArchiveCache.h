@@ -0,0 +1,85 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDWebImageCompat.h"
+#import "SDImageCacheDefine.h"
+#import "SDImageCacheConfig.h"
+#import "SDMemoryCache.h"
+
+/**
+ A read-only image cache which serves the image data from an archive shipped with the app, such as the built-in remote images for onboarding, default avatars and feature banners. So these images are available on first launch without downloading.
+ The archive is a hash index followed by the data, it's memory-mapped and the lookup only reads one index slot (in common) and the entry itself, the returned data is not copied from the mapping.
+ Use `Scripts/build-image-archive.py` to build the archive from a manifest of URLs and local files. Then put this cache below the regular `SDImageCache` in the `SDImageCachesManager` chain:
+ @code
+ // The later cache has the higher priority
+ SDImageCachesManager.sharedManager.caches = @[archiveCache, SDImageCache.sharedImageCache];
+ SDWebImageManager.defaultImageCache = SDImageCachesManager.sharedManager;
+ @endcode
+
+ @note The query result is `SDImageCacheTypeDisk`. The store, remove and disk clear operations have no effect on the archive. The decoded images are kept in a memory cache, which is created from `config.memoryCacheClass`.
+ @note The cache key of entry is the URL string in manifest, which matches the default cache key of `SDWebImageManager`. If you use the `cacheKeyFilter`, the manifest should use the filtered key.
+ */
+@interface SDImageArchiveCache : NSObject <SDImageCache>
+
+/**
+ Cache Config object - storing all kind of settings.
+ */
+@property (nonatomic, copy, readonly, nonnull) SDImageCacheConfig *config;
+
+/**
+ The memory cache for the images decoded from archive.
+ */
+@property (nonatomic, strong, readonly, nonnull) id<SDMemoryCache> memoryCache;
+
+/**
+ The archive file path.
+ */
+@property (nonatomic, copy, readonly, nonnull) NSString *archivePath;
+
+/**
+ The number of entries in archive.
+ */
+@property (nonatomic, assign, readonly) NSUInteger entryCount;
+
+- (nonnull instancetype)init NS_UNAVAILABLE;
++ (nonnull instancetype)new  NS_UNAVAILABLE;
+
+/**
+ Open the archive at the path, with the default cache config.
+
+ @param archivePath The archive file path, typically in main bundle.
+ @return The archive cache, or nil if the archive is not a valid one.
+ */
+- (nullable instancetype)initWithArchivePath:(nonnull NSString *)archivePath;
+
+/**
+ Open the archive at the path.
+
+ @param archivePath The archive file path, typically in main bundle.
+ @param config The cache config, only the memory cache related settings are used. Pass nil to use the default cache config.
+ @return The archive cache, or nil if the archive is not a valid one.
+ */
+- (nullable instancetype)initWithArchivePath:(nonnull NSString *)archivePath config:(nullable SDImageCacheConfig *)config NS_DESIGNATED_INITIALIZER;
+
+/**
+ Returns whether the archive contains the data for the key.
+
+ @param key The image cache key.
+ @return Whether the archive contains the data.
+ */
+- (BOOL)containsDataForKey:(nonnull NSString *)key;
+
+/**
+ Returns the image data for the key. The data is backed by the mapped archive without copy.
+
+ @param key The image cache key.
+ @return The image data, or nil if the archive does not contain the key.
+ */
+- (nullable NSData *)dataForKey:(nonnull NSString *)key;
+
+@end
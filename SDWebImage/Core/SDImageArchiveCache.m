@@ -0,0 +1,302 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDImageArchiveCache.h"
+#import "SDCallbackQueue.h"
+#import "UIImage+Metadata.h"
+#import "UIImage+MemoryCacheCost.h"
+#import "SDInternalMacros.h"
+#import <libkern/OSByteOrder.h>
+
+// The archive layout, all the integers are little-endian. See `Scripts/build-image-archive.py`
+// Header (64 bytes): magic[8], version(u32), flags(u32), entryCount(u64), bucketCount(u64, power of 2), tableOffset(u64)
+// Slot (32 bytes): keyHash(u64, FNV-1a, 0 is empty), recordOffset(u64), keyLength(u32), reserved(u32), dataLength(u64)
+// Record: key bytes, followed by data bytes
+static const char SDImageArchiveMagic[8] = {'S', 'D', 'I', 'M', 'G', 'A', 'R', 'C'};
+static const uint32_t SDImageArchiveVersion = 1;
+static const size_t SDImageArchiveHeaderSize = 64;
+static const size_t SDImageArchiveSlotSize = 32;
+
+static inline uint64_t SDImageArchiveHashKey(const uint8_t *bytes, size_t length) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    // 0 marks the empty slot
+    return hash ?: 1;
+}
+
+@interface SDImageArchiveCacheToken : NSObject <SDWebImageOperation>
+
+@property (nonatomic, assign, getter=isCancelled) BOOL cancelled;
+
+@end
+
+@implementation SDImageArchiveCacheToken
+
+- (void)cancel {
+    @synchronized (self) {
+        self.cancelled = YES;
+    }
+}
+
+@end
+
+@interface SDImageArchiveCache ()
+
+@property (nonatomic, copy, readwrite, nonnull) SDImageCacheConfig *config;
+@property (nonatomic, strong, readwrite, nonnull) id<SDMemoryCache> memoryCache;
+@property (nonatomic, copy, readwrite, nonnull) NSString *archivePath;
+@property (nonatomic, assign, readwrite) NSUInteger entryCount;
+@property (nonatomic, strong, nonnull) NSData *archiveData;
+@property (nonatomic, assign) uint64_t bucketCount;
+@property (nonatomic, assign) uint64_t tableOffset;
+@property (nonatomic, strong, nonnull) dispatch_queue_t decodeQueue;
+
+@end
+
+@implementation SDImageArchiveCache
+
+- (instancetype)init {
+    NSAssert(NO, @"Use `initWithArchivePath:` with the archive path");
+    return nil;
+}
+
+- (instancetype)initWithArchivePath:(NSString *)archivePath {
+    return [self initWithArchivePath:archivePath config:nil];
+}
+
+- (instancetype)initWithArchivePath:(NSString *)archivePath config:(SDImageCacheConfig *)config {
+    NSParameterAssert(archivePath);
+    self = [super init];
+    if (self) {
+        // The archive is mapped, only the touched pages are read from disk
+        NSData *archiveData = [NSData dataWithContentsOfFile:archivePath options:NSDataReadingMappedAlways error:nil];
+        if (archiveData.length < SDImageArchiveHeaderSize) {
+            return nil;
+        }
+        const uint8_t *bytes = archiveData.bytes;
+        if (memcmp(bytes, SDImageArchiveMagic, sizeof(SDImageArchiveMagic)) != 0 || OSReadLittleInt32(bytes, 8) != SDImageArchiveVersion) {
+            return nil;
+        }
+        uint64_t entryCount = OSReadLittleInt64(bytes, 16);
+        uint64_t bucketCount = OSReadLittleInt64(bytes, 24);
+        uint64_t tableOffset = OSReadLittleInt64(bytes, 32);
+        if (bucketCount == 0 || (bucketCount & (bucketCount - 1)) != 0 || entryCount >= bucketCount
+            || tableOffset < SDImageArchiveHeaderSize || tableOffset > archiveData.length
+            || bucketCount > (archiveData.length - tableOffset) / SDImageArchiveSlotSize) {
+            return nil;
+        }
+        _archiveData = archiveData;
+        _archivePath = [archivePath copy];
+        _entryCount = (NSUInteger)entryCount;
+        _bucketCount = bucketCount;
+        _tableOffset = tableOffset;
+        if (!config) {
+            config = SDImageCacheConfig.defaultCacheConfig;
+        }
+        _config = [config copy];
+        NSAssert([config.memoryCacheClass conformsToProtocol:@protocol(SDMemoryCache)], @"Custom memory cache class must conform to `SDMemoryCache` protocol");
+        _memoryCache = [[config.memoryCacheClass alloc] initWithConfig:_config];
+        _decodeQueue = dispatch_queue_create("com.hackemist.SDImageArchiveCache.decodeQueue", DISPATCH_QUEUE_SERIAL);
+    }
+    return self;
+}
+
+#pragma mark - Archive
+
+- (BOOL)containsDataForKey:(NSString *)key {
+    NSParameterAssert(key);
+    return [self dataRangeForKey:key].location != NSNotFound;
+}
+
+- (NSData *)dataForKey:(NSString *)key {
+    NSParameterAssert(key);
+    NSRange dataRange = [self dataRangeForKey:key];
+    if (dataRange.location == NSNotFound) {
+        return nil;
+    }
+    // The deallocator keeps the mapping alive
+    NSData *archiveData = self.archiveData;
+    return [[NSData alloc] initWithBytesNoCopy:(void *)((const uint8_t *)archiveData.bytes + dataRange.location) length:dataRange.length deallocator:^(void * _Nonnull bytes, NSUInteger length) {
+        (void)archiveData;
+    }];
+}
+
+- (NSRange)dataRangeForKey:(nonnull NSString *)key {
+    NSData *keyData = [key dataUsingEncoding:NSUTF8StringEncoding];
+    const uint8_t *keyBytes = keyData.bytes;
+    size_t keyLength = keyData.length;
+    uint64_t keyHash = SDImageArchiveHashKey(keyBytes, keyLength);
+
+    const uint8_t *bytes = self.archiveData.bytes;
+    uint64_t archiveLength = self.archiveData.length;
+    uint64_t mask = self.bucketCount - 1;
+    uint64_t index = keyHash & mask;
+    // Linear probing, the builder keeps the load factor not larger than 0.5, so it's typically one slot
+    for (uint64_t probe = 0; probe < self.bucketCount; probe++) {
+        const uint8_t *slot = bytes + self.tableOffset + index * SDImageArchiveSlotSize;
+        uint64_t slotHash = OSReadLittleInt64(slot, 0);
+        uint64_t recordOffset = OSReadLittleInt64(slot, 8);
+        if (recordOffset == 0) {
+            break;
+        }
+        if (slotHash == keyHash) {
+            uint64_t slotKeyLength = OSReadLittleInt32(slot, 16);
+            uint64_t dataLength = OSReadLittleInt64(slot, 24);
+            // Never read outside the archive, even it's corrupted
+            if (recordOffset <= archiveLength && slotKeyLength <= archiveLength - recordOffset
+                && dataLength <= archiveLength - recordOffset - slotKeyLength
+                && slotKeyLength == keyLength && memcmp(bytes + recordOffset, keyBytes, keyLength) == 0) {
+                if (dataLength == 0) {
+                    break;
+                }
+                return NSMakeRange((NSUInteger)(recordOffset + slotKeyLength), (NSUInteger)dataLength);
+            }
+        }
+        index = (index + 1) & mask;
+    }
+    return NSMakeRange(NSNotFound, 0);
+}
+
+#pragma mark - Memory
+
+- (void)storeImageToMemory:(nullable UIImage *)image forKey:(nonnull NSString *)key {
+    if (!image || !self.config.shouldCacheImagesInMemory) {
+        return;
+    }
+    // The thumbnail and region decoded image does not match the key
+    if (image.sd_isThumbnail || image.sd_isRegionDecoded) {
+        return;
+    }
+    [self.memoryCache setObject:image forKey:key cost:image.sd_memoryCost];
+}
+
+#pragma mark - SDImageCache
+
+- (id<SDWebImageOperation>)queryImageForKey:(NSString *)key options:(SDWebImageOptions)options context:(SDWebImageContext *)context completion:(SDImageCacheQueryCompletionBlock)completionBlock {
+    return [self queryImageForKey:key options:options context:context cacheType:SDImageCacheTypeAll completion:completionBlock];
+}
+
+- (id<SDWebImageOperation>)queryImageForKey:(NSString *)key options:(SDWebImageOptions)options context:(SDWebImageContext *)context cacheType:(SDImageCacheType)cacheType completion:(SDImageCacheQueryCompletionBlock)completionBlock {
+    if (!key || cacheType == SDImageCacheTypeNone) {
+        if (completionBlock) {
+            completionBlock(nil, nil, SDImageCacheTypeNone);
+        }
+        return nil;
+    }
+    UIImage *image;
+    if (cacheType != SDImageCacheTypeDisk) {
+        image = [self.memoryCache objectForKey:key];
+    }
+    if (image || cacheType == SDImageCacheTypeMemory) {
+        NSData *data;
+        if (image && SD_OPTIONS_CONTAINS(options, SDWebImageQueryMemoryData)) {
+            // Mapped data is cheap
+            data = [self dataForKey:key];
+        }
+        if (completionBlock) {
+            completionBlock(image, data, SDImageCacheTypeMemory);
+        }
+        return nil;
+    }
+
+    SDImageArchiveCacheToken *operation = [SDImageArchiveCacheToken new];
+    void(^queryBlock)(void) = ^{
+        @synchronized (operation) {
+            if (operation.isCancelled) {
+                return;
+            }
+        }
+        NSData *data = [self dataForKey:key];
+        UIImage *diskImage;
+        if (data) {
+            diskImage = SDImageCacheDecodeImageData(data, key, options, context);
+            BOOL shouldCacheToMemory = YES;
+            if (context[SDWebImageContextStoreCacheType]) {
+                SDImageCacheType storeCacheType = [context[SDWebImageContextStoreCacheType] integerValue];
+                shouldCacheToMemory = (storeCacheType == SDImageCacheTypeAll || storeCacheType == SDImageCacheTypeMemory);
+            }
+            if (shouldCacheToMemory) {
+                [self storeImageToMemory:diskImage forKey:key];
+            }
+        }
+        if (SD_OPTIONS_CONTAINS(options, SDWebImageQueryDiskDataSync)) {
+            if (completionBlock) {
+                completionBlock(diskImage, data, SDImageCacheTypeDisk);
+            }
+            return;
+        }
+        SDCallbackQueue *queue = context[SDWebImageContextCallbackQueue];
+        [(queue ?: SDCallbackQueue.mainQueue) async:^{
+            @synchronized (operation) {
+                if (operation.isCancelled) {
+                    return;
+                }
+            }
+            if (completionBlock) {
+                completionBlock(diskImage, data, SDImageCacheTypeDisk);
+            }
+        }];
+    };
+    if (SD_OPTIONS_CONTAINS(options, SDWebImageQueryDiskDataSync)) {
+        queryBlock();
+    } else {
+        dispatch_async(self.decodeQueue, queryBlock);
+    }
+    return operation;
+}
+
+- (void)storeImage:(UIImage *)image imageData:(NSData *)imageData forKey:(NSString *)key cacheType:(SDImageCacheType)cacheType completion:(SDWebImageNoParamsBlock)completionBlock {
+    [self storeImage:image imageData:imageData forKey:key options:0 context:nil cacheType:cacheType completion:completionBlock];
+}
+
+- (void)storeImage:(UIImage *)image imageData:(NSData *)imageData forKey:(NSString *)key options:(SDWebImageOptions)options context:(SDWebImageContext *)context cacheType:(SDImageCacheType)cacheType completion:(SDWebImageNoParamsBlock)completionBlock {
+    // The archive is read-only, only the memory cache can be written
+    if (key && (cacheType == SDImageCacheTypeMemory || cacheType == SDImageCacheTypeAll)) {
+        [self storeImageToMemory:image forKey:key];
+    }
+    if (completionBlock) {
+        completionBlock();
+    }
+}
+
+- (void)removeImageForKey:(NSString *)key cacheType:(SDImageCacheType)cacheType completion:(SDWebImageNoParamsBlock)completionBlock {
+    if (key && (cacheType == SDImageCacheTypeMemory || cacheType == SDImageCacheTypeAll)) {
+        [self.memoryCache removeObjectForKey:key];
+    }
+    if (completionBlock) {
+        completionBlock();
+    }
+}
+
+- (void)containsImageForKey:(NSString *)key cacheType:(SDImageCacheType)cacheType completion:(SDImageCacheContainsCompletionBlock)completionBlock {
+    SDImageCacheType containsCacheType = SDImageCacheTypeNone;
+    if (key) {
+        if ((cacheType == SDImageCacheTypeMemory || cacheType == SDImageCacheTypeAll) && [self.memoryCache objectForKey:key]) {
+            containsCacheType = SDImageCacheTypeMemory;
+        } else if ((cacheType == SDImageCacheTypeDisk || cacheType == SDImageCacheTypeAll) && [self containsDataForKey:key]) {
+            containsCacheType = SDImageCacheTypeDisk;
+        }
+    }
+    if (completionBlock) {
+        completionBlock(containsCacheType);
+    }
+}
+
+- (void)clearWithCacheType:(SDImageCacheType)cacheType completion:(SDWebImageNoParamsBlock)completionBlock {
+    if (cacheType == SDImageCacheTypeMemory || cacheType == SDImageCacheTypeAll) {
+        [self.memoryCache removeAllObjects];
+    }
+    if (completionBlock) {
+        completionBlock();
+    }
+}
+
+@end
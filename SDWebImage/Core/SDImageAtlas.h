@@ -0,0 +1,74 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDWebImageCompat.h"
+
+/**
+ An atlas which packs many small decoded images (like icons and emoji) into the shared large bitmaps (pages), instead of allocating a separate bitmap for each of them.
+ The image returned from the atlas is a view of the sub-rectangle of page, its CGImage references the page bitmap directly without copy. The sub-rectangle is freed when the returned image (and its CGImage) is released, and the freed space is reused by the later images.
+ The pages are packed by shelves (rows with rounded height). The empty shelves are merged and reused for other heights, the empty pages are released, and the new images prefer the fullest page, so the sparse pages drain as their images are evicted.
+ To use this, pass the atlas with `SDWebImageContextImageAtlas` context option.
+
+ @note Only the static, 8-bit, sRGB compatible images not larger than `maxImagePixelSize` are packed. The pixels are stored as premultiplied BGRA8888.
+ @note The page bitmap is immutable for the living images, the atlas never move the pixels of a living image. So a single long-living image can keep a whole page alive.
+ */
+@interface SDImageAtlas : NSObject
+
+/**
+ The shared atlas, with the default page size (512x512 pixels) and max image size (64x64 pixels).
+ */
+@property (nonatomic, class, readonly, nonnull) SDImageAtlas *sharedAtlas;
+
+/**
+ The pixel size of each page.
+ */
+@property (nonatomic, assign, readonly) CGSize pagePixelSize;
+
+/**
+ The max pixel size of image to be packed. The larger image is not packed.
+ */
+@property (nonatomic, assign, readonly) CGSize maxImagePixelSize;
+
+/**
+ Create an atlas with the default page size (512x512 pixels) and max image size (64x64 pixels).
+ */
+- (nonnull instancetype)init;
+
+/**
+ Create an atlas with the custom page size and max image size.
+
+ @param pagePixelSize The pixel size of each page.
+ @param maxImagePixelSize The max pixel size of image to be packed, which should not be larger than page size.
+ @return The atlas.
+ */
+- (nonnull instancetype)initWithPagePixelSize:(CGSize)pagePixelSize maxImagePixelSize:(CGSize)maxImagePixelSize NS_DESIGNATED_INITIALIZER;
+
+/**
+ Draw the image into a free sub-rectangle of atlas, and return a new image which is the view of that sub-rectangle. The drawing also decodes the image, so the returned image does not need force-decode.
+
+ @param image The image to be packed.
+ @return The packed image, or nil if the image can not be packed (too large, animated, vector, HDR, wide color, etc).
+ */
+- (nullable UIImage *)packedImageWithImage:(nonnull UIImage *)image;
+
+/**
+ Returns the number of pages.
+ */
+- (NSUInteger)pageCount;
+
+/**
+ Returns the number of living packed images.
+ */
+- (NSUInteger)imageCount;
+
+/**
+ Returns the total bytes size of page bitmaps.
+ */
+- (NSUInteger)totalCost;
+
+@end
@@ -0,0 +1,454 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDImageAtlas.h"
+#import "SDImageCoderHelper.h"
+#import "SDAnimatedImage.h"
+#import "NSImage+Compatibility.h"
+#import "UIImage+Metadata.h"
+#import "UIImage+ForceDecode.h"
+#import "UIImage+MemoryCacheCost.h"
+#import "SDInternalMacros.h"
+
+// The width and height are rounded, so the similar sizes share shelves and the rows keep the preferred byte alignment (8 pixels)
+static const size_t SDImageAtlasGridSize = 8;
+static const CGFloat SDImageAtlasDefaultPageSize = 512;
+static const CGFloat SDImageAtlasDefaultMaxImageSize = 64;
+
+static void SDImageAtlasReleaseSlot(void *info, const void *data, size_t size) {
+    if (info) {
+        CFRelease(info);
+    }
+}
+
+static BOOL SDImageAtlasCanPackImage(UIImage * _Nonnull image, size_t maxWidth, size_t maxHeight) {
+    if (image.sd_isAnimated || image.sd_isVector) {
+        return NO;
+    }
+    if ([image conformsToProtocol:@protocol(SDAnimatedImage)]) {
+        return NO;
+    }
+    CGImageRef cgImage = image.CGImage;
+    if (!cgImage) {
+        return NO;
+    }
+    size_t width = CGImageGetWidth(cgImage);
+    size_t height = CGImageGetHeight(cgImage);
+    if (width == 0 || height == 0 || width > maxWidth || height > maxHeight) {
+        return NO;
+    }
+    if (CGImageGetBitsPerComponent(cgImage) != 8 || image.sd_isHighDynamicRange) {
+        return NO;
+    }
+    CGColorSpaceRef colorSpace = CGImageGetColorSpace(cgImage);
+    if (!colorSpace) {
+        return NO;
+    }
+    CGColorSpaceModel model = CGColorSpaceGetModel(colorSpace);
+    if (colorSpace == [SDImageCoderHelper colorSpaceGetDeviceRGB] || model == kCGColorSpaceModelMonochrome) {
+        return YES;
+    }
+    if (model != kCGColorSpaceModelRGB) {
+        return NO;
+    }
+    if (@available(iOS 10.0, tvOS 10.0, macOS 10.6, watchOS 3.0, *)) {
+        // Drawing the wide color into the device RGB loses the color
+        NSString *colorSpaceName = (__bridge_transfer NSString *)CGColorSpaceCopyName(colorSpace);
+        return [colorSpaceName isEqualToString:(__bridge NSString *)kCGColorSpaceDeviceRGB]
+            || [colorSpaceName isEqualToString:(__bridge NSString *)kCGColorSpaceSRGB];
+    }
+    return YES;
+}
+
+/// A row of page. The non-empty shelf only accepts the image with the same rounded height, the empty shelf can be split for any smaller height.
+@interface SDImageAtlasShelf : NSObject
+
+@property (nonatomic, assign) size_t y;
+@property (nonatomic, assign) size_t height;
+// The end of the used columns, the columns after it are free
+@property (nonatomic, assign) size_t usedWidth;
+// The freed columns before `usedWidth`
+@property (nonatomic, strong, nonnull) NSMutableIndexSet *freeColumns;
+@property (nonatomic, assign) NSUInteger slotCount;
+
+@end
+
+@implementation SDImageAtlasShelf
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _freeColumns = [NSMutableIndexSet indexSet];
+    }
+    return self;
+}
+
+@end
+
+@class SDImageAtlasPage;
+
+/// The sub-rectangle of page used by one packed image. The CGImage data provider retains the slot, the space is freed when the slot is released.
+@interface SDImageAtlasSlot : NSObject
+
+@property (nonatomic, strong, nonnull) SDImageAtlasPage *page;
+@property (nonatomic, strong, nonnull) SDImageAtlasShelf *shelf;
+@property (nonatomic, assign) size_t x;
+@property (nonatomic, assign) size_t width;
+
+@end
+
+@interface SDImageAtlasPage : NSObject {
+    SD_LOCK_DECLARE(_lock); // Lock the shelves
+}
+
+@property (nonatomic, assign, readonly) size_t width;
+@property (nonatomic, assign, readonly) size_t height;
+@property (nonatomic, assign, readonly) size_t bytesPerRow;
+@property (nonatomic, assign, readonly, nonnull) uint8_t *bytes;
+@property (nonatomic, strong, nonnull) NSMutableArray<SDImageAtlasShelf *> *shelves;
+@property (nonatomic, assign) NSUInteger usedArea;
+@property (nonatomic, assign) NSUInteger slotCount;
+
+@end
+
+@implementation SDImageAtlasPage
+
+- (nullable instancetype)initWithWidth:(size_t)width height:(size_t)height {
+    self = [super init];
+    if (self) {
+        _width = width;
+        _height = height;
+        _bytesPerRow = SDByteAlign(width * 4, [SDImageCoderHelper preferredPixelFormat:YES].alignment);
+        _bytes = calloc(height, _bytesPerRow);
+        if (!_bytes) {
+            return nil;
+        }
+        _shelves = [NSMutableArray array];
+        SD_LOCK_INIT(_lock);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(_bytes);
+}
+
+- (NSUInteger)usedAreaSnapshot {
+    SD_LOCK(_lock);
+    NSUInteger usedArea = self.usedArea;
+    SD_UNLOCK(_lock);
+    return usedArea;
+}
+
+- (NSUInteger)slotCountSnapshot {
+    SD_LOCK(_lock);
+    NSUInteger slotCount = self.slotCount;
+    SD_UNLOCK(_lock);
+    return slotCount;
+}
+
+- (nullable SDImageAtlasSlot *)allocateSlotWithWidth:(size_t)width height:(size_t)height {
+    SD_LOCK(_lock);
+    SDImageAtlasShelf *targetShelf;
+    size_t x = 0;
+    // 1. The shelf with the same height, reuse the freed columns first, then append
+    for (SDImageAtlasShelf *shelf in self.shelves) {
+        if (shelf.slotCount == 0 || shelf.height != height) {
+            continue;
+        }
+        __block NSRange freeRange = NSMakeRange(NSNotFound, 0);
+        [shelf.freeColumns enumerateRangesUsingBlock:^(NSRange range, BOOL * _Nonnull stop) {
+            if (range.length >= width) {
+                freeRange = NSMakeRange(range.location, width);
+                *stop = YES;
+            }
+        }];
+        if (freeRange.location != NSNotFound) {
+            [shelf.freeColumns removeIndexesInRange:freeRange];
+            targetShelf = shelf;
+            x = freeRange.location;
+            break;
+        }
+        if (shelf.usedWidth + width <= self.width) {
+            targetShelf = shelf;
+            x = shelf.usedWidth;
+            shelf.usedWidth += width;
+            break;
+        }
+    }
+    // 2. The empty shelf, split the remaining height as a new empty shelf
+    if (!targetShelf) {
+        for (NSUInteger i = 0; i < self.shelves.count; i++) {
+            SDImageAtlasShelf *shelf = self.shelves[i];
+            if (shelf.slotCount > 0 || shelf.height < height) {
+                continue;
+            }
+            if (shelf.height > height) {
+                SDImageAtlasShelf *remainingShelf = [SDImageAtlasShelf new];
+                remainingShelf.y = shelf.y + height;
+                remainingShelf.height = shelf.height - height;
+                [self.shelves insertObject:remainingShelf atIndex:i + 1];
+                shelf.height = height;
+            }
+            targetShelf = shelf;
+            x = 0;
+            shelf.usedWidth = width;
+            break;
+        }
+    }
+    // 3. The new shelf at the bottom
+    if (!targetShelf) {
+        SDImageAtlasShelf *lastShelf = self.shelves.lastObject;
+        size_t bottom = lastShelf ? lastShelf.y + lastShelf.height : 0;
+        if (bottom + height <= self.height) {
+            targetShelf = [SDImageAtlasShelf new];
+            targetShelf.y = bottom;
+            targetShelf.height = height;
+            targetShelf.usedWidth = width;
+            [self.shelves addObject:targetShelf];
+            x = 0;
+        }
+    }
+    SDImageAtlasSlot *slot;
+    if (targetShelf) {
+        targetShelf.slotCount++;
+        self.slotCount++;
+        self.usedArea += width * height;
+        slot = [SDImageAtlasSlot new];
+        slot.page = self;
+        slot.shelf = targetShelf;
+        slot.x = x;
+        slot.width = width;
+    }
+    SD_UNLOCK(_lock);
+    return slot;
+}
+
+- (void)freeSlot:(nonnull SDImageAtlasSlot *)slot {
+    SD_LOCK(_lock);
+    SDImageAtlasShelf *shelf = slot.shelf;
+    shelf.slotCount--;
+    self.slotCount--;
+    self.usedArea -= slot.width * shelf.height;
+    if (shelf.slotCount > 0) {
+        [shelf.freeColumns addIndexesInRange:NSMakeRange(slot.x, slot.width)];
+        // Give the free tail back to the append cursor
+        NSUInteger lastFreeIndex = shelf.freeColumns.lastIndex;
+        while (lastFreeIndex != NSNotFound && lastFreeIndex + 1 == shelf.usedWidth) {
+            __block NSRange lastRange = NSMakeRange(NSNotFound, 0);
+            [shelf.freeColumns enumerateRangesWithOptions:NSEnumerationReverse usingBlock:^(NSRange range, BOOL * _Nonnull stop) {
+                lastRange = range;
+                *stop = YES;
+            }];
+            [shelf.freeColumns removeIndexesInRange:lastRange];
+            shelf.usedWidth = lastRange.location;
+            lastFreeIndex = shelf.freeColumns.lastIndex;
+        }
+    } else {
+        [shelf.freeColumns removeAllIndexes];
+        shelf.usedWidth = 0;
+        [self compactShelves];
+    }
+    SD_UNLOCK(_lock);
+}
+
+// Make sure to call under lock
+- (void)compactShelves {
+    // Merge the adjacent empty shelves, so they can be split again for any height
+    NSUInteger i = 0;
+    while (i + 1 < self.shelves.count) {
+        SDImageAtlasShelf *shelf = self.shelves[i];
+        SDImageAtlasShelf *nextShelf = self.shelves[i + 1];
+        if (shelf.slotCount == 0 && nextShelf.slotCount == 0) {
+            shelf.height += nextShelf.height;
+            [self.shelves removeObjectAtIndex:i + 1];
+        } else {
+            i++;
+        }
+    }
+    // The empty shelf at the bottom is the same as the unused space
+    if (self.shelves.lastObject.slotCount == 0) {
+        [self.shelves removeLastObject];
+    }
+}
+
+@end
+
+@implementation SDImageAtlasSlot
+
+- (void)dealloc {
+    [_page freeSlot:self];
+}
+
+@end
+
+@interface SDImageAtlas () {
+    SD_LOCK_DECLARE(_lock); // Lock the pages
+}
+
+@property (nonatomic, strong, nonnull) NSMutableArray<SDImageAtlasPage *> *pages;
+
+@end
+
+@implementation SDImageAtlas
+
++ (SDImageAtlas *)sharedAtlas {
+    static dispatch_once_t onceToken;
+    static SDImageAtlas *atlas;
+    dispatch_once(&onceToken, ^{
+        atlas = [SDImageAtlas new];
+    });
+    return atlas;
+}
+
+- (instancetype)init {
+    return [self initWithPagePixelSize:CGSizeMake(SDImageAtlasDefaultPageSize, SDImageAtlasDefaultPageSize) maxImagePixelSize:CGSizeMake(SDImageAtlasDefaultMaxImageSize, SDImageAtlasDefaultMaxImageSize)];
+}
+
+- (instancetype)initWithPagePixelSize:(CGSize)pagePixelSize maxImagePixelSize:(CGSize)maxImagePixelSize {
+    self = [super init];
+    if (self) {
+        _pagePixelSize = pagePixelSize;
+        _maxImagePixelSize = CGSizeMake(MIN(maxImagePixelSize.width, pagePixelSize.width), MIN(maxImagePixelSize.height, pagePixelSize.height));
+        _pages = [NSMutableArray array];
+        SD_LOCK_INIT(_lock);
+    }
+    return self;
+}
+
+- (UIImage *)packedImageWithImage:(UIImage *)image {
+    NSParameterAssert(image);
+    if (!SDImageAtlasCanPackImage(image, (size_t)self.maxImagePixelSize.width, (size_t)self.maxImagePixelSize.height)) {
+        return nil;
+    }
+    CGImageRef cgImage = image.CGImage;
+    size_t width = CGImageGetWidth(cgImage);
+    size_t height = CGImageGetHeight(cgImage);
+    size_t slotWidth = MIN(SDByteAlign(width, SDImageAtlasGridSize), (size_t)self.pagePixelSize.width);
+    size_t slotHeight = MIN(SDByteAlign(height, SDImageAtlasGridSize), (size_t)self.pagePixelSize.height);
+
+    SDImageAtlasSlot *slot = [self allocateSlotWithWidth:slotWidth height:slotHeight];
+    if (!slot) {
+        return nil;
+    }
+    SDImageAtlasPage *page = slot.page;
+    size_t y = slot.shelf.y;
+    uint8_t *origin = page.bytes + y * page.bytesPerRow + slot.x * 4;
+    BOOL hasAlpha = [SDImageCoderHelper CGImageContainsAlpha:cgImage];
+    CGBitmapInfo bitmapInfo = kCGBitmapByteOrder32Little | kCGImageAlphaPremultipliedFirst;
+
+    // The context is only a window of page, the slot is owned by us so no one else touch these pixels
+    CGContextRef context = CGBitmapContextCreate(origin, width, height, 8, page.bytesPerRow, [SDImageCoderHelper colorSpaceGetDeviceRGB], bitmapInfo);
+    if (!context) {
+        return nil;
+    }
+    // The freed space may contain the pixels of previous image
+    CGContextClearRect(context, CGRectMake(0, 0, width, height));
+    CGContextDrawImage(context, CGRectMake(0, 0, width, height), cgImage);
+    CGContextRelease(context);
+
+    // The opaque image reads the same pixels, just ignore the alpha
+    if (!hasAlpha) {
+        bitmapInfo = kCGBitmapByteOrder32Little | kCGImageAlphaNoneSkipFirst;
+    }
+    size_t length = (height - 1) * page.bytesPerRow + width * 4;
+    CGDataProviderRef provider = CGDataProviderCreateWithData((__bridge_retained void *)slot, origin, length, SDImageAtlasReleaseSlot);
+    if (!provider) {
+        return nil;
+    }
+    CGImageRef packedCGImage = CGImageCreate(width, height, 8, 32, page.bytesPerRow, [SDImageCoderHelper colorSpaceGetDeviceRGB], bitmapInfo, provider, NULL, false, kCGRenderingIntentDefault);
+    CGDataProviderRelease(provider);
+    if (!packedCGImage) {
+        return nil;
+    }
+#if SD_MAC
+    UIImage *packedImage = [[UIImage alloc] initWithCGImage:packedCGImage scale:image.scale orientation:kCGImagePropertyOrientationUp];
+#else
+    UIImage *packedImage = [[UIImage alloc] initWithCGImage:packedCGImage scale:image.scale orientation:image.imageOrientation];
+#endif
+    CGImageRelease(packedCGImage);
+    packedImage.sd_isDecoded = YES;
+    packedImage.sd_imageFormat = image.sd_imageFormat;
+    // The CGImage's bytesPerRow is the page's, only count the slot
+    packedImage.sd_memoryCost = slotWidth * slotHeight * 4;
+
+    return packedImage;
+}
+
+- (nullable SDImageAtlasSlot *)allocateSlotWithWidth:(size_t)width height:(size_t)height {
+    SD_LOCK(_lock);
+    // Release the empty pages but keep one, avoid the allocation churn
+    NSMutableArray<SDImageAtlasPage *> *emptyPages = [NSMutableArray array];
+    for (SDImageAtlasPage *page in self.pages) {
+        if (page.slotCountSnapshot == 0) {
+            [emptyPages addObject:page];
+        }
+    }
+    if (emptyPages.count > 0) {
+        [emptyPages removeLastObject];
+        [self.pages removeObjectsInArray:emptyPages];
+    }
+    // Prefer the fullest page, so the sparse pages drain and can be released
+    NSArray<SDImageAtlasPage *> *sortedPages = [self.pages sortedArrayUsingComparator:^NSComparisonResult(SDImageAtlasPage * _Nonnull page1, SDImageAtlasPage * _Nonnull page2) {
+        NSUInteger usedArea1 = page1.usedAreaSnapshot;
+        NSUInteger usedArea2 = page2.usedAreaSnapshot;
+        if (usedArea1 > usedArea2) {
+            return NSOrderedAscending;
+        } else if (usedArea1 < usedArea2) {
+            return NSOrderedDescending;
+        }
+        return NSOrderedSame;
+    }];
+    SDImageAtlasSlot *slot;
+    for (SDImageAtlasPage *page in sortedPages) {
+        slot = [page allocateSlotWithWidth:width height:height];
+        if (slot) {
+            break;
+        }
+    }
+    if (!slot) {
+        SDImageAtlasPage *page = [[SDImageAtlasPage alloc] initWithWidth:(size_t)self.pagePixelSize.width height:(size_t)self.pagePixelSize.height];
+        if (page) {
+            [self.pages addObject:page];
+            slot = [page allocateSlotWithWidth:width height:height];
+        }
+    }
+    SD_UNLOCK(_lock);
+    return slot;
+}
+
+#pragma mark - Atlas Info
+
+- (NSUInteger)pageCount {
+    SD_LOCK(_lock);
+    NSUInteger count = self.pages.count;
+    SD_UNLOCK(_lock);
+    return count;
+}
+
+- (NSUInteger)imageCount {
+    SD_LOCK(_lock);
+    NSUInteger count = 0;
+    for (SDImageAtlasPage *page in self.pages) {
+        count += page.slotCountSnapshot;
+    }
+    SD_UNLOCK(_lock);
+    return count;
+}
+
+- (NSUInteger)totalCost {
+    SD_LOCK(_lock);
+    NSUInteger cost = 0;
+    for (SDImageAtlasPage *page in self.pages) {
+        cost += page.bytesPerRow * page.height;
+    }
+    SD_UNLOCK(_lock);
+    return cost;
+}
+
+@end
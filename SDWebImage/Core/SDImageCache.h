@@ -13,6 +13,8 @@
 #import "SDImageCacheDefine.h"
 #import "SDMemoryCache.h"
 #import "SDDiskCache.h"
+#import "SDDecodedImageDiskCache.h"
+#import "SDImageCacheDiskBudget.h"
 
 /// Image Cache Options
 typedef NS_OPTIONS(NSUInteger, SDImageCacheOptions) {
@@ -103,6 +105,19 @@ typedef NS_OPTIONS(NSUInteger, SDImageCacheOptions) {
  */
 @property (nonatomic, strong, readonly, nonnull) id<SDDiskCache> diskCache;
 
+/**
+ * The decoded bitmap disk cache used for current image cache. The image decoded from disk is stored as display-ready bitmap, and the next disk query returns it without reading and decoding the data.
+ * This is nil unless `SDImageCacheConfig.maxDecodedDiskSize` is greater than 0.
+ * @note The image returned from this cache has nil image data in the query completion (same as the memory cache hit). This cache is skipped when `SDImageCacheQueryMemoryData` is specified, which means you need the data.
+ */
+@property (nonatomic, strong, readonly, nullable) SDDecodedImageDiskCache *decodedDiskCache;
+
+/**
+ * The disk budget shared with other caches, which is set when you add this cache to the budget by `-[SDImageCacheDiskBudget addCache:weight:]`.
+ * Defaults to nil.
+ */
+@property (nonatomic, weak, readonly, nullable) SDImageCacheDiskBudget *diskBudget;
+
 /**
  *  The disk cache's root path
  */
@@ -450,6 +465,14 @@ typedef NS_OPTIONS(NSUInteger, SDImageCacheOptions) {
  */
 - (void)deleteOldFilesWithCompletionBlock:(nullable SDWebImageNoParamsBlock)completionBlock;
 
+/**
+ * Asynchronously remove the cached images from disk until the disk size is below the specified size, the same order as the size-based cleanup of expiration. Non-blocking method - returns immediately.
+ * @note The decoded bitmaps of `decodedDiskCache` are counted in the size and removed first. The data requires the disk cache to implement `removeDataToFitSize:`, else only the decoded bitmaps are removed.
+ * @param size The desired disk size in bytes
+ * @param completionBlock A block that should be executed after removal completes (optional)
+ */
+- (void)removeDiskDataToFitSize:(NSUInteger)size completion:(nullable SDWebImageNoParamsBlock)completionBlock;
+
 #pragma mark - Cache Info
 
 /**
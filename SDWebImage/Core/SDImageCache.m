@@ -7,6 +7,10 @@
  */
 
 #import "SDImageCache.h"
+#import "SDImageCacheInternal.h"
+#import "SDImageCacheDiskBudgetInternal.h"
+#import "SDDiskCacheInternal.h"
+#import "SDContentAddressedDiskCache.h"
 #import "SDInternalMacros.h"
 #import "NSImage+Compatibility.h"
 #import "SDImageCodersManager.h"
@@ -17,6 +21,7 @@
 #import "UIImage+ExtendedCacheData.h"
 #import "SDCallbackQueue.h"
 #import "SDImageTransformer.h" // TODO, remove this
+#import <sys/stat.h>
 
 // TODO, remove this
 static BOOL SDIsThumbnailKey(NSString *key) {
@@ -71,6 +76,7 @@ static NSString * _defaultDiskCacheDirectory;
 #pragma mark - Properties
 @property (nonatomic, strong, readwrite, nonnull) id<SDMemoryCache> memoryCache;
 @property (nonatomic, strong, readwrite, nonnull) id<SDDiskCache> diskCache;
+@property (nonatomic, strong, readwrite, nullable) SDDecodedImageDiskCache *decodedDiskCache;
 @property (nonatomic, copy, readwrite, nonnull) SDImageCacheConfig *config;
 @property (nonatomic, copy, readwrite, nonnull) NSString *diskCachePath;
 @property (nonatomic, strong, nonnull) dispatch_queue_t ioQueue;
@@ -78,7 +84,11 @@ static NSString * _defaultDiskCacheDirectory;
 @end
 
 
-@implementation SDImageCache
+@implementation SDImageCache {
+    SD_LOCK_DECLARE(_decodedDiskUsageLock);
+    // The decoded tier size last reported to the disk budget
+    NSUInteger _decodedDiskUsage;
+}
 
 #pragma mark - Singleton, init, dealloc
 
@@ -124,6 +134,7 @@ static NSString * _defaultDiskCacheDirectory;
         if (!config) {
             config = SDImageCacheConfig.defaultCacheConfig;
         }
+        SD_LOCK_INIT(_decodedDiskUsageLock);
         _config = [config copy];
         
         // Create IO queue
@@ -145,6 +156,11 @@ static NSString * _defaultDiskCacheDirectory;
         NSAssert([config.diskCacheClass conformsToProtocol:@protocol(SDDiskCache)], @"Custom disk cache class must conform to `SDDiskCache` protocol");
         _diskCache = [[config.diskCacheClass alloc] initWithCachePath:_diskCachePath config:_config];
         
+        // Init the decoded bitmap disk cache, which is a sibling directory of disk cache
+        if (_config.maxDecodedDiskSize > 0) {
+            _decodedDiskCache = [[SDDecodedImageDiskCache alloc] initWithCachePath:[_diskCachePath stringByAppendingString:@".decoded"] config:_config];
+        }
+        
         // Check and migrate disk cache directory if need
         [self migrateDiskCacheDirectory];
 
@@ -279,9 +295,29 @@ static NSString * _defaultDiskCacheDirectory;
                     format = [SDImageCoderHelper CGImageContainsAlpha:image.CGImage] ? SDImageFormatPNG : SDImageFormatJPEG;
                 }
             }
-            NSData *encodedData = [[SDImageCodersManager sharedManager] encodedDataWithImage:image format:format options:context[SDWebImageContextImageEncodeOptions]];
+            SDImageCoderOptions *encodeOptions = context[SDWebImageContextImageEncodeOptions];
+            // Stream the encoder output into a temporary file, avoid holding the encoded data in memory
+            NSURL *temporaryURL;
+            if ([self.diskCache respondsToSelector:@selector(temporaryURLForKey:)] && [self.diskCache respondsToSelector:@selector(setDataWithTemporaryURL:forKey:)]) {
+                temporaryURL = [self.diskCache temporaryURLForKey:key];
+            }
+            if (temporaryURL && ![[SDImageCodersManager sharedManager] encodeImage:image format:format toURL:temporaryURL options:encodeOptions]) {
+                [[NSFileManager defaultManager] removeItemAtURL:temporaryURL error:nil];
+                temporaryURL = nil;
+            }
+            NSData *encodedData;
+            if (!temporaryURL) {
+                encodedData = [[SDImageCodersManager sharedManager] encodedDataWithImage:image format:format options:encodeOptions];
+            }
             dispatch_async(self.ioQueue, ^{
-                [self _storeImageDataToDisk:encodedData forKey:key];
+                if (temporaryURL) {
+                    [self _performDiskChangeForKey:key block:^{
+                        [self.diskCache setDataWithTemporaryURL:temporaryURL forKey:key];
+                    }];
+                } else {
+                    [self _storeImageDataToDisk:encodedData forKey:key];
+                }
+                [self _storeDiskMetadataWithContext:context forKey:key];
                 [self _archivedDataWithImage:image forKey:key];
                 if (completionBlock) {
                     [(queue ?: SDCallbackQueue.mainQueue) async:^{
@@ -293,6 +329,7 @@ static NSString * _defaultDiskCacheDirectory;
     } else {
         dispatch_async(self.ioQueue, ^{
             [self _storeImageDataToDisk:data forKey:key];
+            [self _storeDiskMetadataWithContext:context forKey:key];
             [self _archivedDataWithImage:image forKey:key];
             if (completionBlock) {
                 [(queue ?: SDCallbackQueue.mainQueue) async:^{
@@ -303,6 +340,18 @@ static NSString * _defaultDiskCacheDirectory;
     }
 }
 
+// Make sure to call from io queue by caller
+- (void)_storeDiskMetadataWithContext:(nullable SDWebImageContext *)context forKey:(nonnull NSString *)key {
+    NSNumber *fetchCost = context[SDWebImageContextImageFetchCost];
+    if (fetchCost && [self.diskCache respondsToSelector:@selector(setFetchCost:forKey:)]) {
+        [self.diskCache setFetchCost:fetchCost.doubleValue forKey:key];
+    }
+    NSDate *expirationDate = context[SDWebImageContextImageCacheExpirationDate];
+    if (expirationDate && self.config.shouldRespectHTTPCacheExpiration && [self.diskCache respondsToSelector:@selector(setExpirationDate:forKey:)]) {
+        [self.diskCache setExpirationDate:expirationDate forKey:key];
+    }
+}
+
 - (void)_archivedDataWithImage:(UIImage *)image forKey:(NSString *)key {
     if (!image || !key) {
         return;
@@ -359,7 +408,9 @@ static NSString * _defaultDiskCacheDirectory;
         return;
     }
     
-    [self.diskCache setData:imageData forKey:key];
+    [self _performDiskChangeForKey:key block:^{
+        [self.diskCache setData:imageData forKey:key];
+    }];
 }
 
 #pragma mark - Query and Retrieve Ops
@@ -432,8 +483,11 @@ static NSString * _defaultDiskCacheDirectory;
     if (!key) {
         return nil;
     }
-    NSData *data = [self diskImageDataForKey:key];
-    UIImage *diskImage = [self diskImageForKey:key data:data options:options context:context];
+    UIImage *diskImage = [self decodedDiskImageForKey:key options:options context:context];
+    if (!diskImage) {
+        NSData *data = [self diskImageDataForKey:key];
+        diskImage = [self diskImageForKey:key data:data options:options context:context];
+    }
     
     BOOL shouldCacheToMemory = YES;
     if (context[SDWebImageContextStoreCacheType]) {
@@ -492,6 +546,7 @@ static NSString * _defaultDiskCacheDirectory;
     
     NSData *data = [self.diskCache dataForKey:key];
     if (data) {
+        [self.diskBudget cacheDidHitDiskData:self];
         return data;
     }
     
@@ -520,9 +575,44 @@ static NSString * _defaultDiskCacheDirectory;
     }
     UIImage *image = SDImageCacheDecodeImageData(data, key, [[self class] imageOptionsFromCacheOptions:options], context);
     [self _unarchiveObjectWithImage:image forKey:key];
+    // Keep the display-ready bitmap, so the next query does not decode again
+    SDImageCoderOptions *decodeOptions = [self _decodedDiskCacheOptionsForKey:key options:options context:context];
+    if (image && decodeOptions) {
+        [self.decodedDiskCache storeImage:image forKey:key options:decodeOptions];
+        [self _updateDecodedDiskBudgetUsage];
+    }
+    return image;
+}
+
+- (nullable UIImage *)decodedDiskImageForKey:(nonnull NSString *)key options:(SDImageCacheOptions)options context:(nullable SDWebImageContext *)context {
+    SDImageCoderOptions *decodeOptions = [self _decodedDiskCacheOptionsForKey:key options:options context:context];
+    if (!decodeOptions) {
+        return nil;
+    }
+    // The bitmap is stale once the data is gone, either expired by HTTP caching headers or evicted by the disk cache itself
+    if (![self.diskCache containsDataForKey:key]) {
+        [self.decodedDiskCache removeImagesForKey:key];
+        return nil;
+    }
+    UIImage *image = [self.decodedDiskCache imageForKey:key options:decodeOptions];
+    [self _unarchiveObjectWithImage:image forKey:key];
     return image;
 }
 
+// The decoded bitmap disk cache can only replace the built-in static image decoding
+- (nullable SDImageCoderOptions *)_decodedDiskCacheOptionsForKey:(nonnull NSString *)key options:(SDImageCacheOptions)options context:(nullable SDWebImageContext *)context {
+    if (!self.decodedDiskCache) {
+        return nil;
+    }
+    if (context[SDWebImageContextImageCoder]) {
+        return nil;
+    }
+    if (context[SDWebImageContextAnimatedImageClass] && !(options & SDImageCacheDecodeFirstFrameOnly)) {
+        return nil;
+    }
+    return SDGetDecodeOptionsFromContext(context, [[self class] imageOptionsFromCacheOptions:options], key);
+}
+
 - (void)_syncDiskToMemoryWithImage:(UIImage *)diskImage forKey:(NSString *)key {
     // earily check
     if (!self.config.shouldCacheImagesInMemory) {
@@ -531,6 +621,10 @@ static NSString * _defaultDiskCacheDirectory;
     if (!diskImage) {
         return;
     }
+    // The region decoded image does not match the key, caller (like SDWebImageManager) will store it with transformed key
+    if (diskImage.sd_isRegionDecoded) {
+        return;
+    }
     // The disk -> memory sync logic, which should only store thumbnail image with thumbnail key
     // However, caller (like SDWebImageManager) will query full key, with thumbnail size, and get thubmnail image
     // We should add a check here, currently it's a hack
@@ -662,6 +756,30 @@ static NSString * _defaultDiskCacheDirectory;
     // 2. in-memory cache miss & diskDataSync
     BOOL shouldQueryDiskSync = ((image && options & SDImageCacheQueryMemoryDataSync) ||
                                 (!image && options & SDImageCacheQueryDiskDataSync));
+    // The decoded bitmap disk cache returns the display-ready image without reading the data, only query it when the data is not required
+    BOOL shouldQueryDecodedDisk = !image && !(options & SDImageCacheQueryMemoryData);
+    UIImage* (^queryDecodedDiskImageBlock)(void) = ^UIImage* {
+        @synchronized (operation) {
+            if (operation.isCancelled) {
+                return nil;
+            }
+        }
+        if (!shouldQueryDecodedDisk) {
+            return nil;
+        }
+        
+        UIImage *diskImage = [self decodedDiskImageForKey:key options:options context:context];
+        BOOL shouldCacheToMemory = YES;
+        if (context[SDWebImageContextStoreCacheType]) {
+            SDImageCacheType cacheType = [context[SDWebImageContextStoreCacheType] integerValue];
+            shouldCacheToMemory = (cacheType == SDImageCacheTypeAll || cacheType == SDImageCacheTypeMemory);
+        }
+        if (diskImage && shouldCacheToMemory) {
+            [self _syncDiskToMemoryWithImage:diskImage forKey:key];
+        }
+        return diskImage;
+    };
+    
     NSData* (^queryDiskDataBlock)(void) = ^NSData* {
         @synchronized (operation) {
             if (operation.isCancelled) {
@@ -715,16 +833,23 @@ static NSString * _defaultDiskCacheDirectory;
         __block NSData* diskData;
         __block UIImage* diskImage;
         dispatch_sync(self.ioQueue, ^{
-            diskData = queryDiskDataBlock();
-            diskImage = queryDiskImageBlock(diskData);
+            diskImage = queryDecodedDiskImageBlock();
+            if (!diskImage) {
+                diskData = queryDiskDataBlock();
+                diskImage = queryDiskImageBlock(diskData);
+            }
         });
         if (doneBlock) {
             doneBlock(diskImage, diskData, SDImageCacheTypeDisk);
         }
     } else {
         dispatch_async(self.ioQueue, ^{
-            NSData* diskData = queryDiskDataBlock();
-            UIImage* diskImage = queryDiskImageBlock(diskData);
+            NSData* diskData;
+            UIImage* diskImage = queryDecodedDiskImageBlock();
+            if (!diskImage) {
+                diskData = queryDiskDataBlock();
+                diskImage = queryDiskImageBlock(diskData);
+            }
             @synchronized (operation) {
                 if (operation.isCancelled) {
                     return;
@@ -769,7 +894,9 @@ static NSString * _defaultDiskCacheDirectory;
 
     if (fromDisk) {
         dispatch_async(self.ioQueue, ^{
-            [self.diskCache removeDataForKey:key];
+            [self _performDiskChangeForKey:key block:^{
+                [self.diskCache removeDataForKey:key];
+            }];
             
             if (completion) {
                 dispatch_async(dispatch_get_main_queue(), ^{
@@ -805,7 +932,9 @@ static NSString * _defaultDiskCacheDirectory;
         return;
     }
     
-    [self.diskCache removeDataForKey:key];
+    [self _performDiskChangeForKey:key block:^{
+        [self.diskCache removeDataForKey:key];
+    }];
 }
 
 #pragma mark - Cache clean Ops
@@ -817,6 +946,11 @@ static NSString * _defaultDiskCacheDirectory;
 - (void)clearDiskOnCompletion:(nullable SDWebImageNoParamsBlock)completion {
     dispatch_async(self.ioQueue, ^{
         [self.diskCache removeAllData];
+        [self.decodedDiskCache removeAllImages];
+        SD_LOCK(self->_decodedDiskUsageLock);
+        self->_decodedDiskUsage = 0;
+        SD_UNLOCK(self->_decodedDiskUsageLock);
+        [self.diskBudget cache:self didResetDiskUsage:0];
         if (completion) {
             dispatch_async(dispatch_get_main_queue(), ^{
                 completion();
@@ -828,6 +962,8 @@ static NSString * _defaultDiskCacheDirectory;
 - (void)deleteOldFilesWithCompletionBlock:(nullable SDWebImageNoParamsBlock)completionBlock {
     dispatch_async(self.ioQueue, ^{
         [self.diskCache removeExpiredData];
+        [self.decodedDiskCache removeExpiredImages];
+        [self _resetDiskBudgetUsage];
         if (completionBlock) {
             dispatch_async(dispatch_get_main_queue(), ^{
                 completionBlock();
@@ -836,6 +972,123 @@ static NSString * _defaultDiskCacheDirectory;
     });
 }
 
+- (void)removeDiskDataToFitSize:(NSUInteger)size completion:(nullable SDWebImageNoParamsBlock)completionBlock {
+    dispatch_async(self.ioQueue, ^{
+        // The bitmaps can be decoded again from the data, trim them first, then fit the data into the rest
+        NSUInteger decodedSize = 0;
+        if (self.decodedDiskCache) {
+            NSUInteger dataSize = [self _diskDataUsedSize];
+            [self.decodedDiskCache removeImagesToFitSize:size > dataSize ? size - dataSize : 0];
+            decodedSize = self.decodedDiskCache.totalSize;
+        }
+        if ([self.diskCache respondsToSelector:@selector(removeDataToFitSize:)]) {
+            [self.diskCache removeDataToFitSize:size > decodedSize ? size - decodedSize : 0];
+        }
+        [self _resetDiskBudgetUsage];
+        if (completionBlock) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completionBlock();
+            });
+        }
+    });
+}
+
+#pragma mark - Disk Budget
+
+- (void)setDiskBudget:(SDImageCacheDiskBudget *)diskBudget {
+    _diskBudget = diskBudget;
+    if (diskBudget) {
+        // Scan once, then the usage is counted by each change
+        dispatch_async(self.ioQueue, ^{
+            [self _resetDiskBudgetUsage];
+        });
+    }
+}
+
+// Make sure to call from io queue by caller
+- (void)_resetDiskBudgetUsage {
+    SDImageCacheDiskBudget *diskBudget = self.diskBudget;
+    if (!diskBudget) {
+        return;
+    }
+    SD_LOCK(_decodedDiskUsageLock);
+    _decodedDiskUsage = self.decodedDiskCache.totalSize;
+    NSUInteger decodedSize = _decodedDiskUsage;
+    SD_UNLOCK(_decodedDiskUsageLock);
+    [diskBudget cache:self didResetDiskUsage:[self _diskDataUsedSize] + decodedSize];
+}
+
+// Make sure to call from io queue by caller
+- (NSUInteger)_diskDataUsedSize {
+    if ([self.diskCache isKindOfClass:SDDiskCache.class]) {
+        return [(SDDiskCache *)self.diskCache totalAllocatedSize];
+    } else if ([self.diskCache isKindOfClass:SDContentAddressedDiskCache.class]) {
+        return [(SDContentAddressedDiskCache *)self.diskCache totalAllocatedSize];
+    } else {
+        return self.diskCache.totalSize;
+    }
+}
+
+// The decoded tier is stored from the query path as well, which may be off the io queue, so report the change since the last report rather than a measured delta
+- (void)_updateDecodedDiskBudgetUsage {
+    SDImageCacheDiskBudget *diskBudget = self.diskBudget;
+    if (!diskBudget || !self.decodedDiskCache) {
+        return;
+    }
+    SD_LOCK(_decodedDiskUsageLock);
+    NSUInteger oldSize = _decodedDiskUsage;
+    NSUInteger newSize = self.decodedDiskCache.totalSize;
+    _decodedDiskUsage = newSize;
+    SD_UNLOCK(_decodedDiskUsageLock);
+    if (newSize != oldSize) {
+        [diskBudget cache:self didChangeDiskUsageBy:(NSInteger)newSize - (NSInteger)oldSize];
+    }
+}
+
+// Make sure to call from io queue by caller
+- (void)_performDiskChangeForKey:(nonnull NSString *)key block:(nonnull dispatch_block_t)block {
+    SDImageCacheDiskBudget *diskBudget = self.diskBudget;
+    if (!diskBudget) {
+        block();
+        // The decoded bitmap of previous data is stale
+        [self.decodedDiskCache removeImagesForKey:key];
+        return;
+    }
+    // The data may be shared with other keys by deduplication, measure the whole cache instead of the key's file, else a duplicated store is counted again
+    if ([self.diskCache isKindOfClass:SDContentAddressedDiskCache.class]) {
+        SDContentAddressedDiskCache *diskCache = (SDContentAddressedDiskCache *)self.diskCache;
+        NSUInteger oldSize = diskCache.totalAllocatedSize;
+        block();
+        NSUInteger newSize = diskCache.totalAllocatedSize;
+        if (newSize != oldSize) {
+            [diskBudget cache:self didChangeDiskUsageBy:(NSInteger)newSize - (NSInteger)oldSize];
+        }
+    } else {
+        NSUInteger oldSize = [self _diskDataSizeForKey:key];
+        block();
+        NSUInteger newSize = [self _diskDataSizeForKey:key];
+        if (newSize != oldSize) {
+            [diskBudget cache:self didChangeDiskUsageBy:(NSInteger)newSize - (NSInteger)oldSize];
+        }
+    }
+    // The decoded bitmap of previous data is stale, the space is reclaimed with the whole chunk
+    [self.decodedDiskCache removeImagesForKey:key];
+    [self _updateDecodedDiskBudgetUsage];
+}
+
+- (NSUInteger)_diskDataSizeForKey:(nonnull NSString *)key {
+    NSString *path = [self.diskCache cachePathForKey:key];
+    if (!path) {
+        return 0;
+    }
+    struct stat fileStat;
+    if (stat(path.fileSystemRepresentation, &fileStat) != 0) {
+        return 0;
+    }
+    // The allocated size, same as the `removeDataToFitSize:` of disk cache use for eviction
+    return (NSUInteger)fileStat.st_blocks * 512;
+}
+
 #pragma mark - UIApplicationWillTerminateNotification
 
 #if SD_UIKIT || SD_MAC
@@ -847,6 +1100,7 @@ static NSString * _defaultDiskCacheDirectory;
     }
     dispatch_sync(self.ioQueue, ^{
         [self.diskCache removeExpiredData];
+        [self.decodedDiskCache removeExpiredImages];
     });
 }
 #endif
@@ -8,6 +8,7 @@
 
 #import <Foundation/Foundation.h>
 #import "SDWebImageCompat.h"
+#import "SDDiskCacheEvictionPolicy.h"
 
 /// Image Cache Expire Type
 typedef NS_ENUM(NSUInteger, SDImageCacheConfigExpireType) {
@@ -94,12 +95,28 @@ typedef NS_ENUM(NSUInteger, SDImageCacheConfigExpireType) {
  */
 @property (assign, nonatomic) NSTimeInterval maxDiskAge;
 
+/**
+ * Whether or not to use the per-entry expiration date from the HTTP caching headers (`Cache-Control: max-age`, `immutable` and `Expires`) instead of `maxDiskAge`. The immutable images are kept until the size-based cleanup, and the short-lived ones are removed when expired, the expired data is treated as not in disk cache, so it will be downloaded again.
+ * The images without these headers still use `maxDiskAge`.
+ * Defaults to NO.
+ * @note The expiration date is passed from the manager by `SDWebImageContextImageCacheExpirationDate`, you can provide it for custom loader as well.
+ */
+@property (assign, nonatomic) BOOL shouldRespectHTTPCacheExpiration;
+
 /**
  * The maximum size of the disk cache, in bytes.
  * Defaults to 0. Which means there is no cache size limit.
  */
 @property (assign, nonatomic) NSUInteger maxDiskSize;
 
+/**
+ * The maximum size of the decoded bitmap disk cache, in bytes. The decoded bitmap disk cache stores the display-ready bitmap of the image decoded from disk, so the next query can display it without decoding, see `SDDecodedImageDiskCache`.
+ * Defaults to 0. Which means the decoded bitmap disk cache is disabled.
+ * @note The bitmap is much larger than the encoded data, this is designed for fixed-size UI (like avatars and grid thumbnails) using thumbnail decoding, and has its own limit separate from `maxDiskSize`.
+ * @note This value does not support dynamic changes. Which means further modification on this value after cache initialized has no effect.
+ */
+@property (assign, nonatomic) NSUInteger maxDecodedDiskSize;
+
 /**
  * The maximum "total cost" of the in-memory image cache. The cost function is the bytes size held in memory.
  * @note The memory cost is bytes size in memory, but not simple pixels count. For common ARGB8888 image, one pixel is 4 bytes (32 bits).
@@ -119,6 +136,15 @@ typedef NS_ENUM(NSUInteger, SDImageCacheConfigExpireType) {
  */
 @property (assign, nonatomic) SDImageCacheConfigExpireType diskCacheExpireType;
 
+/**
+ * The policy to choose the disk data to remove when the disk cache exceeds `maxDiskSize`. For example, `SDDiskCacheGDSFEvictionPolicy` keeps the small images reused often and the slow-to-download ones, instead of only checking the date of `diskCacheExpireType`.
+ * Defaults to nil. Which means the oldest data by `diskCacheExpireType` is removed first.
+ * @note The built-in disk cache records the access count and fetch cost in the extended attribute of cache file when this is set, which also updates the change date (`SDImageCacheConfigExpireTypeChangeDate`).
+ * @note This value does not support dynamic changes. Which means further modification on this value after cache initialized has no effect.
+ * @note The policy is passed by reference during copying. The policy may keep state such as aging value, so it's not recommend to share one policy across caches, or set this value on `defaultCacheConfig`.
+ */
+@property (strong, nonatomic, nullable) id<SDDiskCacheEvictionPolicy> diskEvictionPolicy;
+
 /**
  * The custom file manager for disk cache. Pass nil to let disk cache choose the proper file manager.
  * Defaults to nil.
@@ -34,6 +34,8 @@ static const NSInteger kDefaultCacheMaxDiskAge = 60 * 60 * 24 * 7; // 1 week
         _diskCacheWritingOptions = NSDataWritingAtomic;
         _maxDiskAge = kDefaultCacheMaxDiskAge;
         _maxDiskSize = 0;
+        _shouldRespectHTTPCacheExpiration = NO;
+        _maxDecodedDiskSize = 0;
         _diskCacheExpireType = SDImageCacheConfigExpireTypeAccessDate;
         _fileManager = nil;
         if (@available(iOS 10.0, tvOS 10.0, macOS 10.12, watchOS 3.0, *)) {
@@ -58,9 +60,12 @@ static const NSInteger kDefaultCacheMaxDiskAge = 60 * 60 * 24 * 7; // 1 week
     config.diskCacheWritingOptions = self.diskCacheWritingOptions;
     config.maxDiskAge = self.maxDiskAge;
     config.maxDiskSize = self.maxDiskSize;
+    config.shouldRespectHTTPCacheExpiration = self.shouldRespectHTTPCacheExpiration;
+    config.maxDecodedDiskSize = self.maxDecodedDiskSize;
     config.maxMemoryCost = self.maxMemoryCost;
     config.maxMemoryCount = self.maxMemoryCount;
     config.diskCacheExpireType = self.diskCacheExpireType;
+    config.diskEvictionPolicy = self.diskEvictionPolicy; // The policy may keep state, just pass the reference
     config.fileManager = self.fileManager; // NSFileManager does not conform to NSCopying, just pass the reference
     config.ioQueueAttributes = self.ioQueueAttributes; // Pass the reference
     config.memoryCacheClass = self.memoryCacheClass;
@@ -9,6 +9,8 @@
 #import "SDImageCacheDefine.h"
 #import "SDImageCodersManager.h"
 #import "SDImageCoderHelper.h"
+#import "SDImageAtlas.h"
+#import "SDImageTransformer.h"
 #import "SDAnimatedImage.h"
 #import "UIImage+Metadata.h"
 #import "SDInternalMacros.h"
@@ -66,6 +68,18 @@ SDImageCoderOptions * _Nonnull SDGetDecodeOptionsFromContext(SDWebImageContext *
     mutableCoderOptions[SDImageCoderDecodeScaleDownLimitBytes] = scaleDownLimitBytesValue;
     mutableCoderOptions[SDImageCoderDecodeToHDR] = decodeToHDR;
     
+    // Push the transformer down into decoding, the thumbnail and scale down have higher priority
+    BOOL shouldPushDownTransformer = [context[SDWebImageContextImageTransformerPushDown] boolValue];
+    if (shouldPushDownTransformer && !thumbnailSizeValue && !scaleDownLimitBytesValue) {
+        id<SDImageTransformer> transformer = context[SDWebImageContextImageTransformer];
+        if ([transformer conformsToProtocol:@protocol(SDImageTransformer)]) {
+            SDImageCoderOptions *transformerDecodeOptions = SDImageTransformerDecodeOptions(transformer, scale, NULL);
+            if (transformerDecodeOptions) {
+                [mutableCoderOptions addEntriesFromDictionary:transformerDecodeOptions];
+            }
+        }
+    }
+    
     return [mutableCoderOptions copy];
 }
 
@@ -144,7 +158,13 @@ UIImage * _Nullable SDImageCacheDecodeImageData(NSData * _Nonnull imageData, NSS
             policy = SDImageForceDecodePolicyNever;
         }
 #pragma clang diagnostic pop
-        image = [SDImageCoderHelper decodedImageWithImage:image policy:policy];
+        // Drawing into the atlas is also force-decode, the small image does not need its own bitmap
+        SDImageAtlas *atlas = context[SDWebImageContextImageAtlas];
+        UIImage *packedImage;
+        if ([atlas isKindOfClass:SDImageAtlas.class] && policy != SDImageForceDecodePolicyNever) {
+            packedImage = [atlas packedImageWithImage:image];
+        }
+        image = packedImage ?: [SDImageCoderHelper decodedImageWithImage:image policy:policy];
         // assign the decode options, to let manager check whether to re-decode if needed
         image.sd_decodeOptions = coderOptions;
     }
@@ -0,0 +1,96 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDWebImageCompat.h"
+
+@class SDImageCache;
+
+/**
+ A disk budget shared by multiple image caches (namespaces), such as the feed, avatars and stickers caches. Instead of each cache enforcing its own `maxDiskSize`, the budget owns one total size, and the idle space of one cache can be used by others.
+ Each cache has a guaranteed size, which is the `guaranteedRatio` of total size split by weight, the cache under its guaranteed size is never asked to evict. When the total usage exceeds the budget, the cache with the lowest marginal hit value (recent disk hits per byte, multiplied by weight) among the caches over their guaranteed size evicts next.
+ The usage of each cache is counted when the data is stored or removed, so reading the usage does not scan the directories. It's only scanned once when the cache is added, and after eviction.
+ @code
+ SDImageCacheDiskBudget *budget = [[SDImageCacheDiskBudget alloc] initWithTotalSize:500 * 1024 * 1024];
+ [budget addCache:feedCache weight:2];
+ [budget addCache:avatarCache weight:1];
+ @endcode
+ @note The cache's own `maxDiskSize` is still enforced by the expiration check, set it to 0 to let the budget decide.
+ @note The cache's disk cache should implement `removeDataToFitSize:` to evict, the built-in `SDDiskCache` does.
+ */
+@interface SDImageCacheDiskBudget : NSObject
+
+/**
+ The total disk size in bytes shared by all caches.
+ */
+@property (nonatomic, assign) NSUInteger totalSize;
+
+/**
+ The ratio of total size which is guaranteed for the caches, split by weight. The rest is shared by all caches.
+ Defaults to 0.5.
+ */
+@property (nonatomic, assign) double guaranteedRatio;
+
+/**
+ The caches in this budget.
+ */
+@property (nonatomic, copy, readonly, nonnull) NSArray<SDImageCache *> *caches;
+
+/**
+ The total disk usage of all caches in bytes.
+ */
+@property (nonatomic, assign, readonly) NSUInteger usedSize;
+
+- (nonnull instancetype)init NS_UNAVAILABLE;
++ (nonnull instancetype)new  NS_UNAVAILABLE;
+
+/**
+ Create the budget with total disk size.
+
+ @param totalSize The total disk size in bytes.
+ */
+- (nonnull instancetype)initWithTotalSize:(NSUInteger)totalSize NS_DESIGNATED_INITIALIZER;
+
+/**
+ Add the cache to the budget. One cache can only be in one budget, it's removed from the previous budget.
+
+ @param cache The image cache.
+ @param weight The weight of cache, which is used for guaranteed size and marginal hit value. Must be greater than 0.
+ */
+- (void)addCache:(nonnull SDImageCache *)cache weight:(double)weight;
+
+/**
+ Remove the cache from the budget.
+
+ @param cache The image cache.
+ */
+- (void)removeCache:(nonnull SDImageCache *)cache;
+
+/**
+ The disk usage of the cache in bytes, without scanning directory.
+
+ @param cache The image cache.
+ @return The used size, 0 if the cache is not in budget.
+ */
+- (NSUInteger)usedSizeForCache:(nonnull SDImageCache *)cache;
+
+/**
+ The guaranteed size of the cache in bytes.
+
+ @param cache The image cache.
+ @return The guaranteed size, 0 if the cache is not in budget.
+ */
+- (NSUInteger)guaranteedSizeForCache:(nonnull SDImageCache *)cache;
+
+/**
+ The cache which would evict next, the one with the lowest marginal hit value among the caches over their guaranteed size.
+
+ @return The cache to evict, or nil if all caches are under their guaranteed size.
+ */
+- (nullable SDImageCache *)nextCacheToEvict;
+
+@end
@@ -0,0 +1,267 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDImageCacheDiskBudget.h"
+#import "SDImageCacheDiskBudgetInternal.h"
+#import "SDImageCacheInternal.h"
+#import "SDInternalMacros.h"
+
+static const double kDefaultGuaranteedRatio = 0.5;
+// Evict a bit more than the overflow, to avoid evicting on every store
+static const double kEvictionSlackRatio = 0.1;
+
+@interface SDImageCacheDiskBudgetEntry : NSObject
+
+@property (nonatomic, strong, nonnull) SDImageCache *cache;
+@property (nonatomic, assign) double weight;
+@property (nonatomic, assign) NSUInteger usedSize;
+// The disk hits, which decay after each eviction so the recent hits matter more
+@property (nonatomic, assign) double hitCount;
+
+@end
+
+@implementation SDImageCacheDiskBudgetEntry
+@end
+
+@implementation SDImageCacheDiskBudget {
+    SD_LOCK_DECLARE(_lock);
+    NSMutableArray<SDImageCacheDiskBudgetEntry *> *_entries;
+    BOOL _evicting;
+}
+
+- (instancetype)initWithTotalSize:(NSUInteger)totalSize {
+    self = [super init];
+    if (self) {
+        _totalSize = totalSize;
+        _guaranteedRatio = kDefaultGuaranteedRatio;
+        _entries = [NSMutableArray array];
+        SD_LOCK_INIT(_lock);
+    }
+    return self;
+}
+
+- (NSUInteger)totalSize {
+    SD_LOCK(_lock);
+    NSUInteger totalSize = _totalSize;
+    SD_UNLOCK(_lock);
+    return totalSize;
+}
+
+- (void)setTotalSize:(NSUInteger)totalSize {
+    SD_LOCK(_lock);
+    _totalSize = totalSize;
+    SD_UNLOCK(_lock);
+    [self enforceBudget];
+}
+
+- (double)guaranteedRatio {
+    SD_LOCK(_lock);
+    double guaranteedRatio = _guaranteedRatio;
+    SD_UNLOCK(_lock);
+    return guaranteedRatio;
+}
+
+- (void)setGuaranteedRatio:(double)guaranteedRatio {
+    SD_LOCK(_lock);
+    _guaranteedRatio = guaranteedRatio;
+    SD_UNLOCK(_lock);
+    [self enforceBudget];
+}
+
+#pragma mark - Caches
+
+- (void)addCache:(SDImageCache *)cache weight:(double)weight {
+    NSParameterAssert(cache);
+    NSParameterAssert(weight > 0);
+    SDImageCacheDiskBudget *previousBudget = cache.diskBudget;
+    if (previousBudget && previousBudget != self) {
+        [previousBudget removeCache:cache];
+    }
+    SD_LOCK(_lock);
+    SDImageCacheDiskBudgetEntry *entry = [self entryForCache:cache];
+    if (!entry) {
+        entry = [SDImageCacheDiskBudgetEntry new];
+        entry.cache = cache;
+        [_entries addObject:entry];
+    }
+    entry.weight = MAX(weight, DBL_MIN);
+    SD_UNLOCK(_lock);
+    // The cache reports the usage after scanning once
+    cache.diskBudget = self;
+}
+
+- (void)removeCache:(SDImageCache *)cache {
+    NSParameterAssert(cache);
+    SD_LOCK(_lock);
+    SDImageCacheDiskBudgetEntry *entry = [self entryForCache:cache];
+    if (entry) {
+        [_entries removeObject:entry];
+    }
+    SD_UNLOCK(_lock);
+    if (entry && cache.diskBudget == self) {
+        cache.diskBudget = nil;
+    }
+}
+
+- (NSArray<SDImageCache *> *)caches {
+    SD_LOCK(_lock);
+    NSArray<SDImageCache *> *caches = [_entries valueForKey:NSStringFromSelector(@selector(cache))];
+    SD_UNLOCK(_lock);
+    return caches;
+}
+
+#pragma mark - Usage
+
+- (NSUInteger)usedSize {
+    SD_LOCK(_lock);
+    NSUInteger usedSize = [self totalUsedSize];
+    SD_UNLOCK(_lock);
+    return usedSize;
+}
+
+- (NSUInteger)usedSizeForCache:(SDImageCache *)cache {
+    SD_LOCK(_lock);
+    NSUInteger usedSize = [self entryForCache:cache].usedSize;
+    SD_UNLOCK(_lock);
+    return usedSize;
+}
+
+- (NSUInteger)guaranteedSizeForCache:(SDImageCache *)cache {
+    SD_LOCK(_lock);
+    SDImageCacheDiskBudgetEntry *entry = [self entryForCache:cache];
+    NSUInteger guaranteedSize = entry ? [self guaranteedSizeForEntry:entry] : 0;
+    SD_UNLOCK(_lock);
+    return guaranteedSize;
+}
+
+- (SDImageCache *)nextCacheToEvict {
+    SD_LOCK(_lock);
+    SDImageCache *cache = [self entryToEvict].cache;
+    SD_UNLOCK(_lock);
+    return cache;
+}
+
+#pragma mark - Report from cache
+
+- (void)cache:(SDImageCache *)cache didChangeDiskUsageBy:(NSInteger)delta {
+    SD_LOCK(_lock);
+    SDImageCacheDiskBudgetEntry *entry = [self entryForCache:cache];
+    if (entry) {
+        if (delta >= 0) {
+            entry.usedSize += (NSUInteger)delta;
+        } else {
+            entry.usedSize -= MIN((NSUInteger)(-delta), entry.usedSize);
+        }
+    }
+    SD_UNLOCK(_lock);
+    if (entry && delta > 0) {
+        [self enforceBudget];
+    }
+}
+
+- (void)cache:(SDImageCache *)cache didResetDiskUsage:(NSUInteger)usedSize {
+    SD_LOCK(_lock);
+    SDImageCacheDiskBudgetEntry *entry = [self entryForCache:cache];
+    entry.usedSize = usedSize;
+    SD_UNLOCK(_lock);
+    if (entry) {
+        [self enforceBudget];
+    }
+}
+
+- (void)cacheDidHitDiskData:(SDImageCache *)cache {
+    SD_LOCK(_lock);
+    [self entryForCache:cache].hitCount += 1;
+    SD_UNLOCK(_lock);
+}
+
+#pragma mark - Eviction
+
+- (void)enforceBudget {
+    SD_LOCK(_lock);
+    NSUInteger totalUsedSize = [self totalUsedSize];
+    if (_evicting || totalUsedSize <= _totalSize) {
+        SD_UNLOCK(_lock);
+        return;
+    }
+    SDImageCacheDiskBudgetEntry *entry = [self entryToEvict];
+    if (!entry) {
+        SD_UNLOCK(_lock);
+        return;
+    }
+    // Evict the overflow, but not below the guaranteed size
+    NSUInteger evictSize = totalUsedSize - _totalSize + (NSUInteger)(_totalSize * kEvictionSlackRatio);
+    NSUInteger guaranteedSize = [self guaranteedSizeForEntry:entry];
+    NSUInteger targetSize = entry.usedSize > evictSize ? entry.usedSize - evictSize : 0;
+    targetSize = MAX(targetSize, guaranteedSize);
+    NSUInteger previousUsedSize = entry.usedSize;
+    SDImageCache *cache = entry.cache;
+    for (SDImageCacheDiskBudgetEntry *otherEntry in _entries) {
+        otherEntry.hitCount /= 2;
+    }
+    _evicting = YES;
+    SD_UNLOCK(_lock);
+
+    [cache removeDiskDataToFitSize:targetSize completion:^{
+        SD_LOCK(self->_lock);
+        self->_evicting = NO;
+        // Check again for the next cache, unless the cache can not evict
+        BOOL evicted = [self entryForCache:cache].usedSize < previousUsedSize;
+        SD_UNLOCK(self->_lock);
+        if (evicted) {
+            [self enforceBudget];
+        }
+    }];
+}
+
+#pragma mark - Helper, call with lock
+
+- (nullable SDImageCacheDiskBudgetEntry *)entryForCache:(nonnull SDImageCache *)cache {
+    for (SDImageCacheDiskBudgetEntry *entry in _entries) {
+        if (entry.cache == cache) {
+            return entry;
+        }
+    }
+    return nil;
+}
+
+- (NSUInteger)totalUsedSize {
+    NSUInteger totalUsedSize = 0;
+    for (SDImageCacheDiskBudgetEntry *entry in _entries) {
+        totalUsedSize += entry.usedSize;
+    }
+    return totalUsedSize;
+}
+
+- (NSUInteger)guaranteedSizeForEntry:(nonnull SDImageCacheDiskBudgetEntry *)entry {
+    double totalWeight = 0;
+    for (SDImageCacheDiskBudgetEntry *otherEntry in _entries) {
+        totalWeight += otherEntry.weight;
+    }
+    double guaranteedRatio = MIN(MAX(_guaranteedRatio, 0), 1);
+    return (NSUInteger)(_totalSize * guaranteedRatio * entry.weight / totalWeight);
+}
+
+- (nullable SDImageCacheDiskBudgetEntry *)entryToEvict {
+    SDImageCacheDiskBudgetEntry *entryToEvict;
+    double lowestValue = DBL_MAX;
+    for (SDImageCacheDiskBudgetEntry *entry in _entries) {
+        if (entry.usedSize <= [self guaranteedSizeForEntry:entry]) {
+            continue;
+        }
+        // The marginal hit value of each byte, the idle cache with large usage has the lowest value
+        double value = entry.weight * (entry.hitCount + 1) / (double)entry.usedSize;
+        if (value < lowestValue) {
+            lowestValue = value;
+            entryToEvict = entry;
+        }
+    }
+    return entryToEvict;
+}
+
+@end
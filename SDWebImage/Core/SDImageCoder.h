@@ -97,6 +97,30 @@ FOUNDATION_EXPORT SDImageCoderOption _Nonnull const SDImageCoderDecodeScaleDownL
  */
 FOUNDATION_EXPORT SDImageCoderOption _Nonnull const SDImageCoderDecodeToHDR;
 
+/**
+ A NSUInteger value (stored inside NSNumber) to provide the max thread count for the decoder which supports multi-threaded decoding, such as `SDImageLibWebPCoder` and `SDImageLibAVIFCoder`.
+ Defaults to 0, which means the active processor count. Use 1 to decode on the calling thread only.
+ @note works for `SDImageCoder`, `SDAnimatedImageCoder`
+ */
+FOUNDATION_EXPORT SDImageCoderOption _Nonnull const SDImageCoderDecodeThreadCount;
+
+/**
+ A CGRect raw value (NSValue) in pixel, to decode only the region of image (region-of-interest decoding), instead of decoding the full image and cropping. This save the memory for large image, because only the region bitmap is kept. The coder with the region decoding API (such as libjpeg-turbo and libspng) can save the CPU as well, Image/IO may still decode the full image temporarily.
+ The rect is in the coordinate of the decoded `CGImage`, the same as `-[UIImage sd_croppedImageWithRect:]` multiplied by scale, and it's clipped to the image bounds.
+ Defaults to nil, which means decoding the full image.
+ @note The coder may ignore this option (for example, animated image, or the EXIF oriented image on macOS which `CGImage` is rotated), check the `sd_isRegionDecoded` of the result image.
+ @note When this option is provided, `.decodeThumbnailPixelSize` and `.decodeScaleDownLimitBytes` are ignored, use `.decodeCropScaledPixelSize` instead.
+ @note works for `SDImageCoder`
+ */
+FOUNDATION_EXPORT SDImageCoderOption _Nonnull const SDImageCoderDecodeCropRect;
+
+/**
+ A CGSize raw value (NSValue) in pixel, used with `.decodeCropRect`, to stretch the decoded region to this size. This allows the JPEG decoder to use reduced-size IDCT for the region when down-scaling.
+ Defaults to nil, which means the region is not scaled.
+ @note works for `SDImageCoder`
+ */
+FOUNDATION_EXPORT SDImageCoderOption _Nonnull const SDImageCoderDecodeCropScaledPixelSize;
+
 #pragma mark - Image Encoding Options
 /**
  A NSUInteger (`SDImageHDRType.rawValue`) value (stored inside NSNumber) to provide converting to HDR during encoding. Read the below carefully to choose the value.
@@ -138,10 +162,18 @@ FOUNDATION_EXPORT SDImageCoderOption _Nonnull const SDImageCoderEncodeMaxPixelSi
 /**
  A NSUInteger value specify the max output data bytes size after encoding. Some lossy format like JPEG/HEIF supports the hint for codec to automatically reduce the quality and match the file size you want. Note this option will override the `SDImageCoderEncodeCompressionQuality`, because now the quality is decided by the encoder. (NSNumber)
  @note This is a hint, no guarantee for output size because of compression algorithm limit. And this options does not works for vector images.
+ @note `SDImageIOCoder` does not rely on the codec hint, it searches the compression quality (for lossy format) and downscales the image step by step until the output size matches, see `SDImageCoderEncodeMaxFileSizeTolerance`. The output is still larger than the limit if the image can not be downscaled any more.
  @note works for `SDImageCoder`
  */
 FOUNDATION_EXPORT SDImageCoderOption _Nonnull const SDImageCoderEncodeMaxFileSize;
 
+/**
+ A double value between 0.0-1.0 indicating the acceptable tolerance below the `SDImageCoderEncodeMaxFileSize`. The encoder stop searching once the output bytes size is between `maxFileSize * (1 - tolerance)` and `maxFileSize`. Larger tolerance use less encoding attempts, but the output may waste more of the size budget. (NSNumber)
+ Defaults to 0.1.
+ @note works for `SDImageIOCoder`
+ */
+FOUNDATION_EXPORT SDImageCoderOption _Nonnull const SDImageCoderEncodeMaxFileSizeTolerance;
+
 /**
  A Boolean value indicating the encoding format should contains a thumbnail image into the output data. Only some of image format (like JPEG/HEIF/AVIF) support this behavior. The embed thumbnail will be used during next time thumbnail decoding (provided `.thumbnailPixelSize`), which is faster than full image thumbnail decoding. (NSNumber)
  Defaults to NO, which does not embed any thumbnail.
@@ -232,6 +264,22 @@ FOUNDATION_EXPORT SDImageCoderOption _Nonnull const SDImageCoderWebImageContext
                                  loopCount:(NSUInteger)loopCount
                                     format:(SDImageFormat)format
                                    options:(nullable SDImageCoderOptions *)options;
+
+#pragma mark - Streaming Encoding
+/**
+ Encode the image and stream the output to the file URL directly, without holding the whole encoded data in memory. The file is created or overwritten.
+ If the coder does not implement this, `SDImageCodersManager` fallback to `encodedDataWithImage:format:options:` and write the data to file.
+ 
+ @param image The image to be encoded
+ @param format The image format to encode, you should note `SDImageFormatUndefined` format is also possible
+ @param url The file URL to write
+ @param options A dictionary containing any encoding options. Pass @{SDImageCoderEncodeCompressionQuality: @(1)} to specify compression quality.
+ @return YES if the encoding and writing succeed. The file content is undefined if failed.
+ */
+- (BOOL)encodeImage:(nullable UIImage *)image
+             format:(SDImageFormat)format
+              toURL:(nonnull NSURL *)url
+            options:(nullable SDImageCoderOptions *)options;
 @end
 
 #pragma mark - Progressive Coder
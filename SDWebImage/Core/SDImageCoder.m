@@ -17,6 +17,9 @@ SDImageCoderOption const SDImageCoderDecodeTypeIdentifierHint = @"decodeTypeIden
 SDImageCoderOption const SDImageCoderDecodeUseLazyDecoding = @"decodeUseLazyDecoding";
 SDImageCoderOption const SDImageCoderDecodeScaleDownLimitBytes = @"decodeScaleDownLimitBytes";
 SDImageCoderOption const SDImageCoderDecodeToHDR = @"decodeToHDR";
+SDImageCoderOption const SDImageCoderDecodeThreadCount = @"decodeThreadCount";
+SDImageCoderOption const SDImageCoderDecodeCropRect = @"decodeCropRect";
+SDImageCoderOption const SDImageCoderDecodeCropScaledPixelSize = @"decodeCropScaledPixelSize";
 
 SDImageCoderOption const SDImageCoderEncodeToHDR = @"encodeToHDR";
 SDImageCoderOption const SDImageCoderEncodeFirstFrameOnly = @"encodeFirstFrameOnly";
@@ -24,6 +27,7 @@ SDImageCoderOption const SDImageCoderEncodeCompressionQuality = @"encodeCompress
 SDImageCoderOption const SDImageCoderEncodeBackgroundColor = @"encodeBackgroundColor";
 SDImageCoderOption const SDImageCoderEncodeMaxPixelSize = @"encodeMaxPixelSize";
 SDImageCoderOption const SDImageCoderEncodeMaxFileSize = @"encodeMaxFileSize";
+SDImageCoderOption const SDImageCoderEncodeMaxFileSizeTolerance = @"encodeMaxFileSizeTolerance";
 SDImageCoderOption const SDImageCoderEncodeEmbedThumbnail = @"encodeEmbedThumbnail";
 
 SDImageCoderOption const SDImageCoderWebImageContext = @"webImageContext";
@@ -173,6 +173,13 @@ typedef struct SDImagePixelFormat {
  */
 + (CGSize)scaledSizeWithImageSize:(CGSize)imageSize scaleSize:(CGSize)scaleSize preserveAspectRatio:(BOOL)preserveAspectRatio shouldScaleUp:(BOOL)shouldScaleUp;
 
+/// Calculate the reduced-size IDCT denominator (1, 2, 4 or 8) to decode the JPEG thumbnail, which is the largest one still produce the image not smaller than the thumbnail size. The thumbnail decoding cost is then proportional to the output pixels rather than the source pixels.
+/// @param imageSize The image size in pixel
+/// @param thumbnailSize The thumbnail size in pixel, see `SDImageCoderDecodeThumbnailPixelSize`
+/// @param preserveAspectRatio Whether or not to preserve aspect ratio, see `SDImageCoderDecodePreserveAspectRatio`
+/// @return The denominator, 1 means no scaling
++ (NSUInteger)DCTScaleDenominatorWithImageSize:(CGSize)imageSize thumbnailSize:(CGSize)thumbnailSize preserveAspectRatio:(BOOL)preserveAspectRatio;
+
 /// Calculate the limited image size with the bytes, when using `SDImageCoderDecodeScaleDownLimitBytes`. This preserve aspect ratio and never scale up
 /// @param imageSize The image size (in pixel or point defined by caller)
 /// @param limitBytes The limit bytes
@@ -638,6 +638,22 @@ static const CGFloat kDestSeemOverlap = 2.0f;   // the numbers of pixels to over
     return CGSizeMake(resultWidth, resultHeight);
 }
 
++ (NSUInteger)DCTScaleDenominatorWithImageSize:(CGSize)imageSize thumbnailSize:(CGSize)thumbnailSize preserveAspectRatio:(BOOL)preserveAspectRatio {
+    if (imageSize.width <= 0 || imageSize.height <= 0 || thumbnailSize.width <= 0 || thumbnailSize.height <= 0) {
+        return 1;
+    }
+    CGSize targetSize = [SDImageCoderHelper scaledSizeWithImageSize:imageSize scaleSize:thumbnailSize preserveAspectRatio:preserveAspectRatio shouldScaleUp:NO];
+    for (NSUInteger denominator = 8; denominator > 1; denominator /= 2) {
+        // The reduced-size IDCT output size is rounded up, like libjpeg
+        CGFloat scaledWidth = ceil(imageSize.width / denominator);
+        CGFloat scaledHeight = ceil(imageSize.height / denominator);
+        if (scaledWidth >= round(targetSize.width) && scaledHeight >= round(targetSize.height)) {
+            return denominator;
+        }
+    }
+    return 1;
+}
+
 + (CGSize)scaledSizeWithImageSize:(CGSize)imageSize limitBytes:(NSUInteger)limitBytes bytesPerPixel:(NSUInteger)bytesPerPixel frameCount:(NSUInteger)frameCount {
     if (CGSizeEqualToSize(imageSize, CGSizeZero)) return CGSizeMake(1, 1);
     NSUInteger totalFramePixelSize = limitBytes / bytesPerPixel / (frameCount ?: 1);
@@ -127,6 +127,23 @@
     return nil;
 }
 
+- (BOOL)encodeImage:(UIImage *)image format:(SDImageFormat)format toURL:(NSURL *)url options:(SDImageCoderOptions *)options {
+    if (!image || !url) {
+        return NO;
+    }
+    NSArray<id<SDImageCoder>> *coders = self.coders;
+    for (id<SDImageCoder> coder in coders.reverseObjectEnumerator) {
+        if ([coder canEncodeToFormat:format]) {
+            if ([coder respondsToSelector:@selector(encodeImage:format:toURL:options:)]) {
+                return [coder encodeImage:image format:format toURL:url options:options];
+            }
+            NSData *data = [coder encodedDataWithImage:image format:format options:options];
+            return data && [data writeToURL:url options:0 error:nil];
+        }
+    }
+    return NO;
+}
+
 - (NSData *)encodedDataWithFrames:(NSArray<SDImageFrame *> *)frames loopCount:(NSUInteger)loopCount format:(SDImageFormat)format options:(SDImageCoderOptions *)options {
     if (!frames || frames.count < 1) {
         return nil;
@@ -14,7 +14,7 @@
 #if SD_MAC
 static void *kNSGraphicsContextScaleFactorKey;
 
-static CGContextRef SDCGContextCreateBitmapContext(CGSize size, BOOL opaque, CGFloat scale) {
+CGContextRef SDCGContextCreateBitmapContext(CGSize size, BOOL opaque, CGFloat scale) {
     if (scale == 0) {
         // Match `UIGraphicsBeginImageContextWithOptions`, reset to the scale factor of the device’s main screen if scale is 0.
         NSScreen *mainScreen = nil;
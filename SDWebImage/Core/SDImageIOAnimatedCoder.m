@@ -279,7 +279,7 @@ static BOOL SDImageIOPNGPluginBuggyNeedWorkaround(void) {
     CGFloat _scale;
     NSUInteger _loopCount;
     NSUInteger _frameCount;
-    NSArray<SDImageIOCoderFrame *> *_frames;
+    NSMutableArray<SDImageIOCoderFrame *> *_frames;
     BOOL _finished;
     BOOL _preserveAspectRatio;
     CGSize _thumbnailSize;
@@ -446,6 +446,51 @@ static BOOL SDImageIOPNGPluginBuggyNeedWorkaround(void) {
 }
 
 + (UIImage *)createFrameAtIndex:(NSUInteger)index source:(CGImageSourceRef)source scale:(CGFloat)scale preserveAspectRatio:(BOOL)preserveAspectRatio thumbnailSize:(CGSize)thumbnailSize lazyDecode:(BOOL)lazyDecode animatedImage:(BOOL)animatedImage decodeToHDR:(BOOL)decodeToHDR {
+    return [self createFrameAtIndex:index source:source scale:scale preserveAspectRatio:preserveAspectRatio thumbnailSize:thumbnailSize cropRect:CGRectNull cropScaledPixelSize:CGSizeZero lazyDecode:lazyDecode animatedImage:animatedImage decodeToHDR:decodeToHDR];
+}
+
++ (CGImageRef)createRegionImageAtIndex:(NSUInteger)index source:(CGImageSourceRef)source pixelSize:(CGSize)pixelSize regionRect:(CGRect)regionRect scaledPixelSize:(CGSize)scaledPixelSize canSubsample:(BOOL)canSubsample decodingOptions:(NSMutableDictionary *)decodingOptions CF_RETURNS_RETAINED {
+    BOOL shouldScale = scaledPixelSize.width > 0 && scaledPixelSize.height > 0 && !CGSizeEqualToSize(scaledPixelSize, regionRect.size);
+    NSUInteger subsampleFactor = 1;
+    if (shouldScale && canSubsample) {
+        subsampleFactor = [SDImageCoderHelper DCTScaleDenominatorWithImageSize:regionRect.size thumbnailSize:scaledPixelSize preserveAspectRatio:NO];
+        if (subsampleFactor > 1) {
+            decodingOptions[(__bridge NSString *)kCGImageSourceSubsampleFactor] = @(subsampleFactor);
+        }
+    }
+    // Image/IO does not provide the region decoding API, it may still decode the full image when rendering the cropped one. The full size bitmap is transient, only the cropped (and subsampled) bitmap is kept
+    CGImageRef fullImageRef = CGImageSourceCreateImageAtIndex(source, index, (__bridge CFDictionaryRef)[decodingOptions copy]);
+    if (!fullImageRef) {
+        return NULL;
+    }
+    CGRect rect = regionRect;
+    if (subsampleFactor > 1) {
+        // Image/IO may ignore or clamp the requested subsample factor, map the region into the subsampled image by the size it actually returned
+        size_t width = CGImageGetWidth(fullImageRef);
+        size_t height = CGImageGetHeight(fullImageRef);
+        CGFloat widthFactor = width > 0 ? pixelSize.width / width : 1;
+        CGFloat heightFactor = height > 0 ? pixelSize.height / height : 1;
+        if (widthFactor > 1 || heightFactor > 1) {
+            rect = CGRectIntegral(CGRectMake(rect.origin.x / widthFactor, rect.origin.y / heightFactor, rect.size.width / widthFactor, rect.size.height / heightFactor));
+            rect = CGRectIntersection(rect, CGRectMake(0, 0, width, height));
+        }
+    }
+    CGImageRef imageRef = CGImageCreateWithImageInRect(fullImageRef, rect);
+    CGImageRelease(fullImageRef);
+    if (!imageRef) {
+        return NULL;
+    }
+    if (shouldScale) {
+        CGImageRef scaledImageRef = [SDImageCoderHelper CGImageCreateScaled:imageRef size:scaledPixelSize];
+        if (scaledImageRef) {
+            CGImageRelease(imageRef);
+            imageRef = scaledImageRef;
+        }
+    }
+    return imageRef;
+}
+
++ (UIImage *)createFrameAtIndex:(NSUInteger)index source:(CGImageSourceRef)source scale:(CGFloat)scale preserveAspectRatio:(BOOL)preserveAspectRatio thumbnailSize:(CGSize)thumbnailSize cropRect:(CGRect)cropRect cropScaledPixelSize:(CGSize)cropScaledPixelSize lazyDecode:(BOOL)lazyDecode animatedImage:(BOOL)animatedImage decodeToHDR:(BOOL)decodeToHDR {
     // `animatedImage` means called from `SDAnimatedImageProvider.animatedImageFrameAtIndex`
     NSDictionary *options;
     if (animatedImage) {
@@ -486,8 +531,40 @@ static BOOL SDImageIOPNGPluginBuggyNeedWorkaround(void) {
     }
   
     CGImageRef imageRef;
+    CFStringRef sourceType = CGImageSourceGetType(source);
+    // JPEG decoder use the reduced-size IDCT (1/2, 1/4, 1/8) for subsample factor, instead of the full size IDCT and downscale
+    BOOL canSubsample = !decodeToHDR && sourceType && CFStringCompare(sourceType, kSDUTTypeJPEG, 0) == kCFCompareEqualTo;
+    // Region-of-interest decoding, the thumbnail is ignored
+    CGRect regionRect = CGRectNull;
+    if (!CGRectIsNull(cropRect) && pixelWidth > 0 && pixelHeight > 0) {
+        regionRect = CGRectIntersection(CGRectIntegral(cropRect), CGRectMake(0, 0, pixelWidth, pixelHeight));
+    }
+#if SD_MAC
+    // `-[NSImage initWithCGImage:scale:orientation:]` redraws the CGImage with EXIF orientation applied (see NSImage+Compatibility), so the crop rect is in the rotated coordinate, which does not match the raw pixels in source
+    BOOL createRegionImage = !CGRectIsEmpty(regionRect) && exifOrientation == kCGImagePropertyOrientationUp;
+#else
+    BOOL createRegionImage = !CGRectIsEmpty(regionRect);
+#endif
+    if (createRegionImage) {
+        thumbnailSize = CGSizeZero;
+    }
     BOOL createFullImage = thumbnailSize.width == 0 || thumbnailSize.height == 0 || pixelWidth == 0 || pixelHeight == 0 || (pixelWidth <= thumbnailSize.width && pixelHeight <= thumbnailSize.height);
-    if (createFullImage) {
+    BOOL createSubsampledImage = NO;
+    CGSize subsampledThumbnailSize = thumbnailSize;
+    if (!createFullImage && canSubsample) {
+        // The thumbnail size is for the transformed image, but the subsampled image is not transformed
+        if (preserveAspectRatio && exifOrientation >= kCGImagePropertyOrientationLeftMirrored) {
+            subsampledThumbnailSize = CGSizeMake(thumbnailSize.height, thumbnailSize.width);
+        }
+        NSUInteger subsampleFactor = [SDImageCoderHelper DCTScaleDenominatorWithImageSize:CGSizeMake(pixelWidth, pixelHeight) thumbnailSize:subsampledThumbnailSize preserveAspectRatio:preserveAspectRatio];
+        createSubsampledImage = subsampleFactor > 1;
+        if (createSubsampledImage) {
+            decodingOptions[(__bridge NSString *)kCGImageSourceSubsampleFactor] = @(subsampleFactor);
+        }
+    }
+    if (createRegionImage) {
+        imageRef = [self createRegionImageAtIndex:index source:source pixelSize:CGSizeMake(pixelWidth, pixelHeight) regionRect:regionRect scaledPixelSize:cropScaledPixelSize canSubsample:canSubsample decodingOptions:decodingOptions];
+    } else if (createFullImage || createSubsampledImage) {
         imageRef = CGImageSourceCreateImageAtIndex(source, index, (__bridge CFDictionaryRef)[decodingOptions copy]);
     } else {
         decodingOptions[(__bridge NSString *)kCGImageSourceCreateThumbnailWithTransform] = @(preserveAspectRatio);
@@ -513,7 +590,17 @@ static BOOL SDImageIOPNGPluginBuggyNeedWorkaround(void) {
     BOOL isHDRImage = [SDImageCoderHelper CGImageIsHDR:imageRef];
     
     // Thumbnail image post-process
-    if (!createFullImage) {
+    if (createSubsampledImage) {
+        // High quality resample to the exact thumbnail size, the EXIF orientation is kept
+        CGSize imageSize = CGSizeMake(CGImageGetWidth(imageRef), CGImageGetHeight(imageRef));
+        CGSize scaledSize = [SDImageCoderHelper scaledSizeWithImageSize:CGSizeMake(pixelWidth, pixelHeight) scaleSize:subsampledThumbnailSize preserveAspectRatio:preserveAspectRatio shouldScaleUp:NO];
+        scaledSize = CGSizeMake(MIN(MAX(round(scaledSize.width), 1), imageSize.width), MIN(MAX(round(scaledSize.height), 1), imageSize.height));
+        CGImageRef scaledImageRef = [SDImageCoderHelper CGImageCreateScaled:imageRef size:scaledSize];
+        if (scaledImageRef) {
+            CGImageRelease(imageRef);
+            imageRef = scaledImageRef;
+        }
+    } else if (!createFullImage) {
         if (preserveAspectRatio) {
             // kCGImageSourceCreateThumbnailWithTransform will apply EXIF transform as well, we should not apply twice
             exifOrientation = kCGImagePropertyOrientationUp;
@@ -579,6 +666,9 @@ static BOOL SDImageIOPNGPluginBuggyNeedWorkaround(void) {
 #endif
     CGImageRelease(imageRef);
     image.sd_isDecoded = !isLazy;
+    if (createRegionImage) {
+        image.sd_isRegionDecoded = YES;
+    }
     
     return image;
 }
@@ -614,6 +704,26 @@ static BOOL SDImageIOPNGPluginBuggyNeedWorkaround(void) {
         preserveAspectRatio = preserveAspectRatioValue.boolValue;
     }
     
+    CGRect cropRect = CGRectNull;
+    NSValue *cropRectValue = options[SDImageCoderDecodeCropRect];
+    if (cropRectValue != nil) {
+#if SD_MAC
+        cropRect = cropRectValue.rectValue;
+#else
+        cropRect = cropRectValue.CGRectValue;
+#endif
+    }
+    
+    CGSize cropScaledPixelSize = CGSizeZero;
+    NSValue *cropScaledPixelSizeValue = options[SDImageCoderDecodeCropScaledPixelSize];
+    if (cropScaledPixelSizeValue != nil) {
+#if SD_MAC
+        cropScaledPixelSize = cropScaledPixelSizeValue.sizeValue;
+#else
+        cropScaledPixelSize = cropScaledPixelSizeValue.CGSizeValue;
+#endif
+    }
+    
     BOOL lazyDecode = YES; // Defaults YES for static image coder
     NSNumber *lazyDecodeValue = options[SDImageCoderDecodeUseLazyDecoding];
     if (lazyDecodeValue != nil) {
@@ -631,7 +741,7 @@ static BOOL SDImageIOPNGPluginBuggyNeedWorkaround(void) {
 #if SD_MAC
     // If don't use thumbnail, prefers the built-in generation of frames (GIF/APNG)
     // Which decode frames in time and reduce memory usage
-    if (limitBytes == 0 && (thumbnailSize.width == 0 || thumbnailSize.height == 0)) {
+    if (limitBytes == 0 && (thumbnailSize.width == 0 || thumbnailSize.height == 0) && CGRectIsNull(cropRect)) {
         SDAnimatedImageRep *imageRep = [[SDAnimatedImageRep alloc] initWithData:data];
         if (imageRep) {
             NSSize size = NSMakeSize(imageRep.pixelsWide / scale, imageRep.pixelsHigh / scale);
@@ -692,7 +802,7 @@ static BOOL SDImageIOPNGPluginBuggyNeedWorkaround(void) {
     
     BOOL decodeFirstFrame = [options[SDImageCoderDecodeFirstFrameOnly] boolValue];
     if (decodeFirstFrame || frameCount <= 1) {
-        animatedImage = [self.class createFrameAtIndex:0 source:source scale:scale preserveAspectRatio:preserveAspectRatio thumbnailSize:thumbnailSize lazyDecode:lazyDecode animatedImage:NO decodeToHDR:decodeToHDR];
+        animatedImage = [self.class createFrameAtIndex:0 source:source scale:scale preserveAspectRatio:preserveAspectRatio thumbnailSize:thumbnailSize cropRect:cropRect cropScaledPixelSize:cropScaledPixelSize lazyDecode:lazyDecode animatedImage:NO decodeToHDR:decodeToHDR];
     } else {
         NSMutableArray<SDImageFrame *> *frames = [NSMutableArray arrayWithCapacity:frameCount];
         
@@ -802,8 +912,8 @@ static BOOL SDImageIOPNGPluginBuggyNeedWorkaround(void) {
     }
     
     SD_LOCK(_lock);
-    // For animated image progressive decoding because the frame count and duration may be changed.
-    [self scanAndCheckFramesValidWithImageSource:_imageSource];
+    // For animated image progressive decoding, only the new received frames are appended, the player can keep playing the previous frames.
+    [self appendIncrementalFramesWithImageSource:_imageSource];
     SD_UNLOCK(_lock);
     
     // Scale down to limit bytes if need
@@ -1086,11 +1196,41 @@ static BOOL SDImageIOPNGPluginBuggyNeedWorkaround(void) {
     }
     
     _frameCount = frameCount;
-    _frames = [frames copy];
+    _frames = frames;
     
     return YES;
 }
 
+- (void)appendIncrementalFramesWithImageSource:(CGImageSourceRef)imageSource {
+    if (!imageSource) {
+        return;
+    }
+    NSUInteger frameCount = CGImageSourceGetCount(imageSource);
+    if (!_finished && frameCount > 0) {
+        // The last frame may be still receiving bytes, wait for it to avoid rendering a partial frame
+        CGImageSourceStatus status = CGImageSourceGetStatusAtIndex(imageSource, frameCount - 1);
+        if (status == kCGImageStatusIncomplete || status == kCGImageStatusReadingHeader) {
+            frameCount--;
+        }
+    }
+    _loopCount = [self.class imageLoopCountWithSource:imageSource];
+    
+    if (!_frames) {
+        _frames = [NSMutableArray arrayWithCapacity:frameCount];
+    }
+    // The frames already received never change, so don't parse their durations again
+    for (size_t i = _frames.count; i < frameCount; i++) {
+        SDImageIOCoderFrame *frame = [[SDImageIOCoderFrame alloc] init];
+        frame.index = i;
+        frame.duration = [self.class frameDurationAtIndex:i source:imageSource];
+        [_frames addObject:frame];
+    }
+    if (_frames.count > frameCount) {
+        [_frames removeObjectsInRange:NSMakeRange(frameCount, _frames.count - frameCount)];
+    }
+    _frameCount = frameCount;
+}
+
 - (NSData *)animatedImageData {
     return _imageData;
 }
@@ -27,4 +27,21 @@
 
 @property (nonatomic, class, readonly, nonnull) SDImageIOCoder *sharedCoder;
 
+/**
+ Encode the image to image data, and report the file size targeting statistics when `SDImageCoderEncodeMaxFileSize` is provided.
+ The encoder searches the compression quality for lossy format (several qualities are encoded in parallel for each round), and downscales the image when even the lowest quality is still too large. The image pixels are rendered once for each scale step and reused by all of the attempts of that step.
+ 
+ @param image The image to be encoded
+ @param format The image format to encode, you should note `SDImageFormatUndefined` format is also possible
+ @param options A dictionary containing any encoding options
+ @param attempts The number of encoding attempts used, 1 if there are no file size limit. Pass NULL to ignore.
+ @param bytesPerPixel The output data bytes size per encoded pixel. Pass NULL to ignore.
+ @return The encoded image data
+ */
+- (nullable NSData *)encodedDataWithImage:(nullable UIImage *)image
+                                   format:(SDImageFormat)format
+                                  options:(nullable SDImageCoderOptions *)options
+                                 attempts:(nullable NSUInteger *)attempts
+                            bytesPerPixel:(nullable double *)bytesPerPixel;
+
 @end
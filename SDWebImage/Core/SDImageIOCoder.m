@@ -16,14 +16,199 @@
 #import <ImageIO/ImageIO.h>
 #import <CoreServices/CoreServices.h>
 
-// Specify File Size for lossy format encoding, like JPEG
-static NSString * kSDCGImageDestinationRequestedFileSize = @"kCGImageDestinationRequestedFileSize";
 // Support Xcode 15 SDK, use raw value instead of symbol
 static NSString * kSDCGImageDestinationEncodeRequest = @"kCGImageDestinationEncodeRequest";
 static NSString * kSDCGImageDestinationEncodeToSDR = @"kCGImageDestinationEncodeToSDR";
 static NSString * kSDCGImageDestinationEncodeToISOHDR = @"kCGImageDestinationEncodeToISOHDR";
 static NSString * kSDCGImageDestinationEncodeToISOGainmap = @"kCGImageDestinationEncodeToISOGainmap";
 
+// The qualities encoded in parallel for each search round, each round narrows the quality range to 1/(count + 1)
+static const size_t kSDImageIOEncodeParallelAttempts = 3;
+// The bounded quality search rounds, 4 rounds give 1/256 quality precision
+static const NSUInteger kSDImageIOEncodeMaxSearchRounds = 4;
+// The bounded downscale steps when the lowest quality is still too large
+static const NSUInteger kSDImageIOEncodeMaxDownscaleSteps = 6;
+
+static inline BOOL SDImageIOFormatIsLossy(SDImageFormat format) {
+    switch (format) {
+        case SDImageFormatJPEG:
+        case SDImageFormatWebP:
+        case SDImageFormatHEIC:
+        case SDImageFormatHEIF:
+            return YES;
+        default:
+            return NO;
+    }
+}
+
+static inline double SDImageIOBytesPerPixel(NSData *data, size_t width, size_t height, CGFloat maxPixelSize) {
+    if (data.length == 0 || width == 0 || height == 0) {
+        return 0;
+    }
+    double pixelWidth = width;
+    double pixelHeight = height;
+    if (maxPixelSize > 0 && maxPixelSize < MAX(pixelWidth, pixelHeight)) {
+        double ratio = maxPixelSize / MAX(pixelWidth, pixelHeight);
+        pixelWidth = MAX(floor(pixelWidth * ratio), 1);
+        pixelHeight = MAX(floor(pixelHeight * ratio), 1);
+    }
+    return data.length / (pixelWidth * pixelHeight);
+}
+
+// Encode a single image into the data, the data is reset and reused
+static BOOL SDImageIOEncodeCGImage(CGImageRef imageRef, CFStringRef imageUTType, NSDictionary *properties, NSMutableData *imageData) {
+    imageData.length = 0;
+    // Create an image destination.
+    CGImageDestinationRef imageDestination = CGImageDestinationCreateWithData((__bridge CFMutableDataRef)imageData, imageUTType, 1, NULL);
+    if (!imageDestination) {
+        // Handle failure.
+        return NO;
+    }
+    // Add your image to the destination.
+    CGImageDestinationAddImage(imageDestination, imageRef, (__bridge CFDictionaryRef)properties);
+    // Finalize the destination.
+    BOOL success = CGImageDestinationFinalize(imageDestination);
+    CFRelease(imageDestination);
+    if (!success) {
+        imageData.length = 0;
+    }
+    return success;
+}
+
+// Search the compression quality (lossy format only) and downscale step by step, until the output is between `maxFileSize * (1 - tolerance)` and `maxFileSize`
+// The largest scale which fits is preferred, then the highest quality. Returns the smallest output if nothing fits.
+static NSData * SDImageIOEncodeWithMaxFileSize(CGImageRef imageRef, CFStringRef imageUTType, BOOL lossy, NSDictionary *properties, NSUInteger maxFileSize, double tolerance, NSUInteger *attemptsRef, double *bytesPerPixelRef) {
+    size_t width = CGImageGetWidth(imageRef);
+    size_t height = CGImageGetHeight(imageRef);
+    if (width == 0 || height == 0) {
+        return nil;
+    }
+    // We scale the pixels ourselves, so the codec does not scale again for each attempt
+    NSMutableDictionary *mutableProperties = [properties mutableCopy];
+    CGFloat maxPixelSize = [properties[(__bridge NSString *)kCGImageDestinationImageMaxPixelSize] doubleValue];
+    mutableProperties[(__bridge NSString *)kCGImageDestinationImageMaxPixelSize] = nil;
+    NSDictionary *baseProperties = [mutableProperties copy];
+    CGSize size = CGSizeMake(width, height);
+    if (maxPixelSize > 0 && maxPixelSize < MAX(width, height)) {
+        CGFloat ratio = maxPixelSize / MAX(width, height);
+        size = CGSizeMake(MAX(floor(width * ratio), 1), MAX(floor(height * ratio), 1));
+    }
+    // Render the lazy image (like from ImageIO) once, or each attempt decodes it again. Keep the HDR image as it is, the decoded bitmap is 8 bits per component
+    CGImageRef sourceImageRef = NULL;
+    if ([SDImageCoderHelper CGImageIsLazy:imageRef] && ![SDImageCoderHelper CGImageIsHDR:imageRef]) {
+        sourceImageRef = [SDImageCoderHelper CGImageCreateDecoded:imageRef];
+    }
+    if (!sourceImageRef) {
+        sourceImageRef = CGImageRetain(imageRef);
+    }
+    
+    // The output buffers are reused between attempts
+    NSMutableArray<NSMutableData *> *mutableBuffers = [NSMutableArray arrayWithCapacity:kSDImageIOEncodeParallelAttempts];
+    for (size_t i = 0; i < kSDImageIOEncodeParallelAttempts; i++) {
+        [mutableBuffers addObject:[NSMutableData data]];
+    }
+    NSArray<NSMutableData *> *buffers = [mutableBuffers copy];
+    dispatch_queue_t queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+    NSUInteger minFileSize = (NSUInteger)(maxFileSize * (1 - tolerance));
+    
+    NSUInteger attempts = 0;
+    NSData *resultData;
+    CGSize resultSize = CGSizeZero;
+    NSData *smallestData;
+    CGSize smallestSize = CGSizeZero;
+    for (NSUInteger step = 0; step <= kSDImageIOEncodeMaxDownscaleSteps; step++) {
+        CGImageRef stepImageRef = [SDImageCoderHelper CGImageCreateScaled:sourceImageRef size:size];
+        if (!stepImageRef) {
+            break;
+        }
+        // The smallest output size of this step, used to estimate the next scale
+        NSUInteger stepSmallestLength = 0;
+        NSUInteger roundCount = lossy ? kSDImageIOEncodeMaxSearchRounds : 1;
+        size_t attemptCount = lossy ? kSDImageIOEncodeParallelAttempts : 1;
+        double lowQuality = 0;
+        double highQuality = 1;
+        for (NSUInteger round = 0; round < roundCount; round++) {
+            double low = lowQuality;
+            double high = highQuality;
+            dispatch_apply(attemptCount, queue, ^(size_t i) {
+                NSMutableDictionary *attemptProperties = [baseProperties mutableCopy];
+                if (lossy) {
+                    attemptProperties[(__bridge NSString *)kCGImageDestinationLossyCompressionQuality] = @(low + (high - low) * (i + 1) / (attemptCount + 1));
+                }
+                SDImageIOEncodeCGImage(stepImageRef, imageUTType, attemptProperties, buffers[i]);
+            });
+            attempts += attemptCount;
+            
+            // The qualities are ascending, find the highest one which fits
+            NSInteger fitIndex = -1;
+            for (size_t i = 0; i < attemptCount; i++) {
+                NSUInteger length = buffers[i].length;
+                if (length == 0) {
+                    // Failed
+                    continue;
+                }
+                if (length <= maxFileSize) {
+                    fitIndex = i;
+                }
+                if (stepSmallestLength == 0 || length < stepSmallestLength) {
+                    stepSmallestLength = length;
+                    if (!smallestData || length < smallestData.length) {
+                        smallestData = [buffers[i] copy];
+                        smallestSize = size;
+                    }
+                }
+            }
+            if (fitIndex < 0) {
+                // Search the lower range
+                highQuality = low + (high - low) / (attemptCount + 1);
+                continue;
+            }
+            resultData = [buffers[fitIndex] copy];
+            resultSize = size;
+            if (resultData.length >= minFileSize) {
+                // Within tolerance, stop early
+                break;
+            }
+            // Search the higher range
+            lowQuality = low + (high - low) * (fitIndex + 1) / (attemptCount + 1);
+            highQuality = low + (high - low) * (fitIndex + 2) / (attemptCount + 1);
+        }
+        CGImageRelease(stepImageRef);
+        if (resultData || stepSmallestLength == 0) {
+            break;
+        }
+        // Even the lowest quality is too large, downscale. The output size is roughly proportional to the pixel count
+        double factor = sqrt((double)maxFileSize / stepSmallestLength) * 0.95;
+        factor = MIN(MAX(factor, 0.25), 0.9);
+        CGSize nextSize = CGSizeMake(floor(size.width * factor), floor(size.height * factor));
+        if (nextSize.width < 1 || nextSize.height < 1) {
+            break;
+        }
+        size = nextSize;
+    }
+    CGImageRelease(sourceImageRef);
+    
+    NSData *imageData = resultData ?: smallestData;
+    CGSize imageSize = resultData ? resultSize : smallestSize;
+    double bytesPerPixel = SDImageIOBytesPerPixel(imageData, imageSize.width, imageSize.height, 0);
+    if (!imageData) {
+        // The pixel format can not be scaled by us, fallback to encode the image as it is
+        NSMutableData *mutableData = [NSMutableData data];
+        if (SDImageIOEncodeCGImage(imageRef, imageUTType, properties, mutableData)) {
+            imageData = [mutableData copy];
+        }
+        attempts++;
+        bytesPerPixel = SDImageIOBytesPerPixel(imageData, width, height, maxPixelSize);
+    }
+    if (attemptsRef) {
+        *attemptsRef = attempts;
+    }
+    if (bytesPerPixelRef) {
+        *bytesPerPixelRef = bytesPerPixel;
+    }
+    return imageData;
+}
+
 
 @implementation SDImageIOCoder {
     size_t _width, _height;
@@ -192,6 +377,26 @@ static NSString * kSDCGImageDestinationEncodeToISOGainmap = @"kCGImageDestinatio
         return image;
     }
     
+    CGRect cropRect = CGRectNull;
+    NSValue *cropRectValue = options[SDImageCoderDecodeCropRect];
+    if (cropRectValue != nil) {
+#if SD_MAC
+        cropRect = cropRectValue.rectValue;
+#else
+        cropRect = cropRectValue.CGRectValue;
+#endif
+    }
+    
+    CGSize cropScaledPixelSize = CGSizeZero;
+    NSValue *cropScaledPixelSizeValue = options[SDImageCoderDecodeCropScaledPixelSize];
+    if (cropScaledPixelSizeValue != nil) {
+#if SD_MAC
+        cropScaledPixelSize = cropScaledPixelSizeValue.sizeValue;
+#else
+        cropScaledPixelSize = cropScaledPixelSizeValue.CGSizeValue;
+#endif
+    }
+    
     BOOL lazyDecode = YES; // Defaults YES for static image coder
     NSNumber *lazyDecodeValue = options[SDImageCoderDecodeUseLazyDecoding];
     if (lazyDecodeValue != nil) {
@@ -232,7 +437,7 @@ static NSString * kSDCGImageDestinationEncodeToISOGainmap = @"kCGImageDestinatio
     CFStringRef uttype = CGImageSourceGetType(source);
     SDImageFormat imageFormat = [NSData sd_imageFormatFromUTType:uttype];
     
-    UIImage *image = [SDImageIOAnimatedCoder createFrameAtIndex:0 source:source scale:scale preserveAspectRatio:preserveAspectRatio thumbnailSize:thumbnailSize lazyDecode:lazyDecode animatedImage:NO decodeToHDR:decodeToHDR];
+    UIImage *image = [SDImageIOAnimatedCoder createFrameAtIndex:0 source:source scale:scale preserveAspectRatio:preserveAspectRatio thumbnailSize:thumbnailSize cropRect:cropRect cropScaledPixelSize:cropScaledPixelSize lazyDecode:lazyDecode animatedImage:NO decodeToHDR:decodeToHDR];
     CFRelease(source);
     
     image.sd_imageFormat = imageFormat;
@@ -346,6 +551,10 @@ static NSString * kSDCGImageDestinationEncodeToISOGainmap = @"kCGImageDestinatio
 }
 
 - (NSData *)encodedDataWithImage:(UIImage *)image format:(SDImageFormat)format options:(nullable SDImageCoderOptions *)options {
+    return [self encodedDataWithImage:image format:format options:options attempts:NULL bytesPerPixel:NULL];
+}
+
+- (NSData *)encodedDataWithImage:(UIImage *)image format:(SDImageFormat)format options:(SDImageCoderOptions *)options attempts:(NSUInteger *)attempts bytesPerPixel:(double *)bytesPerPixel {
     if (!image) {
         return nil;
     }
@@ -354,25 +563,79 @@ static NSString * kSDCGImageDestinationEncodeToISOGainmap = @"kCGImageDestinatio
         // Earily return, supports CGImage only
         return nil;
     }
-    if (format == SDImageFormatUndefined) {
-        BOOL hasAlpha = [SDImageCoderHelper CGImageContainsAlpha:imageRef];
-        if (hasAlpha) {
-            format = SDImageFormatPNG;
-        } else {
-            format = SDImageFormatJPEG;
+    format = [self encodingFormatWithImageRef:imageRef format:format];
+    CFStringRef imageUTType = [NSData sd_UTTypeFromImageFormat:format];
+    CGFloat finalPixelSize = 0;
+    NSDictionary *properties = [self encodingPropertiesWithImage:image imageRef:imageRef options:options finalPixelSize:&finalPixelSize];
+    
+    NSUInteger maxFileSize = [options[SDImageCoderEncodeMaxFileSize] unsignedIntegerValue];
+    if (maxFileSize > 0) {
+        double tolerance = 0.1;
+        if (options[SDImageCoderEncodeMaxFileSizeTolerance]) {
+            tolerance = MIN(MAX([options[SDImageCoderEncodeMaxFileSizeTolerance] doubleValue], 0), 1);
         }
+        return SDImageIOEncodeWithMaxFileSize(imageRef, imageUTType, SDImageIOFormatIsLossy(format), properties, maxFileSize, tolerance, attempts, bytesPerPixel);
     }
-
+    
     NSMutableData *imageData = [NSMutableData data];
+    if (!SDImageIOEncodeCGImage(imageRef, imageUTType, properties, imageData)) {
+        imageData = nil;
+    }
+    if (attempts) {
+        *attempts = 1;
+    }
+    if (bytesPerPixel) {
+        *bytesPerPixel = SDImageIOBytesPerPixel(imageData, CGImageGetWidth(imageRef), CGImageGetHeight(imageRef), finalPixelSize);
+    }
+    
+    return [imageData copy];
+}
+
+- (BOOL)encodeImage:(UIImage *)image format:(SDImageFormat)format toURL:(NSURL *)url options:(SDImageCoderOptions *)options {
+    if (!image || !url) {
+        return NO;
+    }
+    CGImageRef imageRef = image.CGImage;
+    if (!imageRef) {
+        return NO;
+    }
+    if ([options[SDImageCoderEncodeMaxFileSize] unsignedIntegerValue] > 0) {
+        // The file size search needs the in-memory attempts
+        NSData *imageData = [self encodedDataWithImage:image format:format options:options];
+        return imageData && [imageData writeToURL:url options:0 error:nil];
+    }
+    format = [self encodingFormatWithImageRef:imageRef format:format];
     CFStringRef imageUTType = [NSData sd_UTTypeFromImageFormat:format];
+    NSDictionary *properties = [self encodingPropertiesWithImage:image imageRef:imageRef options:options finalPixelSize:NULL];
     
-    // Create an image destination.
-    CGImageDestinationRef imageDestination = CGImageDestinationCreateWithData((__bridge CFMutableDataRef)imageData, imageUTType, 1, NULL);
+    // Create an image destination, which writes the encoder output to file directly
+    CGImageDestinationRef imageDestination = CGImageDestinationCreateWithURL((__bridge CFURLRef)url, imageUTType, 1, NULL);
     if (!imageDestination) {
         // Handle failure.
-        return nil;
+        return NO;
     }
+    CGImageDestinationAddImage(imageDestination, imageRef, (__bridge CFDictionaryRef)properties);
+    BOOL success = CGImageDestinationFinalize(imageDestination);
+    CFRelease(imageDestination);
     
+    return success;
+}
+
+#pragma mark - Encode Helper
+
+- (SDImageFormat)encodingFormatWithImageRef:(CGImageRef)imageRef format:(SDImageFormat)format {
+    if (format == SDImageFormatUndefined) {
+        BOOL hasAlpha = [SDImageCoderHelper CGImageContainsAlpha:imageRef];
+        if (hasAlpha) {
+            format = SDImageFormatPNG;
+        } else {
+            format = SDImageFormatJPEG;
+        }
+    }
+    return format;
+}
+
+- (NSDictionary *)encodingPropertiesWithImage:(UIImage *)image imageRef:(CGImageRef)imageRef options:(SDImageCoderOptions *)options finalPixelSize:(CGFloat *)finalPixelSizeRef {
     NSMutableDictionary *properties = [NSMutableDictionary dictionary];
 #if SD_UIKIT || SD_WATCH
     CGImagePropertyOrientation exifOrientation = [SDImageCoderHelper exifOrientationFromImageOrientation:image.imageOrientation];
@@ -429,11 +692,8 @@ static NSString * kSDCGImageDestinationEncodeToISOGainmap = @"kCGImageDestinatio
         }
         properties[(__bridge NSString *)kCGImageDestinationImageMaxPixelSize] = @(finalPixelSize);
     }
-    NSUInteger maxFileSize = [options[SDImageCoderEncodeMaxFileSize] unsignedIntegerValue];
-    if (maxFileSize > 0) {
-        properties[kSDCGImageDestinationRequestedFileSize] = @(maxFileSize);
-        // Remove the quality if we have file size limit
-        properties[(__bridge NSString *)kCGImageDestinationLossyCompressionQuality] = nil;
+    if (finalPixelSizeRef) {
+        *finalPixelSizeRef = finalPixelSize;
     }
     BOOL embedThumbnail = NO;
     if (options[SDImageCoderEncodeEmbedThumbnail]) {
@@ -441,18 +701,7 @@ static NSString * kSDCGImageDestinationEncodeToISOGainmap = @"kCGImageDestinatio
     }
     properties[(__bridge NSString *)kCGImageDestinationEmbedThumbnail] = @(embedThumbnail);
     
-    // Add your image to the destination.
-    CGImageDestinationAddImage(imageDestination, imageRef, (__bridge CFDictionaryRef)properties);
-    
-    // Finalize the destination.
-    if (CGImageDestinationFinalize(imageDestination) == NO) {
-        // Handle failure.
-        imageData = nil;
-    }
-    
-    CFRelease(imageDestination);
-    
-    return [imageData copy];
+    return [properties copy];
 }
 
 @end
@@ -97,6 +97,19 @@ FOUNDATION_EXPORT void SDImageLoaderSetProgressiveCoder(id<SDWebImageOperation>
                       options:(SDWebImageOptions)options
                       context:(nullable SDWebImageContext *)context;
 
+/**
+ The URL schemes (lowercase, such as `https`) which this loader can load. When provided, `SDImageLoadersManager` routes the URL by scheme (and host, see `supportedURLHosts`) through a table, without calling `canRequestImageForURL:` for each request.
+ Return nil if the loader decides dynamically, then `canRequestImageForURL:` is checked instead.
+ @note The value should not change after the loader is added to `SDImageLoadersManager`.
+ */
+@property (nonatomic, copy, readonly, nullable) NSSet<NSString *> *supportedURLSchemes;
+
+/**
+ The URL hosts (lowercase) which this loader can load, only works with `supportedURLSchemes`. Return nil to load all hosts of the supported schemes.
+ @note The value should not change after the loader is added to `SDImageLoadersManager`.
+ */
+@property (nonatomic, copy, readonly, nullable) NSSet<NSString *> *supportedURLHosts;
+
 @required
 /**
  Load the image and image data with the given URL and return the image data. You're responsible for producing the image instance.
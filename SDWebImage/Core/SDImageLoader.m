@@ -10,6 +10,7 @@
 #import "SDWebImageCacheKeyFilter.h"
 #import "SDImageCodersManager.h"
 #import "SDImageCoderHelper.h"
+#import "SDImageAtlas.h"
 #import "SDAnimatedImage.h"
 #import "UIImage+Metadata.h"
 #import "SDInternalMacros.h"
@@ -19,6 +20,7 @@
 SDWebImageContextOption const SDWebImageContextLoaderCachedImage = @"loaderCachedImage";
 
 static void * SDImageLoaderProgressiveCoderKey = &SDImageLoaderProgressiveCoderKey;
+static void * SDImageLoaderProgressiveFrameCountKey = &SDImageLoaderProgressiveFrameCountKey;
 
 id<SDProgressiveImageCoder> SDImageLoaderGetProgressiveCoder(id<SDWebImageOperation> operation) {
     NSCParameterAssert(operation);
@@ -86,7 +88,13 @@ UIImage * _Nullable SDImageLoaderDecodeImageData(NSData * _Nonnull imageData, NS
             policy = SDImageForceDecodePolicyNever;
         }
 #pragma clang diagnostic pop
-        image = [SDImageCoderHelper decodedImageWithImage:image policy:policy];
+        // Drawing into the atlas is also force-decode, the small image does not need its own bitmap
+        SDImageAtlas *atlas = context[SDWebImageContextImageAtlas];
+        UIImage *packedImage;
+        if ([atlas isKindOfClass:SDImageAtlas.class] && policy != SDImageForceDecodePolicyNever) {
+            packedImage = [atlas packedImageWithImage:image];
+        }
+        image = packedImage ?: [SDImageCoderHelper decodedImageWithImage:image policy:policy];
         // assign the decode options, to let manager check whether to re-decode if needed
         image.sd_decodeOptions = coderOptions;
     }
@@ -140,9 +148,16 @@ UIImage * _Nullable SDImageLoaderDecodeProgressiveImageData(NSData * _Nonnull im
         // check whether we should use `SDAnimatedImage`
         Class animatedImageClass = context[SDWebImageContextAnimatedImageClass];
         if ([animatedImageClass isSubclassOfClass:[UIImage class]] && [animatedImageClass conformsToProtocol:@protocol(SDAnimatedImage)] && [progressiveCoder respondsToSelector:@selector(animatedImageFrameAtIndex:)]) {
+            NSUInteger frameCount = [(id<SDAnimatedImageCoder>)progressiveCoder animatedImageFrameCount];
+            NSUInteger previousFrameCount = [objc_getAssociatedObject(operation, SDImageLoaderProgressiveFrameCountKey) unsignedIntegerValue];
+            if (!finished && frameCount > 0 && frameCount == previousFrameCount) {
+                // No new frame received, the running player keeps playing the previous image, avoid publishing the same content again
+                return nil;
+            }
             image = [[animatedImageClass alloc] initWithAnimatedCoder:(id<SDAnimatedImageCoder>)progressiveCoder scale:scale];
             if (image) {
                 // Progressive decoding does not preload frames
+                objc_setAssociatedObject(operation, SDImageLoaderProgressiveFrameCountKey, @(frameCount), OBJC_ASSOCIATION_RETAIN_NONATOMIC);
             } else {
                 // Check image class matching
                 if (options & SDWebImageMatchAnimatedImageClass) {
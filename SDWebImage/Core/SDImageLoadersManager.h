@@ -37,4 +37,16 @@
  */
 - (void)removeLoader:(nonnull id<SDImageLoader>)loader;
 
+/**
+ Returns the loader which can load the URL, with the highest priority.
+ The loaders which declare `supportedURLSchemes` are routed by the URL scheme and host through a table, the other loaders are checked by `canRequestImageForURL:`.
+ @note `SDWebImageManager` resolves the loader once for each request, and use it for loading and the failed URL check.
+ 
+ @param url The image URL to be loaded
+ @param options A mask to specify options to use for this request
+ @param context A context contains different options to perform specify changes or processes, see `SDWebImageContextOption`.
+ @return The loader, or nil if no loader can load the URL
+ */
+- (nullable id<SDImageLoader>)loaderForURL:(nullable NSURL *)url options:(SDWebImageOptions)options context:(nullable SDWebImageContext *)context;
+
 @end
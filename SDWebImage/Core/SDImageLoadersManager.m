@@ -10,6 +10,43 @@
 #import "SDWebImageDownloader.h"
 #import "SDInternalMacros.h"
 
+static inline BOOL SDImageLoaderCanRequestImage(id<SDImageLoader> loader, NSURL *url, SDWebImageOptions options, SDWebImageContext *context) {
+    if ([loader respondsToSelector:@selector(canRequestImageForURL:options:context:)]) {
+        return [loader canRequestImageForURL:url options:options context:context];
+    } else {
+        return [loader canRequestImageForURL:url];
+    }
+}
+
+/// The routing entry for loader, with the declared URL schemes and hosts
+@interface SDImageLoaderRoute : NSObject
+
+@property (nonatomic, strong, readonly, nonnull) id<SDImageLoader> loader;
+/// nil means the loader decide dynamically by `canRequestImageForURL:`
+@property (nonatomic, copy, readonly, nullable) NSSet<NSString *> *schemes;
+/// nil means all hosts
+@property (nonatomic, copy, readonly, nullable) NSSet<NSString *> *hosts;
+
+@end
+
+@implementation SDImageLoaderRoute
+
+- (instancetype)initWithLoader:(id<SDImageLoader>)loader {
+    self = [super init];
+    if (self) {
+        _loader = loader;
+        NSSet<NSString *> *schemes = [loader respondsToSelector:@selector(supportedURLSchemes)] ? loader.supportedURLSchemes : nil;
+        if (schemes) {
+            _schemes = [schemes valueForKey:@"lowercaseString"];
+            NSSet<NSString *> *hosts = [loader respondsToSelector:@selector(supportedURLHosts)] ? loader.supportedURLHosts : nil;
+            _hosts = [hosts valueForKey:@"lowercaseString"];
+        }
+    }
+    return self;
+}
+
+@end
+
 @interface SDImageLoadersManager ()
 
 @property (nonatomic, strong, nonnull) NSMutableArray<id<SDImageLoader>> *imageLoaders;
@@ -18,6 +55,11 @@
 
 @implementation SDImageLoadersManager {
     SD_LOCK_DECLARE(_loadersLock);
+    // The routing table, built lazily and invalidated when loaders changed
+    // scheme -> routes in priority order, contains the loaders declared the scheme and the dynamic loaders
+    NSDictionary<NSString *, NSArray<SDImageLoaderRoute *> *> *_schemeRoutes;
+    // The dynamic loaders only, for the scheme no loader declared
+    NSArray<SDImageLoaderRoute *> *_dynamicRoutes;
 }
 
 + (SDImageLoadersManager *)sharedManager {
@@ -52,6 +94,7 @@
     if (loaders.count) {
         [_imageLoaders addObjectsFromArray:loaders];
     }
+    [self invalidateRoutes];
     SD_UNLOCK(_loadersLock);
 }
 
@@ -63,6 +106,7 @@
     }
     SD_LOCK(_loadersLock);
     [_imageLoaders addObject:loader];
+    [self invalidateRoutes];
     SD_UNLOCK(_loadersLock);
 }
 
@@ -72,52 +116,108 @@
     }
     SD_LOCK(_loadersLock);
     [_imageLoaders removeObject:loader];
+    [self invalidateRoutes];
     SD_UNLOCK(_loadersLock);
 }
 
-#pragma mark - SDImageLoader
+#pragma mark - Routing
 
-- (BOOL)canRequestImageForURL:(nullable NSURL *)url {
-    return [self canRequestImageForURL:url options:0 context:nil];
+// Call with `_loadersLock` locked
+- (void)invalidateRoutes {
+    _schemeRoutes = nil;
+    _dynamicRoutes = nil;
 }
 
-- (BOOL)canRequestImageForURL:(NSURL *)url options:(SDWebImageOptions)options context:(SDWebImageContext *)context {
-    NSArray<id<SDImageLoader>> *loaders = self.loaders;
-    for (id<SDImageLoader> loader in loaders.reverseObjectEnumerator) {
-        if ([loader respondsToSelector:@selector(canRequestImageForURL:options:context:)]) {
-            if ([loader canRequestImageForURL:url options:options context:context]) {
-                return YES;
-            }
+// Call with `_loadersLock` locked
+- (void)buildRoutesIfNeeded {
+    if (_schemeRoutes) {
+        return;
+    }
+    NSMutableArray<SDImageLoaderRoute *> *routes = [NSMutableArray arrayWithCapacity:_imageLoaders.count];
+    NSMutableArray<SDImageLoaderRoute *> *dynamicRoutes = [NSMutableArray array];
+    NSMutableSet<NSString *> *schemes = [NSMutableSet set];
+    for (id<SDImageLoader> loader in _imageLoaders.reverseObjectEnumerator) {
+        SDImageLoaderRoute *route = [[SDImageLoaderRoute alloc] initWithLoader:loader];
+        [routes addObject:route];
+        if (route.schemes) {
+            [schemes unionSet:route.schemes];
         } else {
-            if ([loader canRequestImageForURL:url]) {
-                return YES;
+            [dynamicRoutes addObject:route];
+        }
+    }
+    NSMutableDictionary<NSString *, NSArray<SDImageLoaderRoute *> *> *schemeRoutes = [NSMutableDictionary dictionaryWithCapacity:schemes.count];
+    for (NSString *scheme in schemes) {
+        NSMutableArray<SDImageLoaderRoute *> *candidateRoutes = [NSMutableArray array];
+        for (SDImageLoaderRoute *route in routes) {
+            if (!route.schemes || [route.schemes containsObject:scheme]) {
+                [candidateRoutes addObject:route];
             }
         }
+        schemeRoutes[scheme] = [candidateRoutes copy];
     }
-    return NO;
+    _schemeRoutes = [schemeRoutes copy];
+    _dynamicRoutes = [dynamicRoutes copy];
 }
 
-- (id<SDWebImageOperation>)requestImageWithURL:(NSURL *)url options:(SDWebImageOptions)options context:(SDWebImageContext *)context progress:(SDImageLoaderProgressBlock)progressBlock completed:(SDImageLoaderCompletedBlock)completedBlock {
+- (id<SDImageLoader>)loaderForURL:(NSURL *)url options:(SDWebImageOptions)options context:(SDWebImageContext *)context {
     if (!url) {
         return nil;
     }
-    NSArray<id<SDImageLoader>> *loaders = self.loaders;
-    for (id<SDImageLoader> loader in loaders.reverseObjectEnumerator) {
-        if ([loader canRequestImageForURL:url]) {
-            return [loader requestImageWithURL:url options:options context:context progress:progressBlock completed:completedBlock];
+    NSString *scheme = url.scheme.lowercaseString;
+    SD_LOCK(_loadersLock);
+    [self buildRoutesIfNeeded];
+    NSArray<SDImageLoaderRoute *> *routes = (scheme ? _schemeRoutes[scheme] : nil) ?: _dynamicRoutes;
+    SD_UNLOCK(_loadersLock);
+    
+    NSString *host;
+    for (SDImageLoaderRoute *route in routes) {
+        if (!route.schemes) {
+            if (SDImageLoaderCanRequestImage(route.loader, url, options, context)) {
+                return route.loader;
+            }
+        } else if (!route.hosts) {
+            return route.loader;
+        } else {
+            if (!host) {
+                host = url.host.lowercaseString ?: @"";
+            }
+            if ([route.hosts containsObject:host]) {
+                return route.loader;
+            }
         }
     }
     return nil;
 }
 
+#pragma mark - SDImageLoader
+
+- (BOOL)canRequestImageForURL:(nullable NSURL *)url {
+    return [self canRequestImageForURL:url options:0 context:nil];
+}
+
+- (BOOL)canRequestImageForURL:(NSURL *)url options:(SDWebImageOptions)options context:(SDWebImageContext *)context {
+    return [self loaderForURL:url options:options context:context] != nil;
+}
+
+- (id<SDWebImageOperation>)requestImageWithURL:(NSURL *)url options:(SDWebImageOptions)options context:(SDWebImageContext *)context progress:(SDImageLoaderProgressBlock)progressBlock completed:(SDImageLoaderCompletedBlock)completedBlock {
+    id<SDImageLoader> loader = [self loaderForURL:url options:options context:context];
+    return [loader requestImageWithURL:url options:options context:context progress:progressBlock completed:completedBlock];
+}
+
 - (BOOL)shouldBlockFailedURLWithURL:(NSURL *)url error:(NSError *)error {
-    NSArray<id<SDImageLoader>> *loaders = self.loaders;
-    for (id<SDImageLoader> loader in loaders.reverseObjectEnumerator) {
-        if ([loader canRequestImageForURL:url]) {
-            return [loader shouldBlockFailedURLWithURL:url error:error];
-        }
+    return [self shouldBlockFailedURLWithURL:url error:error options:0 context:nil];
+}
+
+- (BOOL)shouldBlockFailedURLWithURL:(NSURL *)url error:(NSError *)error options:(SDWebImageOptions)options context:(SDWebImageContext *)context {
+    id<SDImageLoader> loader = [self loaderForURL:url options:options context:context];
+    if (!loader) {
+        return NO;
+    }
+    if ([loader respondsToSelector:@selector(shouldBlockFailedURLWithURL:error:options:context:)]) {
+        return [loader shouldBlockFailedURLWithURL:url error:error options:options context:context];
+    } else {
+        return [loader shouldBlockFailedURLWithURL:url error:error];
     }
-    return NO;
 }
 
 @end
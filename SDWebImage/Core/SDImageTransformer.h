@@ -8,6 +8,7 @@
 
 #import "SDWebImageCompat.h"
 #import "UIImage+Transform.h"
+#import "SDImageCoder.h"
 
 /**
  Return the transformed cache key which applied with specify transformerKey.
@@ -28,6 +29,17 @@ FOUNDATION_EXPORT NSString * _Nullable SDTransformedKeyForKey(NSString * _Nullab
  */
 FOUNDATION_EXPORT NSString * _Nullable SDThumbnailedKeyForKey(NSString * _Nullable key, CGSize thumbnailPixelSize, BOOL preserveAspectRatio);
 
+/**
+ Return the decode options which decode the transformed image directly from the image data (region-of-interest decoding), instead of decoding the full image and transforming.
+ Currently supports the `SDImageCroppingTransformer`, or the `SDImagePipelineTransformer` which starts with the `SDImageCroppingTransformer` (and optional following `SDImageResizingTransformer` with `.fill` scale mode).
+ @param transformer The transformer
+ @param scale The image scale factor, since the transformer use point instead of pixel
+ @param remainingTransformer The transformer which still need to be applied on the decoded image, or nil if the whole transformer is pushed down into decoding
+ @return The decode options contains `SDImageCoderDecodeCropRect` and `SDImageCoderDecodeCropScaledPixelSize`, or nil if the transformer can not be pushed down into decoding
+ @note `SDWebImageManager` use this when `SDWebImageContextImageTransformerPushDown` is enabled.
+ */
+FOUNDATION_EXPORT SDImageCoderOptions * _Nullable SDImageTransformerDecodeOptions(id<SDImageTransformer> _Nullable transformer, CGFloat scale, id<SDImageTransformer> _Nullable * _Nullable remainingTransformer);
+
 /**
  A transformer protocol to transform the image load from cache or from download.
  You can provide transformer to cache and manager (Through the `transformer` property or context option `SDWebImageContextImageTransformer`).
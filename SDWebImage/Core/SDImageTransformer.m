@@ -44,6 +44,51 @@ NSString * _Nullable SDThumbnailedKeyForKey(NSString * _Nullable key, CGSize thu
     return SDTransformedKeyForKey(key, thumbnailKey);
 }
 
+SDImageCoderOptions * _Nullable SDImageTransformerDecodeOptions(id<SDImageTransformer> _Nullable transformer, CGFloat scale, id<SDImageTransformer> _Nullable * _Nullable remainingTransformer) {
+    NSArray<id<SDImageTransformer>> *transformers;
+    // Subclass may override the transform logic, check the exact class
+    if ([transformer isMemberOfClass:SDImagePipelineTransformer.class]) {
+        transformers = ((SDImagePipelineTransformer *)transformer).transformers;
+    } else if (transformer) {
+        transformers = @[transformer];
+    }
+    id<SDImageTransformer> croppingTransformer = transformers.firstObject;
+    if (![croppingTransformer isMemberOfClass:SDImageCroppingTransformer.class]) {
+        return nil;
+    }
+    scale = MAX(scale, 1);
+    // Match `sd_croppedImageWithRect:`, which use the pixel rect on CGImage
+    CGRect rect = ((SDImageCroppingTransformer *)croppingTransformer).rect;
+    CGRect cropRect = CGRectMake(rect.origin.x * scale, rect.origin.y * scale, rect.size.width * scale, rect.size.height * scale);
+    if (cropRect.size.width <= 0 || cropRect.size.height <= 0) {
+        return nil;
+    }
+    SDImageCoderMutableOptions *decodeOptions = [NSMutableDictionary dictionaryWithCapacity:2];
+    decodeOptions[SDImageCoderDecodeCropRect] = @(cropRect);
+    NSUInteger pushDownCount = 1;
+    if (transformers.count > 1 && [transformers[1] isMemberOfClass:SDImageResizingTransformer.class]) {
+        SDImageResizingTransformer *resizingTransformer = (SDImageResizingTransformer *)transformers[1];
+        CGSize size = resizingTransformer.size;
+        // Only the stretching one keep the same canvas as decoded region, the aspect fit/fill draw into a larger canvas
+        if (resizingTransformer.scaleMode == SDImageScaleModeFill && size.width > 0 && size.height > 0) {
+            CGSize scaledPixelSize = CGSizeMake(round(size.width * scale), round(size.height * scale));
+            decodeOptions[SDImageCoderDecodeCropScaledPixelSize] = @(scaledPixelSize);
+            pushDownCount = 2;
+        }
+    }
+    if (remainingTransformer) {
+        NSArray<id<SDImageTransformer>> *remainingTransformers = [transformers subarrayWithRange:NSMakeRange(pushDownCount, transformers.count - pushDownCount)];
+        if (remainingTransformers.count == 0) {
+            *remainingTransformer = nil;
+        } else if (remainingTransformers.count == 1) {
+            *remainingTransformer = remainingTransformers.firstObject;
+        } else {
+            *remainingTransformer = [SDImagePipelineTransformer transformerWithTransformers:remainingTransformers];
+        }
+    }
+    return [decodeOptions copy];
+}
+
 @interface SDImagePipelineTransformer ()
 
 @property (nonatomic, copy, readwrite, nonnull) NSArray<id<SDImageTransformer>> *transformers;
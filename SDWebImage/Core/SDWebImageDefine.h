@@ -277,6 +277,12 @@ FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextImageT
  */
 FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextImageForceDecodePolicy;
 
+/**
+ A SDImageAtlas instance which packs the small decoded images into its shared bitmaps. If you provide one, the static image not larger than the atlas's `maxImagePixelSize` is drawn into the atlas instead of force-decoding into its own bitmap. This can reduce the memory overhead and allocation churn for screens with many tiny icons. (SDImageAtlas)
+ @note This is ignored when the force decode policy is `SDImageForceDecodePolicyNever`, because packing is also force-decode.
+ */
+FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextImageAtlas;
+
 #pragma mark - Image Decoder Context Options
 
 /**
@@ -335,6 +341,14 @@ FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextImageS
  */
 FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextImageDecodeToHDR;
 
+/**
+ A Bool value (NSNumber) to push the transformer down into decoding when possible, which decode the transformed region directly from the image data (region-of-interest decoding), instead of decoding the full image and transforming. This save the CPU and memory for large image with `SDImageCroppingTransformer`, see `SDImageTransformerDecodeOptions` for the supported transformers.
+ If the coder does not support region-of-interest decoding (the result image's `sd_isRegionDecoded` is NO), the transformer is applied as usual.
+ @note This is ignored when the `.imageThumbnailPixelSize` or `.imageScaleDownLimitBytes` is provided. The region decoded image is not stored into the original memory cache, like the thumbnail.
+ Defaults to YES for `SDWebImageManager`, unless the `.originalStoreCacheType` contains memory cache, which need the full image. (NSNumber)
+ */
+FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextImageTransformerPushDown;
+
 #pragma mark - Cache Context Options
 
 /**
@@ -376,6 +390,35 @@ FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextOrigin
  */
 FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextOriginalImageCache;
 
+/**
+ A double value which specify the cost to re-fetch the image in seconds, such as the observed download latency. This is used by the disk cache eviction policy (see `SDImageCacheConfig.diskEvictionPolicy`) to keep the images which are expensive to fetch again. (NSNumber)
+ @note The manager fills this with the time from loader request to completion. You can provide one to override it, for example the latency measured by your custom loader.
+ */
+FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextImageFetchCost;
+
+/**
+ A NSDate value which specify the expiration date of the image in disk cache, this is only used when `SDImageCacheConfig.shouldRespectHTTPCacheExpiration` is enabled. The `distantFuture` means never expire. (NSDate)
+ @note The manager fills this with the download's HTTP caching headers (see `SDWebImageDownloadToken.cacheExpirationDate`). You can provide one to override it.
+ */
+FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextImageCacheExpirationDate;
+
+/**
+ A NSURL value which specify the URL of low-quality preview image, such as the small thumbnail generated by server. The manager loads the preview with high priority along with the full image, and calls the completion block with the preview image and `finished` NO, so the view category shows it until the full image is ready. The preview is discarded once the full image pipeline delivers any image (including the progressive partial image), or if the full image completes first. (NSURL)
+ @note The preview shares the context with the full image, such as the transformer and cache.
+ @note Use `SDWebImageTransition` to crossfade from the preview to the full image, cancelling the load operation cancels the preview as well.
+ */
+FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextImagePreviewURL;
+
+/**
+ A NSString value which specify the BlurHash of the image, see `UIImage+BlurHash`. The manager decodes it in memory and uses it as the preview before the full image, the same as `SDWebImageContextImagePreviewURL`. If both are provided, the BlurHash is shown first, then the preview URL. (NSString)
+ */
+FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextImagePreviewBlurHash;
+
+/**
+ A NSData value which specify the ThumbHash of the image, or a NSString value of its base64 encoding, see `UIImage+ThumbHash`. The same as `SDWebImageContextImagePreviewBlurHash`, but keeps the aspect ratio and alpha channel. If both are provided, the BlurHash is used. (NSData/NSString)
+ */
+FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextImagePreviewThumbHash;
+
 /**
  A Class object which the instance is a `UIImage/NSImage` subclass and adopt `SDAnimatedImage` protocol. We will call `initWithData:scale:options:` to create the instance (or `initWithAnimatedCoder:scale:` when using progressive download) . If the instance create failed, fallback to normal `UIImage/NSImage`.
  This can be used to improve animated images rendering performance (especially memory usage on big animated images) with `SDAnimatedImageView` (Class).
@@ -142,6 +142,7 @@ SDWebImageContextOption const SDWebImageContextImageLoader = @"imageLoader";
 SDWebImageContextOption const SDWebImageContextImageCoder = @"imageCoder";
 SDWebImageContextOption const SDWebImageContextImageTransformer = @"imageTransformer";
 SDWebImageContextOption const SDWebImageContextImageForceDecodePolicy = @"imageForceDecodePolicy";
+SDWebImageContextOption const SDWebImageContextImageAtlas = @"imageAtlas";
 SDWebImageContextOption const SDWebImageContextImageDecodeOptions = @"imageDecodeOptions";
 SDWebImageContextOption const SDWebImageContextImageScaleFactor = @"imageScaleFactor";
 SDWebImageContextOption const SDWebImageContextImagePreserveAspectRatio = @"imagePreserveAspectRatio";
@@ -149,12 +150,18 @@ SDWebImageContextOption const SDWebImageContextImageThumbnailPixelSize = @"image
 SDWebImageContextOption const SDWebImageContextImageTypeIdentifierHint = @"imageTypeIdentifierHint";
 SDWebImageContextOption const SDWebImageContextImageScaleDownLimitBytes = @"imageScaleDownLimitBytes";
 SDWebImageContextOption const SDWebImageContextImageDecodeToHDR = @"imageDecodeToHDR";
+SDWebImageContextOption const SDWebImageContextImageTransformerPushDown = @"imageTransformerPushDown";
 SDWebImageContextOption const SDWebImageContextImageEncodeOptions = @"imageEncodeOptions";
 SDWebImageContextOption const SDWebImageContextQueryCacheType = @"queryCacheType";
 SDWebImageContextOption const SDWebImageContextStoreCacheType = @"storeCacheType";
 SDWebImageContextOption const SDWebImageContextOriginalQueryCacheType = @"originalQueryCacheType";
 SDWebImageContextOption const SDWebImageContextOriginalStoreCacheType = @"originalStoreCacheType";
 SDWebImageContextOption const SDWebImageContextOriginalImageCache = @"originalImageCache";
+SDWebImageContextOption const SDWebImageContextImageFetchCost = @"imageFetchCost";
+SDWebImageContextOption const SDWebImageContextImageCacheExpirationDate = @"imageCacheExpirationDate";
+SDWebImageContextOption const SDWebImageContextImagePreviewURL = @"imagePreviewURL";
+SDWebImageContextOption const SDWebImageContextImagePreviewBlurHash = @"imagePreviewBlurHash";
+SDWebImageContextOption const SDWebImageContextImagePreviewThumbHash = @"imagePreviewThumbHash";
 SDWebImageContextOption const SDWebImageContextAnimatedImageClass = @"animatedImageClass";
 SDWebImageContextOption const SDWebImageContextDownloadRequestModifier = @"downloadRequestModifier";
 SDWebImageContextOption const SDWebImageContextDownloadResponseModifier = @"downloadResponseModifier";
@@ -139,6 +139,12 @@ typedef SDImageLoaderCompletedBlock SDWebImageDownloaderCompletedBlock;
  */
 @property (nonatomic, strong, nullable, readonly) NSURLSessionTaskMetrics *metrics API_AVAILABLE(macos(10.12), ios(10.0), watchos(3.0), tvos(10.0));
 
+/**
+ The expiration date from the download's HTTP response caching headers. The `Cache-Control: immutable` returns `distantFuture`, then `max-age` (minus `Age`) and `Expires` are checked, and `no-cache` or `no-store` returns the response date. This will be nil if the response does not have these headers.
+ @note This is used for the per-entry expiration of disk cache, see `SDImageCacheConfig.shouldRespectHTTPCacheExpiration`.
+ */
+@property (nonatomic, strong, nullable, readonly) NSDate *cacheExpirationDate;
+
 @end
 
 
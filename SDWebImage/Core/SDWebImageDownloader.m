@@ -545,6 +545,81 @@ didReceiveResponse:(NSURLResponse *)response
 
 @end
 
+// The HTTP-date in `Expires` and `Date` headers, RFC 7231
+static NSDate * _Nullable SDDateFromHTTPDateString(NSString * _Nullable string) {
+    if (string.length == 0) {
+        return nil;
+    }
+    static NSDateFormatter *formatter;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        formatter = [NSDateFormatter new];
+        formatter.locale = [NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"];
+        formatter.timeZone = [NSTimeZone timeZoneForSecondsFromGMT:0];
+        formatter.dateFormat = @"EEE, dd MMM yyyy HH:mm:ss zzz";
+    });
+    @synchronized (formatter) {
+        return [formatter dateFromString:string];
+    }
+}
+
+// `-[NSHTTPURLResponse valueForHTTPHeaderField:]` is only available on iOS 13+, the header field name is case-insensitive
+static NSString * _Nullable SDHTTPHeaderValue(NSDictionary * _Nonnull headers, NSString * _Nonnull field) {
+    for (NSString *key in headers) {
+        if ([key isKindOfClass:NSString.class] && [key caseInsensitiveCompare:field] == NSOrderedSame) {
+            id value = headers[key];
+            return [value isKindOfClass:NSString.class] ? value : nil;
+        }
+    }
+    return nil;
+}
+
+static NSDate * _Nullable SDCacheExpirationDateFromHTTPResponse(NSHTTPURLResponse * _Nonnull response) {
+    NSDictionary *headers = response.allHeaderFields;
+    NSDate *now = [NSDate date];
+    NSString *cacheControl = [SDHTTPHeaderValue(headers, @"Cache-Control") lowercaseString];
+    if (cacheControl.length > 0) {
+        // Scan all the directives first, the order in header does not matter
+        BOOL noCache = NO;
+        BOOL immutable = NO;
+        NSTimeInterval maxAge = -1;
+        for (NSString *component in [cacheControl componentsSeparatedByString:@","]) {
+            NSString *directive = [component stringByTrimmingCharactersInSet:NSCharacterSet.whitespaceCharacterSet];
+            if ([directive isEqualToString:@"immutable"]) {
+                immutable = YES;
+            } else if ([directive isEqualToString:@"no-cache"] || [directive isEqualToString:@"no-store"]) {
+                noCache = YES;
+            } else if ([directive hasPrefix:@"max-age="]) {
+                maxAge = [directive substringFromIndex:@"max-age=".length].doubleValue;
+            }
+        }
+        // The response which must not be reused wins over the others
+        if (noCache) {
+            return now;
+        }
+        if (immutable) {
+            return [NSDate distantFuture];
+        }
+        if (maxAge >= 0) {
+            // The response may be already stored in the shared cache for a while
+            NSTimeInterval age = MAX(SDHTTPHeaderValue(headers, @"Age").doubleValue, 0);
+            return [now dateByAddingTimeInterval:MAX(maxAge - age, 0)];
+        }
+    }
+    NSString *expiresString = SDHTTPHeaderValue(headers, @"Expires");
+    NSDate *expires = SDDateFromHTTPDateString(expiresString);
+    if (!expires) {
+        // The invalid date like "0" means already expired
+        return expiresString ? now : nil;
+    }
+    // Use the lifetime relative to server date, the device clock may be wrong
+    NSDate *date = SDDateFromHTTPDateString(SDHTTPHeaderValue(headers, @"Date"));
+    if (date) {
+        return [now dateByAddingTimeInterval:MAX([expires timeIntervalSinceDate:date], 0)];
+    }
+    return expires;
+}
+
 @implementation SDWebImageDownloadToken
 
 - (void)dealloc {
@@ -562,6 +637,19 @@ didReceiveResponse:(NSURLResponse *)response
     return self;
 }
 
+- (NSURLResponse *)response {
+    // The response notification is delivered on main queue, read from the operation if not delivered yet
+    return _response ?: self.downloadOperation.response;
+}
+
+- (NSDate *)cacheExpirationDate {
+    NSURLResponse *response = self.response;
+    if (![response isKindOfClass:NSHTTPURLResponse.class]) {
+        return nil;
+    }
+    return SDCacheExpirationDateFromHTTPResponse((NSHTTPURLResponse *)response);
+}
+
 - (void)downloadDidReceiveResponse:(NSNotification *)notification {
     NSOperation<SDWebImageDownloaderOperation> *downloadOperation = notification.object;
     if (downloadOperation && downloadOperation == self.downloadOperation) {
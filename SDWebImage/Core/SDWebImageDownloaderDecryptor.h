@@ -12,7 +12,7 @@
 typedef NSData * _Nullable (^SDWebImageDownloaderDecryptorBlock)(NSData * _Nonnull data, NSURLResponse * _Nullable response);
 
 /**
-This is the protocol for downloader decryptor. Which decrypt the original encrypted data before decoding. Note progressive decoding is not compatible for decryptor.
+This is the protocol for downloader decryptor. Which decrypt the original encrypted data before decoding. Note progressive decoding is not compatible for decryptor, unless it's `SDWebImageDownloaderIncrementalDecryptor`.
 We can use a block to specify the downloader decryptor. But Using protocol can make this extensible, and allow Swift user to use it easily instead of using `@convention(block)` to store a block into context options.
 */
 @protocol SDWebImageDownloaderDecryptor <NSObject>
@@ -25,6 +25,36 @@ We can use a block to specify the downloader decryptor. But Using protocol can m
 
 @end
 
+/**
+This is the protocol for the per-download decrypting state of incremental decryptor. It's created for each download, so it can keep the state between chunks, such as the cipher context or the undecoded bytes.
+The methods are called serially on the URLSession delegate queue.
+*/
+@protocol SDWebImageDownloaderDecryptStream <NSObject>
+
+/// Decrypt the received chunk of the original download data.
+/// @param data The received chunk
+/// @return The decrypted bytes available now, which can be empty if more data is needed. If nil is returned, the download is cancelled and marked as failed with error `SDWebImageErrorBadImageData`
+- (nullable NSData *)updateWithData:(nonnull NSData *)data;
+
+/// Finish the decrypting when the download completed.
+/// @return The remaining decrypted bytes, which can be empty. If nil is returned, the image download will be marked as failed with error `SDWebImageErrorBadImageData`
+- (nullable NSData *)finish;
+
+@end
+
+/**
+This is the protocol for incremental downloader decryptor, which decrypt the data chunk by chunk during downloading, instead of the complete data at completion. This overlap the decryption with network transfer, avoid an extra full copy of data, and keep the progressive decoding works.
+It's suitable for stream cipher or encoding (such as base64). The `decryptedDataWithData:response:` is still used when the incremental decrypting is not available.
+*/
+@protocol SDWebImageDownloaderIncrementalDecryptor <SDWebImageDownloaderDecryptor>
+
+/// Create a new decrypt stream for the download.
+/// @param response The URL response for data. If you modify the original URL response via response modifier, the modified version will be here. This arg is nullable.
+/// @return The decrypt stream, or nil to fallback to decrypt the complete data at completion.
+- (nullable id<SDWebImageDownloaderDecryptStream>)decryptStreamWithResponse:(nullable NSURLResponse *)response;
+
+@end
+
 /**
 A downloader response modifier class with block.
 */
@@ -46,7 +76,7 @@ A downloader response modifier class with block.
 /// Convenience way to create decryptor for common data encryption.
 @interface SDWebImageDownloaderDecryptor (Conveniences)
 
-/// Base64 Encoded image data decryptor
+/// Base64 Encoded image data decryptor. This supports incremental decrypting.
 @property (class, readonly, nonnull) SDWebImageDownloaderDecryptor *base64Decryptor;
 
 @end
@@ -38,13 +38,86 @@
 
 @end
 
+static inline BOOL SDIsBase64Character(uint8_t c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '+' || c == '/' || c == '=';
+}
+
+/// Decode the base64 characters by quantum (4 characters), keep the remaining characters until next chunk
+@interface SDWebImageBase64DecryptStream : NSObject <SDWebImageDownloaderDecryptStream>
+
+@end
+
+@implementation SDWebImageBase64DecryptStream {
+    NSMutableData *_buffer;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _buffer = [NSMutableData data];
+    }
+    return self;
+}
+
+- (NSData *)updateWithData:(NSData *)data {
+    NSMutableData *buffer = _buffer;
+    // Skip the unknown characters (like line breaks), same as `NSDataBase64DecodingIgnoreUnknownCharacters`
+    [data enumerateByteRangesUsingBlock:^(const void * _Nonnull bytes, NSRange byteRange, BOOL * _Nonnull stop) {
+        const uint8_t *chars = bytes;
+        NSUInteger start = 0;
+        for (NSUInteger i = 0; i < byteRange.length; i++) {
+            if (!SDIsBase64Character(chars[i])) {
+                if (i > start) {
+                    [buffer appendBytes:chars + start length:i - start];
+                }
+                start = i + 1;
+            }
+        }
+        if (byteRange.length > start) {
+            [buffer appendBytes:chars + start length:byteRange.length - start];
+        }
+    }];
+    NSUInteger length = buffer.length / 4 * 4;
+    if (length == 0) {
+        return [NSData data];
+    }
+    NSData *quantumData = [NSData dataWithBytesNoCopy:buffer.mutableBytes length:length freeWhenDone:NO];
+    NSData *decodedData = [[NSData alloc] initWithBase64EncodedData:quantumData options:0];
+    [buffer replaceBytesInRange:NSMakeRange(0, length) withBytes:NULL length:0];
+    return decodedData;
+}
+
+- (NSData *)finish {
+    if (_buffer.length == 0) {
+        return [NSData data];
+    }
+    // Not a complete quantum, let the decoder check whether it's valid
+    NSData *decodedData = [[NSData alloc] initWithBase64EncodedData:_buffer options:0];
+    _buffer.length = 0;
+    return decodedData;
+}
+
+@end
+
+@interface SDWebImageDownloaderBase64Decryptor : SDWebImageDownloaderDecryptor <SDWebImageDownloaderIncrementalDecryptor>
+
+@end
+
+@implementation SDWebImageDownloaderBase64Decryptor
+
+- (id<SDWebImageDownloaderDecryptStream>)decryptStreamWithResponse:(NSURLResponse *)response {
+    return [[SDWebImageBase64DecryptStream alloc] init];
+}
+
+@end
+
 @implementation SDWebImageDownloaderDecryptor (Conveniences)
 
 + (SDWebImageDownloaderDecryptor *)base64Decryptor {
     static SDWebImageDownloaderDecryptor *decryptor;
     static dispatch_once_t onceToken;
     dispatch_once(&onceToken, ^{
-        decryptor = [SDWebImageDownloaderDecryptor decryptorWithBlock:^NSData * _Nullable(NSData * _Nonnull data, NSURLResponse * _Nullable response) {
+        decryptor = [[SDWebImageDownloaderBase64Decryptor alloc] initWithBlock:^NSData * _Nullable(NSData * _Nonnull data, NSURLResponse * _Nullable response) {
             NSData *modifiedData = [[NSData alloc] initWithBase64EncodedData:data options:NSDataBase64DecodingIgnoreUnknownCharacters];
             return modifiedData;
         }];
@@ -13,6 +13,9 @@
 #import "SDWebImageDownloaderDecryptor.h"
 #import "SDImageCacheDefine.h"
 #import "SDCallbackQueue.h"
+#import "SDImageCoderHelper.h"
+#import "SDAnimatedImage.h"
+#import "UIImage+Metadata.h"
 
 // A handler to represent individual request
 @interface SDWebImageDownloaderOperationToken : NSObject
@@ -43,6 +46,148 @@
 
 @end
 
+static inline CGSize SDDecodeOptionsThumbnailPixelSize(SDImageCoderOptions *options) {
+    CGSize thumbnailSize = CGSizeZero;
+    NSValue *thumbnailSizeValue = options[SDImageCoderDecodeThumbnailPixelSize];
+    if (thumbnailSizeValue != nil) {
+#if SD_MAC
+        thumbnailSize = thumbnailSizeValue.sizeValue;
+#else
+        thumbnailSize = thumbnailSizeValue.CGSizeValue;
+#endif
+    }
+    return thumbnailSize;
+}
+
+static inline BOOL SDDecodeOptionsPreserveAspectRatio(SDImageCoderOptions *options) {
+    NSNumber *preserveAspectRatioValue = options[SDImageCoderDecodePreserveAspectRatio];
+    return preserveAspectRatioValue != nil ? preserveAspectRatioValue.boolValue : YES;
+}
+
+// Whether the variant can be used as the source to derive the smaller thumbnails
+static inline BOOL SDDecodeOptionsIsDerivableSource(id decodeOptions) {
+    if (![decodeOptions isKindOfClass:[NSDictionary class]]) {
+        return NO;
+    }
+    if (decodeOptions[SDImageCoderDecodeScaleDownLimitBytes] != nil || decodeOptions[SDImageCoderDecodeCropRect] != nil) {
+        return NO;
+    }
+    CGSize thumbnailSize = SDDecodeOptionsThumbnailPixelSize(decodeOptions);
+    if (thumbnailSize.width > 0 && thumbnailSize.height > 0) {
+        return SDDecodeOptionsPreserveAspectRatio(decodeOptions);
+    }
+    return YES;
+}
+
+// The full size variant is the largest, else the thumbnail with the largest area
+static NSUInteger SDDecodeOptionsLargestVariantIndex(NSArray<SDImageCoderOptions *> *variants) {
+    NSUInteger largestIndex = NSNotFound;
+    CGFloat largestArea = 0;
+    for (NSUInteger i = 0; i < variants.count; i++) {
+        SDImageCoderOptions *decodeOptions = variants[i];
+        if (!SDDecodeOptionsIsDerivableSource(decodeOptions)) {
+            continue;
+        }
+        CGSize thumbnailSize = SDDecodeOptionsThumbnailPixelSize(decodeOptions);
+        CGFloat area = (thumbnailSize.width > 0 && thumbnailSize.height > 0) ? thumbnailSize.width * thumbnailSize.height : CGFLOAT_MAX;
+        if (largestIndex == NSNotFound || area > largestArea) {
+            largestIndex = i;
+            largestArea = area;
+        }
+    }
+    return largestIndex;
+}
+
+// The thumbnail variant can be derived only when the other decode options are the same, and the downsampling result matches the one decoded from data
+static BOOL SDDecodeOptionsCanDeriveFromOptions(id decodeOptions, SDImageCoderOptions *baseOptions) {
+    if (![decodeOptions isKindOfClass:[NSDictionary class]] || !SDDecodeOptionsIsDerivableSource(baseOptions)) {
+        return NO;
+    }
+    CGSize thumbnailSize = SDDecodeOptionsThumbnailPixelSize(decodeOptions);
+    if (thumbnailSize.width <= 0 || thumbnailSize.height <= 0) {
+        return NO;
+    }
+    NSArray<SDImageCoderOption> *thumbnailKeys = @[SDImageCoderDecodeThumbnailPixelSize, SDImageCoderDecodePreserveAspectRatio];
+    NSMutableDictionary *options = [decodeOptions mutableCopy];
+    [options removeObjectsForKeys:thumbnailKeys];
+    NSMutableDictionary *otherOptions = [baseOptions mutableCopy];
+    [otherOptions removeObjectsForKeys:thumbnailKeys];
+    if (![options isEqualToDictionary:otherOptions]) {
+        return NO;
+    }
+    BOOL preserveAspectRatio = SDDecodeOptionsPreserveAspectRatio(decodeOptions);
+    CGSize baseThumbnailSize = SDDecodeOptionsThumbnailPixelSize(baseOptions);
+    if (baseThumbnailSize.width <= 0 || baseThumbnailSize.height <= 0) {
+#if SD_MAC
+        // AppKit's CGImage is already transformed by EXIF orientation, the stretched thumbnail size does not match
+        return preserveAspectRatio;
+#else
+        return YES;
+#endif
+    }
+    // Aspect fit into the smaller box of a aspect fit image, is the same as aspect fit the full image
+    return preserveAspectRatio && thumbnailSize.width <= baseThumbnailSize.width && thumbnailSize.height <= baseThumbnailSize.height;
+}
+
+static inline BOOL SDImageCanDeriveFromImage(UIImage *image) {
+    if (!image.CGImage || image.sd_isAnimated || image.sd_isVector || image.sd_isRegionDecoded) {
+        return NO;
+    }
+    // Keep the animated image class for `SDWebImageMatchAnimatedImageClass`
+    if ([image.class conformsToProtocol:@protocol(SDAnimatedImage)]) {
+        return NO;
+    }
+    return ![SDImageCoderHelper CGImageIsHDR:image.CGImage];
+}
+
+// Downsample the decoded image into thumbnail, the same result as `SDImageCoderDecodeThumbnailPixelSize`
+static UIImage * SDDerivedImageWithImage(UIImage *image, SDImageCoderOptions *decodeOptions) {
+    CGImageRef cgImage = image.CGImage;
+    if (!cgImage) {
+        return nil;
+    }
+    CGSize thumbnailSize = SDDecodeOptionsThumbnailPixelSize(decodeOptions);
+    BOOL preserveAspectRatio = SDDecodeOptionsPreserveAspectRatio(decodeOptions);
+    CGSize pixelSize = CGSizeMake(CGImageGetWidth(cgImage), CGImageGetHeight(cgImage));
+#if SD_MAC
+    CGImagePropertyOrientation exifOrientation = kCGImagePropertyOrientationUp;
+#else
+    CGImagePropertyOrientation exifOrientation = [SDImageCoderHelper exifOrientationFromImageOrientation:image.imageOrientation];
+#endif
+    // The thumbnail size is for the transformed image, but the CGImage is not transformed
+    if (preserveAspectRatio && exifOrientation >= kCGImagePropertyOrientationLeftMirrored) {
+        thumbnailSize = CGSizeMake(thumbnailSize.height, thumbnailSize.width);
+    }
+    CGImageRef imageRef;
+    BOOL isDecoded;
+    if (pixelSize.width <= thumbnailSize.width && pixelSize.height <= thumbnailSize.height) {
+        imageRef = CGImageRetain(cgImage);
+        isDecoded = image.sd_isDecoded;
+    } else {
+        CGSize scaledSize = thumbnailSize;
+        if (preserveAspectRatio) {
+            scaledSize = [SDImageCoderHelper scaledSizeWithImageSize:pixelSize scaleSize:thumbnailSize preserveAspectRatio:YES shouldScaleUp:NO];
+            scaledSize = CGSizeMake(MAX(round(scaledSize.width), 1), MAX(round(scaledSize.height), 1));
+        }
+        imageRef = [SDImageCoderHelper CGImageCreateScaled:cgImage size:scaledSize];
+        isDecoded = YES;
+    }
+    if (!imageRef) {
+        return nil;
+    }
+    CGFloat scale = MAX([decodeOptions[SDImageCoderDecodeScaleFactor] doubleValue], 1);
+#if SD_UIKIT || SD_WATCH
+    UIImage *derivedImage = [[UIImage alloc] initWithCGImage:imageRef scale:scale orientation:image.imageOrientation];
+#else
+    UIImage *derivedImage = [[UIImage alloc] initWithCGImage:imageRef scale:scale orientation:kCGImagePropertyOrientationUp];
+#endif
+    CGImageRelease(imageRef);
+    derivedImage.sd_isDecoded = isDecoded;
+    derivedImage.sd_imageFormat = image.sd_imageFormat;
+    derivedImage.sd_decodeOptions = decodeOptions;
+    return derivedImage;
+}
+
 @interface SDWebImageDownloaderOperation ()
 
 @property (strong, nonatomic, nonnull) NSMutableArray<SDWebImageDownloaderOperationToken *> *callbackTokens;
@@ -64,6 +209,7 @@
 
 @property (strong, nonatomic, nullable) id<SDWebImageDownloaderResponseModifier> responseModifier; // modify original URLResponse
 @property (strong, nonatomic, nullable) id<SDWebImageDownloaderDecryptor> decryptor; // decrypt image data
+@property (strong, nonatomic, nullable) id<SDWebImageDownloaderDecryptStream> decryptStream; // decrypt image data during downloading, for incremental decryptor
 
 // This is weak because it is injected by whoever manages this session. If this gets nil-ed out, we won't be able to run
 // the task associated with this operation
@@ -361,48 +507,79 @@
                            pendingTokens:(NSArray<SDWebImageDownloaderOperationToken *> *)pendingTokens
                           finishedTokens:(NSArray<SDWebImageDownloaderOperationToken *> *)finishedTokens {
     @weakify(self);
+    // Group the tokens by decode options, each variant of image is decoded only once
+    NSMutableArray<SDImageCoderOptions *> *variants = [NSMutableArray arrayWithCapacity:pendingTokens.count];
+    NSMutableArray<NSMutableArray<SDWebImageDownloaderOperationToken *> *> *variantTokens = [NSMutableArray arrayWithCapacity:pendingTokens.count];
     for (SDWebImageDownloaderOperationToken *token in pendingTokens) {
+        NSUInteger index = token.decodeOptions ? [variants indexOfObject:token.decodeOptions] : NSNotFound;
+        if (index == NSNotFound) {
+            [variants addObject:token.decodeOptions ?: (SDImageCoderOptions *)[NSNull null]];
+            [variantTokens addObject:[NSMutableArray arrayWithObject:token]];
+        } else {
+            [variantTokens[index] addObject:token];
+        }
+    }
+    // The smaller thumbnail variants are derived from the largest variant by downsampling, instead of decoding from the compressed data again
+    NSUInteger baseIndex = SDDecodeOptionsLargestVariantIndex(variants);
+    NSMutableIndexSet *derivedIndexes = [NSMutableIndexSet indexSet];
+    if (baseIndex != NSNotFound) {
+        [variants enumerateObjectsUsingBlock:^(SDImageCoderOptions * _Nonnull decodeOptions, NSUInteger idx, BOOL * _Nonnull stop) {
+            if (idx != baseIndex && SDDecodeOptionsCanDeriveFromOptions(decodeOptions, variants[baseIndex])) {
+                [derivedIndexes addIndex:idx];
+            }
+        }];
+    }
+    [variants enumerateObjectsUsingBlock:^(SDImageCoderOptions * _Nonnull decodeOptions, NSUInteger idx, BOOL * _Nonnull stop) {
+        if ([derivedIndexes containsIndex:idx]) {
+            return;
+        }
+        NSArray<SDWebImageDownloaderOperationToken *> *tokens = variantTokens[idx];
         [self.coderQueue addOperationWithBlock:^{
             @strongify(self);
             if (!self) {
                 return;
             }
-            UIImage *image;
-            // check if we already decode this variant of image for current callback
-            if (token.decodeOptions) {
-                image = [self.imageMap objectForKey:token.decodeOptions];
-            }
-            if (!image) {
-                // check if we already use progressive decoding, use that to produce faster decoding
-                id<SDProgressiveImageCoder> progressiveCoder = SDImageLoaderGetProgressiveCoder(self);
-                SDWebImageOptions options = [[self class] imageOptionsFromDownloaderOptions:self.options];
-                SDWebImageContext *context;
-                if (token.decodeOptions) {
-                    SDWebImageMutableContext *mutableContext = [NSMutableDictionary dictionaryWithDictionary:self.context];
-                    SDSetDecodeOptionsToContext(mutableContext, &options, token.decodeOptions);
-                    context = [mutableContext copy];
-                } else {
-                    context = self.context;
-                }
-                if (progressiveCoder) {
-                    image = SDImageLoaderDecodeProgressiveImageData(imageData, self.request.URL, YES, self, options, context);
-                } else {
-                    image = SDImageLoaderDecodeImageData(imageData, self.request.URL, options, context);
-                }
-                if (image && token.decodeOptions) {
-                    [self.imageMap setObject:image forKey:token.decodeOptions];
-                }
+            SDImageCoderOptions *options = [decodeOptions isKindOfClass:[NSDictionary class]] ? decodeOptions : nil;
+            UIImage *image = [self decodedImageWithImageData:imageData decodeOptions:options];
+            [self callCompletionBlockWithTokens:tokens image:image imageData:imageData];
+            if (idx != baseIndex || derivedIndexes.count == 0) {
+                return;
             }
-            CGSize imageSize = image.size;
-            if (imageSize.width == 0 || imageSize.height == 0) {
-                NSString *description = image == nil ? @"Downloaded image decode failed" : @"Downloaded image has 0 pixels";
-                NSError *error = [NSError errorWithDomain:SDWebImageErrorDomain code:SDWebImageErrorBadImageData userInfo:@{NSLocalizedDescriptionKey : description}];
-                [self callCompletionBlockWithToken:token image:nil imageData:nil error:error finished:YES];
+            NSArray<SDImageCoderOptions *> *derivedVariants = [variants objectsAtIndexes:derivedIndexes];
+            NSArray<NSArray<SDWebImageDownloaderOperationToken *> *> *derivedTokens = [variantTokens objectsAtIndexes:derivedIndexes];
+            NSMutableIndexSet *failedIndexes = [NSMutableIndexSet indexSet];
+            if (SDImageCanDeriveFromImage(image)) {
+                // Downsample in parallel, each token is completed as soon as its variant is ready
+                dispatch_apply(derivedVariants.count, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+                    SDImageCoderOptions *derivedOptions = derivedVariants[i];
+                    UIImage *derivedImage;
+                    @synchronized (self.imageMap) {
+                        derivedImage = [self.imageMap objectForKey:derivedOptions];
+                    }
+                    if (!derivedImage) {
+                        derivedImage = SDDerivedImageWithImage(image, derivedOptions);
+                    }
+                    if (!derivedImage) {
+                        @synchronized (failedIndexes) {
+                            [failedIndexes addIndex:i];
+                        }
+                        return;
+                    }
+                    @synchronized (self.imageMap) {
+                        [self.imageMap setObject:derivedImage forKey:derivedOptions];
+                    }
+                    [self callCompletionBlockWithTokens:derivedTokens[i] image:derivedImage imageData:imageData];
+                });
             } else {
-                [self callCompletionBlockWithToken:token image:image imageData:imageData error:nil finished:YES];
+                [failedIndexes addIndexesInRange:NSMakeRange(0, derivedVariants.count)];
             }
+            // Fallback to decode from data (such as animated image), the progressive coder is not thread-safe, so keep them serial
+            [failedIndexes enumerateIndexesUsingBlock:^(NSUInteger i, BOOL * _Nonnull stop) {
+                UIImage *derivedImage = [self decodedImageWithImageData:imageData decodeOptions:derivedVariants[i]];
+                [self callCompletionBlockWithTokens:derivedTokens[i] image:derivedImage imageData:imageData];
+            }];
         }];
-    }
+    }];
     // call [self done] after all completed block was dispatched
     dispatch_block_t doneBlock = ^{
         @strongify(self);
@@ -487,6 +664,9 @@ didReceiveResponse:(NSURLResponse *)response
     }
     
     if (valid) {
+        if ([self.decryptor conformsToProtocol:@protocol(SDWebImageDownloaderIncrementalDecryptor)]) {
+            self.decryptStream = [(id<SDWebImageDownloaderIncrementalDecryptor>)self.decryptor decryptStreamWithResponse:response];
+        }
         NSArray<SDWebImageDownloaderOperationToken *> *tokens;
         @synchronized (self) {
             tokens = [self.callbackTokens copy];
@@ -514,9 +694,23 @@ didReceiveResponse:(NSURLResponse *)response
     if (!self.imageData) {
         self.imageData = [[NSMutableData alloc] initWithCapacity:self.expectedSize];
     }
-    [self.imageData appendData:data];
-    
-    self.receivedSize = self.imageData.length;
+    // The progress is based on the original download data
+    self.receivedSize += data.length;
+    if (self.decryptStream) {
+        // Only keep the decrypted data
+        NSData *decryptedData = [self.decryptStream updateWithData:data];
+        if (!decryptedData) {
+            self.decryptStream = nil;
+            self.responseError = [NSError errorWithDomain:SDWebImageErrorDomain
+                                                     code:SDWebImageErrorBadImageData
+                                                 userInfo:@{NSLocalizedDescriptionKey : @"Image data decrypt failed"}];
+            [dataTask cancel];
+            return;
+        }
+        [self.imageData appendData:decryptedData];
+    } else {
+        [self.imageData appendData:data];
+    }
     NSArray<SDWebImageDownloaderOperationToken *> *tokens;
     @synchronized (self) {
         tokens = [self.callbackTokens copy];
@@ -543,8 +737,8 @@ didReceiveResponse:(NSURLResponse *)response
     }
     self.previousProgress = currentProgress;
     
-    // Using data decryptor will disable the progressive decoding, since there are no support for progressive decrypt
-    BOOL supportProgressive = (self.options & SDWebImageDownloaderProgressiveLoad) && !self.decryptor;
+    // Using data decryptor will disable the progressive decoding, unless it's incremental decryptor
+    BOOL supportProgressive = (self.options & SDWebImageDownloaderProgressiveLoad) && (!self.decryptor || self.decryptStream);
     // When multiple thumbnail decoding use different size, this progressive decoding will cause issue because each callback assume called with different size's image, can not share the same decoding part
     // We currently only pick the first thumbnail size, see #3423 talks
     // Progressive decoding Only decode partial image, full image in `URLSession:task:didCompleteWithError:`
@@ -633,7 +827,15 @@ didReceiveResponse:(NSURLResponse *)response
         if (tokens.count > 0) {
             NSData *imageData = self.imageData;
             // data decryptor
-            if (imageData && self.decryptor) {
+            if (self.decryptStream) {
+                NSData *remainingData = [self.decryptStream finish];
+                if (remainingData) {
+                    [self.imageData appendData:remainingData];
+                } else {
+                    imageData = nil;
+                }
+                self.decryptStream = nil;
+            } else if (imageData && self.decryptor) {
                 imageData = [self.decryptor decryptedDataWithData:imageData response:self.response];
             }
             if (imageData) {
@@ -743,6 +945,57 @@ didReceiveResponse:(NSURLResponse *)response
     }
 }
 
+- (nullable UIImage *)decodedImageWithImageData:(nonnull NSData *)imageData decodeOptions:(nullable SDImageCoderOptions *)decodeOptions {
+    UIImage *image;
+    // check if we already decode this variant of image for current callback
+    if (decodeOptions) {
+        @synchronized (self.imageMap) {
+            image = [self.imageMap objectForKey:decodeOptions];
+        }
+    }
+    if (!image) {
+        // check if we already use progressive decoding, use that to produce faster decoding
+        id<SDProgressiveImageCoder> progressiveCoder = SDImageLoaderGetProgressiveCoder(self);
+        SDWebImageOptions options = [[self class] imageOptionsFromDownloaderOptions:self.options];
+        SDWebImageContext *context;
+        if (decodeOptions) {
+            SDWebImageMutableContext *mutableContext = [NSMutableDictionary dictionaryWithDictionary:self.context];
+            SDSetDecodeOptionsToContext(mutableContext, &options, decodeOptions);
+            context = [mutableContext copy];
+        } else {
+            context = self.context;
+        }
+        if (progressiveCoder) {
+            image = SDImageLoaderDecodeProgressiveImageData(imageData, self.request.URL, YES, self, options, context);
+        } else {
+            image = SDImageLoaderDecodeImageData(imageData, self.request.URL, options, context);
+        }
+        if (image && decodeOptions) {
+            @synchronized (self.imageMap) {
+                [self.imageMap setObject:image forKey:decodeOptions];
+            }
+        }
+    }
+    return image;
+}
+
+- (void)callCompletionBlockWithTokens:(nonnull NSArray<SDWebImageDownloaderOperationToken *> *)tokens
+                                image:(nullable UIImage *)image
+                            imageData:(nullable NSData *)imageData {
+    CGSize imageSize = image.size;
+    if (imageSize.width == 0 || imageSize.height == 0) {
+        NSString *description = image == nil ? @"Downloaded image decode failed" : @"Downloaded image has 0 pixels";
+        NSError *error = [NSError errorWithDomain:SDWebImageErrorDomain code:SDWebImageErrorBadImageData userInfo:@{NSLocalizedDescriptionKey : description}];
+        for (SDWebImageDownloaderOperationToken *token in tokens) {
+            [self callCompletionBlockWithToken:token image:nil imageData:nil error:error finished:YES];
+        }
+    } else {
+        for (SDWebImageDownloaderOperationToken *token in tokens) {
+            [self callCompletionBlockWithToken:token image:image imageData:imageData error:nil finished:YES];
+        }
+    }
+}
+
 - (void)callCompletionBlockWithToken:(nonnull SDWebImageDownloaderOperationToken *)token
                                image:(nullable UIImage *)image
                            imageData:(nullable NSData *)imageData
@@ -0,0 +1,113 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDWebImageCompat.h"
+#import "SDWebImageOperation.h"
+
+@class SDCallbackQueue;
+
+/// The state of future.
+typedef NS_ENUM(NSUInteger, SDWebImageFutureState) {
+    /// The future is not resolved yet.
+    SDWebImageFutureStatePending = 0,
+    /// The future is resolved with a result.
+    SDWebImageFutureStateFulfilled,
+    /// The future is resolved with an error.
+    SDWebImageFutureStateRejected,
+    /// The future is cancelled, the error is `SDWebImageErrorCancelled`.
+    SDWebImageFutureStateCancelled
+};
+
+/**
+ A lightweight future (promise) to compose the image loading without nesting the completion blocks, see `-[SDWebImageManager loadImageFutureWithURL:options:context:]`.
+ A future is resolved only once, the completion blocks are called on the thread which resolve the future, or immediately if it's already resolved.
+ Cancellation is structured: cancelling a future cancels its cancellables (such as the underlying loading operation) and the upstream futures it derived from. The combinators (`all`, `race`, `first`) cancel the remaining input futures once they are resolved.
+
+ @code
+ // Load 10 images, take the first 3 loaded, cancel the rest
+ NSArray<SDWebImageFuture *> *futures = ...;
+ [[SDWebImageFuture first:3 ofFutures:futures] whenComplete:^(NSArray<SDWebImageLoadResult *> *results, NSError *error) {
+     // ...
+ }];
+ @endcode
+ */
+@interface SDWebImageFuture<__covariant ResultType> : NSObject <SDWebImageOperation>
+
+/// The current state.
+@property (nonatomic, assign, readonly) SDWebImageFutureState state;
+
+/// The result when fulfilled, else nil.
+@property (nonatomic, strong, readonly, nullable) ResultType result;
+
+/// The error when rejected or cancelled, else nil.
+@property (nonatomic, strong, readonly, nullable) NSError *error;
+
+/// Whether the future is cancelled.
+@property (nonatomic, assign, readonly, getter=isCancelled) BOOL cancelled;
+
+/// Create a pending future, use `fulfillWithResult:` or `rejectWithError:` to resolve it.
+- (nonnull instancetype)init NS_DESIGNATED_INITIALIZER;
+
+/// Create a fulfilled future.
++ (nonnull instancetype)futureWithResult:(nullable ResultType)result;
+
+/// Create a rejected future.
++ (nonnull instancetype)futureWithError:(nonnull NSError *)error;
+
+#pragma mark - Resolve
+
+/// Fulfill the future with result.
+/// @return YES if the future is resolved by this call, NO if it's already resolved.
+- (BOOL)fulfillWithResult:(nullable ResultType)result;
+
+/// Reject the future with error.
+/// @return YES if the future is resolved by this call, NO if it's already resolved.
+- (BOOL)rejectWithError:(nonnull NSError *)error;
+
+/// Add an operation which will be cancelled when the future is cancelled, acts like a cancellation token. If the future is already cancelled, the operation is cancelled immediately.
+/// @note The cancellables are released once the future is resolved.
+- (void)addCancellable:(nonnull id<SDWebImageOperation>)cancellable;
+
+/// Cancel the future and its cancellables. The completion blocks are called with `SDWebImageErrorCancelled` error.
+- (void)cancel;
+
+#pragma mark - Observe
+
+/// Add a completion block, which is called on the resolving thread (or immediately if the future is already resolved).
+- (void)whenComplete:(nonnull void(^)(ResultType _Nullable result, NSError * _Nullable error))completion;
+
+/// Add a completion block, which is called on the specify callback queue. Nil queue means call on the resolving thread.
+- (void)whenCompleteOnQueue:(nullable SDCallbackQueue *)queue completion:(nonnull void(^)(ResultType _Nullable result, NSError * _Nullable error))completion;
+
+/// Block current thread until the future is resolved, or the timeout reached. Like the `await` keyword.
+/// @warning Do not call this on the thread (queue) which the future is resolved on, such as the main queue for image loading with default callback queue, or it will deadlock until timeout.
+/// @param timeout The timeout in seconds, 0 means waiting forever.
+/// @param error The error when rejected, cancelled or timeout (`ETIMEDOUT` in `NSPOSIXErrorDomain`).
+/// @return The result when fulfilled.
+- (nullable ResultType)waitWithTimeout:(NSTimeInterval)timeout error:(NSError * _Nullable * _Nullable)error;
+
+#pragma mark - Chain
+
+/// Returns a new future fulfilled with the transformed result. The error is passed through.
+- (nonnull SDWebImageFuture *)map:(nonnull id _Nullable(^)(ResultType _Nullable result))block;
+
+/// Returns a new future resolved by the future returned from block. A nil return value fulfills with nil. The error is passed through.
+- (nonnull SDWebImageFuture *)then:(nonnull SDWebImageFuture * _Nullable(^)(ResultType _Nullable result))block;
+
+#pragma mark - Combine
+
+/// Returns a new future fulfilled with all results (in the input order, nil result is `NSNull`), or rejected by the first error.
++ (nonnull SDWebImageFuture<NSArray *> *)all:(nonnull NSArray<SDWebImageFuture *> *)futures;
+
+/// Returns a new future resolved by the first resolved future.
++ (nonnull SDWebImageFuture *)race:(nonnull NSArray<SDWebImageFuture *> *)futures;
+
+/// Returns a new future fulfilled with the first `count` fulfilled results (in the completion order, nil result is `NSNull`), or rejected by the last error when there are no enough futures to be fulfilled.
++ (nonnull SDWebImageFuture<NSArray *> *)first:(NSUInteger)count ofFutures:(nonnull NSArray<SDWebImageFuture *> *)futures;
+
+@end
@@ -0,0 +1,407 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDWebImageFuture.h"
+#import "SDCallbackQueue.h"
+#import "SDWebImageError.h"
+#import "SDInternalMacros.h"
+
+typedef void(^SDWebImageFutureCompletionBlock)(id _Nullable result, NSError * _Nullable error);
+typedef id _Nullable(^SDWebImageFutureMapBlock)(id _Nullable result);
+typedef SDWebImageFuture * _Nullable(^SDWebImageFutureThenBlock)(id _Nullable result);
+
+@interface SDWebImageFuture ()
+
+- (void)upstreamDidResolveWithState:(SDWebImageFutureState)state result:(nullable id)result error:(nullable NSError *)error;
+
+@end
+
+@implementation SDWebImageFuture {
+    SD_LOCK_DECLARE(_lock);
+    SDWebImageFutureState _state;
+    id _result;
+    NSError *_error;
+    // The observer is a completion block, or a derived future from `map:` and `then:`, which is notified directly without capturing a block per stage
+    // Most futures have only one observer, keep it inline and allocate the array for the others
+    id _observer;
+    NSMutableArray *_extraObservers;
+    NSMutableArray<id<SDWebImageOperation>> *_cancellables;
+    // For derived future, the future it's waiting for, cancel this future cancel the upstream as well
+    SDWebImageFuture *_upstream;
+    // For derived future, the transform block which is not called yet
+    SDWebImageFutureMapBlock _mapBlock;
+    SDWebImageFutureThenBlock _thenBlock;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        SD_LOCK_INIT(_lock);
+    }
+    return self;
+}
+
++ (instancetype)futureWithResult:(id)result {
+    SDWebImageFuture *future = [[self alloc] init];
+    [future fulfillWithResult:result];
+    return future;
+}
+
++ (instancetype)futureWithError:(NSError *)error {
+    SDWebImageFuture *future = [[self alloc] init];
+    [future rejectWithError:error];
+    return future;
+}
+
+#pragma mark - State
+
+- (SDWebImageFutureState)state {
+    SD_LOCK(_lock);
+    SDWebImageFutureState state = _state;
+    SD_UNLOCK(_lock);
+    return state;
+}
+
+- (id)result {
+    SD_LOCK(_lock);
+    id result = _result;
+    SD_UNLOCK(_lock);
+    return result;
+}
+
+- (NSError *)error {
+    SD_LOCK(_lock);
+    NSError *error = _error;
+    SD_UNLOCK(_lock);
+    return error;
+}
+
+- (BOOL)isCancelled {
+    return self.state == SDWebImageFutureStateCancelled;
+}
+
+#pragma mark - Resolve
+
+static inline void SDWebImageFutureNotifyObserver(id observer, SDWebImageFutureState state, id result, NSError *error) {
+    if ([observer isKindOfClass:SDWebImageFuture.class]) {
+        [(SDWebImageFuture *)observer upstreamDidResolveWithState:state result:result error:error];
+    } else {
+        ((SDWebImageFutureCompletionBlock)observer)(result, error);
+    }
+}
+
+- (BOOL)resolveWithState:(SDWebImageFutureState)state result:(id)result error:(NSError *)error {
+    SD_LOCK(_lock);
+    if (_state != SDWebImageFutureStatePending) {
+        SD_UNLOCK(_lock);
+        return NO;
+    }
+    _state = state;
+    _result = result;
+    _error = error;
+    id observer = _observer;
+    NSArray *extraObservers = _extraObservers;
+    NSArray<id<SDWebImageOperation>> *cancellables = _cancellables;
+    SDWebImageFuture *upstream = _upstream;
+    // Release the observers, cancellables and upstream, which break the retain cycle between the chained futures
+    _observer = nil;
+    _extraObservers = nil;
+    _cancellables = nil;
+    _upstream = nil;
+    _mapBlock = nil;
+    _thenBlock = nil;
+    SD_UNLOCK(_lock);
+
+    if (state == SDWebImageFutureStateCancelled) {
+        [upstream cancel];
+        for (id<SDWebImageOperation> cancellable in cancellables) {
+            [cancellable cancel];
+        }
+    }
+    if (observer) {
+        SDWebImageFutureNotifyObserver(observer, state, result, error);
+    }
+    for (id extraObserver in extraObservers) {
+        SDWebImageFutureNotifyObserver(extraObserver, state, result, error);
+    }
+    return YES;
+}
+
+- (BOOL)fulfillWithResult:(id)result {
+    return [self resolveWithState:SDWebImageFutureStateFulfilled result:result error:nil];
+}
+
+- (BOOL)rejectWithError:(NSError *)error {
+    NSParameterAssert(error);
+    return [self resolveWithState:SDWebImageFutureStateRejected result:nil error:error];
+}
+
+- (void)addCancellable:(id<SDWebImageOperation>)cancellable {
+    NSParameterAssert(cancellable);
+    SD_LOCK(_lock);
+    SDWebImageFutureState state = _state;
+    if (state == SDWebImageFutureStatePending) {
+        if (!_cancellables) {
+            _cancellables = [NSMutableArray arrayWithCapacity:1];
+        }
+        [_cancellables addObject:cancellable];
+    }
+    SD_UNLOCK(_lock);
+    if (state == SDWebImageFutureStateCancelled) {
+        [cancellable cancel];
+    }
+}
+
+- (void)cancel {
+    NSError *error = [NSError errorWithDomain:SDWebImageErrorDomain code:SDWebImageErrorCancelled userInfo:@{NSLocalizedDescriptionKey : @"Future cancelled"}];
+    [self resolveWithState:SDWebImageFutureStateCancelled result:nil error:error];
+}
+
+#pragma mark - Observe
+
+// The observer is a copied completion block or a derived future
+- (void)addObserver:(id)observer {
+    SD_LOCK(_lock);
+    if (_state == SDWebImageFutureStatePending) {
+        if (!_observer) {
+            _observer = observer;
+        } else {
+            if (!_extraObservers) {
+                _extraObservers = [NSMutableArray arrayWithCapacity:1];
+            }
+            [_extraObservers addObject:observer];
+        }
+        SD_UNLOCK(_lock);
+        return;
+    }
+    SDWebImageFutureState state = _state;
+    id result = _result;
+    NSError *error = _error;
+    SD_UNLOCK(_lock);
+    // Already resolved, fast path
+    SDWebImageFutureNotifyObserver(observer, state, result, error);
+}
+
+- (void)whenComplete:(SDWebImageFutureCompletionBlock)completion {
+    NSParameterAssert(completion);
+    [self addObserver:[completion copy]];
+}
+
+- (void)whenCompleteOnQueue:(SDCallbackQueue *)queue completion:(SDWebImageFutureCompletionBlock)completion {
+    NSParameterAssert(completion);
+    if (!queue) {
+        [self whenComplete:completion];
+        return;
+    }
+    [self whenComplete:^(id result, NSError *error) {
+        [queue async:^{
+            completion(result, error);
+        }];
+    }];
+}
+
+- (id)waitWithTimeout:(NSTimeInterval)timeout error:(NSError * _Nullable __autoreleasing *)error {
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    [self whenComplete:^(id result, NSError *error) {
+        dispatch_semaphore_signal(semaphore);
+    }];
+    dispatch_time_t time = timeout > 0 ? dispatch_time(DISPATCH_TIME_NOW, (int64_t)(timeout * NSEC_PER_SEC)) : DISPATCH_TIME_FOREVER;
+    if (dispatch_semaphore_wait(semaphore, time) != 0) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:ETIMEDOUT userInfo:nil];
+        }
+        return nil;
+    }
+    SD_LOCK(_lock);
+    id result = _result;
+    NSError *resultError = _error;
+    SD_UNLOCK(_lock);
+    if (error) {
+        *error = resultError;
+    }
+    return result;
+}
+
+#pragma mark - Chain
+
+// The derived future is the observer of upstream, and keep the transform block in ivar, so each stage allocates only the future itself
+- (void)upstreamDidResolveWithState:(SDWebImageFutureState)state result:(id)result error:(NSError *)error {
+    SD_LOCK(_lock);
+    if (_state != SDWebImageFutureStatePending) {
+        SD_UNLOCK(_lock);
+        return;
+    }
+    SDWebImageFutureMapBlock mapBlock = _mapBlock;
+    SDWebImageFutureThenBlock thenBlock = _thenBlock;
+    _mapBlock = nil;
+    _thenBlock = nil;
+    _upstream = nil;
+    SD_UNLOCK(_lock);
+    if (error) {
+        // Resolve with the same error, keep the cancelled state
+        if (state == SDWebImageFutureStateCancelled) {
+            [self cancel];
+        } else {
+            [self rejectWithError:error];
+        }
+        return;
+    }
+    if (mapBlock) {
+        [self fulfillWithResult:mapBlock(result)];
+        return;
+    }
+    if (thenBlock) {
+        SDWebImageFuture *nextFuture = thenBlock(result);
+        if (!nextFuture) {
+            [self fulfillWithResult:nil];
+            return;
+        }
+        // Wait for the next future, which is the upstream now
+        SD_LOCK(_lock);
+        BOOL pending = _state == SDWebImageFutureStatePending;
+        if (pending) {
+            _upstream = nextFuture;
+        }
+        SD_UNLOCK(_lock);
+        if (!pending) {
+            // Cancelled during the then block
+            [nextFuture cancel];
+            return;
+        }
+        [nextFuture addObserver:self];
+        return;
+    }
+    // The next future of `then:` resolved
+    [self fulfillWithResult:result];
+}
+
+- (SDWebImageFuture *)map:(id (^)(id))block {
+    NSParameterAssert(block);
+    SDWebImageFuture *future = [[SDWebImageFuture alloc] init];
+    future->_mapBlock = [block copy];
+    future->_upstream = self;
+    [self addObserver:future];
+    return future;
+}
+
+- (SDWebImageFuture *)then:(SDWebImageFuture * (^)(id))block {
+    NSParameterAssert(block);
+    SDWebImageFuture *future = [[SDWebImageFuture alloc] init];
+    future->_thenBlock = [block copy];
+    future->_upstream = self;
+    [self addObserver:future];
+    return future;
+}
+
+#pragma mark - Combine
+
+// The combined future owns the input futures: cancel the combined future cancel all of them, and once it's resolved, the remaining input futures are no longer needed
+static SDWebImageFuture *SDWebImageFutureCombined(NSArray<SDWebImageFuture *> *futures) {
+    SDWebImageFuture *future = [[SDWebImageFuture alloc] init];
+    for (SDWebImageFuture *inputFuture in futures) {
+        [future addCancellable:inputFuture];
+    }
+    [future whenComplete:^(id result, NSError *error) {
+        for (SDWebImageFuture *inputFuture in futures) {
+            [inputFuture cancel];
+        }
+    }];
+    return future;
+}
+
++ (SDWebImageFuture<NSArray *> *)all:(NSArray<SDWebImageFuture *> *)futures {
+    NSParameterAssert(futures);
+    NSUInteger count = futures.count;
+    if (count == 0) {
+        return [SDWebImageFuture futureWithResult:@[]];
+    }
+    futures = [futures copy];
+    SDWebImageFuture *future = SDWebImageFutureCombined(futures);
+    NSMutableArray *results = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [results addObject:[NSNull null]];
+    }
+    __block NSUInteger remainingCount = count;
+    [futures enumerateObjectsUsingBlock:^(SDWebImageFuture * _Nonnull inputFuture, NSUInteger idx, BOOL * _Nonnull stop) {
+        [inputFuture whenComplete:^(id result, NSError *error) {
+            if (error) {
+                [future rejectWithError:error];
+                return;
+            }
+            NSArray *finalResults;
+            @synchronized (results) {
+                results[idx] = result ?: [NSNull null];
+                remainingCount--;
+                if (remainingCount == 0) {
+                    finalResults = [results copy];
+                }
+            }
+            if (finalResults) {
+                [future fulfillWithResult:finalResults];
+            }
+        }];
+    }];
+    return future;
+}
+
++ (SDWebImageFuture *)race:(NSArray<SDWebImageFuture *> *)futures {
+    NSParameterAssert(futures.count > 0);
+    futures = [futures copy];
+    SDWebImageFuture *future = SDWebImageFutureCombined(futures);
+    for (SDWebImageFuture *inputFuture in futures) {
+        [inputFuture whenComplete:^(id result, NSError *error) {
+            if (error) {
+                [future rejectWithError:error];
+            } else {
+                [future fulfillWithResult:result];
+            }
+        }];
+    }
+    return future;
+}
+
++ (SDWebImageFuture<NSArray *> *)first:(NSUInteger)count ofFutures:(NSArray<SDWebImageFuture *> *)futures {
+    NSParameterAssert(futures);
+    if (count == 0) {
+        return [SDWebImageFuture futureWithResult:@[]];
+    }
+    futures = [futures copy];
+    NSUInteger totalCount = futures.count;
+    if (totalCount < count) {
+        return [SDWebImageFuture futureWithError:[NSError errorWithDomain:NSPOSIXErrorDomain code:EINVAL userInfo:@{NSLocalizedDescriptionKey : @"No enough futures to be fulfilled"}]];
+    }
+    SDWebImageFuture *future = SDWebImageFutureCombined(futures);
+    NSMutableArray *results = [NSMutableArray arrayWithCapacity:count];
+    __block NSUInteger failedCount = 0;
+    for (SDWebImageFuture *inputFuture in futures) {
+        [inputFuture whenComplete:^(id result, NSError *error) {
+            NSArray *finalResults;
+            BOOL failed = NO;
+            @synchronized (results) {
+                if (error) {
+                    failedCount++;
+                    // Not enough futures left to be fulfilled
+                    failed = totalCount - failedCount < count;
+                } else if (results.count < count) {
+                    [results addObject:result ?: [NSNull null]];
+                    if (results.count == count) {
+                        finalResults = [results copy];
+                    }
+                }
+            }
+            if (failed) {
+                [future rejectWithError:error];
+            } else if (finalResults) {
+                [future fulfillWithResult:finalResults];
+            }
+        }];
+    }
+    return future;
+}
+
+@end
@@ -14,6 +14,7 @@
 #import "SDWebImageCacheKeyFilter.h"
 #import "SDWebImageCacheSerializer.h"
 #import "SDWebImageOptionsProcessor.h"
+#import "SDWebImageFuture.h"
 
 typedef void(^SDExternalCompletionBlock)(UIImage * _Nullable image, NSError * _Nullable error, SDImageCacheType cacheType, NSURL * _Nullable imageURL);
 
@@ -25,7 +26,7 @@ typedef void(^SDInternalCompletionBlock)(UIImage * _Nullable image, NSData * _Nu
 @interface SDWebImageCombinedOperation : NSObject <SDWebImageOperation>
 
 /**
- Cancel the current operation, including cache and loader process
+ Cancel the current operation, including cache, loader and preview process
  */
 - (void)cancel;
 
@@ -42,9 +43,35 @@ typedef void(^SDInternalCompletionBlock)(UIImage * _Nullable image, NSData * _Nu
  */
 @property (strong, nonatomic, nullable, readonly) id<SDWebImageOperation> loaderOperation;
 
+/**
+ The operation loading the preview image, see `SDWebImageContextImagePreviewURL`
+ */
+@property (strong, nonatomic, nullable, readonly) id<SDWebImageOperation> previewOperation;
+
 @end
 
 
+/**
+ The final result of image loading, used by the future-based API.
+ */
+@interface SDWebImageLoadResult : NSObject
+
+/// The loaded image.
+@property (nonatomic, strong, readonly, nonnull) UIImage *image;
+/// The image data, may be nil when the image is from memory cache or transformed.
+@property (nonatomic, strong, readonly, nullable) NSData *data;
+/// The cache type where the image is from.
+@property (nonatomic, assign, readonly) SDImageCacheType cacheType;
+/// The original image URL.
+@property (nonatomic, strong, readonly, nullable) NSURL *imageURL;
+
+- (nonnull instancetype)initWithImage:(nonnull UIImage *)image data:(nullable NSData *)data cacheType:(SDImageCacheType)cacheType imageURL:(nullable NSURL *)imageURL;
+
+- (nonnull instancetype)init NS_UNAVAILABLE;
++ (nonnull instancetype)new  NS_UNAVAILABLE;
+
+@end
+
 @class SDWebImageManager;
 
 /**
@@ -255,6 +282,20 @@ typedef void(^SDInternalCompletionBlock)(UIImage * _Nullable image, NSData * _Nu
                                                   progress:(nullable SDImageLoaderProgressBlock)progressBlock
                                                  completed:(nonnull SDInternalCompletionBlock)completedBlock;
 
+/**
+ * Load the image as a future, which can be chained and combined (`then`/`map`/`all`/`race`/`first`) without nesting the completion blocks.
+ * The future is fulfilled only with the final image (the progressive images are ignored), or rejected with the loading error. Cancel the future cancels the loading operation, and the future is cancelled as well when the loading operation is cancelled (such as `cancelAll`).
+ *
+ * @param url            The URL to the image
+ * @param options        A mask to specify options to use for this request
+ * @param context        A context contains different options to perform specify changes or processes, see `SDWebImageContextOption`. The `SDWebImageContextCallbackQueue` controls the thread which the future is resolved on.
+ *
+ * @return The future of load result.
+ */
+- (nonnull SDWebImageFuture<SDWebImageLoadResult *> *)loadImageFutureWithURL:(nullable NSURL *)url
+                                                                     options:(SDWebImageOptions)options
+                                                                     context:(nullable SDWebImageContext *)context;
+
 /**
  * Cancel all current operations
  */
@@ -286,4 +327,17 @@ typedef void(^SDInternalCompletionBlock)(UIImage * _Nullable image, NSData * _Nu
 */
 - (nullable NSString *)cacheKeyForURL:(nullable NSURL *)url context:(nullable SDWebImageContext *)context;
 
+/**
+ * Synchronously query the memory cache for the image that the load with the same arguments would complete with, without creating the load operation.
+ * This is the fast path used by the view category, when the image is already in memory, the caller can set it directly and skip the whole pipeline.
+ *
+ * @note It returns nil when the load may complete with a different result, such as the `optionsProcessor` is set, the image cache is not a `SDImageCache`, or the options need to refresh, query the image data, or skip the cache. In that case use `loadImageWithURL:options:context:progress:completed:` instead.
+ *
+ * @param url The image URL
+ * @param options The options to use for the load
+ * @param context The context to use for the load
+ * @return The image in memory cache, or nil if miss or the fast path is not available
+ */
+- (nullable UIImage *)imageFromMemoryCacheForURL:(nullable NSURL *)url options:(SDWebImageOptions)options context:(nullable SDWebImageContext *)context;
+
 @end
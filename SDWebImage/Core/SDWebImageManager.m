@@ -14,6 +14,10 @@
 #import "SDWebImageError.h"
 #import "SDInternalMacros.h"
 #import "SDCallbackQueue.h"
+#import "SDImageLoadersManager.h"
+#import "UIImage+BlurHash.h"
+#import "UIImage+ThumbHash.h"
+#import <QuartzCore/QuartzCore.h>
 
 static id<SDImageCache> _defaultImageCache;
 static id<SDImageLoader> _defaultImageLoader;
@@ -23,8 +27,13 @@ static id<SDImageLoader> _defaultImageLoader;
 @property (assign, nonatomic, getter = isCancelled) BOOL cancelled;
 @property (strong, nonatomic, readwrite, nullable) id<SDWebImageOperation> loaderOperation;
 @property (strong, nonatomic, readwrite, nullable) id<SDWebImageOperation> cacheOperation;
+@property (strong, nonatomic, readwrite, nullable) id<SDWebImageOperation> previewOperation;
+// The full image is completed, the preview should not be delivered anymore
+@property (assign, nonatomic, getter = isPreviewDiscarded) BOOL previewDiscarded;
 @property (weak, nonatomic, nullable) SDWebImageManager *manager;
 
+- (void)discardPreview;
+
 @end
 
 @interface SDWebImageManager () {
@@ -191,6 +200,65 @@ static id<SDImageLoader> _defaultImageLoader;
     return key;
 }
 
+- (nullable UIImage *)imageFromMemoryCacheForURL:(nullable NSURL *)url options:(SDWebImageOptions)options context:(nullable SDWebImageContext *)context {
+    if ([url isKindOfClass:NSString.class]) {
+        url = [NSURL URLWithString:(NSString *)url];
+    }
+    if (![url isKindOfClass:NSURL.class] || url.absoluteString.length == 0) {
+        return nil;
+    }
+    // The options processor may change anything, only the full pipeline can apply it
+    if (self.optionsProcessor) {
+        return nil;
+    }
+    // These options need the data, a refresh, or skip the memory cache, which the memory hit can not complete
+    SDWebImageOptions slowPathOptions = SDWebImageRefreshCached | SDWebImageFromLoaderOnly | SDWebImageQueryMemoryData | SDWebImageQueryMemoryDataSync;
+    if (options & slowPathOptions) {
+        return nil;
+    }
+    id<SDImageCache> imageCache = context[SDWebImageContextImageCache];
+    if (!imageCache) {
+        imageCache = self.imageCache;
+    }
+    if (![imageCache isKindOfClass:SDImageCache.class]) {
+        return nil;
+    }
+    if (context[SDWebImageContextQueryCacheType]) {
+        SDImageCacheType queryCacheType = [context[SDWebImageContextQueryCacheType] integerValue];
+        if (queryCacheType != SDImageCacheTypeAll && queryCacheType != SDImageCacheTypeMemory) {
+            return nil;
+        }
+    }
+
+    NSString *key = [self cacheKeyForURL:url context:context];
+    UIImage *image = [(SDImageCache *)imageCache imageFromMemoryCacheForKey:key];
+    if (!image) {
+        return nil;
+    }
+    // The same check as `SDImageCache`, leave the conversion to the full pipeline
+    if (options & SDWebImageDecodeFirstFrameOnly) {
+        if (image.sd_imageFrameCount > 1) {
+            return nil;
+        }
+    } else if (options & SDWebImageMatchAnimatedImageClass) {
+        Class desiredImageClass = context[SDWebImageContextAnimatedImageClass];
+        if (desiredImageClass && ![image.class isSubclassOfClass:desiredImageClass]) {
+            return nil;
+        }
+    }
+    // The blacklisted URL completes with error
+    if (!(options & SDWebImageRetryFailed)) {
+        SD_LOCK(_failedURLsLock);
+        BOOL isFailedUrl = [self.failedURLs containsObject:url];
+        SD_UNLOCK(_failedURLsLock);
+        if (isFailedUrl) {
+            return nil;
+        }
+    }
+
+    return image;
+}
+
 - (SDWebImageCombinedOperation *)loadImageWithURL:(NSURL *)url options:(SDWebImageOptions)options progress:(SDImageLoaderProgressBlock)progressBlock completed:(SDInternalCompletionBlock)completedBlock {
     return [self loadImageWithURL:url options:options context:nil progress:progressBlock completed:completedBlock];
 }
@@ -251,11 +319,55 @@ static id<SDImageLoader> _defaultImageLoader;
     // 4. do transform in CPU
     // 5. store original image to cache
     // 6. store transformed image to cache
-    [self callCacheProcessForOperation:operation url:url options:result.options context:result.context progress:progressBlock completed:completedBlock];
+    BOOL shouldLoadPreview = (result.context[SDWebImageContextImagePreviewURL] || result.context[SDWebImageContextImagePreviewBlurHash] || result.context[SDWebImageContextImagePreviewThumbHash]);
+    SDInternalCompletionBlock fullCompletedBlock = completedBlock;
+    if (shouldLoadPreview) {
+        @weakify(operation);
+        fullCompletedBlock = ^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, SDImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {
+            @strongify(operation);
+            // Any image from the full pipeline (including the progressive partial image) is better than the preview
+            if (image || finished) {
+                [operation discardPreview];
+            }
+            completedBlock(image, data, error, cacheType, finished, imageURL);
+        };
+    }
+    [self callCacheProcessForOperation:operation url:url options:result.options context:result.context progress:progressBlock completed:fullCompletedBlock];
+    // Start preview after the full image, skip it if the full image is already completed (such as memory cache hit)
+    if (shouldLoadPreview && !operation.isPreviewDiscarded) {
+        [self callPreviewProcessForOperation:operation url:url options:result.options context:result.context completed:completedBlock];
+    }
 
     return operation;
 }
 
+- (SDWebImageFuture<SDWebImageLoadResult *> *)loadImageFutureWithURL:(NSURL *)url options:(SDWebImageOptions)options context:(SDWebImageContext *)context {
+    SDWebImageFuture<SDWebImageLoadResult *> *future = [[SDWebImageFuture alloc] init];
+    SDWebImageCombinedOperation *operation = [self loadImageWithURL:url options:options context:context progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, SDImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {
+        if (!finished) {
+            // Progressive image, wait for the final one
+            return;
+        }
+        if (!image) {
+            if ([error.domain isEqualToString:SDWebImageErrorDomain] && error.code == SDWebImageErrorCancelled) {
+                // Cancelled by the operation (such as `cancelAll`), keep the cancelled state
+                [future cancel];
+                return;
+            }
+            if (!error) {
+                error = [NSError errorWithDomain:SDWebImageErrorDomain code:SDWebImageErrorBadImageData userInfo:@{NSLocalizedDescriptionKey : @"Image load finished with nil image"}];
+            }
+            [future rejectWithError:error];
+            return;
+        }
+        [future fulfillWithResult:[[SDWebImageLoadResult alloc] initWithImage:image data:data cacheType:cacheType imageURL:imageURL]];
+    }];
+    if (operation) {
+        [future addCancellable:operation];
+    }
+    return future;
+}
+
 - (void)cancelAll {
     SD_LOCK(_runningOperationsLock);
     NSSet<SDWebImageCombinedOperation *> *copiedOperations = [self.runningOperations copy];
@@ -316,6 +428,7 @@ static id<SDImageLoader> _defaultImageLoader;
         SDWebImageMutableContext *mutableContext = [context mutableCopy];
         mutableContext[SDWebImageContextImageThumbnailPixelSize] = nil;
         mutableContext[SDWebImageContextImagePreserveAspectRatio] = nil;
+        mutableContext[SDWebImageContextImageTransformerPushDown] = nil;
         @weakify(operation);
         operation.cacheOperation = [imageCache queryImageForKey:key options:options context:mutableContext cacheType:queryCacheType completion:^(UIImage * _Nullable cachedImage, NSData * _Nullable cachedData, SDImageCacheType cacheType) {
             @strongify(operation);
@@ -343,6 +456,56 @@ static id<SDImageLoader> _defaultImageLoader;
     }
 }
 
+// Preview process, the preview is delivered as the not finished image, until the full image is completed
+- (void)callPreviewProcessForOperation:(nonnull SDWebImageCombinedOperation *)operation
+                                   url:(nonnull NSURL *)url
+                               options:(SDWebImageOptions)options
+                               context:(nonnull SDWebImageContext *)context
+                             completed:(nonnull SDInternalCompletionBlock)completedBlock {
+    SDCallbackQueue *queue = context[SDWebImageContextCallbackQueue];
+    UIImage *previewImage;
+    NSString *blurHash = context[SDWebImageContextImagePreviewBlurHash];
+    id thumbHash = context[SDWebImageContextImagePreviewThumbHash];
+    // Decode in memory, it's small enough to not block
+    if ([blurHash isKindOfClass:NSString.class]) {
+        previewImage = [UIImage sd_imageWithBlurHash:blurHash size:CGSizeMake(32, 32)];
+    } else if ([thumbHash isKindOfClass:NSData.class]) {
+        previewImage = [UIImage sd_imageWithThumbHash:thumbHash];
+    } else if ([thumbHash isKindOfClass:NSString.class]) {
+        previewImage = [UIImage sd_imageWithThumbHashString:thumbHash];
+    }
+    if (previewImage) {
+        [self callPreviewCompletionBlockForOperation:operation completion:completedBlock image:previewImage data:nil cacheType:SDImageCacheTypeNone queue:queue url:url];
+    }
+    NSURL *previewURL = context[SDWebImageContextImagePreviewURL];
+    if (![previewURL isKindOfClass:NSURL.class]) {
+        return;
+    }
+    SDWebImageMutableContext *previewContext = [context mutableCopy];
+    previewContext[SDWebImageContextImagePreviewURL] = nil;
+    previewContext[SDWebImageContextImagePreviewBlurHash] = nil;
+    previewContext[SDWebImageContextImagePreviewThumbHash] = nil;
+    // The preview is small, load it before the full image in loader queue
+    SDWebImageOptions previewOptions = options & ~(SDWebImageLowPriority | SDWebImageProgressiveLoad | SDWebImageRefreshCached);
+    previewOptions |= SDWebImageHighPriority;
+    @weakify(operation);
+    SDWebImageCombinedOperation *previewOperation = [self loadImageWithURL:previewURL options:previewOptions context:[previewContext copy] progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, SDImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {
+        @strongify(operation);
+        if (!operation || !image || !finished) {
+            return;
+        }
+        [self callPreviewCompletionBlockForOperation:operation completion:completedBlock image:image data:data cacheType:cacheType queue:queue url:url];
+    }];
+    @synchronized (operation) {
+        if (!operation.isCancelled && !operation.isPreviewDiscarded) {
+            operation.previewOperation = previewOperation;
+            previewOperation = nil;
+        }
+    }
+    // The full image completed or cancelled during the preview start
+    [previewOperation cancel];
+}
+
 // Query original cache process
 - (void)callOriginalCacheProcessForOperation:(nonnull SDWebImageCombinedOperation *)operation
                                          url:(nonnull NSURL *)url
@@ -420,7 +583,11 @@ static id<SDImageLoader> _defaultImageLoader;
     BOOL shouldDownload = !SD_OPTIONS_CONTAINS(options, SDWebImageFromCacheOnly);
     shouldDownload &= (!cachedImage || options & SDWebImageRefreshCached);
     shouldDownload &= (![self.delegate respondsToSelector:@selector(imageManager:shouldDownloadImageForURL:)] || [self.delegate imageManager:self shouldDownloadImageForURL:url]);
-    if ([imageLoader respondsToSelector:@selector(canRequestImageForURL:options:context:)]) {
+    if (shouldDownload && [imageLoader isKindOfClass:SDImageLoadersManager.class]) {
+        // Resolve the loader once, use it for both loading and the failed URL check, instead of routing again
+        imageLoader = [(SDImageLoadersManager *)imageLoader loaderForURL:url options:options context:context];
+        shouldDownload &= imageLoader != nil;
+    } else if ([imageLoader respondsToSelector:@selector(canRequestImageForURL:options:context:)]) {
         shouldDownload &= [imageLoader canRequestImageForURL:url options:options context:context];
     } else {
         shouldDownload &= [imageLoader canRequestImageForURL:url];
@@ -441,6 +608,8 @@ static id<SDImageLoader> _defaultImageLoader;
             context = [mutableContext copy];
         }
         
+        // The observed latency is the cost to re-fetch, used by the disk cache eviction policy
+        CFTimeInterval fetchStartTime = CACurrentMediaTime();
         @weakify(operation);
         operation.loaderOperation = [imageLoader requestImageWithURL:url options:options context:context progress:progressBlock completed:^(UIImage *downloadedImage, NSData *downloadedData, NSError *error, BOOL finished) {
             @strongify(operation);
@@ -454,7 +623,7 @@ static id<SDImageLoader> _defaultImageLoader;
                 [self callCompletionBlockForOperation:operation completion:completedBlock error:error queue:context[SDWebImageContextCallbackQueue] url:url];
             } else if (error) {
                 [self callCompletionBlockForOperation:operation completion:completedBlock error:error queue:context[SDWebImageContextCallbackQueue] url:url];
-                BOOL shouldBlockFailedURL = [self shouldBlockFailedURLWithURL:url error:error options:options context:context];
+                BOOL shouldBlockFailedURL = [self shouldBlockFailedURLWithURL:url error:error imageLoader:imageLoader options:options context:context];
                 
                 if (shouldBlockFailedURL) {
                     SD_LOCK(self->_failedURLsLock);
@@ -467,8 +636,20 @@ static id<SDImageLoader> _defaultImageLoader;
                     [self.failedURLs removeObject:url];
                     SD_UNLOCK(self->_failedURLsLock);
                 }
+                SDWebImageContext *storeContext = context;
+                if (finished) {
+                    SDWebImageMutableContext *mutableContext = context ? [context mutableCopy] : [NSMutableDictionary dictionary];
+                    if (!mutableContext[SDWebImageContextImageFetchCost]) {
+                        mutableContext[SDWebImageContextImageFetchCost] = @(CACurrentMediaTime() - fetchStartTime);
+                    }
+                    // The per-entry expiration from the HTTP caching headers
+                    if (!mutableContext[SDWebImageContextImageCacheExpirationDate] && [operation.loaderOperation isKindOfClass:SDWebImageDownloadToken.class]) {
+                        mutableContext[SDWebImageContextImageCacheExpirationDate] = ((SDWebImageDownloadToken *)operation.loaderOperation).cacheExpirationDate;
+                    }
+                    storeContext = [mutableContext copy];
+                }
                 // Continue transform process
-                [self callTransformProcessForOperation:operation url:url options:options context:context originalImage:downloadedImage originalData:downloadedData cacheType:SDImageCacheTypeNone finished:finished completed:completedBlock];
+                [self callTransformProcessForOperation:operation url:url options:options context:storeContext originalImage:downloadedImage originalData:downloadedData cacheType:SDImageCacheTypeNone finished:finished completed:completedBlock];
             }
             
             if (finished) {
@@ -499,6 +680,17 @@ static id<SDImageLoader> _defaultImageLoader;
     if ([transformer isEqual:NSNull.null]) {
         transformer = nil;
     }
+    // region decoding check, the transformer (or its leading part) is pushed down into decoding
+    BOOL isRegionDecoded = originalImage.sd_isRegionDecoded;
+    if (isRegionDecoded && transformer) {
+        id<SDImageTransformer> remainingTransformer;
+        SDImageTransformerDecodeOptions(transformer, originalImage.scale, &remainingTransformer);
+        transformer = remainingTransformer;
+        if (!transformer) {
+            // The whole transformer is applied by decoding, else mark it after the remaining transformer succeed
+            originalImage.sd_isTransformed = YES;
+        }
+    }
     // transformer check
     BOOL shouldTransformImage = originalImage && transformer;
     shouldTransformImage = shouldTransformImage && (!originalImage.sd_isAnimated || (options & SDWebImageTransformAnimatedImage));
@@ -507,7 +699,7 @@ static id<SDImageLoader> _defaultImageLoader;
     BOOL isThumbnail = originalImage.sd_isThumbnail;
     NSData *cacheData = originalData;
     UIImage *cacheImage = originalImage;
-    if (isThumbnail) {
+    if (isThumbnail || isRegionDecoded) {
         cacheData = nil; // thumbnail don't store full size data
         originalImage = nil; // thumbnail don't have full size image
     }
@@ -689,6 +881,22 @@ static id<SDImageLoader> _defaultImageLoader;
     }
 }
 
+- (void)callPreviewCompletionBlockForOperation:(nonnull SDWebImageCombinedOperation *)operation
+                                    completion:(nonnull SDInternalCompletionBlock)completionBlock
+                                         image:(nonnull UIImage *)image
+                                          data:(nullable NSData *)data
+                                     cacheType:(SDImageCacheType)cacheType
+                                         queue:(nullable SDCallbackQueue *)queue
+                                           url:(nonnull NSURL *)url {
+    [(queue ?: SDCallbackQueue.mainQueue) async:^{
+        // Check on the callback queue, which is the same queue the full image is delivered
+        if (operation.isCancelled || operation.isPreviewDiscarded) {
+            return;
+        }
+        completionBlock(image, data, nil, cacheType, NO, url);
+    }];
+}
+
 - (void)callCompletionBlockForOperation:(nullable SDWebImageCombinedOperation*)operation
                              completion:(nullable SDInternalCompletionBlock)completionBlock
                                   error:(nullable NSError *)error
@@ -715,12 +923,9 @@ static id<SDImageLoader> _defaultImageLoader;
 
 - (BOOL)shouldBlockFailedURLWithURL:(nonnull NSURL *)url
                               error:(nonnull NSError *)error
+                        imageLoader:(nonnull id<SDImageLoader>)imageLoader
                             options:(SDWebImageOptions)options
                             context:(nullable SDWebImageContext *)context {
-    id<SDImageLoader> imageLoader = context[SDWebImageContextImageLoader];
-    if (!imageLoader) {
-        imageLoader = self.imageLoader;
-    }
     // Check whether we should block failed url
     BOOL shouldBlockFailedURL;
     if ([self.delegate respondsToSelector:@selector(imageManager:shouldBlockFailedURL:withError:)]) {
@@ -745,6 +950,13 @@ static id<SDImageLoader> _defaultImageLoader;
         id<SDImageTransformer> transformer = self.transformer;
         [mutableContext setValue:transformer forKey:SDWebImageContextImageTransformer];
     }
+    // Transformer push down from manager, the original image stored into memory cache need the full image
+    if (!context[SDWebImageContextImageTransformerPushDown]) {
+        NSNumber *originalStoreCacheTypeValue = context[SDWebImageContextOriginalStoreCacheType];
+        SDImageCacheType originalStoreCacheType = originalStoreCacheTypeValue != nil ? originalStoreCacheTypeValue.integerValue : SDImageCacheTypeDisk;
+        BOOL shouldPushDownTransformer = originalStoreCacheType != SDImageCacheTypeMemory && originalStoreCacheType != SDImageCacheTypeAll;
+        [mutableContext setValue:@(shouldPushDownTransformer) forKey:SDWebImageContextImageTransformerPushDown];
+    }
     // Cache key filter from manager
     if (!context[SDWebImageContextCacheKeyFilter]) {
         id<SDWebImageCacheKeyFilter> cacheKeyFilter = self.cacheKeyFilter;
@@ -778,6 +990,22 @@ static id<SDImageLoader> _defaultImageLoader;
 @end
 
 
+@implementation SDWebImageLoadResult
+
+- (instancetype)initWithImage:(UIImage *)image data:(NSData *)data cacheType:(SDImageCacheType)cacheType imageURL:(NSURL *)imageURL {
+    NSParameterAssert(image);
+    self = [super init];
+    if (self) {
+        _image = image;
+        _data = data;
+        _cacheType = cacheType;
+        _imageURL = imageURL;
+    }
+    return self;
+}
+
+@end
+
 @implementation SDWebImageCombinedOperation
 
 - (BOOL)isCancelled {
@@ -802,8 +1030,28 @@ static id<SDImageLoader> _defaultImageLoader;
             [self.loaderOperation cancel];
             self.loaderOperation = nil;
         }
+        if (self.previewOperation) {
+            [self.previewOperation cancel];
+            self.previewOperation = nil;
+        }
         [self.manager safelyRemoveOperationFromRunning:self];
     }
 }
 
+- (BOOL)isPreviewDiscarded {
+    @synchronized (self) {
+        return _previewDiscarded;
+    }
+}
+
+- (void)discardPreview {
+    id<SDWebImageOperation> previewOperation;
+    @synchronized (self) {
+        _previewDiscarded = YES;
+        previewOperation = self.previewOperation;
+        self.previewOperation = nil;
+    }
+    [previewOperation cancel];
+}
+
 @end
@@ -0,0 +1,36 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDWebImageCompat.h"
+
+/**
+ UIImage category to decode the BlurHash (https://blurha.sh), a compact string (usually 20-30 characters) representing the blurred preview of image. It can be inlined in the API response and decoded in memory without network.
+ See `SDWebImageContextImagePreviewBlurHash` to show it before the full image.
+ */
+@interface UIImage (BlurHash)
+
+/**
+ Decode the BlurHash into a blurred image.
+
+ @param blurHash The BlurHash string.
+ @param size The image pixel size. Because the image is blurred, a small size such as 32x32 is enough, let the view scale it.
+ @return The decoded image, or nil if the BlurHash is invalid.
+ */
++ (nullable UIImage *)sd_imageWithBlurHash:(nonnull NSString *)blurHash size:(CGSize)size;
+
+/**
+ Decode the BlurHash into a blurred image.
+
+ @param blurHash The BlurHash string.
+ @param size The image pixel size.
+ @param punch The contrast of the image, 1 means the original contrast, larger value makes the colors more vivid.
+ @return The decoded image, or nil if the BlurHash is invalid.
+ */
++ (nullable UIImage *)sd_imageWithBlurHash:(nonnull NSString *)blurHash size:(CGSize)size punch:(float)punch;
+
+@end
@@ -0,0 +1,165 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "UIImage+BlurHash.h"
+#import "NSImage+Compatibility.h"
+#import "SDImageCoderHelper.h"
+
+// The max component count in each direction is 9, the size flag is one base83 digit
+static const NSUInteger kBlurHashMaxComponents = 9;
+
+static const char kBlurHashCharacters[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz#$%*+,-.:;=?@[]^_{|}~";
+
+static BOOL SDBlurHashDecode83(const char *string, NSUInteger start, NSUInteger end, NSUInteger *value) {
+    NSUInteger result = 0;
+    for (NSUInteger i = start; i < end; i++) {
+        const char *position = strchr(kBlurHashCharacters, string[i]);
+        if (!position || string[i] == '\0') {
+            return NO;
+        }
+        result = result * 83 + (NSUInteger)(position - kBlurHashCharacters);
+    }
+    *value = result;
+    return YES;
+}
+
+static inline float SDBlurHashSRGBToLinear(NSUInteger value) {
+    float v = value / 255.f;
+    if (v <= 0.04045f) {
+        return v / 12.92f;
+    }
+    return powf((v + 0.055f) / 1.055f, 2.4f);
+}
+
+static inline uint8_t SDBlurHashLinearToSRGB(float value) {
+    float v = MAX(0, MIN(1, value));
+    if (v <= 0.0031308f) {
+        return (uint8_t)(v * 12.92f * 255 + 0.5f);
+    }
+    return (uint8_t)((1.055f * powf(v, 1 / 2.4f) - 0.055f) * 255 + 0.5f);
+}
+
+static inline float SDBlurHashSignPow(float value, float exp) {
+    return copysignf(powf(fabsf(value), exp), value);
+}
+
+@implementation UIImage (BlurHash)
+
++ (UIImage *)sd_imageWithBlurHash:(NSString *)blurHash size:(CGSize)size {
+    return [self sd_imageWithBlurHash:blurHash size:size punch:1];
+}
+
++ (UIImage *)sd_imageWithBlurHash:(NSString *)blurHash size:(CGSize)size punch:(float)punch {
+    const char *hash = blurHash.UTF8String;
+    size_t width = (size_t)size.width;
+    size_t height = (size_t)size.height;
+    if (!hash || strlen(hash) < 6 || width == 0 || height == 0) {
+        return nil;
+    }
+    NSUInteger sizeFlag;
+    if (!SDBlurHashDecode83(hash, 0, 1, &sizeFlag)) {
+        return nil;
+    }
+    NSUInteger numX = sizeFlag % kBlurHashMaxComponents + 1;
+    NSUInteger numY = sizeFlag / kBlurHashMaxComponents + 1;
+    if (strlen(hash) != 4 + 2 * numX * numY) {
+        return nil;
+    }
+    NSUInteger quantisedMaxValue;
+    if (!SDBlurHashDecode83(hash, 1, 2, &quantisedMaxValue)) {
+        return nil;
+    }
+    float maxValue = (quantisedMaxValue + 1) / 166.f * MAX(punch, 1);
+
+    // The DC component is the average color, and the AC components are the cosine coefficients
+    NSUInteger count = numX * numY;
+    float colors[kBlurHashMaxComponents * kBlurHashMaxComponents][3];
+    for (NSUInteger i = 0; i < count; i++) {
+        NSUInteger value;
+        if (i == 0) {
+            if (!SDBlurHashDecode83(hash, 2, 6, &value)) {
+                return nil;
+            }
+            colors[i][0] = SDBlurHashSRGBToLinear(value >> 16);
+            colors[i][1] = SDBlurHashSRGBToLinear((value >> 8) & 255);
+            colors[i][2] = SDBlurHashSRGBToLinear(value & 255);
+        } else {
+            if (!SDBlurHashDecode83(hash, 4 + i * 2, 6 + i * 2, &value)) {
+                return nil;
+            }
+            colors[i][0] = SDBlurHashSignPow(((float)(value / (19 * 19)) - 9) / 9, 2) * maxValue;
+            colors[i][1] = SDBlurHashSignPow(((float)((value / 19) % 19) - 9) / 9, 2) * maxValue;
+            colors[i][2] = SDBlurHashSignPow(((float)(value % 19) - 9) / 9, 2) * maxValue;
+        }
+    }
+
+    // Pre-compute the basis, which is separable in each direction
+    float *basisX = malloc(width * numX * sizeof(float));
+    float *basisY = malloc(height * numY * sizeof(float));
+    size_t bytesPerRow = width * 4;
+    uint8_t *pixels = malloc(bytesPerRow * height);
+    if (!basisX || !basisY || !pixels) {
+        free(basisX);
+        free(basisY);
+        free(pixels);
+        return nil;
+    }
+    for (size_t x = 0; x < width; x++) {
+        for (NSUInteger i = 0; i < numX; i++) {
+            basisX[x * numX + i] = cosf(M_PI * x * i / width);
+        }
+    }
+    for (size_t y = 0; y < height; y++) {
+        for (NSUInteger j = 0; j < numY; j++) {
+            basisY[y * numY + j] = cosf(M_PI * y * j / height);
+        }
+    }
+    for (size_t y = 0; y < height; y++) {
+        for (size_t x = 0; x < width; x++) {
+            float r = 0, g = 0, b = 0;
+            for (NSUInteger j = 0; j < numY; j++) {
+                for (NSUInteger i = 0; i < numX; i++) {
+                    float basis = basisX[x * numX + i] * basisY[y * numY + j];
+                    float *color = colors[i + j * numX];
+                    r += color[0] * basis;
+                    g += color[1] * basis;
+                    b += color[2] * basis;
+                }
+            }
+            uint8_t *pixel = pixels + y * bytesPerRow + x * 4;
+            pixel[0] = SDBlurHashLinearToSRGB(r);
+            pixel[1] = SDBlurHashLinearToSRGB(g);
+            pixel[2] = SDBlurHashLinearToSRGB(b);
+            pixel[3] = 255;
+        }
+    }
+    free(basisX);
+    free(basisY);
+
+    CGBitmapInfo bitmapInfo = kCGBitmapByteOrder32Big | kCGImageAlphaNoneSkipLast;
+    CGContextRef context = CGBitmapContextCreate(pixels, width, height, 8, bytesPerRow, [SDImageCoderHelper colorSpaceGetDeviceRGB], bitmapInfo);
+    if (!context) {
+        free(pixels);
+        return nil;
+    }
+    CGImageRef imageRef = CGBitmapContextCreateImage(context);
+    CGContextRelease(context);
+    free(pixels);
+    if (!imageRef) {
+        return nil;
+    }
+#if SD_UIKIT || SD_WATCH
+    UIImage *image = [[UIImage alloc] initWithCGImage:imageRef scale:1 orientation:UIImageOrientationUp];
+#else
+    UIImage *image = [[UIImage alloc] initWithCGImage:imageRef scale:1 orientation:kCGImagePropertyOrientationUp];
+#endif
+    CGImageRelease(imageRef);
+    return image;
+}
+
+@end
@@ -80,6 +80,12 @@
  */
 @property (nonatomic, assign) BOOL sd_isTransformed;
 
+/**
+ A bool value indicating that the image is decoded from the region of `SDImageCoderDecodeCropRect` (and stretched to `SDImageCoderDecodeCropScaledPixelSize`), so the image data may not always match original download one.
+ @note The coder which supports region-of-interest decoding should set this to YES. If it's NO, the crop options are ignored by the coder.
+ */
+@property (nonatomic, assign) BOOL sd_isRegionDecoded;
+
 /**
  A bool value indicating that the image is using thumbnail decode with smaller size, so the image data may not always match original download one.
  @note This just check `sd_decodeOptions[.decodeThumbnailPixelSize] > CGSize.zero`
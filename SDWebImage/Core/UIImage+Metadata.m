@@ -196,6 +196,15 @@
     return value.boolValue;
 }
 
+- (void)setSd_isRegionDecoded:(BOOL)sd_isRegionDecoded {
+    objc_setAssociatedObject(self, @selector(sd_isRegionDecoded), @(sd_isRegionDecoded), OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+}
+
+- (BOOL)sd_isRegionDecoded {
+    NSNumber *value = objc_getAssociatedObject(self, @selector(sd_isRegionDecoded));
+    return value.boolValue;
+}
+
 - (void)setSd_decodeOptions:(SDImageCoderOptions *)sd_decodeOptions {
     objc_setAssociatedObject(self, @selector(sd_decodeOptions), sd_decodeOptions, OBJC_ASSOCIATION_COPY_NONATOMIC);
 }
@@ -0,0 +1,33 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDWebImageCompat.h"
+
+/**
+ UIImage category to decode the ThumbHash (https://evanw.github.io/thumbhash/), a compact binary (usually 20-25 bytes) representing the blurred preview of image. Compared to BlurHash, it encodes the aspect ratio and alpha channel as well.
+ See `SDWebImageContextImagePreviewThumbHash` to show it before the full image.
+ */
+@interface UIImage (ThumbHash)
+
+/**
+ Decode the ThumbHash into a blurred image. The pixel size is decided by the ThumbHash, the longer side is 32, let the view scale it.
+
+ @param thumbHash The ThumbHash bytes.
+ @return The decoded image, or nil if the ThumbHash is invalid.
+ */
++ (nullable UIImage *)sd_imageWithThumbHash:(nonnull NSData *)thumbHash;
+
+/**
+ Decode the base64 encoded ThumbHash into a blurred image, which is the common format in API response.
+
+ @param thumbHashString The base64 encoded ThumbHash.
+ @return The decoded image, or nil if the ThumbHash is invalid.
+ */
++ (nullable UIImage *)sd_imageWithThumbHashString:(nonnull NSString *)thumbHashString;
+
+@end
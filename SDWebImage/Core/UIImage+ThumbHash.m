@@ -0,0 +1,173 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "UIImage+ThumbHash.h"
+#import "NSImage+Compatibility.h"
+#import "SDImageCoderHelper.h"
+
+// The decoded image longer side, the same as the reference implementation
+static const size_t kThumbHashMaxSize = 32;
+// The max component count in each direction is 7 for luminance, 5 for alpha
+static const NSUInteger kThumbHashMaxComponents = 7;
+
+// The number of AC components in the triangle (without the DC component)
+static NSUInteger SDThumbHashACCount(NSUInteger nx, NSUInteger ny) {
+    NSUInteger count = 0;
+    for (NSUInteger cy = 0; cy < ny; cy++) {
+        for (NSUInteger cx = cy ? 0 : 1; cx * ny < nx * (ny - cy); cx++) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// Read the 4-bit quantized AC components, the caller checked the length
+static void SDThumbHashDecodeChannel(const uint8_t *bytes, NSUInteger acStart, NSUInteger *acIndex, NSUInteger nx, NSUInteger ny, float scale, float *ac) {
+    NSUInteger count = SDThumbHashACCount(nx, ny);
+    for (NSUInteger i = 0; i < count; i++) {
+        NSUInteger index = *acIndex;
+        uint8_t value = (bytes[acStart + (index >> 1)] >> ((index & 1) << 2)) & 15;
+        ac[i] = (value / 7.5f - 1) * scale;
+        *acIndex = index + 1;
+    }
+}
+
+// Sum the AC components in the triangle with the cosine basis
+static inline float SDThumbHashSum(const float *ac, NSUInteger nx, NSUInteger ny, const float *fx, const float *fy) {
+    float sum = 0;
+    NSUInteger j = 0;
+    for (NSUInteger cy = 0; cy < ny; cy++) {
+        float fy2 = fy[cy] * 2;
+        for (NSUInteger cx = cy ? 0 : 1; cx * ny < nx * (ny - cy); cx++, j++) {
+            sum += ac[j] * fx[cx] * fy2;
+        }
+    }
+    return sum;
+}
+
+static inline uint8_t SDThumbHashClampToByte(float value) {
+    return (uint8_t)(MAX(0, MIN(1, value)) * 255);
+}
+
+@implementation UIImage (ThumbHash)
+
++ (UIImage *)sd_imageWithThumbHashString:(NSString *)thumbHashString {
+    // The base64 string is usually without padding
+    NSString *string = thumbHashString;
+    NSUInteger remainder = string.length % 4;
+    if (remainder > 0) {
+        string = [string stringByPaddingToLength:string.length + 4 - remainder withString:@"=" startingAtIndex:0];
+    }
+    NSData *thumbHash = [[NSData alloc] initWithBase64EncodedString:string options:NSDataBase64DecodingIgnoreUnknownCharacters];
+    if (!thumbHash) {
+        return nil;
+    }
+    return [self sd_imageWithThumbHash:thumbHash];
+}
+
++ (UIImage *)sd_imageWithThumbHash:(NSData *)thumbHash {
+    const uint8_t *hash = thumbHash.bytes;
+    NSUInteger length = thumbHash.length;
+    if (length < 5) {
+        return nil;
+    }
+    // Read the header
+    uint32_t header24 = hash[0] | (hash[1] << 8) | (hash[2] << 16);
+    uint16_t header16 = hash[3] | (hash[4] << 8);
+    float lDC = (header24 & 63) / 63.f;
+    float pDC = ((header24 >> 6) & 63) / 31.5f - 1;
+    float qDC = ((header24 >> 12) & 63) / 31.5f - 1;
+    float lScale = ((header24 >> 18) & 31) / 31.f;
+    BOOL hasAlpha = (header24 >> 23) != 0;
+    float pScale = ((header16 >> 3) & 63) / 63.f;
+    float qScale = ((header16 >> 9) & 63) / 63.f;
+    BOOL isLandscape = (header16 >> 15) != 0;
+    NSUInteger lx = MAX(3, isLandscape ? (hasAlpha ? 5 : 7) : (header16 & 7));
+    NSUInteger ly = MAX(3, isLandscape ? (header16 & 7) : (hasAlpha ? 5 : 7));
+    NSUInteger acStart = hasAlpha ? 6 : 5;
+    NSUInteger acCount = SDThumbHashACCount(lx, ly) + SDThumbHashACCount(3, 3) * 2 + (hasAlpha ? SDThumbHashACCount(5, 5) : 0);
+    if (length < acStart + (acCount + 1) / 2) {
+        return nil;
+    }
+    float aDC = hasAlpha ? (hash[5] & 15) / 15.f : 1;
+    float aScale = hasAlpha ? (hash[5] >> 4) / 15.f : 0;
+
+    // Read the AC components, boost the saturation by 1.25x to compensate for quantization
+    float lAC[kThumbHashMaxComponents * kThumbHashMaxComponents];
+    float pAC[9], qAC[9], aAC[25];
+    NSUInteger acIndex = 0;
+    SDThumbHashDecodeChannel(hash, acStart, &acIndex, lx, ly, lScale, lAC);
+    SDThumbHashDecodeChannel(hash, acStart, &acIndex, 3, 3, pScale * 1.25f, pAC);
+    SDThumbHashDecodeChannel(hash, acStart, &acIndex, 3, 3, qScale * 1.25f, qAC);
+    if (hasAlpha) {
+        SDThumbHashDecodeChannel(hash, acStart, &acIndex, 5, 5, aScale, aAC);
+    }
+
+    // The aspect ratio is approximated by the component count in each direction
+    float ratio = (float)(isLandscape ? (hasAlpha ? 5 : 7) : (header16 & 7)) / (float)(isLandscape ? (header16 & 7) : (hasAlpha ? 5 : 7));
+    if (!(ratio > 0) || isinf(ratio)) {
+        return nil;
+    }
+    size_t width = (size_t)MAX(1, roundf(ratio > 1 ? kThumbHashMaxSize : kThumbHashMaxSize * ratio));
+    size_t height = (size_t)MAX(1, roundf(ratio > 1 ? kThumbHashMaxSize / ratio : kThumbHashMaxSize));
+    size_t bytesPerRow = width * 4;
+    uint8_t *pixels = malloc(bytesPerRow * height);
+    if (!pixels) {
+        return nil;
+    }
+    NSUInteger nx = MAX(lx, hasAlpha ? 5 : 3);
+    NSUInteger ny = MAX(ly, hasAlpha ? 5 : 3);
+    float fx[kThumbHashMaxComponents], fy[kThumbHashMaxComponents];
+    for (size_t y = 0; y < height; y++) {
+        for (NSUInteger cy = 0; cy < ny; cy++) {
+            fy[cy] = cosf(M_PI / height * (y + 0.5f) * cy);
+        }
+        for (size_t x = 0; x < width; x++) {
+            for (NSUInteger cx = 0; cx < nx; cx++) {
+                fx[cx] = cosf(M_PI / width * (x + 0.5f) * cx);
+            }
+            float l = lDC + SDThumbHashSum(lAC, lx, ly, fx, fy);
+            float p = pDC + SDThumbHashSum(pAC, 3, 3, fx, fy);
+            float q = qDC + SDThumbHashSum(qAC, 3, 3, fx, fy);
+            float a = hasAlpha ? aDC + SDThumbHashSum(aAC, 5, 5, fx, fy) : 1;
+            // Convert the LPQ color space to RGB
+            float b = l - 2.f / 3.f * p;
+            float r = (3 * l - b + q) / 2;
+            float g = r - q;
+            // CGBitmapContext requires the premultiplied alpha
+            a = MAX(0, MIN(1, a));
+            uint8_t *pixel = pixels + y * bytesPerRow + x * 4;
+            pixel[0] = SDThumbHashClampToByte(r * a);
+            pixel[1] = SDThumbHashClampToByte(g * a);
+            pixel[2] = SDThumbHashClampToByte(b * a);
+            pixel[3] = SDThumbHashClampToByte(a);
+        }
+    }
+
+    CGBitmapInfo bitmapInfo = kCGBitmapByteOrder32Big | (hasAlpha ? kCGImageAlphaPremultipliedLast : kCGImageAlphaNoneSkipLast);
+    CGContextRef context = CGBitmapContextCreate(pixels, width, height, 8, bytesPerRow, [SDImageCoderHelper colorSpaceGetDeviceRGB], bitmapInfo);
+    if (!context) {
+        free(pixels);
+        return nil;
+    }
+    CGImageRef imageRef = CGBitmapContextCreateImage(context);
+    CGContextRelease(context);
+    free(pixels);
+    if (!imageRef) {
+        return nil;
+    }
+#if SD_UIKIT || SD_WATCH
+    UIImage *image = [[UIImage alloc] initWithCGImage:imageRef scale:1 orientation:UIImageOrientationUp];
+#else
+    UIImage *image = [[UIImage alloc] initWithCGImage:imageRef scale:1 orientation:kCGImagePropertyOrientationUp];
+#endif
+    CGImageRelease(imageRef);
+    return image;
+}
+
+@end
@@ -354,8 +354,7 @@ static inline CGImageRef _Nullable SDCreateCGImageFromCIImage(CIImage * _Nonnull
     if (size.width <= 0 || size.height <= 0) return nil;
     SDGraphicsImageRendererFormat *format = [[SDGraphicsImageRendererFormat alloc] init];
     format.scale = self.scale;
-    SDGraphicsImageRenderer *renderer = [[SDGraphicsImageRenderer alloc] initWithSize:size format:format];
-    UIImage *image = [renderer imageWithActions:^(CGContextRef  _Nonnull context) {
+    UIImage *image = [SDGraphicsImageRendererPool.sharedPool imageWithSize:size format:format actions:^(CGContextRef  _Nonnull context) {
         [self sd_drawInRect:CGRectMake(0, 0, size.width, size.height) context:context scaleMode:scaleMode clipsToBounds:NO];
     }];
     return image;
@@ -403,8 +402,7 @@ static inline CGImageRef _Nullable SDCreateCGImageFromCIImage(CIImage * _Nonnull
 - (nullable UIImage *)sd_roundedCornerImageWithRadius:(CGFloat)cornerRadius corners:(SDRectCorner)corners borderWidth:(CGFloat)borderWidth borderColor:(nullable UIColor *)borderColor {
     SDGraphicsImageRendererFormat *format = [[SDGraphicsImageRendererFormat alloc] init];
     format.scale = self.scale;
-    SDGraphicsImageRenderer *renderer = [[SDGraphicsImageRenderer alloc] initWithSize:self.size format:format];
-    UIImage *image = [renderer imageWithActions:^(CGContextRef  _Nonnull context) {
+    UIImage *image = [SDGraphicsImageRendererPool.sharedPool imageWithSize:self.size format:format actions:^(CGContextRef  _Nonnull context) {
         CGRect rect = CGRectMake(0, 0, self.size.width, self.size.height);
         
         CGFloat minSize = MIN(self.size.width, self.size.height);
@@ -471,8 +469,7 @@ static inline CGImageRef _Nullable SDCreateCGImageFromCIImage(CIImage * _Nonnull
     
     SDGraphicsImageRendererFormat *format = [[SDGraphicsImageRendererFormat alloc] init];
     format.scale = self.scale;
-    SDGraphicsImageRenderer *renderer = [[SDGraphicsImageRenderer alloc] initWithSize:newRect.size format:format];
-    UIImage *image = [renderer imageWithActions:^(CGContextRef  _Nonnull context) {
+    UIImage *image = [SDGraphicsImageRendererPool.sharedPool imageWithSize:newRect.size format:format actions:^(CGContextRef  _Nonnull context) {
         CGContextSetShouldAntialias(context, true);
         CGContextSetAllowsAntialiasing(context, true);
         CGContextSetInterpolationQuality(context, kCGInterpolationHigh);
@@ -518,8 +515,7 @@ static inline CGImageRef _Nullable SDCreateCGImageFromCIImage(CIImage * _Nonnull
     
     SDGraphicsImageRendererFormat *format = [[SDGraphicsImageRendererFormat alloc] init];
     format.scale = self.scale;
-    SDGraphicsImageRenderer *renderer = [[SDGraphicsImageRenderer alloc] initWithSize:self.size format:format];
-    UIImage *image = [renderer imageWithActions:^(CGContextRef  _Nonnull context) {
+    UIImage *image = [SDGraphicsImageRendererPool.sharedPool imageWithSize:self.size format:format actions:^(CGContextRef  _Nonnull context) {
         // Use UIKit coordinate system
         if (horizontal) {
             CGAffineTransform flipHorizontal = CGAffineTransformMake(-1, 0, 0, 1, width, 0);
@@ -718,8 +714,7 @@ static NSString * _Nullable SDGetCIFilterNameFromBlendMode(CGBlendMode blendMode
     
     SDGraphicsImageRendererFormat *format = [[SDGraphicsImageRendererFormat alloc] init];
     format.scale = scale;
-    SDGraphicsImageRenderer *renderer = [[SDGraphicsImageRenderer alloc] initWithSize:size format:format];
-    UIImage *image = [renderer imageWithActions:^(CGContextRef  _Nonnull context) {
+    UIImage *image = [SDGraphicsImageRendererPool.sharedPool imageWithSize:size format:format actions:^(CGContextRef  _Nonnull context) {
         [self drawInRect:rect];
         CGContextSetBlendMode(context, blendMode);
         CGContextSetFillColorWithColor(context, tintColor.CGColor);
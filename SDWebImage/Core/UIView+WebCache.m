@@ -14,6 +14,7 @@
 #import "SDWebImageTransitionInternal.h"
 #import "SDImageCache.h"
 #import "SDCallbackQueue.h"
+#import "SDWebImageViewState.h"
 
 const int64_t SDWebImageProgressUnitCountUnknown = 1LL;
 
@@ -21,12 +22,12 @@ const int64_t SDWebImageProgressUnitCountUnknown = 1LL;
 
 // `sd_latestOperationKey`属性的getter方法，用关联属性的方式获取UIView的属性
 - (nullable NSString *)sd_latestOperationKey {
-    return objc_getAssociatedObject(self, @selector(sd_latestOperationKey));
+    return [SDWebImageViewState stateForView:self create:NO].latestOperationKey;
 }
 
 // `sd_latestOperationKey`属性的setter方法，用关联属性的方式获取UIView的属性
 - (void)setSd_latestOperationKey:(NSString * _Nullable)sd_latestOperationKey {
-    objc_setAssociatedObject(self, @selector(sd_latestOperationKey), sd_latestOperationKey, OBJC_ASSOCIATION_COPY_NONATOMIC);
+    [SDWebImageViewState stateForView:self create:sd_latestOperationKey != nil].latestOperationKey = sd_latestOperationKey;
 }
 
 #pragma mark - State
@@ -83,6 +84,11 @@ const int64_t SDWebImageProgressUnitCountUnknown = 1LL;
         url = nil;
     }
 
+    // Memory hit fast path, set the image synchronously without the context copies and the load operation
+    if ([self sd_setImageFromMemoryCacheWithURL:url options:options context:context setImageBlock:setImageBlock completed:completedBlock]) {
+        return nil;
+    }
+
     // 如果有上下文参数，进行一次copy，context本质是字典类型
     if (context) {
         // 进行一次copy避免context是可变类型
@@ -309,6 +315,65 @@ const int64_t SDWebImageProgressUnitCountUnknown = 1LL;
     return operation;
 }
 
+// The memory hit completes synchronously on main queue in the full pipeline as well, so do the same without creating the load operation
+- (BOOL)sd_setImageFromMemoryCacheWithURL:(nullable NSURL *)url
+                                  options:(SDWebImageOptions)options
+                                  context:(nullable SDWebImageContext *)context
+                            setImageBlock:(nullable SDSetImageBlock)setImageBlock
+                                completed:(nullable SDInternalCompletionBlock)completedBlock {
+    if (!url || !NSThread.isMainThread) {
+        return NO;
+    }
+    // The custom callback queue and the transition complete asynchronously, the auto set image disabled case is rare, leave them to the full pipeline
+    if (context[SDWebImageContextCallbackQueue] || options & (SDWebImageAvoidAutoSetImage | SDWebImageForceTransition)) {
+        return NO;
+    }
+    SDWebImageManager *manager = context[SDWebImageContextCustomManager];
+    if (!manager) {
+        manager = [SDWebImageManager sharedManager];
+    }
+    UIImage *image = [manager imageFromMemoryCacheForURL:url options:options context:context];
+    if (!image) {
+        return NO;
+    }
+
+    NSString *validOperationKey = context[SDWebImageContextSetImageOperationKey];
+    if (!validOperationKey) {
+        validOperationKey = NSStringFromClass([self class]);
+    }
+    self.sd_latestOperationKey = validOperationKey;
+    if (!(SD_OPTIONS_CONTAINS(options, SDWebImageAvoidAutoCancelImage))) {
+        [self sd_cancelImageLoadOperationWithKey:validOperationKey];
+    } else {
+        // The full pipeline replaces the previous operation with the new one
+        [self sd_removeImageLoadOperationWithKey:validOperationKey];
+    }
+    SDWebImageLoadState *loadState = [self sd_imageLoadStateForKey:validOperationKey];
+    if (!loadState) {
+        loadState = [SDWebImageLoadState new];
+        [self sd_setImageLoadState:loadState forKey:validOperationKey];
+    }
+    loadState.url = url;
+    NSProgress *imageProgress = loadState.progress;
+    if (imageProgress) {
+        imageProgress.totalUnitCount = SDWebImageProgressUnitCountUnknown;
+        imageProgress.completedUnitCount = SDWebImageProgressUnitCountUnknown;
+    }
+
+#if SD_UIKIT || SD_MAC
+    // The indicator may be still animating for the previous load
+    [self sd_stopImageIndicatorWithQueue:nil];
+    [self sd_setImage:image imageData:nil options:options basedOnClassOrViaCustomSetImageBlock:setImageBlock transition:nil cacheType:SDImageCacheTypeMemory imageURL:url callback:nil];
+#else
+    [self sd_setImage:image imageData:nil basedOnClassOrViaCustomSetImageBlock:setImageBlock cacheType:SDImageCacheTypeMemory imageURL:url];
+#endif
+    [self sd_setNeedsLayout];
+    if (completedBlock) {
+        completedBlock(image, nil, nil, SDImageCacheTypeMemory, YES, url);
+    }
+    return YES;
+}
+
 - (void)sd_cancelLatestImageLoad {
     [self sd_cancelImageLoadOperationWithKey:self.sd_latestOperationKey];
 }
@@ -7,36 +7,19 @@
  */
 
 #import "UIView+WebCacheOperation.h"
-#import "objc/runtime.h"
+#import "SDWebImageViewState.h"
 
-// key is strong, value is weak because operation instance is retained by SDWebImageManager's runningOperations property
-// we should use lock to keep thread-safe because these method may not be accessed from main queue
-typedef NSMapTable<NSString *, id<SDWebImageOperation>> SDOperationsDictionary;
+// The operations are stored in the per-view state object (single associated object slot), the operation is weak because operation instance is retained by SDWebImageManager's runningOperations property
+// The state object use lock to keep thread-safe because these method may not be accessed from main queue
 
 @implementation UIView (WebCacheOperation)
 
-- (SDOperationsDictionary *)sd_operationDictionary {
-    @synchronized(self) {
-        SDOperationsDictionary *operations = objc_getAssociatedObject(self, @selector(sd_operationDictionary));
-        if (operations) {
-            return operations;
-        }
-        operations = [[NSMapTable alloc] initWithKeyOptions:NSPointerFunctionsStrongMemory valueOptions:NSPointerFunctionsWeakMemory capacity:0];
-        objc_setAssociatedObject(self, @selector(sd_operationDictionary), operations, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
-        return operations;
-    }
-}
-
 - (nullable id<SDWebImageOperation>)sd_imageLoadOperationForKey:(nullable NSString *)key  {
-    id<SDWebImageOperation> operation;
     if (!key) {
         key = NSStringFromClass(self.class);
     }
-    SDOperationsDictionary *operationDictionary = [self sd_operationDictionary];
-    @synchronized (self) {
-        operation = [operationDictionary objectForKey:key];
-    }
-    return operation;
+    SDWebImageViewState *state = [SDWebImageViewState stateForView:self create:NO];
+    return [state operationForKey:key];
 }
 
 - (void)sd_setImageLoadOperation:(nullable id<SDWebImageOperation>)operation forKey:(nullable NSString *)key {
@@ -44,10 +27,8 @@ typedef NSMapTable<NSString *, id<SDWebImageOperation>> SDOperationsDictionary;
         key = NSStringFromClass(self.class);
     }
     if (operation) {
-        SDOperationsDictionary *operationDictionary = [self sd_operationDictionary];
-        @synchronized (self) {
-            [operationDictionary setObject:operation forKey:key];
-        }
+        SDWebImageViewState *state = [SDWebImageViewState stateForView:self create:YES];
+        [state setOperation:operation forKey:key];
     }
 }
 
@@ -56,19 +37,13 @@ typedef NSMapTable<NSString *, id<SDWebImageOperation>> SDOperationsDictionary;
         key = NSStringFromClass(self.class);
     }
     // Cancel in progress downloader from queue
-    SDOperationsDictionary *operationDictionary = [self sd_operationDictionary];
-    id<SDWebImageOperation> operation;
-    
-    @synchronized (self) {
-        operation = [operationDictionary objectForKey:key];
-    }
+    SDWebImageViewState *state = [SDWebImageViewState stateForView:self create:NO];
+    id<SDWebImageOperation> operation = [state operationForKey:key];
     if (operation) {
         if ([operation respondsToSelector:@selector(cancel)]) {
             [operation cancel];
         }
-        @synchronized (self) {
-            [operationDictionary removeObjectForKey:key];
-        }
+        [state setOperation:nil forKey:key];
     }
 }
 
@@ -76,10 +51,8 @@ typedef NSMapTable<NSString *, id<SDWebImageOperation>> SDOperationsDictionary;
     if (!key) {
         key = NSStringFromClass(self.class);
     }
-    SDOperationsDictionary *operationDictionary = [self sd_operationDictionary];
-    @synchronized (self) {
-        [operationDictionary removeObjectForKey:key];
-    }
+    SDWebImageViewState *state = [SDWebImageViewState stateForView:self create:NO];
+    [state setOperation:nil forKey:key];
 }
 
 @end
@@ -7,9 +7,7 @@
  */
 
 #import "UIView+WebCacheState.h"
-#import "objc/runtime.h"
-
-typedef NSMutableDictionary<NSString *, SDWebImageLoadState *> SDStatesDictionary;
+#import "SDWebImageViewState.h"
 
 @implementation SDWebImageLoadState
 
@@ -17,40 +15,28 @@ typedef NSMutableDictionary<NSString *, SDWebImageLoadState *> SDStatesDictionar
 
 @implementation UIView (WebCacheState)
 
-- (SDStatesDictionary *)sd_imageLoadStateDictionary {
-    SDStatesDictionary *states = objc_getAssociatedObject(self, @selector(sd_imageLoadStateDictionary));
-    if (!states) {
-        states = [NSMutableDictionary dictionary];
-        objc_setAssociatedObject(self, @selector(sd_imageLoadStateDictionary), states, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
-    }
-    return states;
-}
-
 - (SDWebImageLoadState *)sd_imageLoadStateForKey:(NSString *)key {
     if (!key) {
         key = NSStringFromClass(self.class);
     }
-    @synchronized(self) {
-        return [self.sd_imageLoadStateDictionary objectForKey:key];
-    }
+    SDWebImageViewState *state = [SDWebImageViewState stateForView:self create:NO];
+    return [state loadStateForKey:key];
 }
 
-- (void)sd_setImageLoadState:(SDWebImageLoadState *)state forKey:(NSString *)key {
+- (void)sd_setImageLoadState:(SDWebImageLoadState *)loadState forKey:(NSString *)key {
     if (!key) {
         key = NSStringFromClass(self.class);
     }
-    @synchronized(self) {
-        self.sd_imageLoadStateDictionary[key] = state;
-    }
+    SDWebImageViewState *state = [SDWebImageViewState stateForView:self create:loadState != nil];
+    [state setLoadState:loadState forKey:key];
 }
 
 - (void)sd_removeImageLoadStateForKey:(NSString *)key {
     if (!key) {
         key = NSStringFromClass(self.class);
     }
-    @synchronized(self) {
-        self.sd_imageLoadStateDictionary[key] = nil;
-    }
+    SDWebImageViewState *state = [SDWebImageViewState stateForView:self create:NO];
+    [state setLoadState:nil forKey:key];
 }
 
 @end
@@ -0,0 +1,18 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDWebImageCompat.h"
+#import "SDAnimatedImagePlayer.h"
+
+@interface SDAnimatedImagePlayer ()
+
+/// Replace the provider of a running player, used when the progressive animated image finished loading. The current frame index, loop count and the decoded frames are kept, the frame buffer is moved to the new provider's frame pool.
+/// @param provider The new provider, which frame count should not be less than the current `totalFrameCount`.
+- (void)replaceProvider:(nonnull id<SDAnimatedImageProvider>)provider;
+
+@end
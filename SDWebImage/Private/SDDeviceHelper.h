@@ -9,11 +9,48 @@
 #import <Foundation/Foundation.h>
 #import "SDWebImageCompat.h"
 
+/// The memory budget of current process, in bytes
+typedef struct SDMemoryBudget {
+    /// The max memory the process can use, which is the footprint limit (like jetsam limit or cgroup `memory.max`), or the physical memory when there is no limit
+    NSUInteger limit;
+    /// The memory the process currently use (like `phys_footprint` or `VmRSS`)
+    NSUInteger footprint;
+    /// The memory the process can still allocate. With footprint limit on Mach (jetsam), this is `limit_bytes_remaining` only, the system available memory is not considered. Otherwise, this is the system available memory (including the reclaimable memory), bounded by the cgroup limit on Linux
+    NSUInteger available;
+} SDMemoryBudget;
+
+/// The backend to query the memory budget of current process
+@protocol SDMemoryBudgetProvider <NSObject>
+
+/// Query the current memory budget, return NO if not available.
+- (BOOL)getMemoryBudget:(nonnull SDMemoryBudget *)budget;
+
+@end
+
+/// The Mach backend, use `task_vm_info` (`phys_footprint` and `limit_bytes_remaining`) and `host_statistics64`
+@interface SDMachMemoryBudgetProvider : NSObject <SDMemoryBudgetProvider>
+
+@end
+
+/// The Linux backend, use `/proc/self/status`, `/proc/meminfo` and cgroup v2 (`memory.max`, `memory.current`)
+@interface SDLinuxMemoryBudgetProvider : NSObject <SDMemoryBudgetProvider>
+
+/// The root path to find `proc` and `sys/fs/cgroup`, defaults to `/`. Used for testing.
+- (nonnull instancetype)initWithRootPath:(nonnull NSString *)rootPath NS_DESIGNATED_INITIALIZER;
+
+@end
+
 /// Device information helper methods
 @interface SDDeviceHelper : NSObject
 
 #pragma mark - RAM
+/// The memory budget provider, defaults to the backend of current platform.
+@property (class, nonatomic, strong, nonnull) id<SDMemoryBudgetProvider> memoryBudgetProvider;
+/// The memory budget of current process. If not available, the limit is the physical memory and the available is the system free memory.
++ (SDMemoryBudget)memoryBudget;
+/// The max memory the process can use, the same as `memoryBudget.limit`.
 + (NSUInteger)totalMemory;
+/// The memory the process can still allocate, the same as `memoryBudget.available`.
 + (NSUInteger)freeMemory;
 
 #pragma mark - Screen
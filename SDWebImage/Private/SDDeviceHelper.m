@@ -10,13 +10,155 @@
 #import <mach/mach.h>
 #import <sys/sysctl.h>
 
-@implementation SDDeviceHelper
+#pragma mark - Mach
 
-+ (NSUInteger)totalMemory {
-    return (NSUInteger)[[NSProcessInfo processInfo] physicalMemory];
+// The free pages, plus the pages can be reclaimed without swapping (inactive and purgeable)
+static NSUInteger SDMachSystemAvailableMemory(void) {
+    mach_port_t host_port = mach_host_self();
+    mach_msg_type_number_t host_size = HOST_VM_INFO64_COUNT;
+    vm_size_t page_size;
+    vm_statistics64_data_t vm_stat;
+    kern_return_t kern;
+    
+    kern = host_page_size(host_port, &page_size);
+    if (kern != KERN_SUCCESS) return 0;
+    kern = host_statistics64(host_port, HOST_VM_INFO64, (host_info64_t)&vm_stat, &host_size);
+    if (kern != KERN_SUCCESS) return 0;
+    return (NSUInteger)(((uint64_t)vm_stat.free_count + vm_stat.inactive_count + vm_stat.purgeable_count) * page_size);
 }
 
-+ (NSUInteger)freeMemory {
+@implementation SDMachMemoryBudgetProvider
+
+- (BOOL)getMemoryBudget:(SDMemoryBudget *)budget {
+    task_vm_info_data_t vm_info;
+    mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+    kern_return_t kern = task_info(mach_task_self(), TASK_VM_INFO, (task_info_t)&vm_info, &count);
+    if (kern != KERN_SUCCESS || count < TASK_VM_INFO_REV1_COUNT) {
+        return NO;
+    }
+    NSUInteger footprint = (NSUInteger)vm_info.phys_footprint;
+    if (count >= TASK_VM_INFO_REV4_COUNT && vm_info.limit_bytes_remaining > 0) {
+        // The process has footprint limit (like jetsam on iOS), the system kill it when reach the limit, even if there are free memory
+        budget->limit = footprint + (NSUInteger)vm_info.limit_bytes_remaining;
+        budget->available = (NSUInteger)vm_info.limit_bytes_remaining;
+    } else {
+        budget->limit = (NSUInteger)[NSProcessInfo processInfo].physicalMemory;
+        budget->available = SDMachSystemAvailableMemory();
+    }
+    budget->footprint = footprint;
+    return YES;
+}
+
+@end
+
+#pragma mark - Linux
+
+// Parse the line like `MemTotal:    16384 kB` from `/proc/meminfo` or `/proc/self/status`
+static BOOL SDLinuxParseKiloBytes(NSString *contents, NSString *key, NSUInteger *bytes) {
+    NSString *prefix = [key stringByAppendingString:@":"];
+    for (NSString *line in [contents componentsSeparatedByString:@"\n"]) {
+        if (![line hasPrefix:prefix]) {
+            continue;
+        }
+        NSScanner *scanner = [NSScanner scannerWithString:[line substringFromIndex:prefix.length]];
+        unsigned long long value;
+        if (![scanner scanUnsignedLongLong:&value]) {
+            return NO;
+        }
+        *bytes = (NSUInteger)(value * 1024);
+        return YES;
+    }
+    return NO;
+}
+
+// Parse the cgroup v2 value in bytes, `max` means no limit and return NO
+static BOOL SDLinuxParseCgroupBytes(NSString *contents, NSUInteger *bytes) {
+    NSString *value = [contents stringByTrimmingCharactersInSet:NSCharacterSet.whitespaceAndNewlineCharacterSet];
+    if (value.length == 0 || [value isEqualToString:@"max"]) {
+        return NO;
+    }
+    NSScanner *scanner = [NSScanner scannerWithString:value];
+    unsigned long long result;
+    if (![scanner scanUnsignedLongLong:&result]) {
+        return NO;
+    }
+    *bytes = (NSUInteger)result;
+    return YES;
+}
+
+@implementation SDLinuxMemoryBudgetProvider {
+    NSString *_rootPath;
+}
+
+- (instancetype)init {
+    return [self initWithRootPath:@"/"];
+}
+
+- (instancetype)initWithRootPath:(NSString *)rootPath {
+    self = [super init];
+    if (self) {
+        _rootPath = [rootPath copy];
+    }
+    return self;
+}
+
+- (NSString *)contentsAtPath:(NSString *)path {
+    return [NSString stringWithContentsOfFile:[_rootPath stringByAppendingPathComponent:path] encoding:NSUTF8StringEncoding error:nil];
+}
+
+- (BOOL)getMemoryBudget:(SDMemoryBudget *)budget {
+    NSString *meminfo = [self contentsAtPath:@"proc/meminfo"];
+    NSUInteger total = 0;
+    if (!SDLinuxParseKiloBytes(meminfo, @"MemTotal", &total)) {
+        return NO;
+    }
+    NSUInteger available = 0;
+    if (!SDLinuxParseKiloBytes(meminfo, @"MemAvailable", &available)) {
+        // Before Linux 3.14
+        SDLinuxParseKiloBytes(meminfo, @"MemFree", &available);
+    }
+    NSUInteger footprint = 0;
+    SDLinuxParseKiloBytes([self contentsAtPath:@"proc/self/status"], @"VmRSS", &footprint);
+    
+    // cgroup v2 use the unified hierarchy, the entry is `0::/path`. The limit of each ancestor cgroup applies as well
+    NSString *cgroupPath;
+    for (NSString *line in [[self contentsAtPath:@"proc/self/cgroup"] componentsSeparatedByString:@"\n"]) {
+        if ([line hasPrefix:@"0::"]) {
+            cgroupPath = [line substringFromIndex:3];
+            break;
+        }
+    }
+    NSUInteger limit = total;
+    while (cgroupPath.length > 0) {
+        NSString *cgroupDirectory = [@"sys/fs/cgroup" stringByAppendingPathComponent:cgroupPath];
+        NSUInteger cgroupMax = 0;
+        if (SDLinuxParseCgroupBytes([self contentsAtPath:[cgroupDirectory stringByAppendingPathComponent:@"memory.max"]], &cgroupMax)) {
+            limit = MIN(limit, cgroupMax);
+            NSUInteger cgroupCurrent = 0;
+            if (SDLinuxParseCgroupBytes([self contentsAtPath:[cgroupDirectory stringByAppendingPathComponent:@"memory.current"]], &cgroupCurrent)) {
+                available = MIN(available, cgroupMax > cgroupCurrent ? cgroupMax - cgroupCurrent : 0);
+            }
+        }
+        if ([cgroupPath isEqualToString:@"/"]) {
+            break;
+        }
+        cgroupPath = cgroupPath.stringByDeletingLastPathComponent;
+    }
+    
+    budget->limit = limit;
+    budget->footprint = footprint;
+    budget->available = available;
+    return YES;
+}
+
+@end
+
+#pragma mark - SDDeviceHelper
+
+static id<SDMemoryBudgetProvider> _memoryBudgetProvider;
+
+// The free pages only, used when the memory budget is not available
+static NSUInteger SDSystemFreeMemory(void) {
     mach_port_t host_port = mach_host_self();
     mach_msg_type_number_t host_size = sizeof(vm_statistics_data_t) / sizeof(integer_t);
     vm_size_t page_size;
@@ -30,6 +172,46 @@
     return vm_stat.free_count * page_size;
 }
 
+@implementation SDDeviceHelper
+
++ (id<SDMemoryBudgetProvider>)memoryBudgetProvider {
+    @synchronized (self) {
+        if (!_memoryBudgetProvider) {
+#if defined(__linux__)
+            _memoryBudgetProvider = [[SDLinuxMemoryBudgetProvider alloc] init];
+#else
+            _memoryBudgetProvider = [[SDMachMemoryBudgetProvider alloc] init];
+#endif
+        }
+        return _memoryBudgetProvider;
+    }
+}
+
++ (void)setMemoryBudgetProvider:(id<SDMemoryBudgetProvider>)memoryBudgetProvider {
+    @synchronized (self) {
+        _memoryBudgetProvider = memoryBudgetProvider;
+    }
+}
+
++ (SDMemoryBudget)memoryBudget {
+    SDMemoryBudget budget = {0, 0, 0};
+    if (![self.memoryBudgetProvider getMemoryBudget:&budget] || budget.limit == 0) {
+        // Fallback to the physical memory and the system free memory
+        budget.limit = (NSUInteger)[[NSProcessInfo processInfo] physicalMemory];
+        budget.footprint = 0;
+        budget.available = SDSystemFreeMemory();
+    }
+    return budget;
+}
+
++ (NSUInteger)totalMemory {
+    return [self memoryBudget].limit;
+}
+
++ (NSUInteger)freeMemory {
+    return [self memoryBudget].available;
+}
+
 + (double)screenScale {
 #if SD_VISION
     CGFloat screenScale = UITraitCollection.currentTraitCollection.displayScale;
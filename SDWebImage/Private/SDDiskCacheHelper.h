@@ -0,0 +1,68 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDWebImageCompat.h"
+#import "SDImageCacheConfig.h"
+#import "SDDiskCacheEvictionPolicy.h"
+
+/// The file layout helper methods shared by the built-in disk caches (`SDDiskCache` and `SDContentAddressedDiskCache`)
+@interface SDDiskCacheHelper : NSObject
+
+#pragma mark - Directory
+
+/// Create the cache directory, and exclude it from iCloud backup if `shouldDisableiCloud` is set.
++ (void)createDirectoryAtPath:(nonnull NSString *)path config:(nonnull SDImageCacheConfig *)config fileManager:(nonnull NSFileManager *)fileManager;
+
+/// The files (without hidden files) in the cache directory, with the resource values prefetched.
++ (nonnull NSArray<NSURL *> *)fileURLsInDirectory:(nonnull NSString *)path includingPropertiesForKeys:(nonnull NSArray<NSURLResourceKey> *)keys fileManager:(nonnull NSFileManager *)fileManager;
+
+/// The file date used by expiration and size-based cleanup, decided by `diskCacheExpireType`.
++ (nonnull NSURLResourceKey)contentDateKeyWithConfig:(nonnull SDImageCacheConfig *)config;
+
+#pragma mark - Temporary files
+
+/// The hidden sibling directory for writing, which is on the same volume but not counted as cache files.
++ (nonnull NSString *)temporaryDirectoryPathWithCachePath:(nonnull NSString *)cachePath;
+
+/// A new file URL in the temporary directory, the directory is created if needed.
++ (nonnull NSURL *)uniqueTemporaryURLWithCachePath:(nonnull NSString *)cachePath fileManager:(nonnull NSFileManager *)fileManager;
+
+/// Remove the temporary files left by the interrupted writes.
++ (void)removeExpiredTemporaryFilesWithCachePath:(nonnull NSString *)cachePath fileManager:(nonnull NSFileManager *)fileManager;
+
+#pragma mark - Expiration
+
+/// The per-entry expiration date from HTTP caching headers.
++ (nullable NSDate *)expirationDateAtPath:(nonnull NSString *)path;
++ (void)setExpirationDate:(nullable NSDate *)expirationDate atPath:(nonnull NSString *)path;
+
+/// Whether the file is expired by HTTP caching headers, only when `shouldRespectHTTPCacheExpiration` is set.
++ (BOOL)isExpiredByHTTPCacheAtPath:(nonnull NSString *)path config:(nonnull SDImageCacheConfig *)config;
+
+/// Whether the file should be removed by `removeExpiredData`. The HTTP caching headers expiration is used if available, else `maxDiskAge`.
+/// @param contentDate The file date of `contentDateKeyWithConfig:`.
+/// @param ageExpirationDate The date before which the file is expired by `maxDiskAge`, nil for no limit.
++ (BOOL)isExpiredFileAtPath:(nonnull NSString *)path contentDate:(nullable NSDate *)contentDate ageExpirationDate:(nullable NSDate *)ageExpirationDate config:(nonnull SDImageCacheConfig *)config;
+
+/// The date before which the file is expired by `maxDiskAge`, nil for no limit.
++ (nullable NSDate *)ageExpirationDateWithConfig:(nonnull SDImageCacheConfig *)config;
+
+#pragma mark - Eviction
+
+/// The eviction entry persisted on the file, the identifier is the file name. The size and date is not persisted, filled by caller.
++ (nonnull SDDiskCacheEvictionEntry *)evictionEntryAtPath:(nonnull NSString *)path;
++ (void)setEvictionEntry:(nonnull SDDiskCacheEvictionEntry *)entry atPath:(nonnull NSString *)path;
+
+/// Count the access of file and update the priority by policy, `reset` for the newly written file.
++ (void)updateEvictionEntryAtPath:(nonnull NSString *)path size:(NSUInteger)size reset:(BOOL)reset policy:(nonnull id<SDDiskCacheEvictionPolicy>)policy;
+
+/// Restore and save the `persistentState` of policy, which is stored on the cache directory.
++ (void)restorePersistentStateForPolicy:(nonnull id<SDDiskCacheEvictionPolicy>)policy atPath:(nonnull NSString *)path;
++ (void)savePersistentStateForPolicy:(nonnull id<SDDiskCacheEvictionPolicy>)policy atPath:(nonnull NSString *)path;
+
+@end
@@ -0,0 +1,201 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDDiskCacheHelper.h"
+#import "SDFileAttributeHelper.h"
+
+// The suffix of hidden sibling directory for writing, which is on the same volume but not counted as cache files
+static NSString * const SDDiskCacheTemporaryDirectorySuffix = @".tmp";
+// The temporary files left by the interrupted writes are removed after this age
+static const NSTimeInterval SDDiskCacheTemporaryFileMaxAge = 60 * 60;
+// The eviction metadata of cache file, and the policy state of cache directory
+static NSString * const SDDiskCacheEvictionAttributeName = @"com.hackemist.SDDiskCache.eviction";
+// The per-entry expiration date of cache file, the time interval since 1970
+static NSString * const SDDiskCacheExpirationAttributeName = @"com.hackemist.SDDiskCache.expiration";
+
+typedef struct SDDiskCacheEvictionRecord {
+    uint32_t accessCount;
+    uint32_t reserved;
+    double fetchCost;
+    double priority;
+} SDDiskCacheEvictionRecord;
+
+@implementation SDDiskCacheHelper
+
+#pragma mark - Directory
+
++ (void)createDirectoryAtPath:(NSString *)path config:(SDImageCacheConfig *)config fileManager:(NSFileManager *)fileManager {
+    [fileManager createDirectoryAtPath:path
+           withIntermediateDirectories:YES
+                            attributes:nil
+                                 error:NULL];
+    
+    // disable iCloud backup
+    if (config.shouldDisableiCloud) {
+        // ignore iCloud backup resource value error
+        [[NSURL fileURLWithPath:path isDirectory:YES] setResourceValue:@YES forKey:NSURLIsExcludedFromBackupKey error:nil];
+    }
+}
+
++ (NSArray<NSURL *> *)fileURLsInDirectory:(NSString *)path includingPropertiesForKeys:(NSArray<NSURLResourceKey> *)keys fileManager:(NSFileManager *)fileManager {
+    NSURL *directoryURL = [NSURL fileURLWithPath:path isDirectory:YES];
+    return [fileManager contentsOfDirectoryAtURL:directoryURL
+                      includingPropertiesForKeys:keys
+                                         options:NSDirectoryEnumerationSkipsHiddenFiles
+                                           error:nil] ?: @[];
+}
+
++ (NSURLResourceKey)contentDateKeyWithConfig:(SDImageCacheConfig *)config {
+    switch (config.diskCacheExpireType) {
+        case SDImageCacheConfigExpireTypeModificationDate:
+            return NSURLContentModificationDateKey;
+        case SDImageCacheConfigExpireTypeCreationDate:
+            return NSURLCreationDateKey;
+        case SDImageCacheConfigExpireTypeChangeDate:
+            return NSURLAttributeModificationDateKey;
+        case SDImageCacheConfigExpireTypeAccessDate:
+        default:
+            return NSURLContentAccessDateKey;
+    }
+}
+
+#pragma mark - Temporary files
+
++ (NSString *)temporaryDirectoryPathWithCachePath:(NSString *)cachePath {
+    NSString *directoryName = [NSString stringWithFormat:@".%@%@", cachePath.lastPathComponent, SDDiskCacheTemporaryDirectorySuffix];
+    return [cachePath.stringByDeletingLastPathComponent stringByAppendingPathComponent:directoryName];
+}
+
++ (NSURL *)uniqueTemporaryURLWithCachePath:(NSString *)cachePath fileManager:(NSFileManager *)fileManager {
+    NSString *temporaryDirectoryPath = [self temporaryDirectoryPathWithCachePath:cachePath];
+    [fileManager createDirectoryAtPath:temporaryDirectoryPath withIntermediateDirectories:YES attributes:nil error:NULL];
+    NSString *temporaryPath = [temporaryDirectoryPath stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    
+    return [NSURL fileURLWithPath:temporaryPath isDirectory:NO];
+}
+
++ (void)removeExpiredTemporaryFilesWithCachePath:(NSString *)cachePath fileManager:(NSFileManager *)fileManager {
+    NSURL *temporaryDirectoryURL = [NSURL fileURLWithPath:[self temporaryDirectoryPathWithCachePath:cachePath] isDirectory:YES];
+    NSArray<NSURL *> *temporaryURLs = [fileManager contentsOfDirectoryAtURL:temporaryDirectoryURL includingPropertiesForKeys:@[NSURLContentModificationDateKey] options:0 error:nil];
+    NSDate *expirationDate = [NSDate dateWithTimeIntervalSinceNow:-SDDiskCacheTemporaryFileMaxAge];
+    for (NSURL *temporaryURL in temporaryURLs) {
+        NSDate *modifiedDate;
+        [temporaryURL getResourceValue:&modifiedDate forKey:NSURLContentModificationDateKey error:nil];
+        if (modifiedDate && [modifiedDate compare:expirationDate] == NSOrderedAscending) {
+            [fileManager removeItemAtURL:temporaryURL error:nil];
+        }
+    }
+}
+
+#pragma mark - Expiration
+
++ (NSDate *)expirationDateAtPath:(NSString *)path {
+    NSData *data = [SDFileAttributeHelper extendedAttribute:SDDiskCacheExpirationAttributeName atPath:path traverseLink:NO error:nil];
+    if (data.length != sizeof(double)) {
+        return nil;
+    }
+    double timeInterval;
+    [data getBytes:&timeInterval length:sizeof(timeInterval)];
+    return [NSDate dateWithTimeIntervalSince1970:timeInterval];
+}
+
++ (void)setExpirationDate:(NSDate *)expirationDate atPath:(NSString *)path {
+    if (!expirationDate) {
+        // Remove
+        [SDFileAttributeHelper removeExtendedAttribute:SDDiskCacheExpirationAttributeName atPath:path traverseLink:NO error:nil];
+    } else {
+        // Override
+        double timeInterval = expirationDate.timeIntervalSince1970;
+        NSData *data = [NSData dataWithBytes:&timeInterval length:sizeof(timeInterval)];
+        [SDFileAttributeHelper setExtendedAttribute:SDDiskCacheExpirationAttributeName value:data atPath:path traverseLink:NO overwrite:YES error:nil];
+    }
+}
+
++ (BOOL)isExpiredByHTTPCacheAtPath:(NSString *)path config:(SDImageCacheConfig *)config {
+    if (!config.shouldRespectHTTPCacheExpiration) {
+        return NO;
+    }
+    NSDate *expirationDate = [self expirationDateAtPath:path];
+    return expirationDate && expirationDate.timeIntervalSinceNow <= 0;
+}
+
++ (BOOL)isExpiredFileAtPath:(NSString *)path contentDate:(NSDate *)contentDate ageExpirationDate:(NSDate *)ageExpirationDate config:(SDImageCacheConfig *)config {
+    // Remove files that are expired by HTTP caching headers, instead of `maxDiskAge`
+    NSDate *entryExpirationDate = config.shouldRespectHTTPCacheExpiration ? [self expirationDateAtPath:path] : nil;
+    if (entryExpirationDate) {
+        return entryExpirationDate.timeIntervalSinceNow <= 0;
+    }
+    // Remove files that are older than the expiration date;
+    return ageExpirationDate && [[contentDate laterDate:ageExpirationDate] isEqualToDate:ageExpirationDate];
+}
+
++ (NSDate *)ageExpirationDateWithConfig:(SDImageCacheConfig *)config {
+    return (config.maxDiskAge < 0) ? nil : [NSDate dateWithTimeIntervalSinceNow:-config.maxDiskAge];
+}
+
+#pragma mark - Eviction
+
++ (SDDiskCacheEvictionEntry *)evictionEntryAtPath:(NSString *)path {
+    SDDiskCacheEvictionEntry *entry = [[SDDiskCacheEvictionEntry alloc] initWithIdentifier:path.lastPathComponent];
+    NSData *data = [SDFileAttributeHelper extendedAttribute:SDDiskCacheEvictionAttributeName atPath:path traverseLink:NO error:nil];
+    if (data.length == sizeof(SDDiskCacheEvictionRecord)) {
+        SDDiskCacheEvictionRecord record;
+        [data getBytes:&record length:sizeof(record)];
+        entry.accessCount = record.accessCount;
+        entry.fetchCost = record.fetchCost;
+        entry.priority = record.priority;
+    }
+    return entry;
+}
+
++ (void)setEvictionEntry:(SDDiskCacheEvictionEntry *)entry atPath:(NSString *)path {
+    SDDiskCacheEvictionRecord record = {
+        .accessCount = (uint32_t)MIN(entry.accessCount, UINT32_MAX),
+        .reserved = 0,
+        .fetchCost = entry.fetchCost,
+        .priority = entry.priority,
+    };
+    NSData *data = [NSData dataWithBytes:&record length:sizeof(record)];
+    [SDFileAttributeHelper setExtendedAttribute:SDDiskCacheEvictionAttributeName value:data atPath:path traverseLink:NO overwrite:YES error:nil];
+}
+
++ (void)updateEvictionEntryAtPath:(NSString *)path size:(NSUInteger)size reset:(BOOL)reset policy:(id<SDDiskCacheEvictionPolicy>)policy {
+    SDDiskCacheEvictionEntry *entry;
+    if (reset) {
+        entry = [[SDDiskCacheEvictionEntry alloc] initWithIdentifier:path.lastPathComponent];
+    } else {
+        entry = [self evictionEntryAtPath:path];
+    }
+    entry.size = size;
+    entry.date = [NSDate date];
+    entry.accessCount += 1;
+    [policy updatePriorityForEntry:entry];
+    [self setEvictionEntry:entry atPath:path];
+}
+
++ (void)restorePersistentStateForPolicy:(id<SDDiskCacheEvictionPolicy>)policy atPath:(NSString *)path {
+    if (![policy respondsToSelector:@selector(setPersistentState:)]) {
+        return;
+    }
+    NSData *state = [SDFileAttributeHelper extendedAttribute:SDDiskCacheEvictionAttributeName atPath:path traverseLink:NO error:nil];
+    if (state) {
+        policy.persistentState = state;
+    }
+}
+
++ (void)savePersistentStateForPolicy:(id<SDDiskCacheEvictionPolicy>)policy atPath:(NSString *)path {
+    if (![policy respondsToSelector:@selector(persistentState)]) {
+        return;
+    }
+    NSData *state = policy.persistentState;
+    if (state) {
+        [SDFileAttributeHelper setExtendedAttribute:SDDiskCacheEvictionAttributeName value:state atPath:path traverseLink:NO overwrite:YES error:nil];
+    }
+}
+
+@end
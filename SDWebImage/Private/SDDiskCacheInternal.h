@@ -0,0 +1,17 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDWebImageCompat.h"
+#import "SDDiskCache.h"
+
+@interface SDDiskCache ()
+
+/// The total allocated size of cache files, which is the size used by `removeDataToFitSize:`, while `totalSize` is the sum of file size.
+- (NSUInteger)totalAllocatedSize;
+
+@end
@@ -11,13 +11,22 @@
 
 /// A Image-Asset manager to work like UIKit/AppKit's image cache behavior
 /// Apple parse the Asset Catalog compiled file(`Assets.car`) by CoreUI.framework, however it's a private framework and there are no other ways to directly get the data. So we just process the normal bundle files :)
+/// The first lookup in a bundle schedules a one-time index of its resource files (file name -> path) on a background queue. Until the index is ready, lookups fallback to `-[NSBundle pathForResource:ofType:]`.
 @interface SDImageAssetManager : NSObject
 
-@property (nonatomic, strong, nonnull) NSMapTable<NSString *, UIImage *> *imageTable;
+/// The name -> image table. This is an immutable snapshot which is replaced as a whole on write (copy-on-write), so readers never need to take the write lock.
+@property (atomic, strong, readonly, nonnull) NSMapTable<NSString *, UIImage *> *imageTable;
 
 + (nonnull instancetype)sharedAssetManager;
 - (nullable NSString *)getPathForName:(nonnull NSString *)name bundle:(nonnull NSBundle *)bundle preferredScale:(nonnull CGFloat *)scale;
 - (nullable UIImage *)imageForName:(nonnull NSString *)name;
 - (void)storeImage:(nonnull UIImage *)image forName:(nonnull NSString *)name;
 
+/// Return the resource index of bundle, or nil if the index is still building. This call schedule the index building if it's not started yet.
+/// @note The index key is the lowercased file name with extension (like `image@2x.png`), the value is the full file path. The device modifier (like `image~ipad.png`) of current device is removed from the key and preferred.
+- (nullable NSDictionary<NSString *, NSString *> *)resourceIndexForBundle:(nonnull NSBundle *)bundle;
+
+/// Schedule the index building of bundle if it's not started yet, and call the completion block on a background queue after the index is built.
+- (void)resourceIndexForBundle:(nonnull NSBundle *)bundle completion:(nonnull void(^)(NSDictionary<NSString *, NSString *> * _Nullable index))completionBlock;
+
 @end
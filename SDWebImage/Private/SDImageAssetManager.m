@@ -26,8 +26,99 @@ static NSArray *SDBundlePreferredScales(void) {
     return scales;
 }
 
+// The `@Nx` suffix for each preferred scale, same order as `SDBundlePreferredScales`, avoid formatting the string each lookup
+static NSArray<NSString *> *SDBundlePreferredScaleSuffixes(void) {
+    static NSArray *suffixes;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSArray *scales = SDBundlePreferredScales();
+        NSMutableArray *mutableSuffixes = [NSMutableArray arrayWithCapacity:scales.count];
+        for (NSNumber *scaleValue in scales) {
+            [mutableSuffixes addObject:[NSString stringWithFormat:@"@%@x", scaleValue]];
+        }
+        suffixes = [mutableSuffixes copy];
+    });
+    return suffixes;
+}
+
+// The device modifier of resource file name (like `image~ipad.png`), which `-[NSBundle pathForResource:ofType:]` prefer to the unmodified one on that device
+static NSString *SDBundleDeviceModifier(void) {
+    static NSString *modifier;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+#if SD_UIKIT
+        UIUserInterfaceIdiom idiom = UIDevice.currentDevice.userInterfaceIdiom;
+        if (idiom == UIUserInterfaceIdiomPad) {
+            modifier = @"~ipad";
+        } else if (idiom == UIUserInterfaceIdiomPhone) {
+            modifier = @"~iphone";
+        }
+#endif
+    });
+    return modifier;
+}
+
+// The index key is case-folded, so the lookup match the case-insensitive file system like `-[NSBundle pathForResource:ofType:]`
+static inline NSString *SDBundleResourceIndexKey(NSString *fileName) {
+    return fileName.lowercaseString;
+}
+
+// Build the file name -> path index for bundle resources, match the search order of `-[NSBundle pathForResource:ofType:]`: the non-localized resource directory first, then the preferred localization folders. In each directory, the file with device modifier is preferred
+static NSDictionary<NSString *, NSString *> *SDBundleBuildResourceIndex(NSBundle *bundle) {
+    NSString *resourcePath = bundle.resourcePath;
+    if (!resourcePath) {
+        return @{};
+    }
+    NSFileManager *fileManager = [[NSFileManager alloc] init];
+    NSString *deviceModifier = SDBundleDeviceModifier();
+    NSMutableArray<NSString *> *directories = [NSMutableArray array];
+    // Lower priority first, the later one override the previous one
+    for (NSString *localization in bundle.preferredLocalizations.reverseObjectEnumerator) {
+        [directories addObject:[resourcePath stringByAppendingPathComponent:[localization stringByAppendingPathExtension:@"lproj"]]];
+    }
+    [directories addObject:resourcePath];
+    NSMutableDictionary<NSString *, NSString *> *index = [NSMutableDictionary dictionary];
+    for (NSString *directory in directories) {
+        NSArray<NSString *> *fileNames = [fileManager contentsOfDirectoryAtPath:directory error:nil];
+        NSMutableDictionary<NSString *, NSString *> *modifiedIndex = [NSMutableDictionary dictionary];
+        for (NSString *fileName in fileNames) {
+            NSString *extension = fileName.pathExtension;
+            if (extension.length == 0) {
+                // Images always have extension, skip directories and other files
+                continue;
+            }
+            NSString *path = [directory stringByAppendingPathComponent:fileName];
+            index[SDBundleResourceIndexKey(fileName)] = path;
+            NSString *name = fileName.stringByDeletingPathExtension;
+            if (deviceModifier && [name hasSuffix:deviceModifier]) {
+                name = [name substringToIndex:name.length - deviceModifier.length];
+                modifiedIndex[SDBundleResourceIndexKey([name stringByAppendingPathExtension:extension])] = path;
+            }
+        }
+        [index addEntriesFromDictionary:modifiedIndex];
+    }
+    return [index copy];
+}
+
+// The index contains all the top-level resource files, so the miss is authoritative and does not fallback to the bundle
+static inline NSString *SDBundlePathForResource(NSBundle *bundle, NSDictionary<NSString *, NSString *> *index, NSString *name, NSString *extension) {
+    if (index) {
+        return index[SDBundleResourceIndexKey([name stringByAppendingPathExtension:extension])];
+    }
+    return [bundle pathForResource:name ofType:extension];
+}
+
+@interface SDImageAssetManager ()
+
+@property (atomic, strong, readwrite, nonnull) NSMapTable<NSString *, UIImage *> *imageTable;
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSString *, id> *bundleIndexes; // bundle path -> index, or NSNull when building
+@property (nonatomic, strong, nonnull) dispatch_queue_t indexQueue;
+
+@end
+
 @implementation SDImageAssetManager {
     SD_LOCK_DECLARE(_lock);
+    SD_LOCK_DECLARE(_indexLock);
 }
 
 + (instancetype)sharedAssetManager {
@@ -42,16 +133,12 @@ static NSArray *SDBundlePreferredScales(void) {
 - (instancetype)init {
     self = [super init];
     if (self) {
-        NSPointerFunctionsOptions valueOptions;
-#if SD_MAC
-        // Apple says that NSImage use a weak reference to value
-        valueOptions = NSPointerFunctionsWeakMemory;
-#else
-        // Apple says that UIImage use a strong reference to value
-        valueOptions = NSPointerFunctionsStrongMemory;
-#endif
-        _imageTable = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsCopyIn valueOptions:valueOptions];
+        _imageTable = [self.class emptyImageTable];
+        _bundleIndexes = [NSMutableDictionary dictionary];
+        _indexQueue = dispatch_queue_create("com.hackemist.SDImageAssetManager.indexQueue", DISPATCH_QUEUE_SERIAL);
+        dispatch_set_target_queue(_indexQueue, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0));
         SD_LOCK_INIT(_lock);
+        SD_LOCK_INIT(_indexLock);
 #if SD_UIKIT
         [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(didReceiveMemoryWarning:) name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
 #endif
@@ -59,6 +146,18 @@ static NSArray *SDBundlePreferredScales(void) {
     return self;
 }
 
++ (NSMapTable<NSString *, UIImage *> *)emptyImageTable {
+    NSPointerFunctionsOptions valueOptions;
+#if SD_MAC
+    // Apple says that NSImage use a weak reference to value
+    valueOptions = NSPointerFunctionsWeakMemory;
+#else
+    // Apple says that UIImage use a strong reference to value
+    valueOptions = NSPointerFunctionsStrongMemory;
+#endif
+    return [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsCopyIn valueOptions:valueOptions];
+}
+
 - (void)dealloc {
 #if SD_UIKIT
     [[NSNotificationCenter defaultCenter] removeObserver:self name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
@@ -67,10 +166,55 @@ static NSArray *SDBundlePreferredScales(void) {
 
 - (void)didReceiveMemoryWarning:(NSNotification *)notification {
     SD_LOCK(_lock);
-    [self.imageTable removeAllObjects];
+    self.imageTable = [self.class emptyImageTable];
     SD_UNLOCK(_lock);
 }
 
+- (NSDictionary<NSString *, NSString *> *)resourceIndexForBundle:(NSBundle *)bundle {
+    NSParameterAssert(bundle);
+    NSString *bundlePath = bundle.bundlePath;
+    if (!bundlePath) {
+        return nil;
+    }
+    id index;
+    BOOL shouldBuild = NO;
+    SD_LOCK(_indexLock);
+    index = self.bundleIndexes[bundlePath];
+    if (!index) {
+        self.bundleIndexes[bundlePath] = [NSNull null];
+        shouldBuild = YES;
+    }
+    SD_UNLOCK(_indexLock);
+    if (shouldBuild) {
+        dispatch_async(self.indexQueue, ^{
+            NSDictionary *resourceIndex = SDBundleBuildResourceIndex(bundle);
+            SD_LOCK(self->_indexLock);
+            self.bundleIndexes[bundlePath] = resourceIndex;
+            SD_UNLOCK(self->_indexLock);
+        });
+    }
+    if (index == [NSNull null]) {
+        return nil;
+    }
+    return index;
+}
+
+- (void)resourceIndexForBundle:(NSBundle *)bundle completion:(void (^)(NSDictionary<NSString *,NSString *> * _Nullable))completionBlock {
+    NSParameterAssert(completionBlock);
+    // Schedule the building if needed, the serial queue call the completion after that
+    [self resourceIndexForBundle:bundle];
+    NSString *bundlePath = bundle.bundlePath;
+    dispatch_async(self.indexQueue, ^{
+        NSDictionary<NSString *, NSString *> *index;
+        if (bundlePath) {
+            SD_LOCK(self->_indexLock);
+            index = self.bundleIndexes[bundlePath];
+            SD_UNLOCK(self->_indexLock);
+        }
+        completionBlock(index);
+    });
+}
+
 - (NSString *)getPathForName:(NSString *)name bundle:(NSBundle *)bundle preferredScale:(CGFloat *)scale {
     NSParameterAssert(name);
     NSParameterAssert(bundle);
@@ -88,14 +232,21 @@ static NSArray *SDBundlePreferredScales(void) {
     }
     name = [name stringByDeletingPathExtension];
     
+    // The index only contains the top-level resource files, name with sub-directory use the bundle lookup
+    NSDictionary<NSString *, NSString *> *index;
+    if ([name rangeOfString:@"/"].location == NSNotFound) {
+        index = [self resourceIndexForBundle:bundle];
+    }
+    
     CGFloat providedScale = *scale;
     NSArray *scales = SDBundlePreferredScales();
+    NSArray<NSString *> *suffixes = SDBundlePreferredScaleSuffixes();
     
     // Check if file name contains scale
     for (size_t i = 0; i < scales.count; i++) {
         NSNumber *scaleValue = scales[i];
-        if ([name hasSuffix:[NSString stringWithFormat:@"@%@x", scaleValue]]) {
-            path = [bundle pathForResource:name ofType:extension];
+        if ([name hasSuffix:suffixes[i]]) {
+            path = SDBundlePathForResource(bundle, index, name, extension);
             if (path) {
                 *scale = scaleValue.doubleValue; // override
                 return path;
@@ -106,7 +257,7 @@ static NSArray *SDBundlePreferredScales(void) {
     // Search with provided scale first
     if (providedScale != 0) {
         NSString *scaledName = [name stringByAppendingFormat:@"@%@x", @(providedScale)];
-        path = [bundle pathForResource:scaledName ofType:extension];
+        path = SDBundlePathForResource(bundle, index, scaledName, extension);
         if (path) {
             return path;
         }
@@ -119,8 +270,8 @@ static NSArray *SDBundlePreferredScales(void) {
             // Ignore provided scale
             continue;
         }
-        NSString *scaledName = [name stringByAppendingFormat:@"@%@x", scaleValue];
-        path = [bundle pathForResource:scaledName ofType:extension];
+        NSString *scaledName = [name stringByAppendingString:suffixes[i]];
+        path = SDBundlePathForResource(bundle, index, scaledName, extension);
         if (path) {
             *scale = scaleValue.doubleValue; // override
             return path;
@@ -128,25 +279,24 @@ static NSArray *SDBundlePreferredScales(void) {
     }
     
     // Search without scale
-    path = [bundle pathForResource:name ofType:extension];
+    path = SDBundlePathForResource(bundle, index, name, extension);
     
     return path;
 }
 
 - (UIImage *)imageForName:(NSString *)name {
     NSParameterAssert(name);
-    UIImage *image;
-    SD_LOCK(_lock);
-    image = [self.imageTable objectForKey:name];
-    SD_UNLOCK(_lock);
-    return image;
+    // Read from the immutable snapshot, no lock needed
+    return [self.imageTable objectForKey:name];
 }
 
 - (void)storeImage:(UIImage *)image forName:(NSString *)name {
     NSParameterAssert(image);
     NSParameterAssert(name);
     SD_LOCK(_lock);
-    [self.imageTable setObject:image forKey:name];
+    NSMapTable<NSString *, UIImage *> *imageTable = [self.imageTable copy];
+    [imageTable setObject:image forKey:name];
+    self.imageTable = imageTable;
     SD_UNLOCK(_lock);
 }
 
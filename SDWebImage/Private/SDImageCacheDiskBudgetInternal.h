@@ -0,0 +1,19 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDWebImageCompat.h"
+#import "SDImageCacheDiskBudget.h"
+
+// The disk usage report from cache, called on the cache's IO queue
+@interface SDImageCacheDiskBudget ()
+
+- (void)cache:(nonnull SDImageCache *)cache didChangeDiskUsageBy:(NSInteger)delta;
+- (void)cache:(nonnull SDImageCache *)cache didResetDiskUsage:(NSUInteger)usedSize;
+- (void)cacheDidHitDiskData:(nonnull SDImageCache *)cache;
+
+@end
@@ -0,0 +1,17 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDWebImageCompat.h"
+#import "SDImageCache.h"
+
+@interface SDImageCache ()
+
+/// The disk budget which the cache joined, set by `SDImageCacheDiskBudget` when adding or removing the cache.
+@property (nonatomic, weak, readwrite, nullable) SDImageCacheDiskBudget *diskBudget;
+
+@end
@@ -45,24 +45,52 @@ else lock##_deprecated = OS_SPINLOCK_INIT;
 #endif
 #endif
 
-#ifndef SD_LOCK
+#ifndef SD_LOCK_RAW
 #if SD_USE_OS_UNFAIR_LOCK
-#define SD_LOCK(lock) os_unfair_lock_lock(&lock)
+#define SD_LOCK_RAW(lock) os_unfair_lock_lock(&lock)
 #else
-#define SD_LOCK(lock) if (@available(iOS 10, tvOS 10, watchOS 3, macOS 10.12, *)) os_unfair_lock_lock(&lock); \
+#define SD_LOCK_RAW(lock) if (@available(iOS 10, tvOS 10, watchOS 3, macOS 10.12, *)) os_unfair_lock_lock(&lock); \
 else OSSpinLockLock(&lock##_deprecated);
 #endif
 #endif
 
-#ifndef SD_UNLOCK
+#ifndef SD_UNLOCK_RAW
 #if SD_USE_OS_UNFAIR_LOCK
-#define SD_UNLOCK(lock) os_unfair_lock_unlock(&lock)
+#define SD_UNLOCK_RAW(lock) os_unfair_lock_unlock(&lock)
 #else
-#define SD_UNLOCK(lock) if (@available(iOS 10, tvOS 10, watchOS 3, macOS 10.12, *)) os_unfair_lock_unlock(&lock); \
+#define SD_UNLOCK_RAW(lock) if (@available(iOS 10, tvOS 10, watchOS 3, macOS 10.12, *)) os_unfair_lock_unlock(&lock); \
 else OSSpinLockUnlock(&lock##_deprecated);
 #endif
 #endif
 
+// Set `SD_LOCK_PROFILING=1` in preprocessor macros (Debug build only) to record the acquisition count, wait time and hold time for each `SD_LOCK` site, see `SDLockProfiler`
+#ifndef SD_LOCK_PROFILING
+#define SD_LOCK_PROFILING 0
+#endif
+
+#if SD_LOCK_PROFILING
+#import "SDLockProfiler.h"
+#endif
+
+#ifndef SD_LOCK
+#if SD_LOCK_PROFILING
+#define SD_LOCK(lock) do { uint64_t sd_lock_wait_begin = sd_lockProfilerTime(); \
+SD_LOCK_RAW(lock); \
+sd_lockProfilerDidLock(&lock, __FILE__, __LINE__, sd_lock_wait_begin); } while (0)
+#else
+#define SD_LOCK(lock) SD_LOCK_RAW(lock)
+#endif
+#endif
+
+#ifndef SD_UNLOCK
+#if SD_LOCK_PROFILING
+#define SD_UNLOCK(lock) do { sd_lockProfilerWillUnlock(&lock); \
+SD_UNLOCK_RAW(lock); } while (0)
+#else
+#define SD_UNLOCK(lock) SD_UNLOCK_RAW(lock)
+#endif
+#endif
+
 #ifndef SD_OPTIONS_CONTAINS
 #define SD_OPTIONS_CONTAINS(options, value) (((options) & (value)) == (value))
 #endif
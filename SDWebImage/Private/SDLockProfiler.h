@@ -0,0 +1,50 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import <Foundation/Foundation.h>
+
+/// The statistic keys for each lock site
+FOUNDATION_EXPORT NSString * _Nonnull const SDLockProfilerFileKey; // NSString, the source file name
+FOUNDATION_EXPORT NSString * _Nonnull const SDLockProfilerLineKey; // NSNumber, the source line
+FOUNDATION_EXPORT NSString * _Nonnull const SDLockProfilerCountKey; // NSNumber, the acquisition count
+FOUNDATION_EXPORT NSString * _Nonnull const SDLockProfilerContendedCountKey; // NSNumber, the acquisition count which wait longer than 1 microsecond
+FOUNDATION_EXPORT NSString * _Nonnull const SDLockProfilerWaitTimeKey; // NSNumber, the total wait time in seconds
+FOUNDATION_EXPORT NSString * _Nonnull const SDLockProfilerMaxWaitTimeKey; // NSNumber, the max wait time in seconds
+FOUNDATION_EXPORT NSString * _Nonnull const SDLockProfilerHoldTimeKey; // NSNumber, the total hold time in seconds
+
+/// A lock contention profiler for the `SD_LOCK`/`SD_UNLOCK` sites, only works when build with `SD_LOCK_PROFILING=1` (see `SDInternalMacros.h`).
+/// The statistics are recorded in a fixed size lock-free table, keyed by the source file and line of `SD_LOCK`. The hold time is recorded to the `SD_LOCK` site which acquired the lock.
+/// @note `@synchronized` blocks are not recorded.
+@interface SDLockProfiler : NSObject
+
+/// Whether the library is built with `SD_LOCK_PROFILING=1`.
+@property (nonatomic, class, readonly, getter=isEnabled) BOOL enabled;
+
+/// The statistics for each lock site, sorted by total wait time in descending order (the hottest lock first).
++ (nonnull NSArray<NSDictionary<NSString *, id> *> *)statistics;
+
+/// A human readable table of the statistics.
++ (nonnull NSString *)dumpDescription;
+
+/// Reset all the statistics.
++ (void)reset;
+
+@end
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+    /// The current time in mach absolute unit.
+    uint64_t sd_lockProfilerTime(void);
+    /// Called by `SD_LOCK` after the lock acquired.
+    void sd_lockProfilerDidLock(const void * _Nonnull lock, const char * _Nonnull file, int line, uint64_t waitBegin);
+    /// Called by `SD_UNLOCK` before the lock released.
+    void sd_lockProfilerWillUnlock(const void * _Nonnull lock);
+#if defined(__cplusplus)
+}
+#endif
@@ -0,0 +1,197 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDLockProfiler.h"
+#import "SDInternalMacros.h"
+#import <mach/mach_time.h>
+#import <stdatomic.h>
+
+NSString * const SDLockProfilerFileKey = @"file";
+NSString * const SDLockProfilerLineKey = @"line";
+NSString * const SDLockProfilerCountKey = @"count";
+NSString * const SDLockProfilerContendedCountKey = @"contendedCount";
+NSString * const SDLockProfilerWaitTimeKey = @"waitTime";
+NSString * const SDLockProfilerMaxWaitTimeKey = @"maxWaitTime";
+NSString * const SDLockProfilerHoldTimeKey = @"holdTime";
+
+// Power of 2, much more than the lock sites in library
+#define SD_LOCK_PROFILER_SITE_COUNT 1024
+// The max nested lock depth tracked per thread
+#define SD_LOCK_PROFILER_STACK_DEPTH 16
+// Wait longer than this is treated as contended, uncontended `os_unfair_lock` cost tens of nanoseconds
+#define SD_LOCK_PROFILER_CONTENDED_NANOSECONDS 1000
+
+typedef struct {
+    _Atomic(const char *) file; // NULL means empty slot, the file and line pair is the key
+    _Atomic(int) line;
+    _Atomic(uint64_t) count;
+    _Atomic(uint64_t) contendedCount;
+    _Atomic(uint64_t) waitTime; // mach absolute unit
+    _Atomic(uint64_t) maxWaitTime;
+    _Atomic(uint64_t) holdTime;
+} SDLockProfilerSite;
+
+typedef struct {
+    const void *lock;
+    SDLockProfilerSite *site;
+    uint64_t lockTime;
+} SDLockProfilerHeldLock;
+
+static SDLockProfilerSite SDLockProfilerSites[SD_LOCK_PROFILER_SITE_COUNT];
+static __thread SDLockProfilerHeldLock SDLockProfilerHeldLocks[SD_LOCK_PROFILER_STACK_DEPTH];
+static __thread NSUInteger SDLockProfilerHeldLockCount;
+
+static double SDLockProfilerSecondsFromTime(uint64_t time) {
+    static mach_timebase_info_data_t timebase;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        mach_timebase_info(&timebase);
+    });
+    return (double)time * timebase.numer / timebase.denom / NSEC_PER_SEC;
+}
+
+// The slot is being claimed by other thread, the key is not complete yet
+#define SD_LOCK_PROFILER_CLAIMING ((const char *)1)
+
+static SDLockProfilerSite *SDLockProfilerSiteFor(const char *file, int line) {
+    NSUInteger hash = ((uintptr_t)file >> 4) ^ ((NSUInteger)line * 2654435761u);
+    for (NSUInteger i = 0; i < SD_LOCK_PROFILER_SITE_COUNT; i++) {
+        SDLockProfilerSite *site = &SDLockProfilerSites[(hash + i) & (SD_LOCK_PROFILER_SITE_COUNT - 1)];
+        const char *siteFile = atomic_load_explicit(&site->file, memory_order_acquire);
+        if (!siteFile) {
+            // Claim the empty slot, then publish the line before the file so the readers always see a complete key
+            const char *expected = NULL;
+            if (atomic_compare_exchange_strong_explicit(&site->file, &expected, SD_LOCK_PROFILER_CLAIMING, memory_order_acquire, memory_order_acquire)) {
+                atomic_store_explicit(&site->line, line, memory_order_relaxed);
+                atomic_store_explicit(&site->file, file, memory_order_release);
+                return site;
+            }
+            siteFile = expected;
+        }
+        while (siteFile == SD_LOCK_PROFILER_CLAIMING) {
+            siteFile = atomic_load_explicit(&site->file, memory_order_acquire);
+        }
+        if (siteFile == file && atomic_load_explicit(&site->line, memory_order_relaxed) == line) {
+            return site;
+        }
+    }
+    // Table full
+    return NULL;
+}
+
+uint64_t sd_lockProfilerTime(void) {
+    return mach_absolute_time();
+}
+
+void sd_lockProfilerDidLock(const void *lock, const char *file, int line, uint64_t waitBegin) {
+    uint64_t lockTime = mach_absolute_time();
+    SDLockProfilerSite *site = SDLockProfilerSiteFor(file, line);
+    if (!site) {
+        return;
+    }
+    uint64_t waitTime = lockTime - waitBegin;
+    atomic_fetch_add_explicit(&site->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&site->waitTime, waitTime, memory_order_relaxed);
+    if (SDLockProfilerSecondsFromTime(waitTime) * NSEC_PER_SEC > SD_LOCK_PROFILER_CONTENDED_NANOSECONDS) {
+        atomic_fetch_add_explicit(&site->contendedCount, 1, memory_order_relaxed);
+    }
+    uint64_t maxWaitTime = atomic_load_explicit(&site->maxWaitTime, memory_order_relaxed);
+    while (waitTime > maxWaitTime && !atomic_compare_exchange_weak_explicit(&site->maxWaitTime, &maxWaitTime, waitTime, memory_order_relaxed, memory_order_relaxed)) {}
+    
+    NSUInteger depth = SDLockProfilerHeldLockCount;
+    if (depth < SD_LOCK_PROFILER_STACK_DEPTH) {
+        SDLockProfilerHeldLocks[depth] = (SDLockProfilerHeldLock){lock, site, lockTime};
+    }
+    SDLockProfilerHeldLockCount = depth + 1;
+}
+
+void sd_lockProfilerWillUnlock(const void *lock) {
+    NSUInteger depth = SDLockProfilerHeldLockCount;
+    if (depth == 0) {
+        return;
+    }
+    uint64_t unlockTime = mach_absolute_time();
+    NSUInteger tracked = MIN(depth, SD_LOCK_PROFILER_STACK_DEPTH);
+    // Locks are almost always released in LIFO order, search from the top
+    for (NSInteger i = tracked - 1; i >= 0; i--) {
+        SDLockProfilerHeldLock heldLock = SDLockProfilerHeldLocks[i];
+        if (heldLock.lock != lock) {
+            continue;
+        }
+        atomic_fetch_add_explicit(&heldLock.site->holdTime, unlockTime - heldLock.lockTime, memory_order_relaxed);
+        // Remove from the stack
+        for (NSUInteger j = i; j + 1 < tracked; j++) {
+            SDLockProfilerHeldLocks[j] = SDLockProfilerHeldLocks[j + 1];
+        }
+        break;
+    }
+    SDLockProfilerHeldLockCount = depth - 1;
+}
+
+@implementation SDLockProfiler
+
++ (BOOL)isEnabled {
+    return SD_LOCK_PROFILING;
+}
+
++ (NSArray<NSDictionary<NSString *,id> *> *)statistics {
+    NSMutableArray<NSDictionary<NSString *, id> *> *statistics = [NSMutableArray array];
+    for (NSUInteger i = 0; i < SD_LOCK_PROFILER_SITE_COUNT; i++) {
+        SDLockProfilerSite *site = &SDLockProfilerSites[i];
+        const char *file = atomic_load_explicit(&site->file, memory_order_acquire);
+        if (!file || file == SD_LOCK_PROFILER_CLAIMING) {
+            continue;
+        }
+        uint64_t count = atomic_load_explicit(&site->count, memory_order_relaxed);
+        if (count == 0) {
+            continue;
+        }
+        [statistics addObject:@{
+            SDLockProfilerFileKey : @(file).lastPathComponent ?: @"",
+            SDLockProfilerLineKey : @(atomic_load_explicit(&site->line, memory_order_relaxed)),
+            SDLockProfilerCountKey : @(count),
+            SDLockProfilerContendedCountKey : @(atomic_load_explicit(&site->contendedCount, memory_order_relaxed)),
+            SDLockProfilerWaitTimeKey : @(SDLockProfilerSecondsFromTime(atomic_load_explicit(&site->waitTime, memory_order_relaxed))),
+            SDLockProfilerMaxWaitTimeKey : @(SDLockProfilerSecondsFromTime(atomic_load_explicit(&site->maxWaitTime, memory_order_relaxed))),
+            SDLockProfilerHoldTimeKey : @(SDLockProfilerSecondsFromTime(atomic_load_explicit(&site->holdTime, memory_order_relaxed))),
+        }];
+    }
+    [statistics sortUsingComparator:^NSComparisonResult(NSDictionary * _Nonnull obj1, NSDictionary * _Nonnull obj2) {
+        return [obj2[SDLockProfilerWaitTimeKey] compare:obj1[SDLockProfilerWaitTimeKey]];
+    }];
+    return [statistics copy];
+}
+
++ (NSString *)dumpDescription {
+    NSMutableString *description = [NSMutableString stringWithFormat:@"%-48s %10s %10s %12s %12s %12s\n", "site", "count", "contended", "wait(ms)", "maxWait(ms)", "hold(ms)"];
+    for (NSDictionary<NSString *, id> *statistic in [self statistics]) {
+        NSString *site = [NSString stringWithFormat:@"%@:%@", statistic[SDLockProfilerFileKey], statistic[SDLockProfilerLineKey]];
+        [description appendFormat:@"%-48s %10llu %10llu %12.3f %12.3f %12.3f\n",
+         site.UTF8String,
+         [statistic[SDLockProfilerCountKey] unsignedLongLongValue],
+         [statistic[SDLockProfilerContendedCountKey] unsignedLongLongValue],
+         [statistic[SDLockProfilerWaitTimeKey] doubleValue] * 1000,
+         [statistic[SDLockProfilerMaxWaitTimeKey] doubleValue] * 1000,
+         [statistic[SDLockProfilerHoldTimeKey] doubleValue] * 1000];
+    }
+    return [description copy];
+}
+
++ (void)reset {
+    for (NSUInteger i = 0; i < SD_LOCK_PROFILER_SITE_COUNT; i++) {
+        SDLockProfilerSite *site = &SDLockProfilerSites[i];
+        // Keep the key, only reset the counters
+        atomic_store_explicit(&site->count, 0, memory_order_relaxed);
+        atomic_store_explicit(&site->contendedCount, 0, memory_order_relaxed);
+        atomic_store_explicit(&site->waitTime, 0, memory_order_relaxed);
+        atomic_store_explicit(&site->maxWaitTime, 0, memory_order_relaxed);
+        atomic_store_explicit(&site->holdTime, 0, memory_order_relaxed);
+    }
+}
+
+@end
@@ -0,0 +1,32 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import <Foundation/Foundation.h>
+#import "SDWebImageCompat.h"
+#import "SDWebImageOperation.h"
+
+@class SDWebImageLoadState;
+
+/// The per-view image loading state, stored in a single associated object slot and shared by `UIView+WebCacheOperation` and `UIView+WebCacheState`.
+/// Most views have only one operation key, so the first key with its operation and load state are stored inline. Additional keys (such as `UIButton` states or `highlightedImage`) fallback to the tables.
+/// The operation is weak, because the operation instance is retained by SDWebImageManager's runningOperations property.
+@interface SDWebImageViewState : NSObject
+
+/// Return the state of view. If there is no state yet, create one when `create` is YES, else return nil.
++ (nullable instancetype)stateForView:(nonnull UIView *)view create:(BOOL)create;
+
+/// The latest image loading operation key, see `-[UIView sd_latestOperationKey]`.
+@property (atomic, copy, nullable) NSString *latestOperationKey;
+
+- (nullable id<SDWebImageOperation>)operationForKey:(nonnull NSString *)key;
+- (void)setOperation:(nullable id<SDWebImageOperation>)operation forKey:(nonnull NSString *)key;
+
+- (nullable SDWebImageLoadState *)loadStateForKey:(nonnull NSString *)key;
+- (void)setLoadState:(nullable SDWebImageLoadState *)loadState forKey:(nonnull NSString *)key;
+
+@end
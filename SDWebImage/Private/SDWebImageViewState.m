@@ -0,0 +1,121 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDWebImageViewState.h"
+#import "UIView+WebCacheState.h"
+#import "SDInternalMacros.h"
+#import "objc/runtime.h"
+
+static void * SDWebImageViewStateKey = &SDWebImageViewStateKey;
+
+static inline BOOL SDWebImageViewStateKeyEqual(NSString *key1, NSString *key2) {
+    return key1 == key2 || [key1 isEqualToString:key2];
+}
+
+@implementation SDWebImageViewState {
+    SD_LOCK_DECLARE(_lock);
+    // The inline slot for the first key
+    NSString *_primaryKey;
+    __weak id<SDWebImageOperation> _primaryOperation;
+    SDWebImageLoadState *_primaryLoadState;
+    // Lazily created for other keys
+    NSMapTable<NSString *, id<SDWebImageOperation>> *_operations;
+    NSMutableDictionary<NSString *, SDWebImageLoadState *> *_loadStates;
+}
+
++ (instancetype)stateForView:(UIView *)view create:(BOOL)create {
+    SDWebImageViewState *state = objc_getAssociatedObject(view, SDWebImageViewStateKey);
+    if (state || !create) {
+        return state;
+    }
+    // Only the first access on the view take this slow path
+    @synchronized (view) {
+        state = objc_getAssociatedObject(view, SDWebImageViewStateKey);
+        if (!state) {
+            state = [[SDWebImageViewState alloc] init];
+            objc_setAssociatedObject(view, SDWebImageViewStateKey, state, OBJC_ASSOCIATION_RETAIN);
+        }
+    }
+    return state;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        SD_LOCK_INIT(_lock);
+    }
+    return self;
+}
+
+// Must be called inside lock. Claim the inline slot if it's not used yet.
+- (BOOL)isPrimaryKey:(NSString *)key claim:(BOOL)claim {
+    if (!_primaryKey) {
+        if (claim) {
+            _primaryKey = [key copy];
+            return YES;
+        }
+        return NO;
+    }
+    return SDWebImageViewStateKeyEqual(_primaryKey, key);
+}
+
+- (id<SDWebImageOperation>)operationForKey:(NSString *)key {
+    id<SDWebImageOperation> operation;
+    SD_LOCK(_lock);
+    if ([self isPrimaryKey:key claim:NO]) {
+        operation = _primaryOperation;
+    } else {
+        operation = [_operations objectForKey:key];
+    }
+    SD_UNLOCK(_lock);
+    return operation;
+}
+
+- (void)setOperation:(id<SDWebImageOperation>)operation forKey:(NSString *)key {
+    SD_LOCK(_lock);
+    if ([self isPrimaryKey:key claim:operation != nil]) {
+        _primaryOperation = operation;
+    } else if (operation) {
+        if (!_operations) {
+            _operations = [[NSMapTable alloc] initWithKeyOptions:NSPointerFunctionsStrongMemory valueOptions:NSPointerFunctionsWeakMemory capacity:0];
+        }
+        [_operations setObject:operation forKey:key];
+    } else {
+        [_operations removeObjectForKey:key];
+    }
+    SD_UNLOCK(_lock);
+}
+
+- (SDWebImageLoadState *)loadStateForKey:(NSString *)key {
+    SDWebImageLoadState *loadState;
+    SD_LOCK(_lock);
+    if ([self isPrimaryKey:key claim:NO]) {
+        loadState = _primaryLoadState;
+    } else {
+        loadState = _loadStates[key];
+    }
+    SD_UNLOCK(_lock);
+    return loadState;
+}
+
+- (void)setLoadState:(SDWebImageLoadState *)loadState forKey:(NSString *)key {
+    SD_LOCK(_lock);
+    if ([self isPrimaryKey:key claim:loadState != nil]) {
+        _primaryLoadState = loadState;
+    } else if (loadState) {
+        if (!_loadStates) {
+            _loadStates = [NSMutableDictionary dictionary];
+        }
+        _loadStates[key] = loadState;
+    } else {
+        [_loadStates removeObjectForKey:key];
+    }
+    SD_UNLOCK(_lock);
+}
+
+@end
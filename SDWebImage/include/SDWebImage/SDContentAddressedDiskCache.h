@@ -0,0 +1 @@
+../../Core/SDContentAddressedDiskCache.h
\ No newline at end of file
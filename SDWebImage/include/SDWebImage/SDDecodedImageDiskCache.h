@@ -0,0 +1 @@
+../../Core/SDDecodedImageDiskCache.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../Core/SDDiskCacheEvictionPolicy.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../Core/SDImageArchiveCache.h
\ No newline at end of file
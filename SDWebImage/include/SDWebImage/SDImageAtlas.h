@@ -0,0 +1 @@
+../../Core/SDImageAtlas.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../Core/SDImageCacheDiskBudget.h
\ No newline at end of file
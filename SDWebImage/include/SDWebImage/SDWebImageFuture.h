@@ -0,0 +1 @@
+../../Core/SDWebImageFuture.h
\ No newline at end of file
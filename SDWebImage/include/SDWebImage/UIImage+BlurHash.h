@@ -0,0 +1 @@
+../../Core/UIImage+BlurHash.h
\ No newline at end of file
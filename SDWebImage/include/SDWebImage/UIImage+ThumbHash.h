@@ -0,0 +1 @@
+../../Core/UIImage+ThumbHash.h
\ No newline at end of file
@@ -0,0 +1,33 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import <SDWebImage/SDWebImage.h>
+
+/// Bitmap buffer helper methods for the coders backed by the portable codec libraries (which decode into or encode from the raw RGBA buffer)
+@interface SDImageBitmapHelper : NSObject
+
+/// Create a CGImage with the 8 bits per component, 4 components bitmap buffer. The image takes the ownership of buffer, which is released by `free()`.
+/// @param buffer The buffer allocated by `malloc()`. It's freed immediately if creation failed.
+/// @param bitmapInfo The bitmap info of buffer. If the alpha info is `kCGImageAlphaLast` or `kCGImageAlphaFirst` (non-premultiplied, what most codec libraries output), the buffer is premultiplied in place and the image use the premultiplied alpha.
++ (nullable CGImageRef)CGImageCreateWithBitmapBuffer:(nonnull void *)buffer width:(size_t)width height:(size_t)height bytesPerRow:(size_t)bytesPerRow bitmapInfo:(CGBitmapInfo)bitmapInfo CF_RETURNS_RETAINED;
+
+/// Copy the non-premultiplied RGBA8888 (byte order R, G, B, A) buffer to encode the image, which is the common input of codec libraries. The caller should `free()` the buffer.
+/// The image orientation is applied, and the `SDImageCoderEncodeMaxPixelSize`, `SDImageCoderEncodeBackgroundColor` encoding options are respected.
+/// @param hasAlpha Whether the output contains alpha channel. When NO, the alpha bytes are all 255.
++ (nullable void *)copyRGBA8888BufferWithImage:(nonnull UIImage *)image options:(nullable SDImageCoderOptions *)options width:(nonnull size_t *)width height:(nonnull size_t *)height bytesPerRow:(nonnull size_t *)bytesPerRow hasAlpha:(nonnull BOOL *)hasAlpha;
+
+/// Scale down the image to fit the thumbnail pixel size, see `SDImageCoderDecodeThumbnailPixelSize`. Return the retained input image if no need to scale.
++ (nullable CGImageRef)CGImageCreateThumbnail:(nonnull CGImageRef)cgImage thumbnailSize:(CGSize)thumbnailSize preserveAspectRatio:(BOOL)preserveAspectRatio CF_RETURNS_RETAINED;
+
+/// The region to decode from the `SDImageCoderDecodeCropRect` option, which is integral and clipped to the image bounds. Return CGRectNull if the option is not provided or the region is empty.
++ (CGRect)regionRectWithOptions:(nullable SDImageCoderOptions *)options imageSize:(CGSize)imageSize;
+
+/// Stretch the decoded region to the `SDImageCoderDecodeCropScaledPixelSize` option. Return the retained input image if no need to scale.
++ (nullable CGImageRef)CGImageCreateRegionScaled:(nonnull CGImageRef)cgImage options:(nullable SDImageCoderOptions *)options CF_RETURNS_RETAINED;
+
+@end
@@ -0,0 +1,187 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDImageBitmapHelper.h"
+#import <Accelerate/Accelerate.h>
+
+static void SDImageBitmapHelperReleaseBuffer(void *info, const void *data, size_t size) {
+    free((void *)data);
+}
+
+@implementation SDImageBitmapHelper
+
++ (CGImageRef)CGImageCreateWithBitmapBuffer:(void *)buffer width:(size_t)width height:(size_t)height bytesPerRow:(size_t)bytesPerRow bitmapInfo:(CGBitmapInfo)bitmapInfo {
+    if (!buffer) {
+        return NULL;
+    }
+    if (width == 0 || height == 0 || bytesPerRow < width * 4) {
+        free(buffer);
+        return NULL;
+    }
+    CGImageAlphaInfo alphaInfo = bitmapInfo & kCGBitmapAlphaInfoMask;
+    if (alphaInfo == kCGImageAlphaLast || alphaInfo == kCGImageAlphaFirst) {
+        // Most of codec libraries output the non-premultiplied alpha, premultiply it for rendering
+        vImage_Buffer vBuffer = {.data = buffer, .height = height, .width = width, .rowBytes = bytesPerRow};
+        if (alphaInfo == kCGImageAlphaLast) {
+            vImagePremultiplyData_RGBA8888(&vBuffer, &vBuffer, kvImageNoFlags);
+            alphaInfo = kCGImageAlphaPremultipliedLast;
+        } else {
+            vImagePremultiplyData_ARGB8888(&vBuffer, &vBuffer, kvImageNoFlags);
+            alphaInfo = kCGImageAlphaPremultipliedFirst;
+        }
+        bitmapInfo = (bitmapInfo & ~kCGBitmapAlphaInfoMask) | alphaInfo;
+    }
+    CGDataProviderRef provider = CGDataProviderCreateWithData(NULL, buffer, bytesPerRow * height, SDImageBitmapHelperReleaseBuffer);
+    if (!provider) {
+        free(buffer);
+        return NULL;
+    }
+    CGColorSpaceRef colorSpace = [SDImageCoderHelper colorSpaceGetDeviceRGB];
+    CGImageRef imageRef = CGImageCreate(width, height, 8, 32, bytesPerRow, colorSpace, bitmapInfo, provider, NULL, NO, kCGRenderingIntentDefault);
+    CGDataProviderRelease(provider);
+    return imageRef;
+}
+
++ (void *)copyRGBA8888BufferWithImage:(UIImage *)image options:(SDImageCoderOptions *)options width:(size_t *)widthRef height:(size_t *)heightRef bytesPerRow:(size_t *)bytesPerRowRef hasAlpha:(BOOL *)hasAlphaRef {
+    CGImageRef imageRef = image.CGImage;
+    if (!imageRef) {
+        // Supports CGImage only
+        return NULL;
+    }
+#if SD_UIKIT || SD_WATCH
+    CGImagePropertyOrientation exifOrientation = [SDImageCoderHelper exifOrientationFromImageOrientation:image.imageOrientation];
+#else
+    CGImagePropertyOrientation exifOrientation = kCGImagePropertyOrientationUp;
+#endif
+    if (exifOrientation != kCGImagePropertyOrientationUp) {
+        // The codec libraries know nothing about the orientation, apply it to pixels
+        imageRef = [SDImageCoderHelper CGImageCreateDecoded:imageRef orientation:exifOrientation];
+    } else {
+        CGImageRetain(imageRef);
+    }
+    if (!imageRef) {
+        return NULL;
+    }
+    CGSize imageSize = CGSizeMake(CGImageGetWidth(imageRef), CGImageGetHeight(imageRef));
+    CGSize maxPixelSize = CGSizeZero;
+    NSValue *maxPixelSizeValue = options[SDImageCoderEncodeMaxPixelSize];
+    if (maxPixelSizeValue != nil) {
+#if SD_MAC
+        maxPixelSize = maxPixelSizeValue.sizeValue;
+#else
+        maxPixelSize = maxPixelSizeValue.CGSizeValue;
+#endif
+    }
+    CGSize size = imageSize;
+    if (maxPixelSize.width > 0 && maxPixelSize.height > 0 && (imageSize.width > maxPixelSize.width || imageSize.height > maxPixelSize.height)) {
+        size = [SDImageCoderHelper scaledSizeWithImageSize:imageSize scaleSize:maxPixelSize preserveAspectRatio:YES shouldScaleUp:NO];
+    }
+    size_t width = MAX((size_t)round(size.width), 1);
+    size_t height = MAX((size_t)round(size.height), 1);
+    if (imageSize.width == 0 || imageSize.height == 0) {
+        CGImageRelease(imageRef);
+        return NULL;
+    }
+    
+    BOOL hasAlpha = [SDImageCoderHelper CGImageContainsAlpha:imageRef];
+    CGColorRef backgroundColor = [options[SDImageCoderEncodeBackgroundColor] CGColor];
+    // Align to 64 bytes like CoreGraphics
+    size_t bytesPerRow = SDByteAlign(width * 4, 64);
+    void *buffer = calloc(height, bytesPerRow);
+    if (!buffer) {
+        CGImageRelease(imageRef);
+        return NULL;
+    }
+    CGBitmapInfo bitmapInfo = kCGBitmapByteOrder32Big | (hasAlpha ? kCGImageAlphaPremultipliedLast : kCGImageAlphaNoneSkipLast);
+    CGContextRef context = CGBitmapContextCreate(buffer, width, height, 8, bytesPerRow, [SDImageCoderHelper colorSpaceGetDeviceRGB], bitmapInfo);
+    if (!context) {
+        free(buffer);
+        CGImageRelease(imageRef);
+        return NULL;
+    }
+    CGRect rect = CGRectMake(0, 0, width, height);
+    if (hasAlpha && backgroundColor) {
+        CGContextSetFillColorWithColor(context, backgroundColor);
+        CGContextFillRect(context, rect);
+        hasAlpha = CGColorGetAlpha(backgroundColor) < 1;
+    }
+    CGContextSetInterpolationQuality(context, kCGInterpolationHigh);
+    CGContextDrawImage(context, rect, imageRef);
+    CGContextRelease(context);
+    CGImageRelease(imageRef);
+    
+    vImage_Buffer vBuffer = {.data = buffer, .height = height, .width = width, .rowBytes = bytesPerRow};
+    if (hasAlpha) {
+        vImageUnpremultiplyData_RGBA8888(&vBuffer, &vBuffer, kvImageNoFlags);
+    } else {
+        // The skipped byte is undefined, fill the opaque alpha
+        vImageOverwriteChannelsWithScalar_ARGB8888(255, &vBuffer, &vBuffer, 0x1, kvImageNoFlags);
+    }
+    *widthRef = width;
+    *heightRef = height;
+    *bytesPerRowRef = bytesPerRow;
+    *hasAlphaRef = hasAlpha;
+    return buffer;
+}
+
++ (CGImageRef)CGImageCreateThumbnail:(CGImageRef)cgImage thumbnailSize:(CGSize)thumbnailSize preserveAspectRatio:(BOOL)preserveAspectRatio {
+    CGSize imageSize = CGSizeMake(CGImageGetWidth(cgImage), CGImageGetHeight(cgImage));
+    if (thumbnailSize.width == 0 || thumbnailSize.height == 0 || (imageSize.width <= thumbnailSize.width && imageSize.height <= thumbnailSize.height)) {
+        CGImageRetain(cgImage);
+        return cgImage;
+    }
+    CGSize scaledSize = [SDImageCoderHelper scaledSizeWithImageSize:imageSize scaleSize:thumbnailSize preserveAspectRatio:preserveAspectRatio shouldScaleUp:NO];
+    CGImageRef scaledImageRef = [SDImageCoderHelper CGImageCreateScaled:cgImage size:CGSizeMake(round(scaledSize.width), round(scaledSize.height))];
+    if (!scaledImageRef) {
+        CGImageRetain(cgImage);
+        return cgImage;
+    }
+    return scaledImageRef;
+}
+
++ (CGRect)regionRectWithOptions:(SDImageCoderOptions *)options imageSize:(CGSize)imageSize {
+    NSValue *cropRectValue = options[SDImageCoderDecodeCropRect];
+    if (cropRectValue == nil) {
+        return CGRectNull;
+    }
+#if SD_MAC
+    CGRect cropRect = cropRectValue.rectValue;
+#else
+    CGRect cropRect = cropRectValue.CGRectValue;
+#endif
+    CGRect regionRect = CGRectIntersection(CGRectIntegral(cropRect), CGRectMake(0, 0, imageSize.width, imageSize.height));
+    if (CGRectIsEmpty(regionRect)) {
+        return CGRectNull;
+    }
+    return regionRect;
+}
+
++ (CGImageRef)CGImageCreateRegionScaled:(CGImageRef)cgImage options:(SDImageCoderOptions *)options {
+    CGSize scaledSize = CGSizeZero;
+    NSValue *scaledSizeValue = options[SDImageCoderDecodeCropScaledPixelSize];
+    if (scaledSizeValue != nil) {
+#if SD_MAC
+        scaledSize = scaledSizeValue.sizeValue;
+#else
+        scaledSize = scaledSizeValue.CGSizeValue;
+#endif
+    }
+    CGSize imageSize = CGSizeMake(CGImageGetWidth(cgImage), CGImageGetHeight(cgImage));
+    if (scaledSize.width <= 0 || scaledSize.height <= 0 || CGSizeEqualToSize(imageSize, scaledSize)) {
+        CGImageRetain(cgImage);
+        return cgImage;
+    }
+    CGImageRef scaledImageRef = [SDImageCoderHelper CGImageCreateScaled:cgImage size:scaledSize];
+    if (!scaledImageRef) {
+        CGImageRetain(cgImage);
+        return cgImage;
+    }
+    return scaledImageRef;
+}
+
+@end
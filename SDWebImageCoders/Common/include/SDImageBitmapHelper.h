@@ -0,0 +1 @@
+../SDImageBitmapHelper.h
\ No newline at end of file
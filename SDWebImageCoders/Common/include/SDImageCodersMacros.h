@@ -0,0 +1 @@
+../SDImageCodersMacros.h
\ No newline at end of file
@@ -0,0 +1,21 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import <SDWebImage/SDWebImage.h>
+
+/**
+ The reference GIF coder backed by giflib, which does not use Image/IO, so the decoded result can be compared with the Image/IO one. Supports static and animated GIF decoding, the frames are composited with the disposal method like browsers.
+ @note This coder is a plugin which links giflib, install the `SDWebImage/GIFLibCoder` subspec or the `SDWebImageGIFLibCoder` package product.
+ @note This coder is not in the default coders list. To prefer it to Image/IO, use `[SDImageCodersManager.sharedManager addCoder:SDImageGIFLibCoder.sharedCoder]`.
+ @note GIF encoding is not supported, because it requires color quantization.
+ */
+@interface SDImageGIFLibCoder : NSObject <SDAnimatedImageCoder>
+
+@property (nonatomic, class, readonly, nonnull) SDImageGIFLibCoder *sharedCoder;
+
+@end
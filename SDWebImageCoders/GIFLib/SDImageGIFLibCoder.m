@@ -0,0 +1,344 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDImageGIFLibCoder.h"
+#import "SDImageBitmapHelper.h"
+#import "SDImageCodersMacros.h"
+#import <gif_lib.h>
+
+typedef struct SDGIFLibReadContext {
+    const uint8_t *bytes;
+    size_t length;
+    size_t offset;
+} SDGIFLibReadContext;
+
+static int SDGIFLibRead(GifFileType *gif, GifByteType *bytes, int length) {
+    SDGIFLibReadContext *context = gif->UserData;
+    size_t count = MIN((size_t)length, context->length - context->offset);
+    memcpy(bytes, context->bytes + context->offset, count);
+    context->offset += count;
+    return (int)count;
+}
+
+// The loop count is in the NETSCAPE2.0 application extension, the Netscape standard play once when it's absent
+static NSUInteger SDGIFLibLoopCount(GifFileType *gif) {
+    SavedImage *frame = &gif->SavedImages[0];
+    for (int i = 0; i + 1 < frame->ExtensionBlockCount; i++) {
+        ExtensionBlock *block = &frame->ExtensionBlocks[i];
+        if (block->Function != APPLICATION_EXT_FUNC_CODE || block->ByteCount != 11 || memcmp(block->Bytes, "NETSCAPE2.0", 11) != 0) {
+            continue;
+        }
+        ExtensionBlock *subBlock = &frame->ExtensionBlocks[i + 1];
+        if (subBlock->Function == CONTINUE_EXT_FUNC_CODE && subBlock->ByteCount >= 3 && subBlock->Bytes[0] == 1) {
+            return (NSUInteger)(subBlock->Bytes[1] | subBlock->Bytes[2] << 8);
+        }
+    }
+    return 1;
+}
+
+@implementation SDImageGIFLibCoder {
+    GifFileType *_gif;
+    SD_LOCK_DECLARE(_lock);
+    NSData *_imageData;
+    CGFloat _scale;
+    CGSize _thumbnailSize;
+    BOOL _preserveAspectRatio;
+    NSUInteger _frameCount;
+    NSUInteger _loopCount;
+    size_t _canvasWidth;
+    size_t _canvasHeight;
+    // The composited RGBA8888 (non-premultiplied) canvas of `_canvasIndex` frame
+    uint8_t *_canvas;
+    // The canvas before drawing the frame which use `DISPOSE_PREVIOUS`
+    uint8_t *_previousCanvas;
+    NSUInteger _canvasIndex;
+}
+
+- (void)dealloc {
+    if (_gif) {
+        int error;
+        DGifCloseFile(_gif, &error);
+        _gif = NULL;
+    }
+    if (_canvas) {
+        free(_canvas);
+        _canvas = NULL;
+    }
+    if (_previousCanvas) {
+        free(_previousCanvas);
+        _previousCanvas = NULL;
+    }
+}
+
++ (instancetype)sharedCoder {
+    static SDImageGIFLibCoder *coder;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        coder = [[SDImageGIFLibCoder alloc] init];
+    });
+    return coder;
+}
+
+#pragma mark - Decode
+
+- (BOOL)canDecodeFromData:(NSData *)data {
+    return [NSData sd_imageFormatForImageData:data] == SDImageFormatGIF;
+}
+
+- (UIImage *)decodedImageWithData:(NSData *)data options:(SDImageCoderOptions *)options {
+    SDImageGIFLibCoder *coder = [[SDImageGIFLibCoder alloc] initWithAnimatedImageData:data options:options];
+    if (!coder) {
+        return nil;
+    }
+    BOOL decodeFirstFrame = [options[SDImageCoderDecodeFirstFrameOnly] boolValue];
+    if (decodeFirstFrame || coder.animatedImageFrameCount <= 1) {
+        return [coder animatedImageFrameAtIndex:0];
+    }
+    NSUInteger frameCount = coder.animatedImageFrameCount;
+    NSMutableArray<SDImageFrame *> *frames = [NSMutableArray arrayWithCapacity:frameCount];
+    for (NSUInteger i = 0; i < frameCount; i++) {
+        UIImage *frameImage = [coder animatedImageFrameAtIndex:i];
+        if (!frameImage) {
+            return nil;
+        }
+        [frames addObject:[SDImageFrame frameWithImage:frameImage duration:[coder animatedImageDurationAtIndex:i]]];
+    }
+    UIImage *animatedImage = [SDImageCoderHelper animatedImageWithFrames:frames];
+    animatedImage.sd_imageLoopCount = coder.animatedImageLoopCount;
+    animatedImage.sd_imageFormat = SDImageFormatGIF;
+    return animatedImage;
+}
+
+#pragma mark - Encode
+
+- (BOOL)canEncodeToFormat:(SDImageFormat)format {
+    return NO;
+}
+
+- (NSData *)encodedDataWithImage:(UIImage *)image format:(SDImageFormat)format options:(SDImageCoderOptions *)options {
+    return nil;
+}
+
+#pragma mark - Animated Image
+
+- (instancetype)initWithAnimatedImageData:(NSData *)data options:(SDImageCoderOptions *)options {
+    if (!data) {
+        return nil;
+    }
+    self = [super init];
+    if (self) {
+        SDGIFLibReadContext context = {data.bytes, data.length, 0};
+        int error;
+        GifFileType *gif = DGifOpen(&context, SDGIFLibRead, &error);
+        if (!gif) {
+            return nil;
+        }
+        // Read all of the frames, the raster bits are the color indexes (1 byte per pixel), which is much smaller than the bitmap
+        int frameCount;
+        if (DGifSlurp(gif) == GIF_OK) {
+            frameCount = gif->ImageCount;
+        } else {
+            // The truncated data, drop the incomplete last frame
+            frameCount = gif->ImageCount - 1;
+        }
+        gif->UserData = NULL;
+        if (frameCount <= 0) {
+            DGifCloseFile(gif, &error);
+            return nil;
+        }
+        _gif = gif;
+        _frameCount = frameCount;
+        _loopCount = SDGIFLibLoopCount(gif);
+        _canvasWidth = gif->SWidth > 0 ? gif->SWidth : gif->SavedImages[0].ImageDesc.Width;
+        _canvasHeight = gif->SHeight > 0 ? gif->SHeight : gif->SavedImages[0].ImageDesc.Height;
+        if (_canvasWidth == 0 || _canvasHeight == 0) {
+            return nil;
+        }
+        _canvas = calloc(_canvasWidth * _canvasHeight, 4);
+        if (!_canvas) {
+            return nil;
+        }
+        _canvasIndex = NSNotFound;
+        
+        CGFloat scale = 1;
+        NSNumber *scaleFactor = options[SDImageCoderDecodeScaleFactor];
+        if (scaleFactor != nil) {
+            scale = MAX([scaleFactor doubleValue], 1);
+        }
+        _scale = scale;
+        CGSize thumbnailSize = CGSizeZero;
+        NSValue *thumbnailSizeValue = options[SDImageCoderDecodeThumbnailPixelSize];
+        if (thumbnailSizeValue != nil) {
+    #if SD_MAC
+            thumbnailSize = thumbnailSizeValue.sizeValue;
+    #else
+            thumbnailSize = thumbnailSizeValue.CGSizeValue;
+    #endif
+        }
+        _thumbnailSize = thumbnailSize;
+        BOOL preserveAspectRatio = YES;
+        NSNumber *preserveAspectRatioValue = options[SDImageCoderDecodePreserveAspectRatio];
+        if (preserveAspectRatioValue != nil) {
+            preserveAspectRatio = preserveAspectRatioValue.boolValue;
+        }
+        _preserveAspectRatio = preserveAspectRatio;
+        NSUInteger limitBytes = [options[SDImageCoderDecodeScaleDownLimitBytes] unsignedIntegerValue];
+        if (limitBytes > 0) {
+            // Scale down to limit bytes, override thumbnail size
+            _thumbnailSize = [SDImageCoderHelper scaledSizeWithImageSize:CGSizeMake(_canvasWidth, _canvasHeight) limitBytes:limitBytes bytesPerPixel:4 frameCount:_frameCount];
+            _preserveAspectRatio = YES;
+        }
+        _imageData = data;
+        SD_LOCK_INIT(_lock);
+    }
+    return self;
+}
+
+- (NSData *)animatedImageData {
+    return _imageData;
+}
+
+- (NSUInteger)animatedImageLoopCount {
+    return _loopCount;
+}
+
+- (NSUInteger)animatedImageFrameCount {
+    return _frameCount;
+}
+
+- (NSTimeInterval)animatedImageDurationAtIndex:(NSUInteger)index {
+    if (index >= _frameCount) {
+        return 0;
+    }
+    NSTimeInterval frameDuration = 0.1;
+    GraphicsControlBlock gcb;
+    if (DGifSavedExtensionToGCB(_gif, (int)index, &gcb) == GIF_OK) {
+        // The delay time is in 1/100 seconds
+        frameDuration = gcb.DelayTime / 100.0;
+    }
+    // Same as `SDImageIOAnimatedCoder`, follow Firefox's behavior and use a duration of 100 ms for any frames that specify a duration of <= 10 ms
+    if (frameDuration < 0.011) {
+        frameDuration = 0.1;
+    }
+    return frameDuration;
+}
+
+- (UIImage *)animatedImageFrameAtIndex:(NSUInteger)index {
+    if (index >= _frameCount) {
+        return nil;
+    }
+    size_t bytesPerRow = _canvasWidth * 4;
+    void *buffer = malloc(bytesPerRow * _canvasHeight);
+    if (!buffer) {
+        return nil;
+    }
+    SD_LOCK(_lock);
+    [self renderCanvasAtIndex:index];
+    memcpy(buffer, _canvas, bytesPerRow * _canvasHeight);
+    SD_UNLOCK(_lock);
+    
+    CGImageRef imageRef = [SDImageBitmapHelper CGImageCreateWithBitmapBuffer:buffer width:_canvasWidth height:_canvasHeight bytesPerRow:bytesPerRow bitmapInfo:kCGBitmapByteOrder32Big | kCGImageAlphaLast];
+    if (!imageRef) {
+        return nil;
+    }
+    CGImageRef thumbnailImageRef = [SDImageBitmapHelper CGImageCreateThumbnail:imageRef thumbnailSize:_thumbnailSize preserveAspectRatio:_preserveAspectRatio];
+    CGImageRelease(imageRef);
+    if (!thumbnailImageRef) {
+        return nil;
+    }
+#if SD_UIKIT || SD_WATCH
+    UIImage *image = [[UIImage alloc] initWithCGImage:thumbnailImageRef scale:_scale orientation:UIImageOrientationUp];
+#else
+    UIImage *image = [[UIImage alloc] initWithCGImage:thumbnailImageRef scale:_scale orientation:kCGImagePropertyOrientationUp];
+#endif
+    CGImageRelease(thumbnailImageRef);
+    image.sd_isDecoded = YES;
+    image.sd_imageFormat = SDImageFormatGIF;
+    return image;
+}
+
+#pragma mark - Canvas
+
+// Composite the frames into canvas, continue from current canvas for sequential playback, restart from the first frame for seeking backward
+- (void)renderCanvasAtIndex:(NSUInteger)index {
+    if (index == _canvasIndex) {
+        return;
+    }
+    NSUInteger startIndex = 0;
+    if (_canvasIndex != NSNotFound && index > _canvasIndex) {
+        startIndex = _canvasIndex + 1;
+    } else {
+        memset(_canvas, 0, _canvasWidth * _canvasHeight * 4);
+    }
+    for (NSUInteger i = startIndex; i <= index; i++) {
+        if (i > 0) {
+            [self disposeFrameAtIndex:i - 1];
+        }
+        GraphicsControlBlock gcb = {DISPOSAL_UNSPECIFIED, false, 0, NO_TRANSPARENT_COLOR};
+        DGifSavedExtensionToGCB(_gif, (int)i, &gcb);
+        if (gcb.DisposalMode == DISPOSE_PREVIOUS) {
+            if (!_previousCanvas) {
+                _previousCanvas = malloc(_canvasWidth * _canvasHeight * 4);
+            }
+            if (_previousCanvas) {
+                memcpy(_previousCanvas, _canvas, _canvasWidth * _canvasHeight * 4);
+            }
+        }
+        [self drawFrameAtIndex:i transparentColor:gcb.TransparentColor];
+    }
+    _canvasIndex = index;
+}
+
+- (void)disposeFrameAtIndex:(NSUInteger)index {
+    GraphicsControlBlock gcb = {DISPOSAL_UNSPECIFIED, false, 0, NO_TRANSPARENT_COLOR};
+    DGifSavedExtensionToGCB(_gif, (int)index, &gcb);
+    if (gcb.DisposalMode == DISPOSE_BACKGROUND) {
+        // Clear to transparent like browsers, instead of the background color
+        GifImageDesc desc = _gif->SavedImages[index].ImageDesc;
+        size_t left = MIN((size_t)MAX(desc.Left, 0), _canvasWidth);
+        size_t top = MIN((size_t)MAX(desc.Top, 0), _canvasHeight);
+        size_t right = MIN(left + (size_t)MAX(desc.Width, 0), _canvasWidth);
+        size_t bottom = MIN(top + (size_t)MAX(desc.Height, 0), _canvasHeight);
+        for (size_t y = top; y < bottom; y++) {
+            memset(_canvas + (y * _canvasWidth + left) * 4, 0, (right - left) * 4);
+        }
+    } else if (gcb.DisposalMode == DISPOSE_PREVIOUS && _previousCanvas) {
+        memcpy(_canvas, _previousCanvas, _canvasWidth * _canvasHeight * 4);
+    }
+}
+
+- (void)drawFrameAtIndex:(NSUInteger)index transparentColor:(int)transparentColor {
+    SavedImage *frame = &_gif->SavedImages[index];
+    GifImageDesc desc = frame->ImageDesc;
+    ColorMapObject *colorMap = desc.ColorMap ?: _gif->SColorMap;
+    if (!colorMap || !frame->RasterBits) {
+        return;
+    }
+    // The raster bits are already deinterlaced by `DGifSlurp`
+    size_t left = MIN((size_t)MAX(desc.Left, 0), _canvasWidth);
+    size_t top = MIN((size_t)MAX(desc.Top, 0), _canvasHeight);
+    size_t width = MIN((size_t)MAX(desc.Width, 0), _canvasWidth - left);
+    size_t height = MIN((size_t)MAX(desc.Height, 0), _canvasHeight - top);
+    for (size_t y = 0; y < height; y++) {
+        const GifByteType *src = frame->RasterBits + y * desc.Width;
+        uint8_t *dst = _canvas + ((top + y) * _canvasWidth + left) * 4;
+        for (size_t x = 0; x < width; x++) {
+            int colorIndex = src[x];
+            if (colorIndex == transparentColor || colorIndex >= colorMap->ColorCount) {
+                continue;
+            }
+            GifColorType color = colorMap->Colors[colorIndex];
+            dst[x * 4] = color.Red;
+            dst[x * 4 + 1] = color.Green;
+            dst[x * 4 + 2] = color.Blue;
+            dst[x * 4 + 3] = 255;
+        }
+    }
+}
+
+@end
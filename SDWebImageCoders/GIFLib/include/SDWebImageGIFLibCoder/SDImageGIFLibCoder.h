@@ -0,0 +1 @@
+../../SDImageGIFLibCoder.h
\ No newline at end of file
@@ -0,0 +1,28 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import <SDWebImage/SDWebImage.h>
+#if __has_include(<SDWebImageAVIFCoder/SDImageAVIFCoder.h>)
+#import <SDWebImageAVIFCoder/SDImageAVIFCoder.h>
+#else
+/// The AVIF image format, which is not built-in. The value is the same as https://github.com/SDWebImage/SDWebImageAVIFCoder defines, so the images decoded by both coders have the same `sd_imageFormat`.
+static const SDImageFormat SDImageFormatAVIF = 15; // AV1-codec based HEIF
+#endif
+
+/**
+ The AVIF and AVIF image sequence decoder backed by libavif (1.0+, with dav1d or libaom codec), which use the multi-threaded AV1 decoding and YUV to RGB conversion. The thread count can be configured by `SDImageCoderDecodeThreadCount`, defaults to the active processor count.
+ The image sequence frames are decoded with `avifDecoderNthImage`, which seeks from the nearest key frame, so it works with the frame fetching of `SDAnimatedImagePlayer` and its frame pool.
+ @note This coder is a plugin which links libavif, install the `SDWebImage/LibAVIFCoder` subspec or the `SDWebImageLibAVIFCoder` package product.
+ @note This coder is not in the default coders list. To prefer it to Image/IO, use `[SDImageCodersManager.sharedManager addCoder:SDImageLibAVIFCoder.sharedCoder]`.
+ @note The HDR (10/12 bits) image is decoded into 8 bits SDR, and encoding is not supported, use https://github.com/SDWebImage/SDWebImageAVIFCoder for full features.
+ */
+@interface SDImageLibAVIFCoder : NSObject <SDAnimatedImageCoder>
+
+@property (nonatomic, class, readonly, nonnull) SDImageLibAVIFCoder *sharedCoder;
+
+@end
@@ -0,0 +1,248 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDImageLibAVIFCoder.h"
+#import "SDImageBitmapHelper.h"
+#import "SDImageCodersMacros.h"
+#import <avif/avif.h>
+
+@implementation SDImageLibAVIFCoder {
+    avifDecoder *_decoder;
+    SD_LOCK_DECLARE(_lock);
+    NSData *_imageData;
+    CGFloat _scale;
+    CGSize _thumbnailSize;
+    BOOL _preserveAspectRatio;
+    NSUInteger _threadCount;
+    NSUInteger _frameCount;
+    NSUInteger _loopCount;
+    NSArray<NSNumber *> *_frameDurations;
+}
+
+- (void)dealloc {
+    if (_decoder) {
+        avifDecoderDestroy(_decoder);
+        _decoder = NULL;
+    }
+}
+
++ (instancetype)sharedCoder {
+    static SDImageLibAVIFCoder *coder;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        coder = [[SDImageLibAVIFCoder alloc] init];
+    });
+    return coder;
+}
+
+#pragma mark - Decode
+
+- (BOOL)canDecodeFromData:(NSData *)data {
+    if (!data) {
+        return NO;
+    }
+    avifROData input = {data.bytes, data.length};
+    return avifPeekCompatibleFileType(&input);
+}
+
+- (UIImage *)decodedImageWithData:(NSData *)data options:(SDImageCoderOptions *)options {
+    SDImageLibAVIFCoder *coder = [[SDImageLibAVIFCoder alloc] initWithAnimatedImageData:data options:options];
+    if (!coder) {
+        return nil;
+    }
+    BOOL decodeFirstFrame = [options[SDImageCoderDecodeFirstFrameOnly] boolValue];
+    if (decodeFirstFrame || coder.animatedImageFrameCount <= 1) {
+        return [coder animatedImageFrameAtIndex:0];
+    }
+    NSUInteger frameCount = coder.animatedImageFrameCount;
+    NSMutableArray<SDImageFrame *> *frames = [NSMutableArray arrayWithCapacity:frameCount];
+    for (NSUInteger i = 0; i < frameCount; i++) {
+        UIImage *frameImage = [coder animatedImageFrameAtIndex:i];
+        if (!frameImage) {
+            return nil;
+        }
+        [frames addObject:[SDImageFrame frameWithImage:frameImage duration:[coder animatedImageDurationAtIndex:i]]];
+    }
+    UIImage *animatedImage = [SDImageCoderHelper animatedImageWithFrames:frames];
+    animatedImage.sd_imageLoopCount = coder.animatedImageLoopCount;
+    animatedImage.sd_imageFormat = SDImageFormatAVIF;
+    return animatedImage;
+}
+
+#pragma mark - Encode
+
+- (BOOL)canEncodeToFormat:(SDImageFormat)format {
+    return NO;
+}
+
+- (NSData *)encodedDataWithImage:(UIImage *)image format:(SDImageFormat)format options:(SDImageCoderOptions *)options {
+    return nil;
+}
+
+#pragma mark - Animated Image
+
+- (instancetype)initWithAnimatedImageData:(NSData *)data options:(SDImageCoderOptions *)options {
+    if (!data) {
+        return nil;
+    }
+    self = [super init];
+    if (self) {
+        NSUInteger threadCount = [options[SDImageCoderDecodeThreadCount] unsignedIntegerValue];
+        if (threadCount == 0) {
+            threadCount = NSProcessInfo.processInfo.activeProcessorCount;
+        }
+        _threadCount = threadCount;
+        avifDecoder *decoder = avifDecoderCreate();
+        if (!decoder) {
+            return nil;
+        }
+        _decoder = decoder;
+        // The AV1 codec (dav1d) use the tile and frame threads
+        decoder->maxThreads = (int)threadCount;
+        decoder->ignoreExif = AVIF_TRUE;
+        decoder->ignoreXMP = AVIF_TRUE;
+        // The decoder reference the bytes without copy, which is retained by `_imageData`
+        if (avifDecoderSetIOMemory(decoder, data.bytes, data.length) != AVIF_RESULT_OK || avifDecoderParse(decoder) != AVIF_RESULT_OK) {
+            return nil;
+        }
+        if (decoder->imageCount <= 0) {
+            return nil;
+        }
+        _frameCount = decoder->imageCount;
+        // The repetition count does not include the first play, 0 loop count means infinite
+        if (decoder->repetitionCount >= 0) {
+            _loopCount = (NSUInteger)decoder->repetitionCount + 1;
+        } else {
+            _loopCount = 0;
+        }
+        NSMutableArray<NSNumber *> *frameDurations = [NSMutableArray arrayWithCapacity:_frameCount];
+        for (NSUInteger i = 0; i < _frameCount; i++) {
+            NSTimeInterval frameDuration = 0.1;
+            avifImageTiming timing;
+            if (avifDecoderNthImageTiming(decoder, (uint32_t)i, &timing) == AVIF_RESULT_OK) {
+                frameDuration = timing.duration;
+            }
+            // Same as `SDImageIOAnimatedCoder`, follow Firefox's behavior and use a duration of 100 ms for any frames that specify a duration of <= 10 ms
+            if (frameDuration < 0.011) {
+                frameDuration = 0.1;
+            }
+            [frameDurations addObject:@(frameDuration)];
+        }
+        _frameDurations = [frameDurations copy];
+        
+        CGFloat scale = 1;
+        NSNumber *scaleFactor = options[SDImageCoderDecodeScaleFactor];
+        if (scaleFactor != nil) {
+            scale = MAX([scaleFactor doubleValue], 1);
+        }
+        _scale = scale;
+        CGSize thumbnailSize = CGSizeZero;
+        NSValue *thumbnailSizeValue = options[SDImageCoderDecodeThumbnailPixelSize];
+        if (thumbnailSizeValue != nil) {
+    #if SD_MAC
+            thumbnailSize = thumbnailSizeValue.sizeValue;
+    #else
+            thumbnailSize = thumbnailSizeValue.CGSizeValue;
+    #endif
+        }
+        _thumbnailSize = thumbnailSize;
+        BOOL preserveAspectRatio = YES;
+        NSNumber *preserveAspectRatioValue = options[SDImageCoderDecodePreserveAspectRatio];
+        if (preserveAspectRatioValue != nil) {
+            preserveAspectRatio = preserveAspectRatioValue.boolValue;
+        }
+        _preserveAspectRatio = preserveAspectRatio;
+        NSUInteger limitBytes = [options[SDImageCoderDecodeScaleDownLimitBytes] unsignedIntegerValue];
+        if (limitBytes > 0) {
+            // Scale down to limit bytes, override thumbnail size
+            CGSize imageSize = CGSizeMake(decoder->image->width, decoder->image->height);
+            _thumbnailSize = [SDImageCoderHelper scaledSizeWithImageSize:imageSize limitBytes:limitBytes bytesPerPixel:4 frameCount:_frameCount];
+            _preserveAspectRatio = YES;
+        }
+        _imageData = data;
+        SD_LOCK_INIT(_lock);
+    }
+    return self;
+}
+
+- (NSData *)animatedImageData {
+    return _imageData;
+}
+
+- (NSUInteger)animatedImageLoopCount {
+    return _loopCount;
+}
+
+- (NSUInteger)animatedImageFrameCount {
+    return _frameCount;
+}
+
+- (NSTimeInterval)animatedImageDurationAtIndex:(NSUInteger)index {
+    if (index >= _frameDurations.count) {
+        return 0;
+    }
+    return _frameDurations[index].doubleValue;
+}
+
+- (UIImage *)animatedImageFrameAtIndex:(NSUInteger)index {
+    if (index >= _frameCount) {
+        return nil;
+    }
+    SD_LOCK(_lock);
+    if (avifDecoderNthImage(_decoder, (uint32_t)index) != AVIF_RESULT_OK) {
+        SD_UNLOCK(_lock);
+        return nil;
+    }
+    avifImage *frameImage = _decoder->image;
+    BOOL hasAlpha = _decoder->alphaPresent;
+    size_t width = frameImage->width;
+    size_t height = frameImage->height;
+    size_t bytesPerRow = SDByteAlign(width * 4, 64);
+    void *buffer = malloc(bytesPerRow * height);
+    if (!buffer) {
+        SD_UNLOCK(_lock);
+        return nil;
+    }
+    // Premultiplied BGRA8888 little endian is the hardware supported pixel format
+    avifRGBImage rgb;
+    avifRGBImageSetDefaults(&rgb, frameImage);
+    rgb.format = AVIF_RGB_FORMAT_BGRA;
+    rgb.depth = 8;
+    rgb.alphaPremultiplied = AVIF_TRUE;
+    rgb.maxThreads = (int)_threadCount;
+    rgb.pixels = buffer;
+    rgb.rowBytes = (uint32_t)bytesPerRow;
+    avifResult result = avifImageYUVToRGB(frameImage, &rgb);
+    SD_UNLOCK(_lock);
+    if (result != AVIF_RESULT_OK) {
+        free(buffer);
+        return nil;
+    }
+    
+    CGBitmapInfo bitmapInfo = kCGBitmapByteOrder32Little | (hasAlpha ? kCGImageAlphaPremultipliedFirst : kCGImageAlphaNoneSkipFirst);
+    CGImageRef imageRef = [SDImageBitmapHelper CGImageCreateWithBitmapBuffer:buffer width:width height:height bytesPerRow:bytesPerRow bitmapInfo:bitmapInfo];
+    if (!imageRef) {
+        return nil;
+    }
+    CGImageRef thumbnailImageRef = [SDImageBitmapHelper CGImageCreateThumbnail:imageRef thumbnailSize:_thumbnailSize preserveAspectRatio:_preserveAspectRatio];
+    CGImageRelease(imageRef);
+    if (!thumbnailImageRef) {
+        return nil;
+    }
+#if SD_UIKIT || SD_WATCH
+    UIImage *image = [[UIImage alloc] initWithCGImage:thumbnailImageRef scale:_scale orientation:UIImageOrientationUp];
+#else
+    UIImage *image = [[UIImage alloc] initWithCGImage:thumbnailImageRef scale:_scale orientation:kCGImagePropertyOrientationUp];
+#endif
+    CGImageRelease(thumbnailImageRef);
+    image.sd_isDecoded = YES;
+    image.sd_imageFormat = SDImageFormatAVIF;
+    return image;
+}
+
+@end
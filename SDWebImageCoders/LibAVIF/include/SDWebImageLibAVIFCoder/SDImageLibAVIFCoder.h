@@ -0,0 +1 @@
+../../SDImageLibAVIFCoder.h
\ No newline at end of file
@@ -0,0 +1,22 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import <SDWebImage/SDWebImage.h>
+
+/**
+ The WebP and Animated WebP decoder backed by libwebp, which use the multi-threaded decoding (`use_threads`, see `SDImageCoderDecodeThreadCount`), and the scaling during decoding for thumbnail of static WebP.
+ The animated WebP frames are decoded by `WebPAnimDecoder` sequentially, which match the frame fetching of `SDAnimatedImagePlayer` and its frame pool. Seeking backward restarts from the first frame.
+ @note This coder is a plugin which links libwebp (with libwebpdemux), install the `SDWebImage/LibWebPCoder` subspec or the `SDWebImageLibWebPCoder` package product.
+ @note This coder is not in the default coders list. To prefer it to Image/IO, use `[SDImageCodersManager.sharedManager addCoder:SDImageLibWebPCoder.sharedCoder]`.
+ @note Encoding is not supported, use `SDImageAWebPCoder` or https://github.com/SDWebImage/SDWebImageWebPCoder
+ */
+@interface SDImageLibWebPCoder : NSObject <SDAnimatedImageCoder>
+
+@property (nonatomic, class, readonly, nonnull) SDImageLibWebPCoder *sharedCoder;
+
+@end
@@ -0,0 +1,338 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDImageLibWebPCoder.h"
+#import "SDImageBitmapHelper.h"
+#import "SDImageCodersMacros.h"
+#import <webp/decode.h>
+#import <webp/demux.h>
+
+@implementation SDImageLibWebPCoder {
+    WebPAnimDecoder *_animDecoder;
+    SD_LOCK_DECLARE(_lock);
+    NSData *_imageData;
+    CGFloat _scale;
+    CGSize _thumbnailSize;
+    BOOL _preserveAspectRatio;
+    NSUInteger _frameCount;
+    NSUInteger _loopCount;
+    size_t _canvasWidth;
+    size_t _canvasHeight;
+    NSArray<NSNumber *> *_frameDurations;
+    // The index of next frame returned by `WebPAnimDecoderGetNext`
+    NSUInteger _nextFrameIndex;
+    // The canvas of last decoded frame, owned by decoder and valid until next call
+    uint8_t *_canvas;
+}
+
+- (void)dealloc {
+    if (_animDecoder) {
+        WebPAnimDecoderDelete(_animDecoder);
+        _animDecoder = NULL;
+    }
+}
+
++ (instancetype)sharedCoder {
+    static SDImageLibWebPCoder *coder;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        coder = [[SDImageLibWebPCoder alloc] init];
+    });
+    return coder;
+}
+
+#pragma mark - Decode
+
+- (BOOL)canDecodeFromData:(NSData *)data {
+    return [NSData sd_imageFormatForImageData:data] == SDImageFormatWebP;
+}
+
+- (UIImage *)decodedImageWithData:(NSData *)data options:(SDImageCoderOptions *)options {
+    if (!data) {
+        return nil;
+    }
+    WebPBitstreamFeatures features;
+    if (WebPGetFeatures(data.bytes, data.length, &features) != VP8_STATUS_OK) {
+        return nil;
+    }
+    if (!features.has_animation) {
+        return [self.class createStaticImageWithData:data features:features options:options];
+    }
+    SDImageLibWebPCoder *coder = [[SDImageLibWebPCoder alloc] initWithAnimatedImageData:data options:options];
+    if (!coder) {
+        return nil;
+    }
+    BOOL decodeFirstFrame = [options[SDImageCoderDecodeFirstFrameOnly] boolValue];
+    if (decodeFirstFrame || coder.animatedImageFrameCount <= 1) {
+        return [coder animatedImageFrameAtIndex:0];
+    }
+    NSUInteger frameCount = coder.animatedImageFrameCount;
+    NSMutableArray<SDImageFrame *> *frames = [NSMutableArray arrayWithCapacity:frameCount];
+    for (NSUInteger i = 0; i < frameCount; i++) {
+        UIImage *frameImage = [coder animatedImageFrameAtIndex:i];
+        if (!frameImage) {
+            return nil;
+        }
+        [frames addObject:[SDImageFrame frameWithImage:frameImage duration:[coder animatedImageDurationAtIndex:i]]];
+    }
+    UIImage *animatedImage = [SDImageCoderHelper animatedImageWithFrames:frames];
+    animatedImage.sd_imageLoopCount = coder.animatedImageLoopCount;
+    animatedImage.sd_imageFormat = SDImageFormatWebP;
+    return animatedImage;
+}
+
++ (UIImage *)createStaticImageWithData:(NSData *)data features:(WebPBitstreamFeatures)features options:(SDImageCoderOptions *)options {
+    CGFloat scale = 1;
+    NSNumber *scaleFactor = options[SDImageCoderDecodeScaleFactor];
+    if (scaleFactor != nil) {
+        scale = MAX([scaleFactor doubleValue], 1);
+    }
+    
+    CGSize thumbnailSize = CGSizeZero;
+    NSValue *thumbnailSizeValue = options[SDImageCoderDecodeThumbnailPixelSize];
+    if (thumbnailSizeValue != nil) {
+#if SD_MAC
+        thumbnailSize = thumbnailSizeValue.sizeValue;
+#else
+        thumbnailSize = thumbnailSizeValue.CGSizeValue;
+#endif
+    }
+    
+    BOOL preserveAspectRatio = YES;
+    NSNumber *preserveAspectRatioValue = options[SDImageCoderDecodePreserveAspectRatio];
+    if (preserveAspectRatioValue != nil) {
+        preserveAspectRatio = preserveAspectRatioValue.boolValue;
+    }
+    
+    NSUInteger limitBytes = [options[SDImageCoderDecodeScaleDownLimitBytes] unsignedIntegerValue];
+    CGSize imageSize = CGSizeMake(features.width, features.height);
+    if (limitBytes > 0) {
+        // Scale down to limit bytes, override thumbnail size
+        thumbnailSize = [SDImageCoderHelper scaledSizeWithImageSize:imageSize limitBytes:limitBytes bytesPerPixel:4 frameCount:1];
+        preserveAspectRatio = YES;
+    }
+    
+    WebPDecoderConfig config;
+    if (!WebPInitDecoderConfig(&config)) {
+        return nil;
+    }
+    config.input = features;
+    config.options.use_threads = [options[SDImageCoderDecodeThreadCount] unsignedIntegerValue] != 1;
+    size_t width = features.width;
+    size_t height = features.height;
+    if (thumbnailSize.width > 0 && thumbnailSize.height > 0 && (imageSize.width > thumbnailSize.width || imageSize.height > thumbnailSize.height)) {
+        // libwebp scale during decoding (per row), which avoid the full size bitmap
+        CGSize scaledSize = [SDImageCoderHelper scaledSizeWithImageSize:imageSize scaleSize:thumbnailSize preserveAspectRatio:preserveAspectRatio shouldScaleUp:NO];
+        width = MAX((size_t)round(scaledSize.width), 1);
+        height = MAX((size_t)round(scaledSize.height), 1);
+        config.options.use_scaling = 1;
+        config.options.scaled_width = (int)width;
+        config.options.scaled_height = (int)height;
+    }
+    size_t bytesPerRow = SDByteAlign(width * 4, 64);
+    uint8_t *buffer = malloc(bytesPerRow * height);
+    if (!buffer) {
+        return nil;
+    }
+    // Premultiplied BGRA8888 little endian is the hardware supported pixel format
+    config.output.colorspace = features.has_alpha ? MODE_bgrA : MODE_BGRA;
+    config.output.is_external_memory = 1;
+    config.output.u.RGBA.rgba = buffer;
+    config.output.u.RGBA.stride = (int)bytesPerRow;
+    config.output.u.RGBA.size = bytesPerRow * height;
+    VP8StatusCode status = WebPDecode(data.bytes, data.length, &config);
+    WebPFreeDecBuffer(&config.output);
+    if (status != VP8_STATUS_OK) {
+        free(buffer);
+        return nil;
+    }
+    CGBitmapInfo bitmapInfo = kCGBitmapByteOrder32Little | (features.has_alpha ? kCGImageAlphaPremultipliedFirst : kCGImageAlphaNoneSkipFirst);
+    CGImageRef imageRef = [SDImageBitmapHelper CGImageCreateWithBitmapBuffer:buffer width:width height:height bytesPerRow:bytesPerRow bitmapInfo:bitmapInfo];
+    if (!imageRef) {
+        return nil;
+    }
+#if SD_UIKIT || SD_WATCH
+    UIImage *image = [[UIImage alloc] initWithCGImage:imageRef scale:scale orientation:UIImageOrientationUp];
+#else
+    UIImage *image = [[UIImage alloc] initWithCGImage:imageRef scale:scale orientation:kCGImagePropertyOrientationUp];
+#endif
+    CGImageRelease(imageRef);
+    image.sd_isDecoded = YES;
+    image.sd_imageFormat = SDImageFormatWebP;
+    return image;
+}
+
+#pragma mark - Encode
+
+- (BOOL)canEncodeToFormat:(SDImageFormat)format {
+    return NO;
+}
+
+- (NSData *)encodedDataWithImage:(UIImage *)image format:(SDImageFormat)format options:(SDImageCoderOptions *)options {
+    return nil;
+}
+
+#pragma mark - Animated Image
+
+- (instancetype)initWithAnimatedImageData:(NSData *)data options:(SDImageCoderOptions *)options {
+    if (!data) {
+        return nil;
+    }
+    self = [super init];
+    if (self) {
+        WebPAnimDecoderOptions decoderOptions;
+        if (!WebPAnimDecoderOptionsInit(&decoderOptions)) {
+            return nil;
+        }
+        decoderOptions.color_mode = MODE_bgrA;
+        decoderOptions.use_threads = [options[SDImageCoderDecodeThreadCount] unsignedIntegerValue] != 1;
+        // The decoder reference the bytes without copy, which is retained by `_imageData`
+        WebPData webpData = {data.bytes, data.length};
+        WebPAnimDecoder *animDecoder = WebPAnimDecoderNew(&webpData, &decoderOptions);
+        if (!animDecoder) {
+            return nil;
+        }
+        _animDecoder = animDecoder;
+        WebPAnimInfo info;
+        if (!WebPAnimDecoderGetInfo(animDecoder, &info) || info.frame_count == 0) {
+            return nil;
+        }
+        _frameCount = info.frame_count;
+        _loopCount = info.loop_count;
+        _canvasWidth = info.canvas_width;
+        _canvasHeight = info.canvas_height;
+        // Read the durations from demuxer, without decoding the frames
+        const WebPDemuxer *demuxer = WebPAnimDecoderGetDemuxer(animDecoder);
+        NSMutableArray<NSNumber *> *frameDurations = [NSMutableArray arrayWithCapacity:_frameCount];
+        for (NSUInteger i = 0; i < _frameCount; i++) {
+            NSTimeInterval frameDuration = 0.1;
+            WebPIterator iterator;
+            // The frame number is 1-based
+            if (WebPDemuxGetFrame(demuxer, (int)i + 1, &iterator)) {
+                frameDuration = iterator.duration / 1000.0;
+                WebPDemuxReleaseIterator(&iterator);
+            }
+            // Same as `SDImageIOAnimatedCoder`, follow Firefox's behavior and use a duration of 100 ms for any frames that specify a duration of <= 10 ms
+            if (frameDuration < 0.011) {
+                frameDuration = 0.1;
+            }
+            [frameDurations addObject:@(frameDuration)];
+        }
+        _frameDurations = [frameDurations copy];
+        
+        CGFloat scale = 1;
+        NSNumber *scaleFactor = options[SDImageCoderDecodeScaleFactor];
+        if (scaleFactor != nil) {
+            scale = MAX([scaleFactor doubleValue], 1);
+        }
+        _scale = scale;
+        CGSize thumbnailSize = CGSizeZero;
+        NSValue *thumbnailSizeValue = options[SDImageCoderDecodeThumbnailPixelSize];
+        if (thumbnailSizeValue != nil) {
+    #if SD_MAC
+            thumbnailSize = thumbnailSizeValue.sizeValue;
+    #else
+            thumbnailSize = thumbnailSizeValue.CGSizeValue;
+    #endif
+        }
+        _thumbnailSize = thumbnailSize;
+        BOOL preserveAspectRatio = YES;
+        NSNumber *preserveAspectRatioValue = options[SDImageCoderDecodePreserveAspectRatio];
+        if (preserveAspectRatioValue != nil) {
+            preserveAspectRatio = preserveAspectRatioValue.boolValue;
+        }
+        _preserveAspectRatio = preserveAspectRatio;
+        NSUInteger limitBytes = [options[SDImageCoderDecodeScaleDownLimitBytes] unsignedIntegerValue];
+        if (limitBytes > 0) {
+            // Scale down to limit bytes, override thumbnail size
+            _thumbnailSize = [SDImageCoderHelper scaledSizeWithImageSize:CGSizeMake(_canvasWidth, _canvasHeight) limitBytes:limitBytes bytesPerPixel:4 frameCount:_frameCount];
+            _preserveAspectRatio = YES;
+        }
+        _imageData = data;
+        SD_LOCK_INIT(_lock);
+    }
+    return self;
+}
+
+- (NSData *)animatedImageData {
+    return _imageData;
+}
+
+- (NSUInteger)animatedImageLoopCount {
+    return _loopCount;
+}
+
+- (NSUInteger)animatedImageFrameCount {
+    return _frameCount;
+}
+
+- (NSTimeInterval)animatedImageDurationAtIndex:(NSUInteger)index {
+    if (index >= _frameDurations.count) {
+        return 0;
+    }
+    return _frameDurations[index].doubleValue;
+}
+
+- (UIImage *)animatedImageFrameAtIndex:(NSUInteger)index {
+    if (index >= _frameCount) {
+        return nil;
+    }
+    size_t bytesPerRow = _canvasWidth * 4;
+    void *buffer = malloc(bytesPerRow * _canvasHeight);
+    if (!buffer) {
+        return nil;
+    }
+    BOOL success = NO;
+    SD_LOCK(_lock);
+    if (index + 1 < _nextFrameIndex) {
+        // Seek backward, restart from the first frame
+        WebPAnimDecoderReset(_animDecoder);
+        _nextFrameIndex = 0;
+        _canvas = NULL;
+    }
+    // The frames are blended with the previous canvas, so the skipped frames are decoded as well
+    while (_nextFrameIndex <= index) {
+        uint8_t *canvas;
+        int timestamp;
+        if (!WebPAnimDecoderGetNext(_animDecoder, &canvas, &timestamp)) {
+            break;
+        }
+        _canvas = canvas;
+        _nextFrameIndex++;
+    }
+    if (_nextFrameIndex == index + 1 && _canvas) {
+        memcpy(buffer, _canvas, bytesPerRow * _canvasHeight);
+        success = YES;
+    }
+    SD_UNLOCK(_lock);
+    if (!success) {
+        free(buffer);
+        return nil;
+    }
+    
+    CGImageRef imageRef = [SDImageBitmapHelper CGImageCreateWithBitmapBuffer:buffer width:_canvasWidth height:_canvasHeight bytesPerRow:bytesPerRow bitmapInfo:kCGBitmapByteOrder32Little | kCGImageAlphaPremultipliedFirst];
+    if (!imageRef) {
+        return nil;
+    }
+    CGImageRef thumbnailImageRef = [SDImageBitmapHelper CGImageCreateThumbnail:imageRef thumbnailSize:_thumbnailSize preserveAspectRatio:_preserveAspectRatio];
+    CGImageRelease(imageRef);
+    if (!thumbnailImageRef) {
+        return nil;
+    }
+#if SD_UIKIT || SD_WATCH
+    UIImage *image = [[UIImage alloc] initWithCGImage:thumbnailImageRef scale:_scale orientation:UIImageOrientationUp];
+#else
+    UIImage *image = [[UIImage alloc] initWithCGImage:thumbnailImageRef scale:_scale orientation:kCGImagePropertyOrientationUp];
+#endif
+    CGImageRelease(thumbnailImageRef);
+    image.sd_isDecoded = YES;
+    image.sd_imageFormat = SDImageFormatWebP;
+    return image;
+}
+
+@end
@@ -0,0 +1 @@
+../../SDImageLibWebPCoder.h
\ No newline at end of file
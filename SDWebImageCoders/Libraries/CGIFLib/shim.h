@@ -0,0 +1 @@
+#include <gif_lib.h>
@@ -0,0 +1 @@
+#include <avif/avif.h>
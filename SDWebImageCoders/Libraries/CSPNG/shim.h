@@ -0,0 +1 @@
+#include <spng.h>
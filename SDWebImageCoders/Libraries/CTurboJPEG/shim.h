@@ -0,0 +1 @@
+#include <turbojpeg.h>
@@ -0,0 +1,21 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import <SDWebImage/SDWebImage.h>
+
+/**
+ The reference PNG coder backed by libspng, which does not use Image/IO, so the decoded result can be compared with the Image/IO one. Supports static PNG decoding and encoding (the first frame of APNG).
+ @note This coder is a plugin which links libspng, install the `SDWebImage/SPNGCoder` subspec or the `SDWebImageSPNGCoder` package product.
+ @note This coder is not in the default coders list. To prefer it to Image/IO, use `[SDImageCodersManager.sharedManager addCoder:SDImageSPNGCoder.sharedCoder]`.
+ @note The 16 bits PNG is decoded into 8 bits.
+ */
+@interface SDImageSPNGCoder : NSObject <SDImageCoder>
+
+@property (nonatomic, class, readonly, nonnull) SDImageSPNGCoder *sharedCoder;
+
+@end
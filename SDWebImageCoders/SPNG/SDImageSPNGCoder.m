@@ -0,0 +1,239 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDImageSPNGCoder.h"
+#import "SDImageBitmapHelper.h"
+#import <spng.h>
+
+// Decode the rows progressively until the bottom of region, only the region pixels are kept. The caller should `free()` the buffer.
+static void * SDSPNGCreateRegionBuffer(spng_ctx *ctx, size_t rowBytes, CGRect regionRect) {
+    size_t x = regionRect.origin.x;
+    size_t y = regionRect.origin.y;
+    size_t width = regionRect.size.width;
+    size_t height = regionRect.size.height;
+    size_t bytesPerRow = width * 4;
+    uint8_t *row = malloc(rowBytes);
+    uint8_t *buffer = malloc(bytesPerRow * height);
+    if (!row || !buffer) {
+        free(row);
+        free(buffer);
+        return NULL;
+    }
+    if (spng_decode_image(ctx, NULL, 0, SPNG_FMT_RGBA8, SPNG_DECODE_TRNS | SPNG_DECODE_PROGRESSIVE) != 0) {
+        free(row);
+        free(buffer);
+        return NULL;
+    }
+    for (size_t rowIndex = 0; rowIndex < y + height; rowIndex++) {
+        // Returns `SPNG_EOI` when the last row is decoded
+        int result = spng_decode_row(ctx, row, rowBytes);
+        if (result != 0 && result != SPNG_EOI) {
+            free(row);
+            free(buffer);
+            return NULL;
+        }
+        if (rowIndex >= y) {
+            memcpy(buffer + (rowIndex - y) * bytesPerRow, row + x * 4, bytesPerRow);
+        }
+        if (result == SPNG_EOI) {
+            break;
+        }
+    }
+    free(row);
+    return buffer;
+}
+
+@implementation SDImageSPNGCoder
+
++ (instancetype)sharedCoder {
+    static SDImageSPNGCoder *coder;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        coder = [[SDImageSPNGCoder alloc] init];
+    });
+    return coder;
+}
+
+#pragma mark - Decode
+
+- (BOOL)canDecodeFromData:(NSData *)data {
+    return [NSData sd_imageFormatForImageData:data] == SDImageFormatPNG;
+}
+
+- (UIImage *)decodedImageWithData:(NSData *)data options:(SDImageCoderOptions *)options {
+    if (!data) {
+        return nil;
+    }
+    CGFloat scale = 1;
+    NSNumber *scaleFactor = options[SDImageCoderDecodeScaleFactor];
+    if (scaleFactor != nil) {
+        scale = MAX([scaleFactor doubleValue], 1);
+    }
+    
+    CGSize thumbnailSize = CGSizeZero;
+    NSValue *thumbnailSizeValue = options[SDImageCoderDecodeThumbnailPixelSize];
+    if (thumbnailSizeValue != nil) {
+#if SD_MAC
+        thumbnailSize = thumbnailSizeValue.sizeValue;
+#else
+        thumbnailSize = thumbnailSizeValue.CGSizeValue;
+#endif
+    }
+    
+    BOOL preserveAspectRatio = YES;
+    NSNumber *preserveAspectRatioValue = options[SDImageCoderDecodePreserveAspectRatio];
+    if (preserveAspectRatioValue != nil) {
+        preserveAspectRatio = preserveAspectRatioValue.boolValue;
+    }
+    
+    spng_ctx *ctx = spng_ctx_new(0);
+    if (!ctx) {
+        return nil;
+    }
+    // Ignore the ancillary chunk CRC errors like browsers, but fail on the critical chunks
+    spng_set_crc_action(ctx, SPNG_CRC_ERROR, SPNG_CRC_USE);
+    spng_set_png_buffer(ctx, data.bytes, data.length);
+    struct spng_ihdr ihdr;
+    size_t bufferSize;
+    if (spng_get_ihdr(ctx, &ihdr) != 0 || spng_decoded_image_size(ctx, SPNG_FMT_RGBA8, &bufferSize) != 0) {
+        spng_ctx_free(ctx);
+        return nil;
+    }
+    BOOL hasAlpha = ihdr.color_type == SPNG_COLOR_TYPE_TRUECOLOR_ALPHA || ihdr.color_type == SPNG_COLOR_TYPE_GRAYSCALE_ALPHA;
+    struct spng_trns trns;
+    if (!hasAlpha && spng_get_trns(ctx, &trns) == 0) {
+        hasAlpha = YES;
+    }
+    CGRect regionRect = [SDImageBitmapHelper regionRectWithOptions:options imageSize:CGSizeMake(ihdr.width, ihdr.height)];
+    BOOL decodeRegion = !CGRectIsNull(regionRect);
+    void *buffer;
+    size_t width, height, bytesPerRow;
+    if (decodeRegion && ihdr.interlace_method == SPNG_INTERLACE_NONE) {
+        // Row-range decoding, the rows below the region are not decoded at all
+        width = regionRect.size.width;
+        height = regionRect.size.height;
+        bytesPerRow = width * 4;
+        buffer = SDSPNGCreateRegionBuffer(ctx, bufferSize / ihdr.height, regionRect);
+        spng_ctx_free(ctx);
+        if (!buffer) {
+            return nil;
+        }
+    } else {
+        // The rows are tightly packed
+        width = ihdr.width;
+        height = ihdr.height;
+        bytesPerRow = width * 4;
+        buffer = malloc(bufferSize);
+        if (!buffer) {
+            spng_ctx_free(ctx);
+            return nil;
+        }
+        int result = spng_decode_image(ctx, buffer, bufferSize, SPNG_FMT_RGBA8, SPNG_DECODE_TRNS);
+        spng_ctx_free(ctx);
+        if (result != 0) {
+            free(buffer);
+            return nil;
+        }
+    }
+    CGBitmapInfo bitmapInfo = kCGBitmapByteOrder32Big | (hasAlpha ? kCGImageAlphaLast : kCGImageAlphaNoneSkipLast);
+    CGImageRef imageRef = [SDImageBitmapHelper CGImageCreateWithBitmapBuffer:buffer width:width height:height bytesPerRow:bytesPerRow bitmapInfo:bitmapInfo];
+    if (!imageRef) {
+        return nil;
+    }
+    if (decodeRegion && (width != regionRect.size.width || height != regionRect.size.height)) {
+        // Adam7 interlaced rows are not in order, crop the full image
+        CGImageRef regionImageRef = CGImageCreateWithImageInRect(imageRef, regionRect);
+        CGImageRelease(imageRef);
+        if (!regionImageRef) {
+            return nil;
+        }
+        imageRef = regionImageRef;
+    }
+    CGImageRef thumbnailImageRef;
+    if (decodeRegion) {
+        thumbnailImageRef = [SDImageBitmapHelper CGImageCreateRegionScaled:imageRef options:options];
+    } else {
+        thumbnailImageRef = [SDImageBitmapHelper CGImageCreateThumbnail:imageRef thumbnailSize:thumbnailSize preserveAspectRatio:preserveAspectRatio];
+    }
+    CGImageRelease(imageRef);
+    if (!thumbnailImageRef) {
+        return nil;
+    }
+#if SD_UIKIT || SD_WATCH
+    UIImage *image = [[UIImage alloc] initWithCGImage:thumbnailImageRef scale:scale orientation:UIImageOrientationUp];
+#else
+    UIImage *image = [[UIImage alloc] initWithCGImage:thumbnailImageRef scale:scale orientation:kCGImagePropertyOrientationUp];
+#endif
+    CGImageRelease(thumbnailImageRef);
+    image.sd_isDecoded = YES;
+    image.sd_isRegionDecoded = decodeRegion;
+    image.sd_imageFormat = SDImageFormatPNG;
+    return image;
+}
+
+#pragma mark - Encode
+
+- (BOOL)canEncodeToFormat:(SDImageFormat)format {
+    return format == SDImageFormatPNG;
+}
+
+- (NSData *)encodedDataWithImage:(UIImage *)image format:(SDImageFormat)format options:(SDImageCoderOptions *)options {
+    if (!image) {
+        return nil;
+    }
+    size_t width, height, bytesPerRow;
+    BOOL hasAlpha;
+    uint8_t *buffer = [SDImageBitmapHelper copyRGBA8888BufferWithImage:image options:options width:&width height:&height bytesPerRow:&bytesPerRow hasAlpha:&hasAlpha];
+    if (!buffer) {
+        return nil;
+    }
+    // libspng requires the tightly packed rows in PNG's pixel format, drop the padding (and the alpha for opaque image) in place
+    size_t components = hasAlpha ? 4 : 3;
+    for (size_t y = 0; y < height; y++) {
+        uint8_t *src = buffer + y * bytesPerRow;
+        uint8_t *dst = buffer + y * width * components;
+        if (components == 4) {
+            memmove(dst, src, width * 4);
+        } else {
+            for (size_t x = 0; x < width; x++) {
+                dst[x * 3] = src[x * 4];
+                dst[x * 3 + 1] = src[x * 4 + 1];
+                dst[x * 3 + 2] = src[x * 4 + 2];
+            }
+        }
+    }
+    spng_ctx *ctx = spng_ctx_new(SPNG_CTX_ENCODER);
+    if (!ctx) {
+        free(buffer);
+        return nil;
+    }
+    spng_set_option(ctx, SPNG_ENCODE_TO_BUFFER, 1);
+    struct spng_ihdr ihdr = {
+        .width = (uint32_t)width,
+        .height = (uint32_t)height,
+        .bit_depth = 8,
+        .color_type = hasAlpha ? SPNG_COLOR_TYPE_TRUECOLOR_ALPHA : SPNG_COLOR_TYPE_TRUECOLOR,
+    };
+    spng_set_ihdr(ctx, &ihdr);
+    int result = spng_encode_image(ctx, buffer, width * height * components, SPNG_FMT_PNG, SPNG_ENCODE_FINALIZE);
+    free(buffer);
+    NSData *data;
+    if (result == 0) {
+        size_t pngSize;
+        int error;
+        // The buffer is allocated by the default `malloc()`, transfer the ownership
+        void *pngBuffer = spng_get_png_buffer(ctx, &pngSize, &error);
+        if (pngBuffer) {
+            data = [NSData dataWithBytesNoCopy:pngBuffer length:pngSize freeWhenDone:YES];
+        }
+    }
+    spng_ctx_free(ctx);
+    return data;
+}
+
+@end
@@ -0,0 +1 @@
+../../SDImageSPNGCoder.h
\ No newline at end of file
@@ -0,0 +1,22 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import <SDWebImage/SDWebImage.h>
+
+/**
+ The reference JPEG coder backed by libjpeg-turbo (the TurboJPEG API), which does not use Image/IO, so the decoded result can be compared with the Image/IO one. Supports progressive decoding and JPEG encoding.
+ The thumbnail decoding use the DCT-domain scaling (1/2, 1/4, 1/8 IDCT, see `+[SDImageCoderHelper DCTScaleDenominatorWithImageSize:thumbnailSize:preserveAspectRatio:]`), which skip most of the IDCT and color conversion work, then scale down to the exact thumbnail pixel size.
+ @note This coder is a plugin which links libjpeg-turbo, install the `SDWebImage/TurboJPEGCoder` subspec or the `SDWebImageTurboJPEGCoder` package product.
+ @note This coder is not in the default coders list. To prefer it to Image/IO, use `[SDImageCodersManager.sharedManager addCoder:SDImageTurboJPEGCoder.sharedCoder]`.
+ @note CMYK JPEG is not supported.
+ */
+@interface SDImageTurboJPEGCoder : NSObject <SDProgressiveImageCoder>
+
+@property (nonatomic, class, readonly, nonnull) SDImageTurboJPEGCoder *sharedCoder;
+
+@end
@@ -0,0 +1,435 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDImageTurboJPEGCoder.h"
+#import "SDImageBitmapHelper.h"
+#import <turbojpeg.h>
+
+static inline uint16_t SDTIFFReadUInt16(const uint8_t *bytes, BOOL littleEndian) {
+    return littleEndian ? (uint16_t)(bytes[0] | bytes[1] << 8) : (uint16_t)(bytes[0] << 8 | bytes[1]);
+}
+
+static inline uint32_t SDTIFFReadUInt32(const uint8_t *bytes, BOOL littleEndian) {
+    return littleEndian ? ((uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24) : ((uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16 | (uint32_t)bytes[2] << 8 | (uint32_t)bytes[3]);
+}
+
+// TurboJPEG does not parse the metadata, read the orientation tag in the IFD0 of EXIF (APP1) segment
+static CGImagePropertyOrientation SDJPEGEXIFOrientation(NSData *data) {
+    const uint8_t *bytes = data.bytes;
+    size_t length = data.length;
+    if (length < 4 || bytes[0] != 0xFF || bytes[1] != 0xD8) {
+        return kCGImagePropertyOrientationUp;
+    }
+    size_t offset = 2;
+    while (offset + 4 <= length && bytes[offset] == 0xFF) {
+        uint8_t marker = bytes[offset + 1];
+        if (marker == 0xFF) {
+            // Fill byte
+            offset++;
+            continue;
+        }
+        if (marker == 0xDA || marker == 0xD9) {
+            // Start of scan, no more metadata
+            break;
+        }
+        size_t segmentLength = (size_t)bytes[offset + 2] << 8 | bytes[offset + 3];
+        if (segmentLength < 2 || offset + 2 + segmentLength > length) {
+            break;
+        }
+        // APP1 segment: "Exif\0\0" + TIFF header + IFD0
+        if (marker == 0xE1 && segmentLength >= 2 + 6 + 8 && memcmp(bytes + offset + 4, "Exif\0\0", 6) == 0) {
+            const uint8_t *tiff = bytes + offset + 10;
+            size_t tiffLength = segmentLength - 8;
+            BOOL littleEndian;
+            if (tiff[0] == 'I' && tiff[1] == 'I') {
+                littleEndian = YES;
+            } else if (tiff[0] == 'M' && tiff[1] == 'M') {
+                littleEndian = NO;
+            } else {
+                break;
+            }
+            uint32_t ifdOffset = SDTIFFReadUInt32(tiff + 4, littleEndian);
+            if ((size_t)ifdOffset + 2 > tiffLength) {
+                break;
+            }
+            uint16_t entryCount = SDTIFFReadUInt16(tiff + ifdOffset, littleEndian);
+            for (uint16_t i = 0; i < entryCount; i++) {
+                size_t entryOffset = (size_t)ifdOffset + 2 + (size_t)i * 12;
+                if (entryOffset + 12 > tiffLength) {
+                    break;
+                }
+                if (SDTIFFReadUInt16(tiff + entryOffset, littleEndian) == 0x0112) {
+                    uint16_t orientation = SDTIFFReadUInt16(tiff + entryOffset + 8, littleEndian);
+                    if (orientation >= 1 && orientation <= 8) {
+                        return (CGImagePropertyOrientation)orientation;
+                    }
+                    break;
+                }
+            }
+            break;
+        }
+        offset += 2 + segmentLength;
+    }
+    return kCGImagePropertyOrientationUp;
+}
+
+// Decode the scaled image into the BGRX8888 buffer, which covers the region (in the scaled image coordinate). The caller should `free()` the buffer.
+static void * SDTurboJPEGCreateRegionBuffer(NSData *data, NSUInteger denominator, CGRect regionRect, CGRect *decodedRect, size_t *bytesPerRow) {
+    tjscalingfactor scalingFactor = {1, (int)denominator};
+#if defined(TJ_NUMINIT)
+    // libjpeg-turbo 3 API, decode only the MCU-aligned columns and the rows which intersect the region
+    tjhandle handle = tj3Init(TJINIT_DECOMPRESS);
+    if (!handle) {
+        return NULL;
+    }
+    if (tj3DecompressHeader(handle, data.bytes, data.length) != 0 || tj3SetScalingFactor(handle, scalingFactor) != 0) {
+        tj3Destroy(handle);
+        return NULL;
+    }
+    int subsamp = tj3Get(handle, TJPARAM_SUBSAMP);
+    CGRect rect = CGRectMake(0, 0, TJSCALED(tj3Get(handle, TJPARAM_JPEGWIDTH), scalingFactor), TJSCALED(tj3Get(handle, TJPARAM_JPEGHEIGHT), scalingFactor));
+    if (subsamp >= 0) {
+        // The left edge of cropping region must be aligned to the scaled MCU width
+        int mcuWidth = TJSCALED(tjMCUWidth[subsamp], scalingFactor);
+        CGFloat x = floor(CGRectGetMinX(regionRect) / mcuWidth) * mcuWidth;
+        rect = CGRectMake(x, CGRectGetMinY(regionRect), CGRectGetMaxX(regionRect) - x, CGRectGetHeight(regionRect));
+        tjregion croppingRegion = {(int)rect.origin.x, (int)rect.origin.y, (int)rect.size.width, (int)rect.size.height};
+        if (tj3SetCroppingRegion(handle, croppingRegion) != 0) {
+            tj3Destroy(handle);
+            return NULL;
+        }
+    }
+    size_t rowBytes = SDByteAlign((size_t)rect.size.width * 4, 64);
+    void *buffer = malloc(rowBytes * (size_t)rect.size.height);
+    if (!buffer) {
+        tj3Destroy(handle);
+        return NULL;
+    }
+    int result = tj3Decompress8(handle, data.bytes, data.length, buffer, (int)rowBytes, TJPF_BGRX);
+    BOOL success = result == 0 || tj3GetErrorCode(handle) == TJERR_WARNING;
+    tj3Destroy(handle);
+#else
+    // TurboJPEG 2 API does not support partial decoding, decode the whole scaled image
+    tjhandle handle = tjInitDecompress();
+    if (!handle) {
+        return NULL;
+    }
+    int width, height, subsamp, colorspace;
+    if (tjDecompressHeader3(handle, data.bytes, (unsigned long)data.length, &width, &height, &subsamp, &colorspace) != 0) {
+        tjDestroy(handle);
+        return NULL;
+    }
+    CGRect rect = CGRectMake(0, 0, TJSCALED(width, scalingFactor), TJSCALED(height, scalingFactor));
+    size_t rowBytes = SDByteAlign((size_t)rect.size.width * 4, 64);
+    void *buffer = malloc(rowBytes * (size_t)rect.size.height);
+    if (!buffer) {
+        tjDestroy(handle);
+        return NULL;
+    }
+    int result = tjDecompress2(handle, data.bytes, (unsigned long)data.length, buffer, (int)rect.size.width, (int)rowBytes, (int)rect.size.height, TJPF_BGRX, 0);
+    BOOL success = result == 0 || tjGetErrorCode(handle) == TJERR_WARNING;
+    tjDestroy(handle);
+#endif
+    if (!success) {
+        free(buffer);
+        return NULL;
+    }
+    *decodedRect = rect;
+    *bytesPerRow = rowBytes;
+    return buffer;
+}
+
+@implementation SDImageTurboJPEGCoder {
+    NSData *_imageData;
+    CGFloat _scale;
+    CGSize _thumbnailSize;
+    BOOL _preserveAspectRatio;
+    BOOL _finished;
+}
+
++ (instancetype)sharedCoder {
+    static SDImageTurboJPEGCoder *coder;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        coder = [[SDImageTurboJPEGCoder alloc] init];
+    });
+    return coder;
+}
+
+#pragma mark - Decode
+
+- (BOOL)canDecodeFromData:(NSData *)data {
+    return [NSData sd_imageFormatForImageData:data] == SDImageFormatJPEG;
+}
+
+- (UIImage *)decodedImageWithData:(NSData *)data options:(SDImageCoderOptions *)options {
+    if (!data) {
+        return nil;
+    }
+    CGFloat scale = 1;
+    NSNumber *scaleFactor = options[SDImageCoderDecodeScaleFactor];
+    if (scaleFactor != nil) {
+        scale = MAX([scaleFactor doubleValue], 1);
+    }
+    
+    CGSize thumbnailSize = CGSizeZero;
+    NSValue *thumbnailSizeValue = options[SDImageCoderDecodeThumbnailPixelSize];
+    if (thumbnailSizeValue != nil) {
+#if SD_MAC
+        thumbnailSize = thumbnailSizeValue.sizeValue;
+#else
+        thumbnailSize = thumbnailSizeValue.CGSizeValue;
+#endif
+    }
+    
+    BOOL preserveAspectRatio = YES;
+    NSNumber *preserveAspectRatioValue = options[SDImageCoderDecodePreserveAspectRatio];
+    if (preserveAspectRatioValue != nil) {
+        preserveAspectRatio = preserveAspectRatioValue.boolValue;
+    }
+    
+    if (options[SDImageCoderDecodeCropRect]) {
+        UIImage *image = [self.class createRegionImageWithData:data scale:scale options:options];
+        if (image) {
+            return image;
+        }
+    }
+    
+    return [self.class createImageWithData:data scale:scale thumbnailSize:thumbnailSize preserveAspectRatio:preserveAspectRatio];
+}
+
++ (UIImage *)createRegionImageWithData:(NSData *)data scale:(CGFloat)scale options:(SDImageCoderOptions *)options {
+    CGImagePropertyOrientation exifOrientation = SDJPEGEXIFOrientation(data);
+#if SD_MAC
+    // AppKit's CGImage is rotated by EXIF orientation, which does not match the region
+    if (exifOrientation != kCGImagePropertyOrientationUp) {
+        return nil;
+    }
+#endif
+    tjhandle handle = tjInitDecompress();
+    if (!handle) {
+        return nil;
+    }
+    int width, height, subsamp, colorspace;
+    int result = tjDecompressHeader3(handle, data.bytes, (unsigned long)data.length, &width, &height, &subsamp, &colorspace);
+    tjDestroy(handle);
+    if (result != 0) {
+        return nil;
+    }
+    CGRect regionRect = [SDImageBitmapHelper regionRectWithOptions:options imageSize:CGSizeMake(width, height)];
+    if (CGRectIsNull(regionRect)) {
+        return nil;
+    }
+    CGSize scaledSize = CGSizeZero;
+    NSValue *scaledSizeValue = options[SDImageCoderDecodeCropScaledPixelSize];
+    if (scaledSizeValue != nil) {
+#if SD_MAC
+        scaledSize = scaledSizeValue.sizeValue;
+#else
+        scaledSize = scaledSizeValue.CGSizeValue;
+#endif
+    }
+    // Use the reduced-size IDCT for the down-scaled region, then map the region into the scaled image
+    NSUInteger denominator = [SDImageCoderHelper DCTScaleDenominatorWithImageSize:regionRect.size thumbnailSize:scaledSize preserveAspectRatio:NO];
+    tjscalingfactor scalingFactor = {1, (int)denominator};
+    CGRect scaledImageRect = CGRectMake(0, 0, TJSCALED(width, scalingFactor), TJSCALED(height, scalingFactor));
+    CGRect scaledRegionRect = CGRectIntegral(CGRectMake(regionRect.origin.x / denominator, regionRect.origin.y / denominator, regionRect.size.width / denominator, regionRect.size.height / denominator));
+    scaledRegionRect = CGRectIntersection(scaledRegionRect, scaledImageRect);
+    if (CGRectIsEmpty(scaledRegionRect)) {
+        return nil;
+    }
+    CGRect decodedRect;
+    size_t bytesPerRow;
+    void *buffer = SDTurboJPEGCreateRegionBuffer(data, denominator, scaledRegionRect, &decodedRect, &bytesPerRow);
+    if (!buffer) {
+        return nil;
+    }
+    CGImageRef imageRef = [SDImageBitmapHelper CGImageCreateWithBitmapBuffer:buffer width:decodedRect.size.width height:decodedRect.size.height bytesPerRow:bytesPerRow bitmapInfo:kCGBitmapByteOrder32Little | kCGImageAlphaNoneSkipFirst];
+    if (!imageRef) {
+        return nil;
+    }
+    // Crop the extra columns (MCU alignment) or the whole image (TurboJPEG 2)
+    CGRect cropRect = CGRectOffset(scaledRegionRect, -decodedRect.origin.x, -decodedRect.origin.y);
+    if (!CGRectEqualToRect(cropRect, CGRectMake(0, 0, decodedRect.size.width, decodedRect.size.height))) {
+        CGImageRef croppedImageRef = CGImageCreateWithImageInRect(imageRef, cropRect);
+        CGImageRelease(imageRef);
+        if (!croppedImageRef) {
+            return nil;
+        }
+        imageRef = croppedImageRef;
+    }
+    CGImageRef scaledImageRef = [SDImageBitmapHelper CGImageCreateRegionScaled:imageRef options:options];
+    CGImageRelease(imageRef);
+    if (!scaledImageRef) {
+        return nil;
+    }
+#if SD_UIKIT || SD_WATCH
+    UIImageOrientation imageOrientation = [SDImageCoderHelper imageOrientationFromEXIFOrientation:exifOrientation];
+    UIImage *image = [[UIImage alloc] initWithCGImage:scaledImageRef scale:scale orientation:imageOrientation];
+#else
+    UIImage *image = [[UIImage alloc] initWithCGImage:scaledImageRef scale:scale orientation:exifOrientation];
+#endif
+    CGImageRelease(scaledImageRef);
+    image.sd_isDecoded = YES;
+    image.sd_isRegionDecoded = YES;
+    image.sd_imageFormat = SDImageFormatJPEG;
+    return image;
+}
+
++ (UIImage *)createImageWithData:(NSData *)data scale:(CGFloat)scale thumbnailSize:(CGSize)thumbnailSize preserveAspectRatio:(BOOL)preserveAspectRatio {
+    tjhandle handle = tjInitDecompress();
+    if (!handle) {
+        return nil;
+    }
+    int width, height, subsamp, colorspace;
+    if (tjDecompressHeader3(handle, data.bytes, (unsigned long)data.length, &width, &height, &subsamp, &colorspace) != 0) {
+        tjDestroy(handle);
+        return nil;
+    }
+    CGImagePropertyOrientation exifOrientation = SDJPEGEXIFOrientation(data);
+    if (exifOrientation >= kCGImagePropertyOrientationLeftMirrored) {
+        // The thumbnail size is for the oriented image, but the pixels are not rotated yet
+        thumbnailSize = CGSizeMake(thumbnailSize.height, thumbnailSize.width);
+    }
+    NSUInteger denominator = [SDImageCoderHelper DCTScaleDenominatorWithImageSize:CGSizeMake(width, height) thumbnailSize:thumbnailSize preserveAspectRatio:preserveAspectRatio];
+    tjscalingfactor scalingFactor = {1, (int)denominator};
+    int scaledWidth = TJSCALED(width, scalingFactor);
+    int scaledHeight = TJSCALED(height, scalingFactor);
+    size_t bytesPerRow = SDByteAlign((size_t)scaledWidth * 4, 64);
+    void *buffer = malloc(bytesPerRow * scaledHeight);
+    if (!buffer) {
+        tjDestroy(handle);
+        return nil;
+    }
+    // BGRX8888 little endian is the hardware supported pixel format, which avoid the extra conversion during rendering
+    int result = tjDecompress2(handle, data.bytes, (unsigned long)data.length, buffer, scaledWidth, (int)bytesPerRow, scaledHeight, TJPF_BGRX, 0);
+    // The truncated data (progressive decoding) or minor corruption only produce warning, and the remaining pixels are gray
+    BOOL success = result == 0 || tjGetErrorCode(handle) == TJERR_WARNING;
+    tjDestroy(handle);
+    if (!success) {
+        free(buffer);
+        return nil;
+    }
+    CGImageRef imageRef = [SDImageBitmapHelper CGImageCreateWithBitmapBuffer:buffer width:scaledWidth height:scaledHeight bytesPerRow:bytesPerRow bitmapInfo:kCGBitmapByteOrder32Little | kCGImageAlphaNoneSkipFirst];
+    if (!imageRef) {
+        return nil;
+    }
+    CGImageRef thumbnailImageRef = [SDImageBitmapHelper CGImageCreateThumbnail:imageRef thumbnailSize:thumbnailSize preserveAspectRatio:preserveAspectRatio];
+    CGImageRelease(imageRef);
+    if (!thumbnailImageRef) {
+        return nil;
+    }
+#if SD_UIKIT || SD_WATCH
+    UIImageOrientation imageOrientation = [SDImageCoderHelper imageOrientationFromEXIFOrientation:exifOrientation];
+    UIImage *image = [[UIImage alloc] initWithCGImage:thumbnailImageRef scale:scale orientation:imageOrientation];
+#else
+    UIImage *image = [[UIImage alloc] initWithCGImage:thumbnailImageRef scale:scale orientation:exifOrientation];
+#endif
+    CGImageRelease(thumbnailImageRef);
+    image.sd_isDecoded = YES;
+    image.sd_imageFormat = SDImageFormatJPEG;
+    return image;
+}
+
+#pragma mark - Progressive Decode
+
+- (BOOL)canIncrementalDecodeFromData:(NSData *)data {
+    return [self canDecodeFromData:data];
+}
+
+- (instancetype)initIncrementalWithOptions:(SDImageCoderOptions *)options {
+    self = [super init];
+    if (self) {
+        CGFloat scale = 1;
+        NSNumber *scaleFactor = options[SDImageCoderDecodeScaleFactor];
+        if (scaleFactor != nil) {
+            scale = MAX([scaleFactor doubleValue], 1);
+        }
+        _scale = scale;
+        CGSize thumbnailSize = CGSizeZero;
+        NSValue *thumbnailSizeValue = options[SDImageCoderDecodeThumbnailPixelSize];
+        if (thumbnailSizeValue != nil) {
+    #if SD_MAC
+            thumbnailSize = thumbnailSizeValue.sizeValue;
+    #else
+            thumbnailSize = thumbnailSizeValue.CGSizeValue;
+    #endif
+        }
+        _thumbnailSize = thumbnailSize;
+        BOOL preserveAspectRatio = YES;
+        NSNumber *preserveAspectRatioValue = options[SDImageCoderDecodePreserveAspectRatio];
+        if (preserveAspectRatioValue != nil) {
+            preserveAspectRatio = preserveAspectRatioValue.boolValue;
+        }
+        _preserveAspectRatio = preserveAspectRatio;
+    }
+    return self;
+}
+
+- (void)updateIncrementalData:(NSData *)data finished:(BOOL)finished {
+    if (_finished) {
+        return;
+    }
+    _finished = finished;
+    // TurboJPEG has no suspending data source, keep all the data and decode from the beginning
+    _imageData = [data copy];
+}
+
+- (UIImage *)incrementalDecodedImageWithOptions:(SDImageCoderOptions *)options {
+    if (_imageData.length == 0) {
+        return nil;
+    }
+    CGFloat scale = _scale;
+    NSNumber *scaleFactor = options[SDImageCoderDecodeScaleFactor];
+    if (scaleFactor != nil) {
+        scale = MAX([scaleFactor doubleValue], 1);
+    }
+    return [self.class createImageWithData:_imageData scale:scale thumbnailSize:_thumbnailSize preserveAspectRatio:_preserveAspectRatio];
+}
+
+#pragma mark - Encode
+
+- (BOOL)canEncodeToFormat:(SDImageFormat)format {
+    return format == SDImageFormatJPEG;
+}
+
+- (NSData *)encodedDataWithImage:(UIImage *)image format:(SDImageFormat)format options:(SDImageCoderOptions *)options {
+    if (!image) {
+        return nil;
+    }
+    size_t width, height, bytesPerRow;
+    BOOL hasAlpha;
+    // JPEG does not have alpha channel, the alpha is dropped, use `SDImageCoderEncodeBackgroundColor` to composite it
+    void *buffer = [SDImageBitmapHelper copyRGBA8888BufferWithImage:image options:options width:&width height:&height bytesPerRow:&bytesPerRow hasAlpha:&hasAlpha];
+    if (!buffer) {
+        return nil;
+    }
+    double compressionQuality = 1;
+    if (options[SDImageCoderEncodeCompressionQuality]) {
+        compressionQuality = [options[SDImageCoderEncodeCompressionQuality] doubleValue];
+    }
+    int quality = (int)MIN(MAX(round(compressionQuality * 100), 1), 100);
+    tjhandle handle = tjInitCompress();
+    if (!handle) {
+        free(buffer);
+        return nil;
+    }
+    unsigned char *jpegBuffer = NULL;
+    unsigned long jpegSize = 0;
+    int result = tjCompress2(handle, buffer, (int)width, (int)bytesPerRow, (int)height, TJPF_RGBX, &jpegBuffer, &jpegSize, TJSAMP_420, quality, 0);
+    tjDestroy(handle);
+    free(buffer);
+    NSData *data;
+    if (result == 0 && jpegBuffer) {
+        data = [NSData dataWithBytes:jpegBuffer length:jpegSize];
+    }
+    tjFree(jpegBuffer);
+    return data;
+}
+
+@end
@@ -0,0 +1 @@
+../../SDImageTurboJPEGCoder.h
\ No newline at end of file
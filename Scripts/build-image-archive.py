@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+#
+# Build the read-only image archive used by `SDImageArchiveCache`.
+#
+# The manifest is a text file, each line is the image URL, optionally followed by the local file path (separated by whitespace):
+#
+#   https://example.com/onboarding/1.png  Assets/onboarding-1.png
+#   https://example.com/avatar/default.jpg
+#
+# The URL is used as the cache key (the same as the default `SDWebImageManager` cache key). When the local file is omitted, the URL is downloaded.
+# Blank lines and lines starting with `#` are ignored. Relative paths are resolved from the manifest's directory.
+#
+# Usage: build-image-archive.py <manifest> -o <output.sdarchive>
+
+import argparse
+import os
+import struct
+import sys
+import urllib.request
+
+MAGIC = b"SDIMGARC"
+VERSION = 1
+HEADER_SIZE = 64
+SLOT_SIZE = 32
+RECORD_ALIGNMENT = 8
+
+FNV_OFFSET_BASIS = 0xcbf29ce484222325
+FNV_PRIME = 0x100000001b3
+
+
+def fnv1a64(data):
+    value = FNV_OFFSET_BASIS
+    for byte in data:
+        value ^= byte
+        value = (value * FNV_PRIME) & 0xffffffffffffffff
+    # 0 marks the empty slot
+    return value or 1
+
+
+def align(value, alignment):
+    return (value + alignment - 1) // alignment * alignment
+
+
+def read_manifest(path):
+    base = os.path.dirname(os.path.abspath(path))
+    entries = []
+    with open(path, encoding="utf-8") as manifest:
+        for line_number, line in enumerate(manifest, 1):
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+            fields = line.split()
+            if len(fields) > 2:
+                sys.exit("%s:%d: expected '<url> [<file>]'" % (path, line_number))
+            url = fields[0]
+            if len(fields) == 2:
+                file_path = os.path.join(base, fields[1])
+                with open(file_path, "rb") as f:
+                    data = f.read()
+            else:
+                with urllib.request.urlopen(url) as response:
+                    data = response.read()
+            entries.append((url, data))
+    return entries
+
+
+def build_archive(entries):
+    keys = {}
+    for key, data in entries:
+        # The later line overrides the former one
+        keys[key.encode("utf-8")] = data
+
+    bucket_count = 1
+    while bucket_count < len(keys) * 2:
+        bucket_count *= 2
+    table_offset = HEADER_SIZE
+    offset = align(table_offset + bucket_count * SLOT_SIZE, RECORD_ALIGNMENT)
+
+    slots = [None] * bucket_count
+    records = bytearray()
+    for key, data in keys.items():
+        key_hash = fnv1a64(key)
+        # Linear probing, the load factor is not larger than 0.5
+        index = key_hash & (bucket_count - 1)
+        while slots[index] is not None:
+            index = (index + 1) & (bucket_count - 1)
+        record_offset = offset + len(records)
+        slots[index] = struct.pack("<QQIIQ", key_hash, record_offset, len(key), 0, len(data))
+        records += key + data
+        records += b"\0" * (align(len(records), RECORD_ALIGNMENT) - len(records))
+
+    archive = bytearray()
+    archive += struct.pack("<8sIIQQQ", MAGIC, VERSION, 0, len(keys), bucket_count, table_offset)
+    archive += b"\0" * (HEADER_SIZE - len(archive))
+    for slot in slots:
+        archive += slot if slot is not None else b"\0" * SLOT_SIZE
+    archive += b"\0" * (offset - len(archive))
+    archive += records
+    return archive
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Build the read-only image archive for SDImageArchiveCache.")
+    parser.add_argument("manifest", help="the manifest file, each line is '<url> [<file>]'")
+    parser.add_argument("-o", "--output", required=True, help="the output archive path")
+    args = parser.parse_args()
+
+    entries = read_manifest(args.manifest)
+    archive = build_archive(entries)
+    with open(args.output, "wb") as output:
+        output.write(archive)
+    print("Wrote %d images (%d bytes) to %s" % (len({key for key, _ in entries}), len(archive), args.output))
+
+
+if __name__ == "__main__":
+    main()
@@ -816,6 +816,51 @@ static BOOL _isCalled;
     expect(scaledImage).notTo.equal(image);
 }
 
+- (void)test38AnimatedImageProgressiveAppendFrames {
+    NSData *fullData = [self testGIFData];
+    NSUInteger length = fullData.length;
+    SDImageGIFCoder *coder = [[SDImageGIFCoder alloc] initIncrementalWithOptions:nil];
+    [coder updateIncrementalData:[fullData subdataWithRange:NSMakeRange(0, length / 2)] finished:NO];
+    NSUInteger partialFrameCount = coder.animatedImageFrameCount;
+    expect(partialFrameCount).beGreaterThan(1);
+    NSTimeInterval firstDuration = [coder animatedImageDurationAtIndex:0];
+
+    SDAnimatedImageView *imageView = [SDAnimatedImageView new];
+    imageView.shouldIncrementalLoad = YES;
+    SDAnimatedImage *progressiveImage = [[SDAnimatedImage alloc] initWithAnimatedCoder:coder scale:1];
+    progressiveImage.sd_isIncremental = YES;
+    imageView.image = progressiveImage;
+    SDAnimatedImagePlayer *player = imageView.player;
+    expect(player).notTo.beNil();
+    expect(player.totalFrameCount).equal(partialFrameCount);
+
+    // New frames are appended to the same player, the received frames are not changed
+    [coder updateIncrementalData:fullData finished:NO];
+    NSUInteger frameCount = coder.animatedImageFrameCount;
+    expect(frameCount).beGreaterThan(partialFrameCount);
+    expect([coder animatedImageDurationAtIndex:0]).equal(firstDuration);
+    progressiveImage = [[SDAnimatedImage alloc] initWithAnimatedCoder:coder scale:1];
+    progressiveImage.sd_isIncremental = YES;
+    imageView.image = progressiveImage;
+    expect(imageView.isProgressive).beTruthy();
+    expect(imageView.player).equal(player);
+    expect(player.totalFrameCount).equal(frameCount);
+    
+    // The final image is handed over to the running player, the playing state is kept
+    NSUInteger frameIndex = partialFrameCount - 1;
+    [player seekToFrameAtIndex:frameIndex loopCount:0];
+    expect(imageView.currentFrameIndex).equal(frameIndex);
+    SDAnimatedImage *finalImage = [[SDAnimatedImage alloc] initWithData:fullData scale:1];
+    NSUInteger finalFrameCount = finalImage.animatedImageFrameCount;
+    expect(finalFrameCount).beGreaterThan(partialFrameCount);
+    imageView.image = finalImage;
+    expect(imageView.isProgressive).beFalsy();
+    expect(imageView.player).equal(player);
+    expect(imageView.currentFrameIndex).equal(frameIndex);
+    expect(player.currentFrameIndex).equal(frameIndex);
+    expect(player.totalFrameCount).equal(finalFrameCount);
+}
+
 - (void)testAnimationTransformerWorks {
     XCTestExpectation *expectation = [self expectationWithDescription:@"test SDAnimatedImageView animationTransformer works"];
     SDAnimatedImageView *imageView = [SDAnimatedImageView new];
@@ -10,6 +10,7 @@
 #import "SDWebImageTestCoder.h"
 #import "SDMockFileManager.h"
 #import "SDWebImageTestCache.h"
+#import <libkern/OSByteOrder.h>
 
 static NSString *kTestImageKeyJPEG = @"TestImageKey.jpg";
 static NSString *kTestImageKeyPNG = @"TestImageKey.png";
@@ -967,8 +968,413 @@ static NSString *kTestImageKeyPNG = @"TestImageKey.png";
     expect(cacheFiles.count).equal(0);
 }
 
+- (void)test59StoreImageStreamEncodeToDiskCache {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Store image without data should stream encode to disk cache"];
+    SDImageCache *cache = [[SDImageCache alloc] initWithNamespace:@"TestStreamEncode"];
+    NSString *key = @"TestStreamEncodeKey";
+    // Temporary file is created in the cache volume
+    NSURL *temporaryURL = [(SDDiskCache *)cache.diskCache temporaryURLForKey:key];
+    expect(temporaryURL).notTo.beNil();
+    expect([temporaryURL.path hasPrefix:cache.diskCachePath]).beFalsy();
+    
+    [cache storeImage:self.testJPEGImage imageData:nil forKey:key toDisk:YES completion:^{
+        NSData *data = [cache diskImageDataForKey:key];
+        expect([NSData sd_imageFormatForImageData:data]).equal(SDImageFormatJPEG);
+        UIImage *diskImage = [UIImage sd_imageWithData:data];
+        expect(diskImage.size).equal(self.testJPEGImage.size);
+        // Committed file is moved from the temporary directory
+        NSString *temporaryDirectoryPath = temporaryURL.URLByDeletingLastPathComponent.path;
+        NSArray<NSString *> *temporaryFiles = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:temporaryDirectoryPath error:nil];
+        expect(temporaryFiles.count).equal(0);
+        [cache clearDiskOnCompletion:^{
+            [expectation fulfill];
+        }];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)test60ContentAddressedDiskCacheDeduplicate {
+    NSString *cachePath = [[self userCacheDirectory] stringByAppendingPathComponent:@"TestContentAddressed"];
+    SDContentAddressedDiskCache *diskCache = [[SDContentAddressedDiskCache alloc] initWithCachePath:cachePath config:[SDImageCacheConfig new]];
+    [diskCache removeAllData];
+    NSData *data = [NSData dataWithContentsOfFile:[self testJPEGPath]];
+    NSData *otherData = [NSData dataWithContentsOfFile:[self testPNGPath]];
+    NSString *key1 = @"https://cdn.example.com/image.jpg?signature=1";
+    NSString *key2 = @"https://mirror.example.com/image.jpg?utm_source=test";
+
+    // Same bytes under different keys are stored once
+    [diskCache setData:data forKey:key1];
+    [diskCache setData:data forKey:key2];
+    expect([diskCache dataForKey:key1]).equal(data);
+    expect([diskCache dataForKey:key2]).equal(data);
+    expect([diskCache cachePathForKey:key1]).equal([diskCache cachePathForKey:key2]);
+    expect([diskCache referenceCountForKey:key1]).equal(2);
+    expect(diskCache.totalCount).equal(2);
+    expect(diskCache.totalSize).equal(data.length);
+    // The duplicated store does not allocate again, and the shared file can't be modified by path
+    NSUInteger allocatedSize = diskCache.totalAllocatedSize;
+    [diskCache setData:data forKey:@"https://cdn.example.com/image.jpg?signature=3"];
+    expect(diskCache.totalAllocatedSize).equal(allocatedSize);
+    expect([[NSFileManager defaultManager] isWritableFileAtPath:[diskCache cachePathForKey:key1]]).beFalsy();
+    [diskCache removeDataForKey:@"https://cdn.example.com/image.jpg?signature=3"];
+
+    // Extended data is still per key
+    NSData *extendedData = [@"extended" dataUsingEncoding:NSUTF8StringEncoding];
+    [diskCache setExtendedData:extendedData forKey:key1];
+    expect([diskCache extendedDataForKey:key1]).equal(extendedData);
+    expect([diskCache extendedDataForKey:key2]).beNil();
+
+    // Removing one reference keeps the shared content
+    [diskCache removeDataForKey:key1];
+    expect([diskCache containsDataForKey:key1]).beFalsy();
+    expect([diskCache dataForKey:key2]).equal(data);
+    expect([diskCache referenceCountForKey:key2]).equal(1);
+
+    // Overwriting the last reference releases the old content
+    [diskCache setData:otherData forKey:key2];
+    expect([diskCache dataForKey:key2]).equal(otherData);
+    expect(diskCache.totalSize).equal(otherData.length);
+
+    [diskCache removeExpiredData];
+    expect([diskCache referenceCountForKey:key2]).equal(1);
+    [diskCache removeAllData];
+    expect(diskCache.totalCount).equal(0);
+}
+
+- (void)test61DecodedDiskCacheReturnsMappedBitmap {
+    SDImageCacheConfig *config = [SDImageCacheConfig new];
+    config.maxDecodedDiskSize = 32 * 1024 * 1024;
+    config.shouldCacheImagesInMemory = NO;
+    SDImageCache *cache = [[SDImageCache alloc] initWithNamespace:@"DecodedDiskCache" diskCacheDirectory:[self userCacheDirectory] config:config];
+    expect(cache.decodedDiskCache).notTo.beNil();
+    [cache.decodedDiskCache removeAllImages];
+    NSString *key = @"TestDecodedDiskCacheKey";
+    [cache storeImageDataToDisk:[NSData dataWithContentsOfFile:[self testJPEGPath]] forKey:key];
+    SDWebImageContext *context = @{SDWebImageContextImageThumbnailPixelSize : @(CGSizeMake(50, 50))};
+
+    // The first query decodes from data and keeps the bitmap
+    UIImage *decodedImage = [cache imageFromDiskCacheForKey:key options:0 context:context];
+    expect(decodedImage).notTo.beNil();
+    expect(cache.decodedDiskCache.totalCount).equal(1);
+
+    // The next query returns the mapped bitmap with the same pixel size
+    UIImage *mappedImage = [cache imageFromDiskCacheForKey:key options:0 context:context];
+    expect(mappedImage).notTo.beNil();
+    expect(mappedImage.sd_isDecoded).beTruthy();
+    expect(mappedImage.sd_isThumbnail).beTruthy();
+    expect(CGImageGetWidth(mappedImage.CGImage)).equal(CGImageGetWidth(decodedImage.CGImage));
+    expect(CGImageGetHeight(mappedImage.CGImage)).equal(CGImageGetHeight(decodedImage.CGImage));
+    expect(CGImageGetBitmapInfo(mappedImage.CGImage) & kCGBitmapByteOrderMask).equal(kCGBitmapByteOrder32Little);
+
+    // Different pixel size is a different entry
+    [cache imageFromDiskCacheForKey:key options:0 context:@{SDWebImageContextImageThumbnailPixelSize : @(CGSizeMake(20, 20))}];
+    expect(cache.decodedDiskCache.totalCount).equal(2);
+
+    // New data invalidates the stale bitmaps
+    [cache storeImageDataToDisk:[NSData dataWithContentsOfFile:[self testPNGPath]] forKey:key];
+    expect(cache.decodedDiskCache.totalCount).equal(0);
+    // The coalesced index is flushed by `removeExpiredImages`, the removed bitmaps are not revived after relaunch
+    [cache.decodedDiskCache removeExpiredImages];
+    SDDecodedImageDiskCache *reloadedCache = [[SDDecodedImageDiskCache alloc] initWithCachePath:[cache.diskCachePath stringByAppendingString:@".decoded"] config:config];
+    expect(reloadedCache.totalCount).equal(0);
+
+    // The data evicted by the disk cache itself invalidates the bitmap as well
+    expect([cache imageFromDiskCacheForKey:key options:0 context:context]).notTo.beNil();
+    expect(cache.decodedDiskCache.totalCount).equal(1);
+    [cache.diskCache removeDataForKey:key];
+    expect([cache imageFromDiskCacheForKey:key options:0 context:context]).beNil();
+    expect(cache.decodedDiskCache.totalCount).equal(0);
+    [cache.decodedDiskCache removeAllImages];
+    expect(cache.decodedDiskCache.totalSize).equal(0);
+    [cache removeImageFromDiskForKey:key];
+}
+
+- (void)test62ArchiveCacheServesBundledImages {
+    NSString *archivePath = [[self userCacheDirectory] stringByAppendingPathComponent:@"TestImageArchive.sdarchive"];
+    NSString *jpegKey = @"https://example.com/onboarding.jpg";
+    NSString *pngKey = @"https://example.com/avatar.png";
+    NSData *jpegData = [NSData dataWithContentsOfFile:[self testJPEGPath]];
+    NSData *pngData = [NSData dataWithContentsOfFile:[self testPNGPath]];
+    [self writeImageArchiveToPath:archivePath entries:@{jpegKey : jpegData, pngKey : pngData}];
+
+    SDImageArchiveCache *archiveCache = [[SDImageArchiveCache alloc] initWithArchivePath:archivePath];
+    expect(archiveCache).notTo.beNil();
+    expect(archiveCache.entryCount).equal(2);
+    expect([archiveCache dataForKey:jpegKey]).equal(jpegData);
+    expect([archiveCache dataForKey:pngKey]).equal(pngData);
+    expect([archiveCache containsDataForKey:@"https://example.com/missing.png"]).beFalsy();
+    // Corrupted archive is rejected
+    expect([[SDImageArchiveCache alloc] initWithArchivePath:[self testPNGPath]]).beNil();
+
+    // The archive is below the regular cache in the chain
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Archive cache query in caches manager"];
+    SDImageCache *imageCache = [[SDImageCache alloc] initWithNamespace:@"ArchiveCacheChain"];
+    SDImageCachesManager *cachesManager = [SDImageCachesManager new];
+    cachesManager.caches = @[archiveCache, imageCache];
+    [cachesManager queryImageForKey:jpegKey options:0 context:nil cacheType:SDImageCacheTypeAll completion:^(UIImage * _Nullable image, NSData * _Nullable data, SDImageCacheType cacheType) {
+        expect(image).notTo.beNil();
+        expect(data).equal(jpegData);
+        expect(cacheType).equal(SDImageCacheTypeDisk);
+        // Read-only, the store does not change the archive
+        [archiveCache storeImage:nil imageData:pngData forKey:jpegKey cacheType:SDImageCacheTypeDisk completion:^{
+            expect([archiveCache dataForKey:jpegKey]).equal(jpegData);
+            [[NSFileManager defaultManager] removeItemAtPath:archivePath error:nil];
+            [expectation fulfill];
+        }];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)test63DiskCacheGDSFEvictionKeepsSmallReusedData {
+    // Replay the trace: each round requests one of 20 small avatars and one large one-off hero image
+    NSMutableString *trace = [NSMutableString stringWithString:@"# key size fetchCost\n"];
+    for (NSUInteger round = 0; round < 200; round++) {
+        [trace appendFormat:@"https://example.com/avatar/%lu.jpg 5000 0.1\n", (unsigned long)(round % 20)];
+        [trace appendFormat:@"https://example.com/hero/%lu.jpg 600000\n", (unsigned long)round];
+    }
+    NSString *tracePath = [[self userCacheDirectory] stringByAppendingPathComponent:@"EvictionTrace.txt"];
+    [trace writeToFile:tracePath atomically:YES encoding:NSUTF8StringEncoding error:nil];
+    SDDiskCacheEvictionReplay *lruReplay = [[SDDiskCacheEvictionReplay alloc] initWithPolicy:[SDDiskCacheLRUEvictionPolicy new] capacity:1000000];
+    SDDiskCacheEvictionReplay *gdsfReplay = [[SDDiskCacheEvictionReplay alloc] initWithPolicy:[SDDiskCacheGDSFEvictionPolicy new] capacity:1000000];
+    expect([lruReplay replayTraceAtPath:tracePath]).beTruthy();
+    expect([gdsfReplay replayTraceAtPath:tracePath]).beTruthy();
+    [[NSFileManager defaultManager] removeItemAtPath:tracePath error:nil];
+    expect(gdsfReplay.requestCount).equal(400);
+    expect(lruReplay.requestHitRatio).equal(0);
+    expect(gdsfReplay.requestHitRatio).beGreaterThan(0.4);
+    expect(gdsfReplay.byteHitRatio).beGreaterThan(lruReplay.byteHitRatio);
+    
+    // The small data reused often is kept, the large new data is evicted first
+    NSString *cachePath = [[self userCacheDirectory] stringByAppendingPathComponent:@"GDSFDisk"];
+    SDImageCacheConfig *config = [SDImageCacheConfig new];
+    config.maxDiskSize = 300 * 1024;
+    SDDiskCacheGDSFEvictionPolicy *policy = [SDDiskCacheGDSFEvictionPolicy new];
+    config.diskEvictionPolicy = policy;
+    SDDiskCache *diskCache = [[SDDiskCache alloc] initWithCachePath:cachePath config:config];
+    [diskCache removeAllData];
+    NSData *smallData = [NSMutableData dataWithLength:4 * 1024];
+    NSData *largeData = [NSMutableData dataWithLength:400 * 1024];
+    [diskCache setData:smallData forKey:@"small"];
+    [diskCache setFetchCost:0.2 forKey:@"small"];
+    expect([diskCache dataForKey:@"small"]).equal(smallData);
+    expect([diskCache dataForKey:@"small"]).equal(smallData);
+    [diskCache setData:largeData forKey:@"large"];
+    [diskCache removeExpiredData];
+    expect([diskCache containsDataForKey:@"small"]).beTruthy();
+    expect([diskCache containsDataForKey:@"large"]).beFalsy();
+    expect(policy.inflation).beGreaterThan(0);
+    // The aging value is restored by the new cache
+    SDDiskCacheGDSFEvictionPolicy *restoredPolicy = [SDDiskCacheGDSFEvictionPolicy new];
+    config.diskEvictionPolicy = restoredPolicy;
+    SDDiskCache *restoredDiskCache = [[SDDiskCache alloc] initWithCachePath:cachePath config:config];
+    expect(restoredPolicy.inflation).equal(policy.inflation);
+    [restoredDiskCache removeAllData];
+}
+
+- (void)test64DiskCacheRespectsHTTPCacheExpiration {
+    SDImageCacheConfig *config = [SDImageCacheConfig new];
+    config.shouldRespectHTTPCacheExpiration = YES;
+    SDImageCache *cache = [[SDImageCache alloc] initWithNamespace:@"HTTPCacheExpiration" diskCacheDirectory:[self userCacheDirectory] config:config];
+    [cache clearDiskOnCompletion:nil];
+    NSData *imageData = [NSData dataWithContentsOfFile:[self testPNGPath]];
+    [cache storeImage:nil imageData:imageData forKey:@"expired" options:0 context:@{SDWebImageContextImageCacheExpirationDate : [NSDate dateWithTimeIntervalSinceNow:-1]} cacheType:SDImageCacheTypeDisk completion:nil];
+    [cache storeImage:nil imageData:imageData forKey:@"immutable" options:0 context:@{SDWebImageContextImageCacheExpirationDate : [NSDate distantFuture]} cacheType:SDImageCacheTypeDisk completion:nil];
+    [cache storeImage:nil imageData:imageData forKey:@"default" options:0 context:nil cacheType:SDImageCacheTypeDisk completion:nil];
+    // Sync with the io queue
+    expect([cache diskImageDataExistsWithKey:@"default"]).beTruthy();
+    // The expired data is treated as not in cache, to download again
+    expect([cache diskImageDataExistsWithKey:@"expired"]).beFalsy();
+    expect([cache diskImageDataForKey:@"immutable"]).equal(imageData);
+    // The immutable data is kept beyond maxDiskAge, the data without caching headers still uses maxDiskAge
+    cache.config.maxDiskAge = 0;
+    [cache.diskCache removeExpiredData];
+    expect([cache diskImageDataExistsWithKey:@"immutable"]).beTruthy();
+    expect([cache diskImageDataExistsWithKey:@"default"]).beFalsy();
+    [cache clearDiskOnCompletion:nil];
+}
+
+- (void)test65DiskBudgetEvictsIdleCacheOverGuarantee {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Disk budget evicts the idle cache"];
+    SDImageCache *feedCache = [[SDImageCache alloc] initWithNamespace:@"BudgetFeed" diskCacheDirectory:[self userCacheDirectory]];
+    SDImageCache *avatarCache = [[SDImageCache alloc] initWithNamespace:@"BudgetAvatar" diskCacheDirectory:[self userCacheDirectory]];
+    [feedCache clearDiskOnCompletion:nil];
+    [avatarCache clearDiskOnCompletion:nil];
+    SDImageCacheDiskBudget *budget = [[SDImageCacheDiskBudget alloc] initWithTotalSize:100 * 1024];
+    [budget addCache:feedCache weight:1];
+    [budget addCache:avatarCache weight:1];
+    expect(feedCache.diskBudget).equal(budget);
+    expect([budget guaranteedSizeForCache:feedCache]).equal(25 * 1024);
+    
+    NSData *data = [NSMutableData dataWithLength:15 * 1024];
+    for (NSUInteger i = 0; i < 4; i++) {
+        [feedCache storeImageDataToDisk:data forKey:[NSString stringWithFormat:@"feed%lu", (unsigned long)i]];
+    }
+    for (NSUInteger i = 0; i < 2; i++) {
+        [avatarCache storeImageDataToDisk:data forKey:[NSString stringWithFormat:@"avatar%lu", (unsigned long)i]];
+    }
+    // The avatars are reused, the feed images are idle
+    for (NSUInteger i = 0; i < 3; i++) {
+        expect([avatarCache diskImageDataForKey:@"avatar0"]).equal(data);
+    }
+    expect([budget usedSizeForCache:feedCache]).equal(60 * 1024);
+    expect([budget usedSizeForCache:avatarCache]).equal(30 * 1024);
+    expect(budget.nextCacheToEvict).equal(feedCache);
+    
+    // Exceed the budget, the feed cache evicts instead of the avatar cache
+    [avatarCache storeImageDataToDisk:data forKey:@"avatar2"];
+    [feedCache calculateSizeWithCompletionBlock:^(NSUInteger fileCount, NSUInteger totalSize) {
+        expect([budget usedSizeForCache:avatarCache]).equal(45 * 1024);
+        expect([budget usedSizeForCache:feedCache]).beLessThan(60 * 1024);
+        expect([budget usedSizeForCache:feedCache]).beGreaterThanOrEqualTo(25 * 1024);
+        expect([budget usedSizeForCache:feedCache]).equal(totalSize);
+        expect(budget.usedSize).beLessThanOrEqualTo(budget.totalSize);
+        [budget removeCache:feedCache];
+        [budget removeCache:avatarCache];
+        expect(feedCache.diskBudget).beNil();
+        [feedCache clearDiskOnCompletion:nil];
+        [avatarCache clearDiskOnCompletion:nil];
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)test66ContentAddressedDiskCacheExpirationAndFitSize {
+    SDImageCacheConfig *config = [SDImageCacheConfig new];
+    config.shouldRespectHTTPCacheExpiration = YES;
+    NSString *cachePath = [[self userCacheDirectory] stringByAppendingPathComponent:@"TestContentAddressedFitSize"];
+    SDContentAddressedDiskCache *diskCache = [[SDContentAddressedDiskCache alloc] initWithCachePath:cachePath config:config];
+    [diskCache removeAllData];
+    NSData *data = [NSData dataWithContentsOfFile:[self testJPEGPath]];
+    NSData *otherData = [NSData dataWithContentsOfFile:[self testPNGPath]];
+
+    // The expiration is per key, the shared content is kept for other keys
+    [diskCache setData:data forKey:@"expired"];
+    [diskCache setData:data forKey:@"shared"];
+    [diskCache setExpirationDate:[NSDate dateWithTimeIntervalSinceNow:-1] forKey:@"expired"];
+    expect([diskCache containsDataForKey:@"expired"]).beFalsy();
+    expect([diskCache dataForKey:@"shared"]).equal(data);
+    expect([diskCache referenceCountForKey:@"shared"]).equal(1);
+
+    // Fit size removes keys until the shared content is released
+    [diskCache setData:otherData forKey:@"other"];
+    [diskCache setFetchCost:1 forKey:@"other"];
+    NSUInteger allocatedSize = diskCache.totalAllocatedSize;
+    expect(allocatedSize).beGreaterThan(0);
+    [diskCache removeDataToFitSize:allocatedSize - 1];
+    expect(diskCache.totalAllocatedSize).beLessThan(allocatedSize);
+    expect(diskCache.totalCount).equal(1);
+    [diskCache removeDataToFitSize:0];
+    expect(diskCache.totalCount).equal(0);
+    expect(diskCache.totalAllocatedSize).equal(0);
+}
+
+- (void)test67ContentAddressedDiskCacheGDSFEvictionKeepsSmallReusedData {
+    NSString *cachePath = [[self userCacheDirectory] stringByAppendingPathComponent:@"TestContentAddressedGDSF"];
+    SDImageCacheConfig *config = [SDImageCacheConfig new];
+    config.maxDiskSize = 300 * 1024;
+    SDDiskCacheGDSFEvictionPolicy *policy = [SDDiskCacheGDSFEvictionPolicy new];
+    config.diskEvictionPolicy = policy;
+    SDContentAddressedDiskCache *diskCache = [[SDContentAddressedDiskCache alloc] initWithCachePath:cachePath config:config];
+    [diskCache removeAllData];
+    NSMutableData *smallData = [NSMutableData dataWithLength:4 * 1024];
+    NSMutableData *largeData = [NSMutableData dataWithLength:400 * 1024];
+    // Different content, else the data is deduplicated
+    ((uint8_t *)largeData.mutableBytes)[0] = 1;
+    [diskCache setData:smallData forKey:@"small"];
+    [diskCache setFetchCost:0.2 forKey:@"small"];
+    // The access count is persisted on the key file, the reused small data is kept
+    expect([diskCache dataForKey:@"small"]).equal(smallData);
+    expect([diskCache dataForKey:@"small"]).equal(smallData);
+    [diskCache setData:largeData forKey:@"large"];
+    [diskCache removeExpiredData];
+    expect([diskCache containsDataForKey:@"small"]).beTruthy();
+    expect([diskCache containsDataForKey:@"large"]).beFalsy();
+    expect(policy.inflation).beGreaterThan(0);
+    // The aging value is restored by the new cache
+    SDDiskCacheGDSFEvictionPolicy *restoredPolicy = [SDDiskCacheGDSFEvictionPolicy new];
+    config.diskEvictionPolicy = restoredPolicy;
+    SDContentAddressedDiskCache *restoredDiskCache = [[SDContentAddressedDiskCache alloc] initWithCachePath:cachePath config:config];
+    expect(restoredPolicy.inflation).equal(policy.inflation);
+    [restoredDiskCache removeAllData];
+}
+
+- (void)test68DiskBudgetCountsAndTrimsDecodedDiskCache {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Disk budget trims the decoded bitmaps"];
+    SDImageCacheConfig *config = [SDImageCacheConfig new];
+    config.maxDecodedDiskSize = 1024 * 1024;
+    config.shouldCacheImagesInMemory = NO;
+    SDImageCache *cache = [[SDImageCache alloc] initWithNamespace:@"BudgetDecoded" diskCacheDirectory:[self userCacheDirectory] config:config];
+    [cache clearDiskOnCompletion:nil];
+    SDImageCacheDiskBudget *budget = [[SDImageCacheDiskBudget alloc] initWithTotalSize:100 * 1024 * 1024];
+    [budget addCache:cache weight:1];
+    NSString *key = @"TestBudgetDecodedKey";
+    [cache storeImageDataToDisk:[NSData dataWithContentsOfFile:[self testJPEGPath]] forKey:key];
+    NSUInteger dataUsedSize = [budget usedSizeForCache:cache];
+    expect(dataUsedSize).beGreaterThan(0);
+
+    // The mapped chunk of decoded bitmap is counted as well
+    [cache imageFromDiskCacheForKey:key options:0 context:@{SDWebImageContextImageThumbnailPixelSize : @(CGSizeMake(50, 50))}];
+    expect(cache.decodedDiskCache.totalSize).beGreaterThan(0);
+    expect([budget usedSizeForCache:cache]).equal(dataUsedSize + cache.decodedDiskCache.totalSize);
+
+    // The decoded bitmaps are removed first to fit
+    [cache removeDiskDataToFitSize:dataUsedSize completion:^{
+        expect(cache.decodedDiskCache.totalSize).equal(0);
+        expect(cache.decodedDiskCache.totalCount).equal(0);
+        expect([cache diskImageDataExistsWithKey:key]).beTruthy();
+        expect([budget usedSizeForCache:cache]).equal(dataUsedSize);
+        [budget removeCache:cache];
+        [cache clearDiskOnCompletion:nil];
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+}
+
 #pragma mark Helper methods
 
+// The same layout as `Scripts/build-image-archive.py`
+- (void)writeImageArchiveToPath:(NSString *)path entries:(NSDictionary<NSString *, NSData *> *)entries {
+    uint64_t bucketCount = 1;
+    while (bucketCount < entries.count * 2) {
+        bucketCount *= 2;
+    }
+    uint64_t tableOffset = 64;
+    uint64_t recordsOffset = tableOffset + bucketCount * 32;
+    NSMutableData *table = [NSMutableData dataWithLength:(NSUInteger)(bucketCount * 32)];
+    NSMutableData *records = [NSMutableData data];
+    [entries enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull key, NSData * _Nonnull data, BOOL * _Nonnull stop) {
+        NSData *keyData = [key dataUsingEncoding:NSUTF8StringEncoding];
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        const uint8_t *keyBytes = keyData.bytes;
+        for (NSUInteger i = 0; i < keyData.length; i++) {
+            hash ^= keyBytes[i];
+            hash *= 0x100000001b3ULL;
+        }
+        uint64_t index = hash & (bucketCount - 1);
+        uint8_t *slot = (uint8_t *)table.mutableBytes + index * 32;
+        while (OSReadLittleInt64(slot, 8) != 0) {
+            index = (index + 1) & (bucketCount - 1);
+            slot = (uint8_t *)table.mutableBytes + index * 32;
+        }
+        OSWriteLittleInt64(slot, 0, hash);
+        OSWriteLittleInt64(slot, 8, recordsOffset + records.length);
+        OSWriteLittleInt32(slot, 16, (uint32_t)keyData.length);
+        OSWriteLittleInt64(slot, 24, data.length);
+        [records appendData:keyData];
+        [records appendData:data];
+    }];
+    NSMutableData *archive = [NSMutableData dataWithLength:64];
+    uint8_t *header = archive.mutableBytes;
+    memcpy(header, "SDIMGARC", 8);
+    OSWriteLittleInt32(header, 8, 1);
+    OSWriteLittleInt64(header, 16, entries.count);
+    OSWriteLittleInt64(header, 24, bucketCount);
+    OSWriteLittleInt64(header, 32, tableOffset);
+    [archive appendData:table];
+    [archive appendData:records];
+    [archive writeToFile:path atomically:YES];
+}
+
 - (UIImage *)testJPEGImage {
     static UIImage *reusableImage = nil;
     if (!reusableImage) {
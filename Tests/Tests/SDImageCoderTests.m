@@ -8,6 +8,7 @@
  */
 
 #import "SDTestCase.h"
+#import "SDImageFramePool.h"
 #import "UIColor+SDHexString.h"
 
 @interface SDWebImageDecoderTests : SDTestCase
@@ -761,8 +762,455 @@
     }
 }
 
+- (void)test35ThatEncodeWithMaxFileSizeSearchWorks {
+    NSString *testImagePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"TestImageLarge" ofType:@"jpg"];
+    UIImage *image = [[UIImage alloc] initWithContentsOfFile:testImagePath];
+    NSUInteger limitFileSize = 500 * 1024; // 500KB
+    NSUInteger attempts = 0;
+    double bytesPerPixel = 0;
+    NSData *limitEncodedData = [SDImageIOCoder.sharedCoder encodedDataWithImage:image format:SDImageFormatJPEG options:@{SDImageCoderEncodeMaxFileSize : @(limitFileSize), SDImageCoderEncodeMaxFileSizeTolerance : @(0.2)} attempts:&attempts bytesPerPixel:&bytesPerPixel];
+    expect(limitEncodedData).notTo.beNil();
+    expect(limitEncodedData.length).beLessThanOrEqualTo(limitFileSize);
+    expect(limitEncodedData.length).beGreaterThanOrEqualTo(limitFileSize * 0.8);
+    expect(attempts).beGreaterThan(0);
+    expect(bytesPerPixel).beGreaterThan(0);
+    
+    // Even the lowest quality is too large, should downscale
+    NSUInteger tinyFileSize = 10 * 1024; // 10KB
+    NSData *tinyEncodedData = [SDImageIOCoder.sharedCoder encodedDataWithImage:image format:SDImageFormatJPEG options:@{SDImageCoderEncodeMaxFileSize : @(tinyFileSize)} attempts:&attempts bytesPerPixel:&bytesPerPixel];
+    expect(tinyEncodedData.length).beLessThanOrEqualTo(tinyFileSize);
+    UIImage *tinyImage = [UIImage sd_imageWithData:tinyEncodedData];
+    expect(tinyImage.size.width).beLessThan(image.size.width);
+    
+    // Lossless format can only downscale
+    NSData *PNGEncodedData = [SDImageIOCoder.sharedCoder encodedDataWithImage:image format:SDImageFormatPNG options:@{SDImageCoderEncodeMaxFileSize : @(limitFileSize)} attempts:&attempts bytesPerPixel:&bytesPerPixel];
+    expect(PNGEncodedData.length).beLessThanOrEqualTo(limitFileSize);
+}
+
+- (void)test36ThatDCTScaleCalculationWorks {
+    // DCT scaling calculation
+    CGSize imageSize = CGSizeMake(4000, 3000);
+    expect([SDImageCoderHelper DCTScaleDenominatorWithImageSize:imageSize thumbnailSize:CGSizeZero preserveAspectRatio:YES]).equal(1);
+    expect([SDImageCoderHelper DCTScaleDenominatorWithImageSize:imageSize thumbnailSize:CGSizeMake(2000, 2000) preserveAspectRatio:YES]).equal(2);
+    expect([SDImageCoderHelper DCTScaleDenominatorWithImageSize:imageSize thumbnailSize:CGSizeMake(500, 500) preserveAspectRatio:YES]).equal(8);
+    expect([SDImageCoderHelper DCTScaleDenominatorWithImageSize:imageSize thumbnailSize:CGSizeMake(500, 500) preserveAspectRatio:NO]).equal(4);
+    expect([SDImageCoderHelper DCTScaleDenominatorWithImageSize:imageSize thumbnailSize:CGSizeMake(3999, 3000) preserveAspectRatio:NO]).equal(1);
+}
+
+#if __has_include(<SDWebImage/SDImageTurboJPEGCoder.h>)
+- (void)test37ThatTurboJPEGCoderMatchesImageIO {
+    [self verifyReferenceCoder:SDImageTurboJPEGCoder.sharedCoder withImageName:@"TestImageLarge" extension:@"jpg" tolerance:8];
+}
+#endif
+
+#if __has_include(<SDWebImage/SDImageSPNGCoder.h>)
+- (void)test38ThatSPNGCoderMatchesImageIO {
+    // PNG is lossless, the pixels should be the same
+    [self verifyReferenceCoder:SDImageSPNGCoder.sharedCoder withImageName:@"TestImageLarge" extension:@"png" tolerance:1];
+}
+#endif
+
+#if __has_include(<SDWebImage/SDImageGIFLibCoder.h>)
+- (void)test39ThatGIFLibCoderMatchesImageIO {
+    [self verifyReferenceCoder:SDImageGIFLibCoder.sharedCoder withImageName:@"TestImage" extension:@"gif" tolerance:1];
+    // Animated GIF, the frames are composited with the disposal method
+    NSString *testImagePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"TestImage" ofType:@"gif"];
+    NSData *data = [NSData dataWithContentsOfFile:testImagePath];
+    SDImageGIFLibCoder *coder = [[SDImageGIFLibCoder alloc] initWithAnimatedImageData:data options:nil];
+    SDImageGIFCoder *referenceCoder = [[SDImageGIFCoder alloc] initWithAnimatedImageData:data options:nil];
+    expect(coder.animatedImageFrameCount).equal(referenceCoder.animatedImageFrameCount);
+    expect(coder.animatedImageLoopCount).equal(referenceCoder.animatedImageLoopCount);
+    expect([coder animatedImageDurationAtIndex:1]).beCloseToWithin([referenceCoder animatedImageDurationAtIndex:1], 0.01);
+    // Seek backward
+    UIImage *frame = [coder animatedImageFrameAtIndex:4];
+    expect([self maxColorDifferenceBetweenImage:frame referenceImage:[referenceCoder animatedImageFrameAtIndex:4]]).beLessThanOrEqualTo(1);
+    frame = [coder animatedImageFrameAtIndex:0];
+    expect([self maxColorDifferenceBetweenImage:frame referenceImage:[referenceCoder animatedImageFrameAtIndex:0]]).beLessThanOrEqualTo(1);
+}
+#endif
+
+#if __has_include(<SDWebImage/SDImageLibWebPCoder.h>)
+- (void)test40ThatLibWebPCoderMatchesImageIO {
+    if (@available(iOS 14, tvOS 14, macOS 11, watchOS 7, *)) {
+        // Animated WebP, compare the frames with Image/IO
+        NSString *webpPath = [[NSBundle bundleForClass:[self class]] pathForResource:@"TestAnimatedImageMemory" ofType:@"webp"];
+        NSData *webpData = [NSData dataWithContentsOfFile:webpPath];
+        expect([SDImageLibWebPCoder.sharedCoder canDecodeFromData:webpData]).beTruthy();
+        SDImageLibWebPCoder *coder = [[SDImageLibWebPCoder alloc] initWithAnimatedImageData:webpData options:@{SDImageCoderDecodeThreadCount : @(0)}];
+        SDImageAWebPCoder *referenceCoder = [[SDImageAWebPCoder alloc] initWithAnimatedImageData:webpData options:nil];
+        NSUInteger frameCount = coder.animatedImageFrameCount;
+        expect(frameCount).beGreaterThan(1);
+        expect(frameCount).equal(referenceCoder.animatedImageFrameCount);
+        expect(coder.animatedImageLoopCount).equal(referenceCoder.animatedImageLoopCount);
+        // The frame fetching of frame pool is sequential, and seek backward when loop
+        for (NSUInteger i = 0; i < frameCount; i++) {
+            @autoreleasepool {
+                UIImage *frame = [coder animatedImageFrameAtIndex:i];
+                expect(frame.size).equal([referenceCoder animatedImageFrameAtIndex:i].size);
+                expect([self maxColorDifferenceBetweenImage:frame referenceImage:[referenceCoder animatedImageFrameAtIndex:i]]).beLessThanOrEqualTo(2);
+                expect([coder animatedImageDurationAtIndex:i]).beCloseToWithin([referenceCoder animatedImageDurationAtIndex:i], 0.01);
+            }
+        }
+        // Seek backward
+        UIImage *firstFrame = [coder animatedImageFrameAtIndex:0];
+        expect([self maxColorDifferenceBetweenImage:firstFrame referenceImage:[referenceCoder animatedImageFrameAtIndex:0]]).beLessThanOrEqualTo(2);
+    }
+    
+    // Static WebP, the multi-threaded and concurrent decoding produce the same pixels
+    NSString *staticWebPPath = [[NSBundle bundleForClass:[self class]] pathForResource:@"TestImageStatic" ofType:@"webp"];
+    NSData *staticWebPData = [NSData dataWithContentsOfFile:staticWebPPath];
+    [self verifyConcurrentDecodingWithCoder:SDImageLibWebPCoder.sharedCoder data:staticWebPData];
+    
+    // Scaling during decoding for static WebP
+    UIImage *thumbnailImage = [SDImageLibWebPCoder.sharedCoder decodedImageWithData:staticWebPData options:@{SDImageCoderDecodeThumbnailPixelSize : @(CGSizeMake(50, 50))}];
+    expect(MAX(thumbnailImage.size.width, thumbnailImage.size.height)).equal(50);
+}
+#endif
+
+#if __has_include(<SDWebImage/SDImageLibAVIFCoder.h>)
+- (void)test41ThatLibAVIFCoderMatchesImageIO {
+    NSString *avifPath = [[NSBundle bundleForClass:[self class]] pathForResource:@"TestHDR" ofType:@"avif"];
+    NSData *avifData = [NSData dataWithContentsOfFile:avifPath];
+    expect([SDImageLibAVIFCoder.sharedCoder canDecodeFromData:avifData]).beTruthy();
+    SDImageLibAVIFCoder *coder = [[SDImageLibAVIFCoder alloc] initWithAnimatedImageData:avifData options:nil];
+    expect(coder.animatedImageFrameCount).equal(1);
+    UIImage *image = [SDImageLibAVIFCoder.sharedCoder decodedImageWithData:avifData options:nil];
+    expect(image).notTo.beNil();
+    expect(image.sd_imageFormat).equal(SDImageFormatAVIF);
+    // The HDR image is tone mapped differently by Image/IO, compare the size only
+    UIImage *referenceImage = [SDImageIOCoder.sharedCoder decodedImageWithData:avifData options:nil];
+    if (referenceImage) {
+        expect(image.size).equal(referenceImage.size);
+    }
+    [self verifyConcurrentDecodingWithCoder:SDImageLibAVIFCoder.sharedCoder data:avifData];
+}
+#endif
+
+- (void)test42ThatJPEGThumbnailUseSubsampleDecoding {
+    NSString *testImagePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"TestImageLarge" ofType:@"jpg"];
+    NSData *testImageData = [NSData dataWithContentsOfFile:testImagePath];
+    // 5250x3450, use 1/8 IDCT then resample
+    expect([SDImageCoderHelper DCTScaleDenominatorWithImageSize:CGSizeMake(5250, 3450) thumbnailSize:CGSizeMake(400, 300) preserveAspectRatio:YES]).equal(8);
+    UIImage *image = [SDImageIOCoder.sharedCoder decodedImageWithData:testImageData options:@{SDImageCoderDecodeThumbnailPixelSize : @(CGSizeMake(400, 300))}];
+    expect(image.size).equal(CGSizeMake(400, 263));
+    expect(image.sd_isDecoded).beTruthy();
+    // Stretch, use 1/4 IDCT
+    expect([SDImageCoderHelper DCTScaleDenominatorWithImageSize:CGSizeMake(5250, 3450) thumbnailSize:CGSizeMake(1000, 500) preserveAspectRatio:NO]).equal(4);
+    UIImage *stretchImage = [SDImageIOCoder.sharedCoder decodedImageWithData:testImageData options:@{SDImageCoderDecodeThumbnailPixelSize : @(CGSizeMake(1000, 500)), SDImageCoderDecodePreserveAspectRatio : @(NO)}];
+    expect(stretchImage.size).equal(CGSizeMake(1000, 500));
+    // Larger than half size, use the full size IDCT
+    UIImage *largeImage = [SDImageIOCoder.sharedCoder decodedImageWithData:testImageData options:@{SDImageCoderDecodeThumbnailPixelSize : @(CGSizeMake(4000, 4000))}];
+    expect(largeImage.size).equal(CGSizeMake(4000, 2629));
+}
+
+- (void)test43ThatRegionDecodeWorks {
+    NSString *testImagePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"TestImageLarge" ofType:@"jpg"];
+    NSData *testImageData = [NSData dataWithContentsOfFile:testImagePath];
+    CGRect cropRect = CGRectMake(1000, 500, 800, 600);
+    UIImage *fullImage = [SDImageIOCoder.sharedCoder decodedImageWithData:testImageData options:nil];
+    UIImage *croppedImage = [fullImage sd_croppedImageWithRect:cropRect];
+    UIImage *regionImage = [SDImageIOCoder.sharedCoder decodedImageWithData:testImageData options:@{SDImageCoderDecodeCropRect : @(cropRect)}];
+    expect(regionImage.sd_isRegionDecoded).beTruthy();
+    expect(regionImage.size).equal(CGSizeMake(800, 600));
+    // Same pixels as decoding the full image and cropping
+    expect([[regionImage sd_colorAtPoint:CGPointMake(400, 300)] sd_hexString]).equal([[croppedImage sd_colorAtPoint:CGPointMake(400, 300)] sd_hexString]);
+    
+    // Use reduced-size IDCT and stretch to the scaled size
+    UIImage *scaledRegionImage = [SDImageIOCoder.sharedCoder decodedImageWithData:testImageData options:@{SDImageCoderDecodeCropRect : @(cropRect), SDImageCoderDecodeCropScaledPixelSize : @(CGSizeMake(100, 50))}];
+    expect(scaledRegionImage.sd_isRegionDecoded).beTruthy();
+    expect(scaledRegionImage.size).equal(CGSizeMake(100, 50));
+    
+    // Clipped to image bounds
+    UIImage *clippedImage = [SDImageIOCoder.sharedCoder decodedImageWithData:testImageData options:@{SDImageCoderDecodeCropRect : @(CGRectMake(5000, 3000, 1000, 1000))}];
+    expect(clippedImage.size).equal(CGSizeMake(250, 450));
+    
+    // Out of bounds, decode the full image
+    UIImage *outOfBoundsImage = [SDImageIOCoder.sharedCoder decodedImageWithData:testImageData options:@{SDImageCoderDecodeCropRect : @(CGRectMake(6000, 0, 100, 100))}];
+    expect(outOfBoundsImage.sd_isRegionDecoded).beFalsy();
+    expect(outOfBoundsImage.size).equal(fullImage.size);
+    
+    // Animated image ignore the region
+    NSData *gifData = [NSData dataWithContentsOfFile:[[NSBundle bundleForClass:[self class]] pathForResource:@"TestImage" ofType:@"gif"]];
+    UIImage *animatedImage = [SDImageGIFCoder.sharedCoder decodedImageWithData:gifData options:@{SDImageCoderDecodeCropRect : @(CGRectMake(0, 0, 10, 10))}];
+    expect(animatedImage.sd_isAnimated).beTruthy();
+    expect(animatedImage.sd_isRegionDecoded).beFalsy();
+}
+
+- (void)test44ThatImageAtlasPacksSmallImages {
+    NSData *testImageData = [NSData dataWithContentsOfFile:[[NSBundle bundleForClass:[self class]] pathForResource:@"TestImage" ofType:@"jpg"]];
+    UIImage *smallImage = [SDImageIOCoder.sharedCoder decodedImageWithData:testImageData options:@{SDImageCoderDecodeThumbnailPixelSize : @(CGSizeMake(30, 30))}];
+    UIImage *largeImage = [SDImageIOCoder.sharedCoder decodedImageWithData:testImageData options:nil];
+    SDImageAtlas *atlas = [[SDImageAtlas alloc] initWithPagePixelSize:CGSizeMake(64, 64) maxImagePixelSize:CGSizeMake(32, 32)];
+    expect([atlas packedImageWithImage:largeImage]).beNil();
+
+    @autoreleasepool {
+        UIImage *packedImage1 = [atlas packedImageWithImage:smallImage];
+        UIImage *packedImage2 = [atlas packedImageWithImage:smallImage];
+        expect(packedImage1).notTo.beNil();
+        expect(packedImage2).notTo.beNil();
+        expect(packedImage1.size).equal(smallImage.size);
+        expect(packedImage1.sd_isDecoded).beTruthy();
+        expect(packedImage1.sd_memoryCost).beLessThan(CGImageGetBytesPerRow(packedImage1.CGImage) * CGImageGetHeight(packedImage1.CGImage));
+        // The images share the page, and have the same pixels as the source
+        expect(atlas.pageCount).equal(1);
+        expect(atlas.imageCount).equal(2);
+        CGPoint point = CGPointMake(CGImageGetWidth(smallImage.CGImage) / 2, CGImageGetHeight(smallImage.CGImage) / 2);
+        expect([[packedImage2 sd_colorAtPoint:point] sd_hexString]).equal([[smallImage sd_colorAtPoint:point] sd_hexString]);
+        // The full page use another page
+        for (NSUInteger i = 0; i < 4; i++) {
+            expect([atlas packedImageWithImage:smallImage]).notTo.beNil();
+        }
+    }
+
+    // The space is freed with the released images, and the empty pages are released on next packing
+    expect(atlas.imageCount).equal(0);
+    UIImage *reusedImage = [atlas packedImageWithImage:smallImage];
+    expect(reusedImage).notTo.beNil();
+    expect(atlas.pageCount).equal(1);
+}
+
+#pragma mark - Performance
+
+// The reference coders against Image/IO, run the test with the Release configuration to compare the numbers
+
+- (void)test45ThatImageIOCoderJPEGDecodePerformance {
+    [self measureDecodingWithCoder:SDImageIOCoder.sharedCoder imageName:@"TestImageLarge" extension:@"jpg" options:nil];
+}
+
+- (void)test46ThatImageIOCoderJPEGHalfThumbnailDecodePerformance {
+    [self measureDCTScaledDecodingWithCoder:SDImageIOCoder.sharedCoder denominator:2];
+}
+
+- (void)test47ThatImageIOCoderJPEGQuarterThumbnailDecodePerformance {
+    [self measureDCTScaledDecodingWithCoder:SDImageIOCoder.sharedCoder denominator:4];
+}
+
+- (void)test48ThatImageIOCoderJPEGEighthThumbnailDecodePerformance {
+    [self measureDCTScaledDecodingWithCoder:SDImageIOCoder.sharedCoder denominator:8];
+}
+
+- (void)test49ThatImageIOCoderPNGDecodePerformance {
+    [self measureDecodingWithCoder:SDImageIOCoder.sharedCoder imageName:@"TestImage" extension:@"png" options:nil];
+}
+
+- (void)test50ThatImageIOCoderGIFDecodePerformance {
+    [self measureDecodingWithCoder:SDImageIOCoder.sharedCoder imageName:@"TestImage" extension:@"gif" options:@{SDImageCoderDecodeFirstFrameOnly : @(YES)}];
+}
+
+#if __has_include(<SDWebImage/SDImageTurboJPEGCoder.h>)
+- (void)test51ThatTurboJPEGCoderDecodePerformance {
+    [self measureDecodingWithCoder:SDImageTurboJPEGCoder.sharedCoder imageName:@"TestImageLarge" extension:@"jpg" options:nil];
+}
+
+- (void)test52ThatTurboJPEGCoderHalfThumbnailDecodePerformance {
+    [self measureDCTScaledDecodingWithCoder:SDImageTurboJPEGCoder.sharedCoder denominator:2];
+}
+
+- (void)test53ThatTurboJPEGCoderQuarterThumbnailDecodePerformance {
+    [self measureDCTScaledDecodingWithCoder:SDImageTurboJPEGCoder.sharedCoder denominator:4];
+}
+
+- (void)test54ThatTurboJPEGCoderEighthThumbnailDecodePerformance {
+    [self measureDCTScaledDecodingWithCoder:SDImageTurboJPEGCoder.sharedCoder denominator:8];
+}
+#endif
+
+#if __has_include(<SDWebImage/SDImageSPNGCoder.h>)
+- (void)test55ThatSPNGCoderDecodePerformance {
+    [self measureDecodingWithCoder:SDImageSPNGCoder.sharedCoder imageName:@"TestImage" extension:@"png" options:nil];
+}
+#endif
+
+#if __has_include(<SDWebImage/SDImageGIFLibCoder.h>)
+- (void)test56ThatGIFLibCoderDecodePerformance {
+    [self measureDecodingWithCoder:SDImageGIFLibCoder.sharedCoder imageName:@"TestImage" extension:@"gif" options:@{SDImageCoderDecodeFirstFrameOnly : @(YES)}];
+}
+#endif
+
+#if __has_include(<SDWebImage/SDImageLibWebPCoder.h>)
+- (void)test57ThatAWebPCoderAnimatedDecodePerformance {
+    if (@available(iOS 14, tvOS 14, macOS 11, watchOS 7, *)) {
+        [self measureDecodingWithCoder:SDImageAWebPCoder.sharedCoder imageName:@"TestAnimatedImageMemory" extension:@"webp" options:nil];
+    }
+}
+
+- (void)test58ThatLibWebPCoderSingleThreadAnimatedDecodePerformance {
+    [self measureDecodingWithCoder:SDImageLibWebPCoder.sharedCoder imageName:@"TestAnimatedImageMemory" extension:@"webp" options:@{SDImageCoderDecodeThreadCount : @(1)}];
+}
+
+- (void)test59ThatLibWebPCoderMultiThreadAnimatedDecodePerformance {
+    [self measureDecodingWithCoder:SDImageLibWebPCoder.sharedCoder imageName:@"TestAnimatedImageMemory" extension:@"webp" options:@{SDImageCoderDecodeThreadCount : @(0)}];
+}
+
+- (void)test60ThatAWebPCoderFramePoolFetchPerformance {
+    if (@available(iOS 14, tvOS 14, macOS 11, watchOS 7, *)) {
+        NSData *data = [NSData dataWithContentsOfFile:[[NSBundle bundleForClass:[self class]] pathForResource:@"TestAnimatedImageMemory" ofType:@"webp"]];
+        [self measureFramePoolFetchingWithCoder:[[SDImageAWebPCoder alloc] initWithAnimatedImageData:data options:nil]];
+    }
+}
+
+- (void)test61ThatLibWebPCoderSingleThreadFramePoolFetchPerformance {
+    NSData *data = [NSData dataWithContentsOfFile:[[NSBundle bundleForClass:[self class]] pathForResource:@"TestAnimatedImageMemory" ofType:@"webp"]];
+    [self measureFramePoolFetchingWithCoder:[[SDImageLibWebPCoder alloc] initWithAnimatedImageData:data options:@{SDImageCoderDecodeThreadCount : @(1)}]];
+}
+
+- (void)test62ThatLibWebPCoderMultiThreadFramePoolFetchPerformance {
+    NSData *data = [NSData dataWithContentsOfFile:[[NSBundle bundleForClass:[self class]] pathForResource:@"TestAnimatedImageMemory" ofType:@"webp"]];
+    [self measureFramePoolFetchingWithCoder:[[SDImageLibWebPCoder alloc] initWithAnimatedImageData:data options:@{SDImageCoderDecodeThreadCount : @(0)}]];
+}
+#endif
+
+#if __has_include(<SDWebImage/SDImageLibAVIFCoder.h>)
+// SDImageHEICCoder can not decode the AVIF container, measure it on the same HDR content in HEIC, and Image/IO AVIF through SDImageIOCoder
+- (void)test63ThatHEICCoderDecodePerformance {
+    [self measureDecodingWithCoder:SDImageHEICCoder.sharedCoder imageName:@"TestHDR" extension:@"heic" options:nil];
+}
+
+- (void)test64ThatImageIOCoderAVIFDecodePerformance {
+    NSData *data = [NSData dataWithContentsOfFile:[[NSBundle bundleForClass:[self class]] pathForResource:@"TestHDR" ofType:@"avif"]];
+    if (![SDImageIOCoder.sharedCoder decodedImageWithData:data options:nil]) {
+        // Image/IO AVIF is not available on this OS
+        return;
+    }
+    [self measureDecodingWithCoder:SDImageIOCoder.sharedCoder imageName:@"TestHDR" extension:@"avif" options:nil];
+}
+
+- (void)test65ThatLibAVIFCoderSingleThreadDecodePerformance {
+    [self measureDecodingWithCoder:SDImageLibAVIFCoder.sharedCoder imageName:@"TestHDR" extension:@"avif" options:@{SDImageCoderDecodeThreadCount : @(1)}];
+}
+
+- (void)test66ThatLibAVIFCoderMultiThreadDecodePerformance {
+    [self measureDecodingWithCoder:SDImageLibAVIFCoder.sharedCoder imageName:@"TestHDR" extension:@"avif" options:@{SDImageCoderDecodeThreadCount : @(0)}];
+}
+
+- (void)test67ThatHEICCoderFramePoolFetchPerformance {
+    NSData *data = [NSData dataWithContentsOfFile:[[NSBundle bundleForClass:[self class]] pathForResource:@"TestHDR" ofType:@"heic"]];
+    [self measureFramePoolFetchingWithCoder:[[SDImageHEICCoder alloc] initWithAnimatedImageData:data options:nil]];
+}
+
+- (void)test68ThatLibAVIFCoderSingleThreadFramePoolFetchPerformance {
+    NSData *data = [NSData dataWithContentsOfFile:[[NSBundle bundleForClass:[self class]] pathForResource:@"TestHDR" ofType:@"avif"]];
+    [self measureFramePoolFetchingWithCoder:[[SDImageLibAVIFCoder alloc] initWithAnimatedImageData:data options:@{SDImageCoderDecodeThreadCount : @(1)}]];
+}
+
+- (void)test69ThatLibAVIFCoderMultiThreadFramePoolFetchPerformance {
+    NSData *data = [NSData dataWithContentsOfFile:[[NSBundle bundleForClass:[self class]] pathForResource:@"TestHDR" ofType:@"avif"]];
+    [self measureFramePoolFetchingWithCoder:[[SDImageLibAVIFCoder alloc] initWithAnimatedImageData:data options:@{SDImageCoderDecodeThreadCount : @(0)}]];
+}
+#endif
+
 #pragma mark - Utils
 
+- (void)measureFramePoolFetchingWithCoder:(id<SDAnimatedImageCoder>)coder {
+    expect(coder).notTo.beNil();
+    NSUInteger frameCount = coder.animatedImageFrameCount;
+    expect(frameCount).beGreaterThan(0);
+    SDImageFramePool *framePool = [SDImageFramePool registerProvider:coder];
+    framePool.maxBufferCount = frameCount;
+    [self measureBlock:^{
+        [framePool removeAllFrames];
+        // Fetch each frame in the fetch queue as the player does, the next frame is requested after the current one is ready
+        for (NSUInteger i = 0; i < frameCount; i++) {
+            while (![framePool frameAtIndex:i]) {
+                [framePool prefetchFrameAtIndex:i];
+                usleep(100);
+            }
+        }
+    }];
+    [SDImageFramePool unregisterProvider:coder];
+}
+
+- (void)measureDecodingWithCoder:(id<SDImageCoder>)coder imageName:(NSString *)name extension:(NSString *)extension options:(SDImageCoderOptions *)options {
+    NSString *path = [[NSBundle bundleForClass:[self class]] pathForResource:name ofType:extension];
+    NSData *data = [NSData dataWithContentsOfFile:path];
+    // Disable the lazy decoding, else Image/IO only parse the header and the cost is moved to rendering
+    NSMutableDictionary *decodeOptions = [NSMutableDictionary dictionaryWithDictionary:options ?: @{}];
+    decodeOptions[SDImageCoderDecodeUseLazyDecoding] = @(NO);
+    SDImageCoderOptions *measureOptions = [decodeOptions copy];
+    expect([coder decodedImageWithData:data options:measureOptions]).notTo.beNil();
+    [self measureBlock:^{
+        @autoreleasepool {
+            [coder decodedImageWithData:data options:measureOptions];
+        }
+    }];
+}
+
+- (void)measureDCTScaledDecodingWithCoder:(id<SDImageCoder>)coder denominator:(NSUInteger)denominator {
+    // 5250x3450, the thumbnail size is exactly the reduced-size IDCT output
+    CGSize imageSize = CGSizeMake(5250, 3450);
+    CGSize thumbnailSize = CGSizeMake(ceil(imageSize.width / denominator), ceil(imageSize.height / denominator));
+    expect([SDImageCoderHelper DCTScaleDenominatorWithImageSize:imageSize thumbnailSize:thumbnailSize preserveAspectRatio:YES]).equal(denominator);
+    [self measureDecodingWithCoder:coder imageName:@"TestImageLarge" extension:@"jpg" options:@{SDImageCoderDecodeThumbnailPixelSize : @(thumbnailSize)}];
+}
+
+- (void)verifyReferenceCoder:(id<SDImageCoder>)coder withImageName:(NSString *)name extension:(NSString *)extension tolerance:(NSUInteger)tolerance {
+    NSString *testImagePath = [[NSBundle bundleForClass:[self class]] pathForResource:name ofType:extension];
+    NSData *data = [NSData dataWithContentsOfFile:testImagePath];
+    expect([coder canDecodeFromData:data]).beTruthy();
+    UIImage *referenceImage = [SDImageIOCoder.sharedCoder decodedImageWithData:data options:@{SDImageCoderDecodeFirstFrameOnly : @(YES)}];
+    UIImage *image = [coder decodedImageWithData:data options:@{SDImageCoderDecodeFirstFrameOnly : @(YES)}];
+    expect(image).notTo.beNil();
+    expect(image.size).equal(referenceImage.size);
+    expect(image.scale).equal(referenceImage.scale);
+    expect([self maxColorDifferenceBetweenImage:image referenceImage:referenceImage]).beLessThanOrEqualTo(tolerance);
+    
+    // Thumbnail, compare with the Image/IO thumbnail
+    NSDictionary *thumbnailOptions = @{SDImageCoderDecodeThumbnailPixelSize : @(CGSizeMake(100, 100))};
+    UIImage *thumbnailImage = [coder decodedImageWithData:data options:thumbnailOptions];
+    UIImage *referenceThumbnailImage = [SDImageIOCoder.sharedCoder decodedImageWithData:data options:thumbnailOptions];
+    expect(MAX(thumbnailImage.size.width, thumbnailImage.size.height)).beLessThanOrEqualTo(100);
+    expect(thumbnailImage.size.width).beCloseToWithin(referenceThumbnailImage.size.width, 1);
+    expect(thumbnailImage.size.height).beCloseToWithin(referenceThumbnailImage.size.height, 1);
+}
+
+- (void)verifyConcurrentDecodingWithCoder:(id<SDImageCoder>)coder data:(NSData *)data {
+    UIImage *singleThreadImage = [coder decodedImageWithData:data options:@{SDImageCoderDecodeThreadCount : @(1)}];
+    expect(singleThreadImage).notTo.beNil();
+    // Multi-threaded decoding
+    UIImage *multiThreadImage = [coder decodedImageWithData:data options:@{SDImageCoderDecodeThreadCount : @(0)}];
+    expect(multiThreadImage.size).equal(singleThreadImage.size);
+    expect([self maxColorDifferenceBetweenImage:multiThreadImage referenceImage:singleThreadImage]).equal(0);
+    // Concurrent decoding with the shared coder
+    NSUInteger concurrentCount = 8;
+    NSMutableArray<UIImage *> *images = [NSMutableArray arrayWithCapacity:concurrentCount];
+    NSLock *lock = [NSLock new];
+    dispatch_apply(concurrentCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t iteration) {
+        UIImage *image = [coder decodedImageWithData:data options:nil];
+        if (image) {
+            [lock lock];
+            [images addObject:image];
+            [lock unlock];
+        }
+    });
+    expect(images.count).equal(concurrentCount);
+    for (UIImage *image in images) {
+        expect([self maxColorDifferenceBetweenImage:image referenceImage:singleThreadImage]).equal(0);
+    }
+}
+
+// The max difference of the 8-bit RGBA components, sampled on a 16x16 grid
+- (NSUInteger)maxColorDifferenceBetweenImage:(UIImage *)image referenceImage:(UIImage *)referenceImage {
+    size_t width = CGImageGetWidth(image.CGImage);
+    size_t height = CGImageGetHeight(image.CGImage);
+    if (!image || width != CGImageGetWidth(referenceImage.CGImage) || height != CGImageGetHeight(referenceImage.CGImage)) {
+        return NSUIntegerMax;
+    }
+    NSUInteger maxDifference = 0;
+    NSUInteger gridCount = 16;
+    for (NSUInteger i = 0; i < gridCount; i++) {
+        for (NSUInteger j = 0; j < gridCount; j++) {
+            CGPoint point = CGPointMake((width - 1) * i / (gridCount - 1), (height - 1) * j / (gridCount - 1));
+            CGFloat components[4], referenceComponents[4];
+            [[image sd_colorAtPoint:point] getRed:&components[0] green:&components[1] blue:&components[2] alpha:&components[3]];
+            [[referenceImage sd_colorAtPoint:point] getRed:&referenceComponents[0] green:&referenceComponents[1] blue:&referenceComponents[2] alpha:&referenceComponents[3]];
+            for (NSUInteger k = 0; k < 4; k++) {
+                maxDifference = MAX(maxDifference, (NSUInteger)round(fabs(components[k] - referenceComponents[k]) * 255));
+            }
+        }
+    }
+    return maxDifference;
+}
+
 - (void)verifyCoder:(id<SDImageCoder>)coder
 withLocalImageURL:(NSURL *)imageUrl
  supportsEncoding:(BOOL)supportsEncoding
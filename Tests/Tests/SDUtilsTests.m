@@ -13,6 +13,9 @@
 #import "SDInternalMacros.h"
 #import "SDFileAttributeHelper.h"
 #import "UIColor+SDHexString.h"
+#import "SDImageAssetManager.h"
+#import "SDLockProfiler.h"
+#import "SDDeviceHelper.h"
 
 @interface SDUtilsTests : SDTestCase
 
@@ -151,6 +154,37 @@
     expect([grayscaleImage sd_colorAtPoint:CGPointMake(50, 50)].sd_hexString).equal(grayscaleColor.sd_hexString);
 }
 
+- (void)testSDGraphicsImageRendererPool {
+    SDGraphicsImageRendererPool *pool = [[SDGraphicsImageRendererPool alloc] init];
+    pool.countLimit = 2;
+    SDGraphicsImageRendererFormat *format = [[SDGraphicsImageRendererFormat alloc] init];
+    format.scale = 1;
+    CGSize size = CGSizeMake(10, 10);
+    UIImage *redImage = [pool imageWithSize:size format:format actions:^(CGContextRef  _Nonnull context) {
+        CGContextSetFillColorWithColor(context, UIColor.redColor.CGColor);
+        CGContextFillRect(context, CGRectMake(0, 0, size.width, size.height));
+    }];
+    expect(pool.missCount).equal(1);
+    expect(pool.hitCount).equal(0);
+    expect(pool.count).equal(1);
+    // Reuse the same renderer, the previous image should not be changed
+    UIImage *clearImage = [pool imageWithSize:size format:format actions:^(CGContextRef  _Nonnull context) {}];
+    expect(pool.hitCount).equal(1);
+    expect(pool.hitRate).equal(0.5);
+    expect(redImage.size).equal(size);
+    expect([redImage sd_colorAtPoint:CGPointMake(5, 5)].sd_hexString).equal(UIColor.redColor.sd_hexString);
+    expect([clearImage sd_colorAtPoint:CGPointMake(5, 5)].sd_hexString).notTo.equal(UIColor.redColor.sd_hexString);
+    // Size cap
+    [pool imageWithSize:CGSizeMake(20, 20) format:format actions:^(CGContextRef  _Nonnull context) {}];
+    [pool imageWithSize:CGSizeMake(30, 30) format:format actions:^(CGContextRef  _Nonnull context) {}];
+    expect(pool.count).equal(2);
+    expect(pool.missCount).equal(3);
+    [pool removeAllRenderers];
+    expect(pool.count).equal(0);
+    [pool resetStatistics];
+    expect(pool.hitRate).equal(0);
+}
+
 - (void)testSDScaledImageForKey {
     // Test nil
     expect(SDScaledImageForKey(nil, nil)).beNil();
@@ -217,6 +251,137 @@
     [self waitForExpectationsWithCommonTimeout];
 }
 
+- (void)testSDImageAssetManagerResourceIndex {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Asset manager resource index"];
+    NSBundle *testBundle = [NSBundle bundleForClass:[self class]];
+    SDImageAssetManager *assetManager = [[SDImageAssetManager alloc] init];
+    // Index is built on background queue, lookup fallback to bundle before ready
+    CGFloat scale = 0;
+    NSString *path = [assetManager getPathForName:@"TestImage.jpg" bundle:testBundle preferredScale:&scale];
+    expect(path).equal([self testJPEGPath]);
+    [assetManager resourceIndexForBundle:testBundle completion:^(NSDictionary<NSString *,NSString *> * _Nullable index) {
+        expect(index).notTo.beNil();
+        expect([assetManager resourceIndexForBundle:testBundle]).equal(index);
+        // Case-folded key
+        expect(index[@"testimage.jpg"]).equal([self testJPEGPath]);
+        CGFloat scale2 = 0;
+        expect([assetManager getPathForName:@"TestImage.gif" bundle:testBundle preferredScale:&scale2]).equal([self testGIFPath]);
+        expect([assetManager getPathForName:@"TESTIMAGE.gif" bundle:testBundle preferredScale:&scale2]).equal([self testGIFPath]);
+        expect([assetManager getPathForName:@"1.gif" bundle:testBundle preferredScale:&scale2]).notTo.beNil();
+        expect(scale2).equal(2);
+        expect([assetManager getPathForName:@"NotExist.png" bundle:testBundle preferredScale:&scale2]).beNil();
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)testSDLockProfilerStress {
+    // Run with `SD_LOCK_PROFILING=1` to rank the hot locks, the statistics are empty otherwise
+    [SDLockProfiler reset];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Concurrent loads finished"];
+    SDImageCache *cache = [[SDImageCache alloc] initWithNamespace:@"LockProfiler"];
+    SDWebImageManager *manager = [[SDWebImageManager alloc] initWithCache:cache loader:SDWebImageDownloader.sharedDownloader];
+    NSString *path = [self testJPEGPath];
+    NSUInteger loadCount = 200;
+    dispatch_group_t group = dispatch_group_create();
+    dispatch_apply(loadCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+        // Different URLs with same file, which exercise the downloader, manager and cache locks concurrently
+        NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"%@?index=%zu", [NSURL fileURLWithPath:path].absoluteString, i % 20]];
+        dispatch_group_enter(group);
+        [manager loadImageWithURL:url options:0 context:@{SDWebImageContextCallbackQueue : SDCallbackQueue.globalQueue} progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, SDImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {
+            if (finished) {
+                dispatch_group_leave(group);
+            }
+        }];
+    });
+    dispatch_group_notify(group, dispatch_get_main_queue(), ^{
+        NSArray<NSDictionary<NSString *, id> *> *statistics = [SDLockProfiler statistics];
+        if (SDLockProfiler.isEnabled) {
+            expect(statistics.count).beGreaterThan(0);
+            NSUInteger totalCount = 0;
+            double previousWaitTime = DBL_MAX;
+            BOOL hasManagerSite = NO;
+            for (NSDictionary<NSString *, id> *statistic in statistics) {
+                NSUInteger count = [statistic[SDLockProfilerCountKey] unsignedIntegerValue];
+                double waitTime = [statistic[SDLockProfilerWaitTimeKey] doubleValue];
+                expect([statistic[SDLockProfilerFileKey] length]).beGreaterThan(0);
+                expect([statistic[SDLockProfilerLineKey] unsignedIntegerValue]).beGreaterThan(0);
+                expect(count).beGreaterThan(0);
+                // The contention stats are consistent with the count
+                expect([statistic[SDLockProfilerContendedCountKey] unsignedIntegerValue]).beLessThanOrEqualTo(count);
+                expect([statistic[SDLockProfilerMaxWaitTimeKey] doubleValue]).beLessThanOrEqualTo(waitTime);
+                expect([statistic[SDLockProfilerHoldTimeKey] doubleValue]).beGreaterThanOrEqualTo(0);
+                // Sorted by the total wait time, the hottest lock first
+                expect(waitTime).beLessThanOrEqualTo(previousWaitTime);
+                previousWaitTime = waitTime;
+                totalCount += count;
+                if ([statistic[SDLockProfilerFileKey] containsString:@"SDWebImageManager"]) {
+                    hasManagerSite = YES;
+                }
+            }
+            // Each load acquires the running operations lock of manager at least once
+            expect(hasManagerSite).beTruthy();
+            expect(totalCount).beGreaterThanOrEqualTo(loadCount);
+            expect([SDLockProfiler dumpDescription]).contain(statistics.firstObject[SDLockProfilerFileKey]);
+        } else {
+            expect(statistics.count).equal(0);
+        }
+        [cache clearWithCacheType:SDImageCacheTypeAll completion:nil];
+        [expectation fulfill];
+    });
+    [self waitForExpectationsWithTimeout:kAsyncTestTimeout * 4 handler:nil];
+}
+
+- (void)testSDMemoryBudgetProvider {
+    // Fake the procfs and cgroup v2 files
+    NSString *rootPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"SDMemoryBudgetProvider"];
+    NSFileManager *fileManager = [NSFileManager new];
+    [fileManager removeItemAtPath:rootPath error:nil];
+    NSString *cgroupPath = [rootPath stringByAppendingPathComponent:@"sys/fs/cgroup/app.slice/app.service"];
+    [fileManager createDirectoryAtPath:[rootPath stringByAppendingPathComponent:@"proc/self"] withIntermediateDirectories:YES attributes:nil error:nil];
+    [fileManager createDirectoryAtPath:cgroupPath withIntermediateDirectories:YES attributes:nil error:nil];
+    [@"MemTotal:        8388608 kB\nMemFree:          524288 kB\nMemAvailable:    4194304 kB\n" writeToFile:[rootPath stringByAppendingPathComponent:@"proc/meminfo"] atomically:YES encoding:NSUTF8StringEncoding error:nil];
+    [@"Name:\tapp\nVmRSS:\t  102400 kB\n" writeToFile:[rootPath stringByAppendingPathComponent:@"proc/self/status"] atomically:YES encoding:NSUTF8StringEncoding error:nil];
+    
+    // No cgroup, use the system memory
+    SDMemoryBudget budget;
+    SDLinuxMemoryBudgetProvider *provider = [[SDLinuxMemoryBudgetProvider alloc] initWithRootPath:rootPath];
+    expect([provider getMemoryBudget:&budget]).beTruthy();
+    expect(budget.limit).equal(8388608ull * 1024);
+    expect(budget.available).equal(4194304ull * 1024);
+    expect(budget.footprint).equal(102400ull * 1024);
+    
+    // The cgroup limit and the parent cgroup limit
+    [@"0::/app.slice/app.service\n" writeToFile:[rootPath stringByAppendingPathComponent:@"proc/self/cgroup"] atomically:YES encoding:NSUTF8StringEncoding error:nil];
+    [@"max\n" writeToFile:[cgroupPath stringByAppendingPathComponent:@"memory.max"] atomically:YES encoding:NSUTF8StringEncoding error:nil];
+    [@"1073741824\n" writeToFile:[cgroupPath.stringByDeletingLastPathComponent stringByAppendingPathComponent:@"memory.max"] atomically:YES encoding:NSUTF8StringEncoding error:nil];
+    [@"805306368\n" writeToFile:[cgroupPath.stringByDeletingLastPathComponent stringByAppendingPathComponent:@"memory.current"] atomically:YES encoding:NSUTF8StringEncoding error:nil];
+    expect([provider getMemoryBudget:&budget]).beTruthy();
+    expect(budget.limit).equal(1073741824);
+    expect(budget.available).equal(268435456);
+    
+    // Missing meminfo
+    SDLinuxMemoryBudgetProvider *invalidProvider = [[SDLinuxMemoryBudgetProvider alloc] initWithRootPath:[rootPath stringByAppendingPathComponent:@"invalid"]];
+    expect([invalidProvider getMemoryBudget:&budget]).beFalsy();
+    [fileManager removeItemAtPath:rootPath error:nil];
+    
+    // Fallback to the physical memory when the provider is not available
+    id<SDMemoryBudgetProvider> defaultProvider = SDDeviceHelper.memoryBudgetProvider;
+    SDDeviceHelper.memoryBudgetProvider = invalidProvider;
+    budget = [SDDeviceHelper memoryBudget];
+    expect(budget.limit).equal(NSProcessInfo.processInfo.physicalMemory);
+    expect(budget.footprint).equal(0);
+    expect(SDDeviceHelper.totalMemory).equal(budget.limit);
+    SDDeviceHelper.memoryBudgetProvider = defaultProvider;
+    
+    // Default provider
+    budget = [SDDeviceHelper memoryBudget];
+    expect(budget.limit).beGreaterThan(0);
+    expect(budget.footprint).beGreaterThan(0);
+    expect(budget.limit).beGreaterThanOrEqualTo(budget.available);
+    expect(SDDeviceHelper.totalMemory).equal(budget.limit);
+}
+
 - (void)testInternalMacro {
     @weakify(self);
     @onExit {
@@ -666,6 +666,72 @@
     
 }
 
+- (void)testUIViewMemoryCacheHitSetsImageWithoutLoadOperation {
+    UIImageView *imageView = [[UIImageView alloc] init];
+    SDImageCache *cache = [[SDImageCache alloc] initWithNamespace:@"MemoryFastPath"];
+    SDWebImageManager *imageManager = [[SDWebImageManager alloc] initWithCache:cache loader:[SDWebImageDownloader sharedDownloader]];
+    NSURL *url = [NSURL URLWithString:@"http://via.placeholder.com/memoryfastpath.png"];
+    UIImage *image = [[UIImage alloc] initWithContentsOfFile:[self testJPEGPath]];
+    [cache storeImageToMemory:image forKey:url.absoluteString];
+    SDWebImageContext *context = @{SDWebImageContextCustomManager : imageManager};
+
+    // Bind many times like a list, each bind completes synchronously and creates no load operation
+    NSUInteger bindCount = 1000;
+    __block NSUInteger completedCount = 0;
+    for (NSUInteger i = 0; i < bindCount; i++) {
+        imageView.image = nil;
+        id<SDWebImageOperation> operation = [imageView sd_internalSetImageWithURL:url placeholderImage:nil options:0 context:context setImageBlock:nil progress:nil completed:^(UIImage * _Nullable completedImage, NSData * _Nullable data, NSError * _Nullable error, SDImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {
+            expect(completedImage).equal(image);
+            expect(cacheType).equal(SDImageCacheTypeMemory);
+            expect(finished).beTruthy();
+            completedCount++;
+        }];
+        expect(operation).beNil();
+        expect(imageView.image).equal(image);
+    }
+    expect(completedCount).equal(bindCount);
+    expect(imageManager.isRunning).beFalsy();
+    expect(imageView.sd_imageURL).equal(url);
+    expect([imageView sd_imageLoadOperationForKey:NSStringFromClass(UIImageView.class)]).beNil();
+
+    // The options which can not complete from memory use the full pipeline
+    id<SDWebImageOperation> operation = [imageView sd_internalSetImageWithURL:url placeholderImage:nil options:SDWebImageRefreshCached context:context setImageBlock:nil progress:nil completed:nil];
+    expect(operation).notTo.beNil();
+    [operation cancel];
+
+    [cache clearMemory];
+    [cache clearDiskOnCompletion:nil];
+}
+
+- (void)testUIViewOperationAndLoadStateForMultipleKeys {
+    UIView *view = [[UIView alloc] init];
+    NSString *key1 = @"key1";
+    NSString *key2 = @"key2";
+    NSOperation *operation1 = [NSOperation new];
+    NSOperation *operation2 = [NSOperation new];
+    [view sd_setImageLoadOperation:operation1 forKey:key1];
+    [view sd_setImageLoadOperation:operation2 forKey:key2];
+    expect([view sd_imageLoadOperationForKey:key1]).equal(operation1);
+    expect([view sd_imageLoadOperationForKey:key2]).equal(operation2);
+    
+    SDWebImageLoadState *state1 = [SDWebImageLoadState new];
+    state1.url = [NSURL URLWithString:kTestJPEGURL];
+    SDWebImageLoadState *state2 = [SDWebImageLoadState new];
+    state2.url = [NSURL URLWithString:kTestPNGURL];
+    [view sd_setImageLoadState:state1 forKey:key1];
+    [view sd_setImageLoadState:state2 forKey:key2];
+    expect([view sd_imageLoadStateForKey:key1]).equal(state1);
+    expect([view sd_imageLoadStateForKey:key2]).equal(state2);
+    
+    // Remove the inline key should not affect the other keys
+    [view sd_removeImageLoadOperationWithKey:key1];
+    [view sd_removeImageLoadStateForKey:key1];
+    expect([view sd_imageLoadOperationForKey:key1]).beNil();
+    expect([view sd_imageLoadStateForKey:key1]).beNil();
+    expect([view sd_imageLoadOperationForKey:key2]).equal(operation2);
+    expect([view sd_imageLoadStateForKey:key2]).equal(state2);
+}
+
 #pragma mark - Helper
 
 - (NSString *)testJPEGPath {
@@ -20,12 +20,52 @@
  */
 @interface SDWebImageDownloadToken ()
 @property (nonatomic, weak, nullable) NSOperation<SDWebImageDownloaderOperation> *downloadOperation;
+@property (nonatomic, strong, nullable, readwrite) NSURLResponse *response;
+- (nonnull instancetype)initWithDownloadOperation:(nullable NSOperation<SDWebImageDownloaderOperation> *)downloadOperation;
 @end
 
 @interface SDWebImageDownloader ()
 @property (strong, nonatomic, nonnull) NSOperationQueue *downloadQueue;
 @end
 
+/**
+ *  Coder which count the data decoding, the decoding is forwarded to the shared coders manager
+ */
+@interface SDWebImageCountingTestCoder : NSObject <SDImageCoder>
+@property (nonatomic, assign, readonly) NSUInteger decodeCount;
+@end
+
+@implementation SDWebImageCountingTestCoder {
+    NSUInteger _decodeCount;
+}
+
+- (NSUInteger)decodeCount {
+    @synchronized (self) {
+        return _decodeCount;
+    }
+}
+
+- (BOOL)canDecodeFromData:(NSData *)data {
+    return [SDImageCodersManager.sharedManager canDecodeFromData:data];
+}
+
+- (UIImage *)decodedImageWithData:(NSData *)data options:(SDImageCoderOptions *)options {
+    @synchronized (self) {
+        _decodeCount++;
+    }
+    return [SDImageCodersManager.sharedManager decodedImageWithData:data options:options];
+}
+
+- (BOOL)canEncodeToFormat:(SDImageFormat)format {
+    return NO;
+}
+
+- (NSData *)encodedDataWithImage:(UIImage *)image format:(SDImageFormat)format options:(SDImageCoderOptions *)options {
+    return nil;
+}
+
+@end
+
 
 @interface SDWebImageDownloaderTests : SDTestCase
 
@@ -857,6 +897,111 @@
 }
 
 #pragma mark - SDWebImageLoader
+- (void)test32ThatIncrementalDecryptorWorks {
+    // Base64 decryptor decrypts chunk by chunk, the chunk boundary does not need to align with the base64 quantum
+    NSData *PNGData = [NSData dataWithContentsOfFile:[self testPNGPath]];
+    NSData *base64PNGData = [PNGData base64EncodedDataWithOptions:NSDataBase64Encoding76CharacterLineLength];
+    id<SDWebImageDownloaderDecryptor> decryptor = SDWebImageDownloaderDecryptor.base64Decryptor;
+    expect([decryptor conformsToProtocol:@protocol(SDWebImageDownloaderIncrementalDecryptor)]).beTruthy();
+    id<SDWebImageDownloaderDecryptStream> stream = [(id<SDWebImageDownloaderIncrementalDecryptor>)decryptor decryptStreamWithResponse:nil];
+    expect(stream).notTo.beNil();
+    NSMutableData *decryptedData = [NSMutableData data];
+    NSUInteger chunkSize = 1021;
+    for (NSUInteger offset = 0; offset < base64PNGData.length; offset += chunkSize) {
+        NSData *chunk = [base64PNGData subdataWithRange:NSMakeRange(offset, MIN(chunkSize, base64PNGData.length - offset))];
+        NSData *data = [stream updateWithData:chunk];
+        expect(data).notTo.beNil();
+        [decryptedData appendData:data];
+    }
+    NSData *remainingData = [stream finish];
+    expect(remainingData).notTo.beNil();
+    [decryptedData appendData:remainingData];
+    expect(decryptedData).equal(PNGData);
+    
+    // Progressive download keeps working with incremental decryptor
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Progressive download with incremental decryptor"];
+    NSURL *base64FileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:@"TestIncrementalBase64.png"]];
+    [base64PNGData writeToURL:base64FileURL atomically:YES];
+    SDWebImageDownloader *downloader = [[SDWebImageDownloader alloc] init];
+    [downloader downloadImageWithURL:base64FileURL options:SDWebImageDownloaderProgressiveLoad context:@{SDWebImageContextDownloadDecryptor : decryptor} progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, BOOL finished) {
+        if (!finished) {
+            return;
+        }
+        expect(error).to.beNil();
+        expect(image).notTo.beNil();
+        expect(data).equal(PNGData);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeoutUsingHandler:^(NSError * _Nullable error) {
+        [downloader invalidateSessionAndCancel:YES];
+    }];
+}
+
+- (void)test33ThatThumbnailVariantsDeriveFromLargestVariant {
+    // The shared download decode the full size once, the thumbnails are downsampled from it
+    NSURL *url = [NSURL fileURLWithPath:[self testJPEGPath]];
+    UIImage *testImage = [[UIImage alloc] initWithContentsOfFile:[self testJPEGPath]];
+    CGSize fullSize = testImage.size;
+    SDWebImageCountingTestCoder *coder = [SDWebImageCountingTestCoder new];
+    SDWebImageDownloader *downloader = [[SDWebImageDownloader alloc] init];
+    [downloader setSuspended:YES];
+
+    XCTestExpectation *fullExpectation = [self expectationWithDescription:@"Full size variant"];
+    [downloader downloadImageWithURL:url options:0 context:@{SDWebImageContextImageCoder : coder} progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, BOOL finished) {
+        expect(image.size).equal(fullSize);
+        expect(image.sd_isThumbnail).beFalsy();
+        [fullExpectation fulfill];
+    }];
+    CGSize thumbnailSizes[] = {CGSizeMake(100, 100), CGSizeMake(50, 50), CGSizeMake(20, 20)};
+    for (int i = 0; i < 3; i++) {
+        CGSize thumbnailSize = thumbnailSizes[i];
+        CGSize expectedSize = [SDImageCoderHelper scaledSizeWithImageSize:fullSize scaleSize:thumbnailSize preserveAspectRatio:YES shouldScaleUp:NO];
+        XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Thumbnail variant (%dx%d)", (int)thumbnailSize.width, (int)thumbnailSize.height]];
+        [downloader downloadImageWithURL:url options:0 context:@{SDWebImageContextImageCoder : coder, SDWebImageContextImageThumbnailPixelSize : @(thumbnailSize)} progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, BOOL finished) {
+            expect(image.size.width).beCloseToWithin(expectedSize.width, 1);
+            expect(image.size.height).beCloseToWithin(expectedSize.height, 1);
+            expect(image.sd_isThumbnail).beTruthy();
+            expect(image.sd_imageFormat).equal(SDImageFormatJPEG);
+            [expectation fulfill];
+        }];
+    }
+    // The scale down variant is not derived, it decodes from data
+    XCTestExpectation *scaleDownExpectation = [self expectationWithDescription:@"Scale down variant"];
+    [downloader downloadImageWithURL:url options:0 context:@{SDWebImageContextImageCoder : coder, SDWebImageContextImageScaleDownLimitBytes : @(fullSize.width * fullSize.height)} progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, BOOL finished) {
+        expect(image).notTo.beNil();
+        expect(image.size.width).beLessThan(fullSize.width);
+        [scaleDownExpectation fulfill];
+    }];
+    [downloader setSuspended:NO];
+    [self waitForExpectationsWithCommonTimeout];
+    // One decode for the full size and the grouped thumbnails, one for the scale down
+    expect(coder.decodeCount).equal(2);
+
+    // The animated image can not be downsampled as the thumbnail, each variant decodes from data
+    NSURL *gifURL = [[NSBundle bundleForClass:[self class]] URLForResource:@"TestImage" withExtension:@"gif"];
+    SDWebImageCountingTestCoder *animatedCoder = [SDWebImageCountingTestCoder new];
+    [downloader setSuspended:YES];
+    XCTestExpectation *animatedExpectation = [self expectationWithDescription:@"Animated full size variant"];
+    [downloader downloadImageWithURL:gifURL options:0 context:@{SDWebImageContextImageCoder : animatedCoder} progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, BOOL finished) {
+        expect(image.sd_isAnimated).beTruthy();
+        [animatedExpectation fulfill];
+    }];
+    for (int i = 0; i < 2; i++) {
+        CGSize thumbnailSize = thumbnailSizes[i];
+        XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"Animated thumbnail variant (%dx%d)", (int)thumbnailSize.width, (int)thumbnailSize.height]];
+        [downloader downloadImageWithURL:gifURL options:0 context:@{SDWebImageContextImageCoder : animatedCoder, SDWebImageContextImageThumbnailPixelSize : @(thumbnailSize)} progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, BOOL finished) {
+            expect(image.sd_isAnimated).beTruthy();
+            [expectation fulfill];
+        }];
+    }
+    [downloader setSuspended:NO];
+
+    [self waitForExpectationsWithCommonTimeoutUsingHandler:^(NSError * _Nullable error) {
+        expect(animatedCoder.decodeCount).equal(3);
+        [downloader invalidateSessionAndCancel:YES];
+    }];
+}
+
 - (void)testCustomImageLoaderWorks {
     XCTestExpectation *expectation = [self expectationWithDescription:@"Custom image not works"];
     SDWebImageTestLoader *loader = [[SDWebImageTestLoader alloc] init];
@@ -901,6 +1046,55 @@
     [self waitForExpectationsWithCommonTimeout];
 }
 
+- (void)testThatLoadersManagerRoutesBySchemeAndHost {
+    SDWebImageTestLoader *httpLoader = [[SDWebImageTestLoader alloc] init];
+    httpLoader.supportedURLSchemes = [NSSet setWithObjects:@"http", @"https", nil];
+    SDWebImageTestLoader *hostLoader = [[SDWebImageTestLoader alloc] init];
+    hostLoader.supportedURLSchemes = [NSSet setWithObject:@"https"];
+    hostLoader.supportedURLHosts = [NSSet setWithObject:@"example.com"];
+    SDImageLoadersManager *manager = [[SDImageLoadersManager alloc] init];
+    // Dynamic loader (downloader) has the lowest priority
+    manager.loaders = @[SDWebImageDownloader.sharedDownloader, httpLoader, hostLoader];
+    
+    expect([manager loaderForURL:[NSURL URLWithString:@"https://EXAMPLE.com/a.png"] options:0 context:nil]).equal(hostLoader);
+    expect([manager loaderForURL:[NSURL URLWithString:@"HTTPS://other.com/a.png"] options:0 context:nil]).equal(httpLoader);
+    expect([manager loaderForURL:[NSURL URLWithString:@"http://example.com/a.png"] options:0 context:nil]).equal(httpLoader);
+    // Undeclared scheme fallback to dynamic loader
+    expect([manager loaderForURL:[NSURL fileURLWithPath:@"/tmp/a.png"] options:0 context:nil]).equal(SDWebImageDownloader.sharedDownloader);
+    expect([manager loaderForURL:nil options:0 context:nil]).beNil();
+    
+    // Routes are rebuilt when loaders changed
+    [manager removeLoader:hostLoader];
+    expect([manager loaderForURL:[NSURL URLWithString:@"https://example.com/a.png"] options:0 context:nil]).equal(httpLoader);
+    [manager removeLoader:SDWebImageDownloader.sharedDownloader];
+    expect([manager canRequestImageForURL:[NSURL fileURLWithPath:@"/tmp/a.png"] options:0 context:nil]).beFalsy();
+}
+
+- (void)testThatDownloadTokenParsesCacheExpiration {
+    NSURL *url = [NSURL URLWithString:@"https://example.com/a.png"];
+    SDWebImageDownloadToken *token = [[SDWebImageDownloadToken alloc] initWithDownloadOperation:nil];
+    // No caching headers
+    token.response = [[NSHTTPURLResponse alloc] initWithURL:url statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:@{}];
+    expect(token.cacheExpirationDate).beNil();
+    // Immutable wins over max-age
+    token.response = [[NSHTTPURLResponse alloc] initWithURL:url statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:@{@"Cache-Control" : @"public, max-age=31536000, immutable"}];
+    expect(token.cacheExpirationDate).equal([NSDate distantFuture]);
+    // The max-age minus age
+    token.response = [[NSHTTPURLResponse alloc] initWithURL:url statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:@{@"cache-control" : @"max-age=60", @"Age" : @"10"}];
+    expect(token.cacheExpirationDate.timeIntervalSinceNow).beCloseToWithin(50, 5);
+    // The no-store is already expired
+    token.response = [[NSHTTPURLResponse alloc] initWithURL:url statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:@{@"Cache-Control" : @"no-store"}];
+    expect(token.cacheExpirationDate.timeIntervalSinceNow).beLessThanOrEqualTo(0);
+    // The no-cache wins regardless of the directive order
+    token.response = [[NSHTTPURLResponse alloc] initWithURL:url statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:@{@"Cache-Control" : @"immutable, no-cache"}];
+    expect(token.cacheExpirationDate.timeIntervalSinceNow).beLessThanOrEqualTo(0);
+    token.response = [[NSHTTPURLResponse alloc] initWithURL:url statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:@{@"Cache-Control" : @"max-age=60, no-store"}];
+    expect(token.cacheExpirationDate.timeIntervalSinceNow).beLessThanOrEqualTo(0);
+    // The Expires relative to Date
+    token.response = [[NSHTTPURLResponse alloc] initWithURL:url statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:@{@"Date" : @"Wed, 21 Oct 2015 07:28:00 GMT", @"Expires" : @"Wed, 21 Oct 2015 08:28:00 GMT"}];
+    expect(token.cacheExpirationDate.timeIntervalSinceNow).beCloseToWithin(3600, 5);
+}
+
 #pragma mark - Helper
 
 - (NSString *)testPNGPath {
@@ -908,4 +1102,9 @@
     return [testBundle pathForResource:@"TestImage" ofType:@"png"];
 }
 
+- (NSString *)testJPEGPath {
+    NSBundle *testBundle = [NSBundle bundleForClass:[self class]];
+    return [testBundle pathForResource:@"TestImage" ofType:@"jpg"];
+}
+
 @end
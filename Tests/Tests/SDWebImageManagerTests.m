@@ -663,6 +663,181 @@
     [self waitForExpectationsWithCommonTimeout];
 }
 
+- (void)test23ThatLoadImageFutureCanBeChainedAndCombined {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Load image future works"];
+    NSURL *fileURL = [NSURL fileURLWithPath:[self testJPEGPath]];
+    SDWebImageManager *manager = [[SDWebImageManager alloc] initWithCache:[[SDImageCache alloc] initWithNamespace:@"FutureTest"] loader:SDWebImageDownloader.sharedDownloader];
+    SDWebImageFuture<SDWebImageLoadResult *> *future1 = [manager loadImageFutureWithURL:fileURL options:SDWebImageFromLoaderOnly context:nil];
+    SDWebImageFuture<SDWebImageLoadResult *> *future2 = [manager loadImageFutureWithURL:[NSURL URLWithString:@"https://www.nonexistentdomain.invalid/image.png"] options:0 context:nil];
+    SDWebImageFuture<SDWebImageLoadResult *> *future3 = [manager loadImageFutureWithURL:fileURL options:SDWebImageFromLoaderOnly context:nil];
+    SDWebImageFuture *sizeFuture = [[SDWebImageFuture first:1 ofFutures:@[future1, future2, future3]] map:^id _Nullable(NSArray<SDWebImageLoadResult *> * _Nullable results) {
+        expect(results.count).equal(1);
+        return [NSValue valueWithCGSize:results.firstObject.image.size];
+    }];
+    [sizeFuture whenCompleteOnQueue:SDCallbackQueue.mainQueue completion:^(NSValue * _Nullable result, NSError * _Nullable error) {
+        expect(error).beNil();
+        expect(result.CGSizeValue.width).beGreaterThan(0);
+        // The remaining loads are cancelled once the combined future is resolved
+        expect(future1.state == SDWebImageFutureStateCancelled || future3.state == SDWebImageFutureStateCancelled || future2.state == SDWebImageFutureStateCancelled).beTruthy();
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)test24ThatFutureCombinatorsWork {
+    SDWebImageFuture<NSNumber *> *promise1 = [[SDWebImageFuture alloc] init];
+    SDWebImageFuture<NSNumber *> *promise2 = [[SDWebImageFuture alloc] init];
+    SDWebImageFuture<NSArray *> *allFuture = [SDWebImageFuture all:@[promise1, [promise2 map:^id _Nullable(NSNumber * _Nullable result) {
+        return @(result.integerValue * 2);
+    }]]];
+    [promise2 fulfillWithResult:@2];
+    expect(allFuture.state).equal(SDWebImageFutureStatePending);
+    [promise1 fulfillWithResult:@1];
+    expect(allFuture.result).equal(@[@1, @4]);
+    
+    SDWebImageFuture *promise3 = [[SDWebImageFuture alloc] init];
+    SDWebImageFuture *promise4 = [[SDWebImageFuture alloc] init];
+    SDWebImageFuture *raceFuture = [SDWebImageFuture race:@[promise3, promise4]];
+    [promise4 fulfillWithResult:@"4"];
+    expect(raceFuture.result).equal(@"4");
+    expect(promise3.isCancelled).beTruthy();
+    
+    SDWebImageFuture *promise5 = [[SDWebImageFuture alloc] init];
+    SDWebImageFuture *thenFuture = [promise5 then:^SDWebImageFuture * _Nullable(id _Nullable result) {
+        return [SDWebImageFuture futureWithResult:@"then"];
+    }];
+    [thenFuture cancel];
+    expect(promise5.isCancelled).beTruthy();
+    expect(thenFuture.error.code).equal(SDWebImageErrorCancelled);
+    
+    // The derived future wait for the future returned from then block
+    SDWebImageFuture *promise7 = [[SDWebImageFuture alloc] init];
+    SDWebImageFuture *nextPromise = [[SDWebImageFuture alloc] init];
+    SDWebImageFuture *chainFuture = [[promise7 then:^SDWebImageFuture * _Nullable(id _Nullable result) {
+        return nextPromise;
+    }] map:^id _Nullable(NSNumber * _Nullable result) {
+        return @(result.integerValue * 2);
+    }];
+    [promise7 fulfillWithResult:@1];
+    expect(chainFuture.state).equal(SDWebImageFutureStatePending);
+    [nextPromise fulfillWithResult:@7];
+    expect(chainFuture.result).equal(@14);
+    
+    SDWebImageFuture *promise6 = [[SDWebImageFuture alloc] init];
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.1 * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        [promise6 fulfillWithResult:@6];
+    });
+    NSError *error;
+    expect([promise6 waitWithTimeout:5 error:&error]).equal(@6);
+    expect(error).beNil();
+}
+
+- (void)test24ThatLoadImageFutureIsCancelledByOperation {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Load image future cancelled by operation"];
+    NSURL *fileURL = [NSURL fileURLWithPath:[self testJPEGPath]];
+    SDWebImageManager *manager = [[SDWebImageManager alloc] initWithCache:[[SDImageCache alloc] initWithNamespace:@"FutureCancelTest"] loader:SDWebImageDownloader.sharedDownloader];
+    SDWebImageFuture<SDWebImageLoadResult *> *future = [manager loadImageFutureWithURL:fileURL options:SDWebImageFromLoaderOnly context:nil];
+    [future whenComplete:^(SDWebImageLoadResult * _Nullable result, NSError * _Nullable error) {
+        expect(future.state).equal(SDWebImageFutureStateCancelled);
+        expect(error.code).equal(SDWebImageErrorCancelled);
+        [expectation fulfill];
+    }];
+    [manager cancelAll];
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)test25ThatCroppingTransformerPushDownIntoDecoding {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Cropping transformer push down into region decoding"];
+    NSURL *url = [NSURL URLWithString:@"https://placehold.co/200x200.png"];
+    SDImageCroppingTransformer *transformer = [SDImageCroppingTransformer transformerWithRect:CGRectMake(50, 50, 100, 50)];
+    SDWebImageContext *context = @{SDWebImageContextImageTransformer : transformer};
+    NSString *originalKey = [SDWebImageManager.sharedManager cacheKeyForURL:url];
+    [SDWebImageManager.sharedManager loadImageWithURL:url options:SDWebImageFromLoaderOnly | SDWebImageWaitStoreCache context:context progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, SDImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {
+        expect(image.sd_isRegionDecoded).beTruthy();
+        expect(image.sd_isTransformed).beTruthy();
+        expect(image.size).equal(CGSizeMake(100, 50));
+        // The region image should not be stored as original image
+        expect([SDImageCache.sharedImageCache imageFromMemoryCacheForKey:originalKey]).beNil();
+        NSString *transformedKey = [SDWebImageManager.sharedManager cacheKeyForURL:url context:context];
+        expect([SDImageCache.sharedImageCache imageFromMemoryCacheForKey:transformedKey]).equal(image);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)test26ThatBlurHashPreviewIsDeliveredBeforeFullImage {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"BlurHash preview then full image"];
+    expect([UIImage sd_imageWithBlurHash:@"invalid" size:CGSizeMake(32, 32)]).beNil();
+    NSURL *url = [NSURL URLWithString:@"https://placehold.co/301x301.png"];
+    SDWebImageContext *context = @{SDWebImageContextImagePreviewBlurHash : @"LEHV6nWB2yk8pyo0adR*.7kCMdnj"};
+    __block NSUInteger callCount = 0;
+    [SDWebImageManager.sharedManager loadImageWithURL:url options:SDWebImageFromLoaderOnly context:context progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, SDImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {
+        callCount++;
+        expect(imageURL).equal(url);
+        if (callCount == 1) {
+            // The preview is decoded in memory and delivered first
+            expect(finished).beFalsy();
+            expect(image.size).equal(CGSizeMake(32, 32));
+        } else {
+            expect(callCount).equal(2);
+            expect(finished).beTruthy();
+            expect(image.size).equal(CGSizeMake(301, 301));
+            [expectation fulfill];
+        }
+    }];
+    // The preview does not wait for network
+    expect(callCount).equal(1);
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)test27ThatCancelTwoPhaseLoadCancelsPreview {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Cancel two-phase load cancels the preview"];
+    NSURL *url = [NSURL URLWithString:@"https://placehold.co/302x302.png"];
+    NSURL *previewURL = [NSURL URLWithString:@"https://placehold.co/30x30.png"];
+    SDWebImageContext *context = @{SDWebImageContextImagePreviewURL : previewURL};
+    SDWebImageCombinedOperation *operation = [SDWebImageManager.sharedManager loadImageWithURL:url options:SDWebImageFromLoaderOnly context:context progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, SDImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {
+        // The preview should not be delivered after cancel
+        expect(finished).beTruthy();
+        expect(error.code).equal(SDWebImageErrorCancelled);
+        [expectation fulfill];
+    }];
+    SDWebImageCombinedOperation *previewOperation = (SDWebImageCombinedOperation *)operation.previewOperation;
+    expect(previewOperation).notTo.beNil();
+    [operation cancel];
+    expect(previewOperation.isCancelled).beTruthy();
+    expect(operation.previewOperation).beNil();
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)test28ThatThumbHashPreviewIsDiscardedByProgressiveImage {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"ThumbHash preview then progressive image"];
+    expect([UIImage sd_imageWithThumbHashString:@"invalid"]).beNil();
+    // The ThumbHash keeps the aspect ratio (5:7), the longer side is 32
+    NSString *thumbHash = @"1QcSHQRnh493V4dIh4eXh1h4kJUI";
+    expect([UIImage sd_imageWithThumbHashString:thumbHash].size).equal(CGSizeMake(23, 32));
+    NSURL *url = [NSURL URLWithString:@"https://raw.githubusercontent.com/SDWebImage/SDWebImage/master/SDWebImage_logo.png"];
+    SDWebImageContext *context = @{SDWebImageContextImagePreviewThumbHash : thumbHash};
+    __block NSUInteger callCount = 0;
+    __block BOOL fullImageDelivered = NO;
+    [SDWebImageManager.sharedManager loadImageWithURL:url options:SDWebImageFromLoaderOnly | SDWebImageProgressiveLoad context:context progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, SDImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {
+        callCount++;
+        BOOL isPreview = CGSizeEqualToSize(image.size, CGSizeMake(23, 32));
+        if (callCount == 1) {
+            expect(isPreview).beTruthy();
+        } else if (image) {
+            // The preview should never be delivered after any image from the full pipeline, including the partial one
+            expect(isPreview && fullImageDelivered).beFalsy();
+            fullImageDelivered = YES;
+        }
+        if (finished) {
+            expect(image).notTo.beNil();
+            [expectation fulfill];
+        }
+    }];
+    expect(callCount).equal(1);
+    [self waitForExpectationsWithCommonTimeout];
+}
+
 - (NSString *)testJPEGPath {
     NSBundle *testBundle = [NSBundle bundleForClass:[self class]];
     return [testBundle pathForResource:@"TestImage" ofType:@"jpg"];
@@ -15,4 +15,8 @@
 
 @property (nonatomic, class, readonly, nonnull) SDWebImageTestLoader *sharedLoader;
 
+// For loaders manager routing test, nil by default
+@property (nonatomic, copy, nullable) NSSet<NSString *> *supportedURLSchemes;
+@property (nonatomic, copy, nullable) NSSet<NSString *> *supportedURLHosts;
+
 @end
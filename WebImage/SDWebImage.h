@@ -25,8 +25,13 @@ FOUNDATION_EXPORT const unsigned char SDWebImageVersionString[];
 #import <SDWebImage/SDImageCache.h>
 #import <SDWebImage/SDMemoryCache.h>
 #import <SDWebImage/SDDiskCache.h>
+#import <SDWebImage/SDDiskCacheEvictionPolicy.h>
+#import <SDWebImage/SDImageCacheDiskBudget.h>
+#import <SDWebImage/SDContentAddressedDiskCache.h>
+#import <SDWebImage/SDDecodedImageDiskCache.h>
 #import <SDWebImage/SDImageCacheDefine.h>
 #import <SDWebImage/SDImageCachesManager.h>
+#import <SDWebImage/SDImageArchiveCache.h>
 #import <SDWebImage/UIView+WebCache.h>
 #import <SDWebImage/UIImageView+WebCache.h>
 #import <SDWebImage/UIImageView+HighlightedWebCache.h>
@@ -44,8 +49,11 @@ FOUNDATION_EXPORT const unsigned char SDWebImageVersionString[];
 #import <SDWebImage/UIImage+Metadata.h>
 #import <SDWebImage/UIImage+MultiFormat.h>
 #import <SDWebImage/UIImage+MemoryCacheCost.h>
+#import <SDWebImage/UIImage+BlurHash.h>
+#import <SDWebImage/UIImage+ThumbHash.h>
 #import <SDWebImage/UIImage+ExtendedCacheData.h>
 #import <SDWebImage/SDWebImageOperation.h>
+#import <SDWebImage/SDWebImageFuture.h>
 #import <SDWebImage/SDWebImageDownloader.h>
 #import <SDWebImage/SDWebImageTransition.h>
 #import <SDWebImage/SDWebImageIndicator.h>
@@ -62,6 +70,7 @@ FOUNDATION_EXPORT const unsigned char SDWebImageVersionString[];
 #import <SDWebImage/SDImageIOCoder.h>
 #import <SDWebImage/SDImageFrame.h>
 #import <SDWebImage/SDImageCoderHelper.h>
+#import <SDWebImage/SDImageAtlas.h>
 #import <SDWebImage/SDImageGraphics.h>
 #import <SDWebImage/SDGraphicsImageRenderer.h>
 #import <SDWebImage/UIImage+GIF.h>
@@ -89,3 +98,20 @@ FOUNDATION_EXPORT const unsigned char SDWebImageVersionString[];
 #if __has_include(<SDWebImage/MKAnnotationView+WebCache.h>)
 #import <SDWebImage/MKAnnotationView+WebCache.h>
 #endif
+
+// Coders
+#if __has_include(<SDWebImage/SDImageTurboJPEGCoder.h>)
+#import <SDWebImage/SDImageTurboJPEGCoder.h>
+#endif
+#if __has_include(<SDWebImage/SDImageSPNGCoder.h>)
+#import <SDWebImage/SDImageSPNGCoder.h>
+#endif
+#if __has_include(<SDWebImage/SDImageGIFLibCoder.h>)
+#import <SDWebImage/SDImageGIFLibCoder.h>
+#endif
+#if __has_include(<SDWebImage/SDImageLibWebPCoder.h>)
+#import <SDWebImage/SDImageLibWebPCoder.h>
+#endif
+#if __has_include(<SDWebImage/SDImageLibAVIFCoder.h>)
+#import <SDWebImage/SDImageLibAVIFCoder.h>
+#endif